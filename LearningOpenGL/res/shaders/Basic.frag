@@ -9,11 +9,16 @@ in vec2 v_TexCoord;
 
 
 // Uniform variable - way to get data from CPU at draw call to the GPU in shader
-uniform vec4 u_Color;
 uniform sampler2D u_Texture;	// Sampler2D is an index to the texture slot we are using
 
+// Per-material data (UniformBlockBinding::Material)
+layout(std140) uniform Material
+{
+	vec4 u_Tint;	// Multiplied with the texture color
+};
+
 void main()
 {
 	vec4 texColor = texture(u_Texture, v_TexCoord);
-	color = texColor;
-}
\ No newline at end of file
+	color = texColor * u_Tint;
+}
@@ -7,10 +7,16 @@ layout(location = 1) in vec2 texCoord;
 
 out vec2 v_TexCoord;	// v - varying
 
-uniform mat4 u_MVP;	// Model View Projection matrix
+// Camera data shared by every shader, uploaded once per frame (UniformBlockBinding::Camera)
+layout(std140) uniform Camera
+{
+	mat4 u_ViewProjection;	// Projection * View matrix
+};
+
+uniform mat4 u_Model;	// Model matrix of the object being drawn
 
 void main()
 {
-	gl_Position = u_MVP * position;
+	gl_Position = u_ViewProjection * u_Model * position;
 	v_TexCoord = texCoord;
-}
\ No newline at end of file
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Vertices are already transformed into world space on the CPU by the BatchRenderer
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+layout(location = 2) in vec4 color;
+layout(location = 3) in float texIndex;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+out float v_TexIndex;
+
+// Camera data shared by every shader (UniformBlockBinding::Camera)
+layout(std140) uniform Camera
+{
+	mat4 u_ViewProjection;
+};
+
+void main()
+{
+	gl_Position = u_ViewProjection * position;
+	v_TexCoord = texCoord;
+	v_Color = color;
+	v_TexIndex = texIndex;
+}
@@ -0,0 +1,25 @@
+#version 330 core
+
+// Per-vertex attributes (the quad)
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+// Per-instance attributes (a mat4 takes up 4 locations: 2, 3, 4, 5)
+layout(location = 2) in mat4 model;
+layout(location = 6) in vec4 color;
+
+out vec2 v_TexCoord;
+out vec4 v_Color;
+
+// Camera data shared by every shader (UniformBlockBinding::Camera)
+layout(std140) uniform Camera
+{
+	mat4 u_ViewProjection;
+};
+
+void main()
+{
+	gl_Position = u_ViewProjection * model * position;
+	v_TexCoord = texCoord;
+	v_Color = color;
+}
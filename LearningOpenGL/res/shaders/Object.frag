@@ -0,0 +1,18 @@
+#version 330 core
+
+layout(location = 0) out vec4 color;
+
+in vec2 v_TexCoord;
+
+uniform sampler2D u_Texture;	// Texture unit 0
+
+layout(std140) uniform Object
+{
+	mat4 u_Model;
+	vec4 u_Color;	// Multiplied with the texture color
+};
+
+void main()
+{
+	color = texture(u_Texture, v_TexCoord) * u_Color;
+}
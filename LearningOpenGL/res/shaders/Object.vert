@@ -0,0 +1,25 @@
+#version 330 core
+
+layout(location = 0) in vec4 position;
+layout(location = 1) in vec2 texCoord;
+
+out vec2 v_TexCoord;
+
+// Camera data shared by every shader, uploaded once per frame (UniformBlockBinding::Camera)
+layout(std140) uniform Camera
+{
+	mat4 u_ViewProjection;
+};
+
+// Per-object data, a range of one buffer holding every object's block (UniformBlockBinding::Object)
+layout(std140) uniform Object
+{
+	mat4 u_Model;
+	vec4 u_Color;
+};
+
+void main()
+{
+	gl_Position = u_ViewProjection * u_Model * position;
+	v_TexCoord = texCoord;
+}
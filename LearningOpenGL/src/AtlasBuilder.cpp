@@ -0,0 +1,154 @@
+#include "AtlasBuilder.h"
+#include "stb_image/stb_image.h"
+
+// imgui_draw.cpp already compiles stb_rect_pack with STBRP_STATIC, so this file gets its own static copy
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include "imgui/imstb_rectpack.h"
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+AtlasBuilder::AtlasBuilder(int pageSize, int padding, const TextureSpec& spec)
+	: m_PageSize(pageSize), m_Padding(padding), m_Spec(spec)
+{
+}
+
+/*
+ * Loads the image at [filepath]. Returns its id, or -1 if it failed to load.
+ */
+int AtlasBuilder::AddImage(const std::string& filepath)
+{
+	int width, height;
+	unsigned char* pixels = Texture::DecodeImage(filepath, width, height);	// Same orientation as Texture
+	if (!pixels)
+	{
+		std::cout << "Warning: failed to load atlas image " << filepath << ": " << stbi_failure_reason() << std::endl;
+		return -1;
+	}
+
+	int id = AddImage(filepath, width, height, pixels);
+	stbi_image_free(pixels);
+	return id;
+}
+
+/*
+ * Copies [pixels] (RGBA8, bottom row first) into the builder. Returns the image's id.
+ */
+int AtlasBuilder::AddImage(const std::string& name, int width, int height, const unsigned char* pixels)
+{
+	Image image;
+	image.Name = name;
+	image.Width = width;
+	image.Height = height;
+	image.Pixels.assign(pixels, pixels + (size_t)width * height * 4);
+	m_Images.push_back(std::move(image));
+	return (int)m_Images.size() - 1;
+}
+
+/*
+ * Where image [id] was packed. Page is -1 for images that failed to load or did not fit, and before Build().
+ */
+const AtlasRegion& AtlasBuilder::GetRegion(int id) const
+{
+	static const AtlasRegion invalid = { -1, glm::vec4(0.0f), 0, 0 };
+	if (id < 0 || id >= (int)m_Regions.size())
+		return invalid;
+	return m_Regions[id];
+}
+
+/*
+ * Packs every added image into as few pages as possible and uploads the pages.
+ * Images that don't fit on the current page move on to the next one.
+ */
+void AtlasBuilder::Build()
+{
+	m_Regions.assign(m_Images.size(), { -1, glm::vec4(0.0f), 0, 0 });
+	m_Pages.clear();
+
+	std::vector<stbrp_rect> pending;
+	for (int i = 0; i < (int)m_Images.size(); i++)
+	{
+		stbrp_rect rect = {};
+		rect.id = i;
+		rect.w = m_Images[i].Width + 2 * m_Padding;
+		rect.h = m_Images[i].Height + 2 * m_Padding;
+
+		if (rect.w > m_PageSize || rect.h > m_PageSize)
+		{
+			std::cout << "Warning: atlas image " << m_Images[i].Name << " (" << m_Images[i].Width << "x" << m_Images[i].Height
+				<< ") does not fit in a " << m_PageSize << "x" << m_PageSize << " page" << std::endl;
+			continue;
+		}
+		pending.push_back(rect);
+	}
+
+	std::vector<stbrp_node> nodes(m_PageSize);
+	while (!pending.empty())
+	{
+		stbrp_context context;
+		stbrp_init_target(&context, m_PageSize, m_PageSize, nodes.data(), (int)nodes.size());
+		stbrp_setup_heuristic(&context, STBRP_HEURISTIC_Skyline_BF_sortHeight);
+		stbrp_pack_rects(&context, pending.data(), (int)pending.size());
+
+		int pageIndex = (int)m_Pages.size();
+		std::vector<unsigned char> page((size_t)m_PageSize * m_PageSize * 4, 0);
+		std::vector<stbrp_rect> remaining;
+
+		for (const stbrp_rect& rect : pending)
+		{
+			if (!rect.was_packed)
+			{
+				remaining.push_back(rect);
+				continue;
+			}
+
+			const Image& image = m_Images[rect.id];
+			int x = rect.x + m_Padding;
+			int y = rect.y + m_Padding;
+			CopyWithBleed(image, page, x, y);
+
+			AtlasRegion& region = m_Regions[rect.id];
+			region.Page = pageIndex;
+			region.UVRect = glm::vec4((float)x, (float)y, (float)(x + image.Width), (float)(y + image.Height)) / (float)m_PageSize;
+			region.Width = image.Width;
+			region.Height = image.Height;
+		}
+
+		// Every pending rect fits an empty page on its own, so this only happens if the packer misbehaves
+		if (remaining.size() == pending.size())
+		{
+			std::cout << "Warning: atlas packing made no progress, " << remaining.size() << " images were left out" << std::endl;
+			break;
+		}
+
+		m_Pages.push_back(std::make_unique<Texture>(m_PageSize, m_PageSize, page.data(), m_Spec));
+		pending.swap(remaining);
+	}
+
+	// The pixels live on the GPU now
+	for (Image& image : m_Images)
+		std::vector<unsigned char>().swap(image.Pixels);
+}
+
+/*
+ * Copies [image] to (x, y) in [page], then repeats its edge pixels outwards over the padding.
+ */
+void AtlasBuilder::CopyWithBleed(const Image& image, std::vector<unsigned char>& page, int x, int y) const
+{
+	size_t rowSize = (size_t)image.Width * 4;
+	for (int row = -m_Padding; row < image.Height + m_Padding; row++)
+	{
+		int sourceRow = std::min(std::max(row, 0), image.Height - 1);
+		const unsigned char* src = &image.Pixels[sourceRow * rowSize];
+		unsigned char* dst = &page[((size_t)(y + row) * m_PageSize + x) * 4];
+
+		std::memcpy(dst, src, rowSize);
+		for (int i = 1; i <= m_Padding; i++)
+		{
+			std::memcpy(dst - i * 4, src, 4);
+			std::memcpy(dst + rowSize + (i - 1) * 4, src + rowSize - 4, 4);
+		}
+	}
+}
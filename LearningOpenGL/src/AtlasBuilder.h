@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+/*
+ * AtlasBuilder.h
+ * Packs many images into a few large textures (atlas pages), so sprites using different images can be
+ * drawn from the same texture without rebinding between them.
+ *
+ * Usage:
+ *		Add every image with AddImage(). It returns the image's id.
+ *		Call Build() to pack the images (with stb_rect_pack) and create the page textures.
+ *		Look up an image with GetRegion(id): its page index, and the UV rectangle to pass to
+ *		BatchRenderer::SubmitQuad() along with GetPage(region.Page). Ids of images that failed to load (-1) or
+ *		were not packed give a region with Page -1.
+ *
+ *		Each image is surrounded by [padding] pixels that repeat its edge pixels (bleed), so linear filtering
+ *		and lower mip levels sample the image's own border color instead of its neighbour in the atlas.
+ *		Images that are larger than a page (with padding) are skipped with a warning.
+ */
+
+/*
+ * AtlasRegion
+ * Where an image ended up in the atlas.
+ */
+struct AtlasRegion
+{
+	int Page;			// -1 if the image could not be packed
+	glm::vec4 UVRect;	// Bottom left (x, y) and top right (z, w) texture coordinates, without the padding
+	int Width, Height;
+};
+
+class AtlasBuilder
+{
+private:
+	struct Image
+	{
+		std::string Name;
+		std::vector<unsigned char> Pixels;	// RGBA8, bottom row first like the rest of the textures
+		int Width, Height;
+	};
+
+	int m_PageSize;
+	int m_Padding;
+	TextureSpec m_Spec;
+
+	std::vector<Image> m_Images;
+	std::vector<AtlasRegion> m_Regions;
+	std::vector<std::unique_ptr<Texture>> m_Pages;
+
+public:
+	AtlasBuilder(int pageSize = 4096, int padding = 2, const TextureSpec& spec = TextureSpec());
+
+	int AddImage(const std::string& filepath);
+	int AddImage(const std::string& name, int width, int height, const unsigned char* pixels);
+
+	void Build();
+
+	const AtlasRegion& GetRegion(int id) const;
+	inline const Texture& GetPage(int page) const { return *m_Pages[page]; }
+	inline unsigned int GetPageCount() const { return (unsigned int)m_Pages.size(); }
+	inline unsigned int GetImageCount() const { return (unsigned int)m_Images.size(); }
+	inline int GetPageSize() const { return m_PageSize; }
+	inline int GetPadding() const { return m_Padding; }
+
+private:
+	void CopyWithBleed(const Image& image, std::vector<unsigned char>& page, int x, int y) const;
+};
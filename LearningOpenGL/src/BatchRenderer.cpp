@@ -0,0 +1,164 @@
+#include "BatchRenderer.h"
+#include "Renderer.h"
+#include "GLErrorManager.h"
+
+
+BatchRenderer::BatchRenderer()
+	: m_QuadCapacity(0), m_DrawCalls(0)
+{
+	m_Shader = std::make_unique<Shader>("res/shaders/Batch.vert", "res/shaders/Batch.frag");
+
+	// Every texture slot samples from the texture unit with the same number
+	int slots[MaxTextureSlots];
+	for (unsigned int i = 0; i < MaxTextureSlots; i++)
+		slots[i] = i;
+	m_Shader->Bind();
+	m_Shader->SetUniform1iv("u_Textures", MaxTextureSlots, slots);
+
+	m_VAO = std::make_unique<VertexArrayObject>();
+	m_VertexBuffer = std::make_unique<VertexBuffer>(1024 * 4 * sizeof(QuadVertex));
+
+	// Must match QuadVertex
+	VertexBufferLayout layout;
+	layout.Push<float>(3);	// Position
+	layout.Push<float>(2);	// TexCoord
+	layout.Push<float>(4);	// Color
+	layout.Push<float>(1);	// TexIndex
+	m_VAO->AddBuffer(*m_VertexBuffer, layout);
+
+	ReserveIndices(1024);
+}
+
+BatchRenderer::~BatchRenderer()
+{
+}
+
+/*
+ * Starts a new batch. Quads submitted from now on are drawn by the next EndBatch().
+ */
+void BatchRenderer::BeginBatch()
+{
+	m_Vertices.clear();
+	m_TextureSets.clear();
+	m_DrawCalls = 0;
+}
+
+/*
+ * Adds a quad to the batch.
+ *
+ * @input transform - model matrix applied to the unit quad
+ * @input uvRect - texture coordinates of the bottom left (x, y) and top right (z, w) corners
+ * @input texture - texture to sample
+ * @input color - multiplied with the texture color
+ */
+void BatchRenderer::SubmitQuad(const glm::mat4& transform, const glm::vec4& uvRect, const Texture& texture,
+	const glm::vec4& color)
+{
+	float texIndex = GetTextureSlot(texture);
+
+	// Corners of the unit quad, counter-clockwise from the bottom left
+	static const glm::vec4 corners[4] = {
+		{ -0.5f, -0.5f, 0.0f, 1.0f },
+		{  0.5f, -0.5f, 0.0f, 1.0f },
+		{  0.5f,  0.5f, 0.0f, 1.0f },
+		{ -0.5f,  0.5f, 0.0f, 1.0f }
+	};
+	const glm::vec2 texCoords[4] = {
+		{ uvRect.x, uvRect.y },
+		{ uvRect.z, uvRect.y },
+		{ uvRect.z, uvRect.w },
+		{ uvRect.x, uvRect.w }
+	};
+
+	for (int i = 0; i < 4; i++)
+		m_Vertices.push_back({ glm::vec3(transform * corners[i]), texCoords[i], color, texIndex });
+
+	m_TextureSets.back().QuadCount++;
+}
+
+/*
+ * Uploads every submitted vertex in one go, then draws each texture set with a single draw call.
+ */
+void BatchRenderer::EndBatch()
+{
+	unsigned int quadCount = GetQuadCount();
+	if (quadCount == 0)
+		return;
+
+	ReserveIndices(quadCount);
+	m_VertexBuffer->SetData(m_Vertices.data(), (unsigned int)(m_Vertices.size() * sizeof(QuadVertex)));
+
+	Renderer renderer;
+	for (const TextureSet& set : m_TextureSets)
+	{
+		for (unsigned int slot = 0; slot < set.TextureCount; slot++)
+			set.Textures[slot]->Bind(slot);
+
+		renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader, set.QuadCount * 6, set.FirstQuad * 6);
+		m_DrawCalls++;
+	}
+}
+
+/*
+ * Returns the slot [texture] is bound to in the current texture set.
+ * Starts a new texture set if the texture is not in the current one and every slot is taken.
+ */
+float BatchRenderer::GetTextureSlot(const Texture& texture)
+{
+	if (!m_TextureSets.empty())
+	{
+		TextureSet& set = m_TextureSets.back();
+		for (unsigned int i = 0; i < set.TextureCount; i++)
+		{
+			if (set.Textures[i] == &texture)
+				return (float)i;
+		}
+
+		if (set.TextureCount < MaxTextureSlots)
+		{
+			set.Textures[set.TextureCount] = &texture;
+			return (float)(set.TextureCount++);
+		}
+	}
+
+	// No room left (or first quad of the batch), so the following quads go in a new draw call
+	TextureSet set;
+	set.FirstQuad = GetQuadCount();
+	set.QuadCount = 0;
+	set.TextureCount = 1;
+	set.Textures[0] = &texture;
+	m_TextureSets.push_back(set);
+	return 0.0f;
+}
+
+/*
+ * Makes sure the index buffer has indices for at least [quadCount] quads.
+ * Every quad uses the same pattern, so the indices never change once created.
+ */
+void BatchRenderer::ReserveIndices(unsigned int quadCount)
+{
+	if (quadCount <= m_QuadCapacity)
+		return;
+
+	unsigned int capacity = m_QuadCapacity == 0 ? quadCount : m_QuadCapacity;
+	while (capacity < quadCount)
+		capacity *= 2;
+
+	std::vector<unsigned int> indices(capacity * 6);
+	for (unsigned int quad = 0; quad < capacity; quad++)
+	{
+		unsigned int vertex = quad * 4;
+		unsigned int* index = &indices[quad * 6];
+		index[0] = vertex + 0;
+		index[1] = vertex + 1;
+		index[2] = vertex + 2;
+		index[3] = vertex + 2;
+		index[4] = vertex + 3;
+		index[5] = vertex + 0;
+	}
+
+	// Bind our VAO first so the new index buffer is attached to it
+	m_VAO->Bind();
+	m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+	m_QuadCapacity = capacity;
+}
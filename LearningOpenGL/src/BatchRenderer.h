@@ -0,0 +1,89 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "FrameArena.h"
+#include "VertexArrayObject.h"
+#include "VertexBuffer.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+
+#include "glm/glm.hpp"
+
+/*
+ * BatchRenderer.h
+ * Draws many textured quads with a handful of draw calls instead of one Renderer::Draw per quad.
+ * Quad vertices are transformed on the CPU and collected into one dynamic VertexBuffer, so quads
+ * with different transforms (and up to MaxTextureSlots different textures) share a single glDrawElements.
+ *
+ * Usage:
+ *		Upload the view-projection matrix to the Camera UniformBuffer (shared by every shader).
+ *		Call BeginBatch() to start collecting quads.
+ *		Call SubmitQuad() for every quad. The texture must stay alive until EndBatch() returns.
+ *		Call EndBatch() to upload the vertices and issue one draw call per texture set.
+ *		The quads are stored in the FrameArena, so a batch must end in the frame it began.
+ *
+ *		The quad being transformed is the unit quad from (-0.5, -0.5) to (0.5, 0.5), so the
+ *		transform's scale is the size of the quad.
+ */
+
+/*
+ * QuadVertex
+ * A single vertex of a batched quad, matching the layout in res/shaders/Batch.vert.
+ */
+struct QuadVertex
+{
+	glm::vec3 Position;
+	glm::vec2 TexCoord;
+	glm::vec4 Color;
+	float TexIndex;		// Which texture slot to sample (float because attributes are set up with glVertexAttribPointer)
+};
+
+class BatchRenderer
+{
+public:
+	// Texture units a single draw call can sample from (GL guarantees at least 16 in the fragment shader)
+	static const unsigned int MaxTextureSlots = 16;
+
+private:
+	/*
+	 * A run of consecutive quads that can be drawn with the same set of bound textures.
+	 */
+	struct TextureSet
+	{
+		unsigned int FirstQuad;
+		unsigned int QuadCount;
+		unsigned int TextureCount;
+		const Texture* Textures[MaxTextureSlots];
+	};
+
+	std::unique_ptr<VertexArrayObject> m_VAO;
+	std::unique_ptr<VertexBuffer> m_VertexBuffer;
+	std::unique_ptr<IndexBuffer> m_IndexBuffer;
+	std::unique_ptr<Shader> m_Shader;
+
+	// Rebuilt every batch, so they live in the FrameArena
+	FrameArray<QuadVertex> m_Vertices;
+	FrameArray<TextureSet> m_TextureSets;
+	unsigned int m_QuadCapacity;	// Number of quads the index buffer currently covers
+
+	unsigned int m_DrawCalls;
+
+public:
+	BatchRenderer();
+	~BatchRenderer();
+
+	void BeginBatch();
+	void SubmitQuad(const glm::mat4& transform, const glm::vec4& uvRect, const Texture& texture,
+		const glm::vec4& color = glm::vec4(1.0f));
+	void EndBatch();
+
+	inline unsigned int GetQuadCount() const { return (unsigned int)(m_Vertices.size() / 4); }
+	inline unsigned int GetDrawCallCount() const { return m_DrawCalls; }
+
+private:
+	float GetTextureSlot(const Texture& texture);
+	void ReserveIndices(unsigned int quadCount);
+};
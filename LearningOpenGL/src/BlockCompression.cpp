@@ -0,0 +1,606 @@
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define BC_USE_SSE2 1
+	#include <emmintrin.h>
+#else
+	#define BC_USE_SSE2 0
+#endif
+
+// BC7 interpolation weights for 4 bit indices, out of 64
+static const int s_BC7Weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+/*
+ * One 4x4 block with a separate array per channel, so 4 pixels fit in one SSE register
+ */
+struct Block
+{
+	alignas(16) float Channels[4][16];
+};
+
+struct Endpoints
+{
+	float Start[4];
+	float End[4];
+};
+
+static void LoadBlock(const unsigned char* rgba, Block& block)
+{
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 4; c++)
+			block.Channels[c][i] = rgba[i * 4 + c];
+}
+
+/*
+ * For every pixel, finds the closest of the [paletteSize] palette colors over channels
+ * [firstChannel, firstChannel + channelCount). Writes the indices and returns the summed squared error.
+ */
+static float FindClosest(const Block& block, int firstChannel, int channelCount,
+	const float (*palette)[4], int paletteSize, unsigned char* indices)
+{
+#if BC_USE_SSE2
+	// The 16 pixels are 4 groups of 4, each group's best distance and index kept in a register
+	__m128 best[4];
+	__m128i bestIndex[4];
+	for (int group = 0; group < 4; group++)
+	{
+		best[group] = _mm_set1_ps(1e30f);
+		bestIndex[group] = _mm_setzero_si128();
+	}
+
+	for (int p = 0; p < paletteSize; p++)
+	{
+		__m128 color[4];
+		for (int c = 0; c < channelCount; c++)
+			color[c] = _mm_set1_ps(palette[p][firstChannel + c]);
+		__m128i index = _mm_set1_epi32(p);
+
+		for (int group = 0; group < 4; group++)
+		{
+			__m128 distance = _mm_setzero_ps();
+			for (int c = 0; c < channelCount; c++)
+			{
+				__m128 diff = _mm_sub_ps(_mm_load_ps(&block.Channels[firstChannel + c][group * 4]), color[c]);
+				distance = _mm_add_ps(distance, _mm_mul_ps(diff, diff));
+			}
+
+			// Select without branches: take the new index wherever the distance is smaller
+			__m128i closer = _mm_castps_si128(_mm_cmplt_ps(distance, best[group]));
+			bestIndex[group] = _mm_or_si128(_mm_and_si128(closer, index), _mm_andnot_si128(closer, bestIndex[group]));
+			best[group] = _mm_min_ps(best[group], distance);
+		}
+	}
+
+	alignas(16) int groupIndices[16];
+	alignas(16) float groupErrors[16];
+	for (int group = 0; group < 4; group++)
+	{
+		_mm_store_si128((__m128i*)&groupIndices[group * 4], bestIndex[group]);
+		_mm_store_ps(&groupErrors[group * 4], best[group]);
+	}
+
+	float error = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		indices[i] = (unsigned char)groupIndices[i];
+		error += groupErrors[i];
+	}
+	return error;
+#else
+	float error = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		float best = 1e30f;
+		int bestIndex = 0;
+		for (int p = 0; p < paletteSize; p++)
+		{
+			float distance = 0.0f;
+			for (int c = 0; c < channelCount; c++)
+			{
+				float diff = block.Channels[firstChannel + c][i] - palette[p][firstChannel + c];
+				distance += diff * diff;
+			}
+			if (distance < best)
+			{
+				best = distance;
+				bestIndex = p;
+			}
+		}
+		indices[i] = (unsigned char)bestIndex;
+		error += best;
+	}
+	return error;
+#endif
+}
+
+/*
+ * Endpoints at the extremes of the block's colors along their principal axis
+ */
+static Endpoints PrincipalAxisEndpoints(const Block& block, int channelCount)
+{
+	float mean[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int c = 0; c < channelCount; c++)
+	{
+		for (int i = 0; i < 16; i++)
+			mean[c] += block.Channels[c][i];
+		mean[c] /= 16.0f;
+	}
+
+	float covariance[4][4] = {};
+	for (int i = 0; i < 16; i++)
+	{
+		for (int a = 0; a < channelCount; a++)
+			for (int b = 0; b < channelCount; b++)
+				covariance[a][b] += (block.Channels[a][i] - mean[a]) * (block.Channels[b][i] - mean[b]);
+	}
+
+	// Power iteration converges on the eigenvector with the largest eigenvalue
+	float axis[4] = { 1.0f, 1.0f, 1.0f, 1.0f };
+	for (int iteration = 0; iteration < 8; iteration++)
+	{
+		float next[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+		float length = 0.0f;
+		for (int a = 0; a < channelCount; a++)
+		{
+			for (int b = 0; b < channelCount; b++)
+				next[a] += covariance[a][b] * axis[b];
+			length += next[a] * next[a];
+		}
+		if (length < 1e-12f)
+			break;	// Every pixel is the same color, any axis will do
+
+		length = 1.0f / std::sqrt(length);
+		for (int c = 0; c < channelCount; c++)
+			axis[c] = next[c] * length;
+	}
+
+	float minT = 1e30f, maxT = -1e30f;
+	for (int i = 0; i < 16; i++)
+	{
+		float t = 0.0f;
+		for (int c = 0; c < channelCount; c++)
+			t += (block.Channels[c][i] - mean[c]) * axis[c];
+		minT = std::min(minT, t);
+		maxT = std::max(maxT, t);
+	}
+
+	Endpoints endpoints = {};
+	for (int c = 0; c < channelCount; c++)
+	{
+		endpoints.Start[c] = std::min(std::max(mean[c] + axis[c] * maxT, 0.0f), 255.0f);
+		endpoints.End[c] = std::min(std::max(mean[c] + axis[c] * minT, 0.0f), 255.0f);
+	}
+	return endpoints;
+}
+
+/*
+ * Least squares fit of the endpoints, given each pixel's position [weights] (0 = start, 1 = end) between them.
+ * Returns false if the indices don't determine the endpoints (every pixel uses the same weight).
+ */
+static bool RefineEndpoints(const Block& block, int channelCount, const float* weights, Endpoints& endpoints)
+{
+	float a = 0.0f, b = 0.0f, c = 0.0f;
+	float x0[4] = { 0.0f, 0.0f, 0.0f, 0.0f }, x1[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+	for (int i = 0; i < 16; i++)
+	{
+		float t = weights[i], s = 1.0f - t;
+		a += s * s;
+		b += s * t;
+		c += t * t;
+		for (int ch = 0; ch < channelCount; ch++)
+		{
+			x0[ch] += s * block.Channels[ch][i];
+			x1[ch] += t * block.Channels[ch][i];
+		}
+	}
+
+	float determinant = a * c - b * b;
+	if (std::abs(determinant) < 1e-6f)
+		return false;
+
+	for (int ch = 0; ch < channelCount; ch++)
+	{
+		endpoints.Start[ch] = std::min(std::max((c * x0[ch] - b * x1[ch]) / determinant, 0.0f), 255.0f);
+		endpoints.End[ch] = std::min(std::max((a * x1[ch] - b * x0[ch]) / determinant, 0.0f), 255.0f);
+	}
+	return true;
+}
+
+/* ~~~~~~~~~~ BC1 ~~~~~~~~~~ */
+
+static unsigned short To565(const float* color)
+{
+	int r = (int)(color[0] * 31.0f / 255.0f + 0.5f);
+	int g = (int)(color[1] * 63.0f / 255.0f + 0.5f);
+	int b = (int)(color[2] * 31.0f / 255.0f + 0.5f);
+	return (unsigned short)((r << 11) | (g << 5) | b);
+}
+
+static void From565(unsigned short value, float* color)
+{
+	int r = (value >> 11) & 31, g = (value >> 5) & 63, b = value & 31;
+	color[0] = (float)((r << 3) | (r >> 2));
+	color[1] = (float)((g << 2) | (g >> 4));
+	color[2] = (float)((b << 3) | (b >> 2));
+	color[3] = 255.0f;
+}
+
+/*
+ * Palette of a BC1 block, as the decoder sees it. [fourColor] is always true inside BC3.
+ */
+static void BC1Palette(unsigned short color0, unsigned short color1, bool fourColor, float (*palette)[4])
+{
+	From565(color0, palette[0]);
+	From565(color1, palette[1]);
+	for (int c = 0; c < 3; c++)
+	{
+		if (fourColor)
+		{
+			palette[2][c] = (float)(int)((2.0f * palette[0][c] + palette[1][c]) / 3.0f);
+			palette[3][c] = (float)(int)((palette[0][c] + 2.0f * palette[1][c]) / 3.0f);
+		}
+		else
+		{
+			palette[2][c] = (float)(int)((palette[0][c] + palette[1][c]) / 2.0f);
+			palette[3][c] = 0.0f;
+		}
+	}
+	palette[2][3] = 255.0f;
+	palette[3][3] = fourColor ? 255.0f : 0.0f;
+}
+
+static void CompressColorBlock(const Block& block, unsigned char* output)
+{
+	static const float s_IndexWeights[4] = { 0.0f, 1.0f, 1.0f / 3.0f, 2.0f / 3.0f };
+
+	Endpoints endpoints = PrincipalAxisEndpoints(block, 3);
+
+	float bestError = 1e30f;
+	unsigned short bestColor0 = 0, bestColor1 = 0;
+	unsigned char bestIndices[16] = {};
+
+	for (int iteration = 0; iteration < 2; iteration++)
+	{
+		unsigned short color0 = To565(endpoints.Start);
+		unsigned short color1 = To565(endpoints.End);
+		if (color0 < color1)
+			std::swap(color0, color1);	// color0 > color1 selects the 4 color mode
+
+		float palette[4][4];
+		BC1Palette(color0, color1, true, palette);
+
+		unsigned char indices[16];
+		float error = FindClosest(block, 0, 3, palette, color0 == color1 ? 1 : 4, indices);
+		if (error < bestError)
+		{
+			bestError = error;
+			bestColor0 = color0;
+			bestColor1 = color1;
+			std::memcpy(bestIndices, indices, 16);
+		}
+
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+			weights[i] = s_IndexWeights[indices[i]];
+
+		// Fit relative to the endpoints actually used, which may have been swapped
+		From565(color0, endpoints.Start);
+		From565(color1, endpoints.End);
+		if (error == 0.0f || !RefineEndpoints(block, 3, weights, endpoints))
+			break;
+	}
+
+	output[0] = (unsigned char)(bestColor0 & 0xFF);
+	output[1] = (unsigned char)(bestColor0 >> 8);
+	output[2] = (unsigned char)(bestColor1 & 0xFF);
+	output[3] = (unsigned char)(bestColor1 >> 8);
+
+	unsigned int bits = 0;
+	for (int i = 0; i < 16; i++)
+		bits |= (unsigned int)bestIndices[i] << (i * 2);
+	for (int i = 0; i < 4; i++)
+		output[4 + i] = (unsigned char)(bits >> (i * 8));
+}
+
+static void DecompressColorBlock(const unsigned char* input, bool allowThreeColor, unsigned char* rgba)
+{
+	unsigned short color0 = (unsigned short)(input[0] | (input[1] << 8));
+	unsigned short color1 = (unsigned short)(input[2] | (input[3] << 8));
+	unsigned int bits = input[4] | (input[5] << 8) | (input[6] << 16) | ((unsigned int)input[7] << 24);
+
+	float palette[4][4];
+	BC1Palette(color0, color1, !allowThreeColor || color0 > color1, palette);
+
+	for (int i = 0; i < 16; i++)
+	{
+		int index = (bits >> (i * 2)) & 3;
+		for (int c = 0; c < 4; c++)
+			rgba[i * 4 + c] = (unsigned char)palette[index][c];
+	}
+}
+
+/* ~~~~~~~~~~ BC3 alpha ~~~~~~~~~~ */
+
+static void AlphaPalette(int alpha0, int alpha1, float (*palette)[4])
+{
+	palette[0][3] = (float)alpha0;
+	palette[1][3] = (float)alpha1;
+	for (int i = 2; i < 8; i++)
+	{
+		if (alpha0 > alpha1)
+			palette[i][3] = (float)(((8 - i) * alpha0 + (i - 1) * alpha1) / 7);
+		else if (i < 6)
+			palette[i][3] = (float)(((6 - i) * alpha0 + (i - 1) * alpha1) / 5);
+		else
+			palette[i][3] = i == 6 ? 0.0f : 255.0f;
+	}
+}
+
+static void CompressAlphaBlock(const Block& block, unsigned char* output)
+{
+	float minAlpha = 255.0f, maxAlpha = 0.0f;
+	for (int i = 0; i < 16; i++)
+	{
+		minAlpha = std::min(minAlpha, block.Channels[3][i]);
+		maxAlpha = std::max(maxAlpha, block.Channels[3][i]);
+	}
+
+	int alpha0 = (int)maxAlpha, alpha1 = (int)minAlpha;
+	unsigned char indices[16] = {};
+	if (alpha0 != alpha1)
+	{
+		float palette[8][4];
+		AlphaPalette(alpha0, alpha1, palette);
+		FindClosest(block, 3, 1, palette, 8, indices);
+	}
+
+	output[0] = (unsigned char)alpha0;
+	output[1] = (unsigned char)alpha1;
+
+	unsigned long long bits = 0;
+	for (int i = 0; i < 16; i++)
+		bits |= (unsigned long long)indices[i] << (i * 3);
+	for (int i = 0; i < 6; i++)
+		output[2 + i] = (unsigned char)(bits >> (i * 8));
+}
+
+static void DecompressAlphaBlock(const unsigned char* input, unsigned char* rgba)
+{
+	float palette[8][4];
+	AlphaPalette(input[0], input[1], palette);
+
+	unsigned long long bits = 0;
+	for (int i = 0; i < 6; i++)
+		bits |= (unsigned long long)input[2 + i] << (i * 8);
+
+	for (int i = 0; i < 16; i++)
+		rgba[i * 4 + 3] = (unsigned char)palette[(bits >> (i * 3)) & 7][3];
+}
+
+/* ~~~~~~~~~~ BC7 mode 6 ~~~~~~~~~~ */
+
+/*
+ * Writes [count] bits of [value] at [offset] in the 128 bit block, least significant bit first
+ */
+static void WriteBits(unsigned char* output, int& offset, unsigned int value, int count)
+{
+	for (int i = 0; i < count; i++, offset++)
+	{
+		if (value & (1u << i))
+			output[offset >> 3] |= (unsigned char)(1 << (offset & 7));
+	}
+}
+
+static unsigned int ReadBits(const unsigned char* input, int& offset, int count)
+{
+	unsigned int value = 0;
+	for (int i = 0; i < count; i++, offset++)
+		value |= (unsigned int)((input[offset >> 3] >> (offset & 7)) & 1) << i;
+	return value;
+}
+
+static void BC7Palette(const int* endpoint0, const int* endpoint1, float (*palette)[4])
+{
+	for (int i = 0; i < 16; i++)
+		for (int c = 0; c < 4; c++)
+			palette[i][c] = (float)(((64 - s_BC7Weights[i]) * endpoint0[c] + s_BC7Weights[i] * endpoint1[c] + 32) >> 6);
+}
+
+static void CompressBC7Block(const Block& block, unsigned char* output)
+{
+	Endpoints endpoints = PrincipalAxisEndpoints(block, 4);
+
+	float bestError = 1e30f;
+	int best0[4] = {}, best1[4] = {};	// 8 bit endpoints, the lowest bit being the p-bit
+	unsigned char bestIndices[16] = {};
+
+	for (int iteration = 0; iteration < 2; iteration++)
+	{
+		// Each endpoint shares one p-bit between its channels, so try all 4 combinations
+		for (int pbits = 0; pbits < 4; pbits++)
+		{
+			int p0 = pbits & 1, p1 = pbits >> 1;
+			int endpoint0[4], endpoint1[4];
+			for (int c = 0; c < 4; c++)
+			{
+				int q0 = std::min(std::max((int)((endpoints.Start[c] - p0) * 0.5f + 0.5f), 0), 127);
+				int q1 = std::min(std::max((int)((endpoints.End[c] - p1) * 0.5f + 0.5f), 0), 127);
+				endpoint0[c] = (q0 << 1) | p0;
+				endpoint1[c] = (q1 << 1) | p1;
+			}
+
+			float palette[16][4];
+			BC7Palette(endpoint0, endpoint1, palette);
+
+			unsigned char indices[16];
+			float error = FindClosest(block, 0, 4, palette, 16, indices);
+			if (error < bestError)
+			{
+				bestError = error;
+				std::memcpy(best0, endpoint0, sizeof(best0));
+				std::memcpy(best1, endpoint1, sizeof(best1));
+				std::memcpy(bestIndices, indices, 16);
+			}
+		}
+
+		float weights[16];
+		for (int i = 0; i < 16; i++)
+			weights[i] = s_BC7Weights[bestIndices[i]] / 64.0f;
+		if (bestError == 0.0f || !RefineEndpoints(block, 4, weights, endpoints))
+			break;
+	}
+
+	// The anchor (first) index is stored without its top bit, so it must be below 8
+	if (bestIndices[0] & 8)
+	{
+		std::swap(best0, best1);
+		for (unsigned char& index : bestIndices)
+			index = 15 - index;
+	}
+
+	std::memset(output, 0, 16);
+	int offset = 0;
+	WriteBits(output, offset, 1 << 6, 7);	// Mode 6
+	for (int c = 0; c < 4; c++)
+	{
+		WriteBits(output, offset, best0[c] >> 1, 7);
+		WriteBits(output, offset, best1[c] >> 1, 7);
+	}
+	WriteBits(output, offset, best0[0] & 1, 1);
+	WriteBits(output, offset, best1[0] & 1, 1);
+	WriteBits(output, offset, bestIndices[0], 3);
+	for (int i = 1; i < 16; i++)
+		WriteBits(output, offset, bestIndices[i], 4);
+}
+
+static void DecompressBC7Block(const unsigned char* input, unsigned char* rgba)
+{
+	if ((input[0] & 0x7F) != 0x40)
+	{
+		// Only mode 6 is supported, flag anything else in magenta
+		for (int i = 0; i < 16; i++)
+		{
+			rgba[i * 4 + 0] = 255; rgba[i * 4 + 1] = 0; rgba[i * 4 + 2] = 255; rgba[i * 4 + 3] = 255;
+		}
+		return;
+	}
+
+	int offset = 7;
+	int endpoint0[4], endpoint1[4];
+	for (int c = 0; c < 4; c++)
+	{
+		endpoint0[c] = ReadBits(input, offset, 7) << 1;
+		endpoint1[c] = ReadBits(input, offset, 7) << 1;
+	}
+	int p0 = ReadBits(input, offset, 1), p1 = ReadBits(input, offset, 1);
+	for (int c = 0; c < 4; c++)
+	{
+		endpoint0[c] |= p0;
+		endpoint1[c] |= p1;
+	}
+
+	float palette[16][4];
+	BC7Palette(endpoint0, endpoint1, palette);
+	for (int i = 0; i < 16; i++)
+	{
+		int index = ReadBits(input, offset, i == 0 ? 3 : 4);
+		for (int c = 0; c < 4; c++)
+			rgba[i * 4 + c] = (unsigned char)palette[index][c];
+	}
+}
+
+/* ~~~~~~~~~~ BlockCompressor ~~~~~~~~~~ */
+
+unsigned int BlockCompressor::GetBlockBytes(BlockFormat format)
+{
+	return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+size_t BlockCompressor::GetCompressedSize(BlockFormat format, int width, int height)
+{
+	return (size_t)((width + 3) / 4) * ((height + 3) / 4) * GetBlockBytes(format);
+}
+
+const char* BlockCompressor::GetFormatName(BlockFormat format)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1:	return "BC1";
+	case BlockFormat::BC3:	return "BC3";
+	default:				return "BC7";
+	}
+}
+
+void BlockCompressor::CompressBlock(const unsigned char* rgba, BlockFormat format, unsigned char* output)
+{
+	Block block;
+	LoadBlock(rgba, block);
+
+	switch (format)
+	{
+	case BlockFormat::BC1:
+		CompressColorBlock(block, output);
+		break;
+	case BlockFormat::BC3:
+		CompressAlphaBlock(block, output);
+		CompressColorBlock(block, output + 8);
+		break;
+	case BlockFormat::BC7:
+		CompressBC7Block(block, output);
+		break;
+	}
+}
+
+void BlockCompressor::DecompressBlock(const unsigned char* input, BlockFormat format, unsigned char* rgba)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1:
+		DecompressColorBlock(input, true, rgba);
+		break;
+	case BlockFormat::BC3:
+		DecompressColorBlock(input + 8, false, rgba);
+		DecompressAlphaBlock(input, rgba);
+		break;
+	case BlockFormat::BC7:
+		DecompressBC7Block(input, rgba);
+		break;
+	}
+}
+
+void BlockCompressor::CompressImage(const unsigned char* pixels, int width, int height, BlockFormat format,
+	unsigned char* output, int firstBlockRow, int blockRowCount)
+{
+	int blocksWide = (width + 3) / 4;
+	int blocksHigh = (height + 3) / 4;
+	int lastBlockRow = blockRowCount < 0 ? blocksHigh : std::min(blocksHigh, firstBlockRow + blockRowCount);
+	unsigned int blockBytes = GetBlockBytes(format);
+
+	unsigned char rgba[16 * 4];
+	for (int by = firstBlockRow; by < lastBlockRow; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			// Gather the block, repeating the last row/column past the edge of the image
+			for (int y = 0; y < 4; y++)
+			{
+				int py = std::min(by * 4 + y, height - 1);
+				for (int x = 0; x < 4; x++)
+				{
+					int px = std::min(bx * 4 + x, width - 1);
+					std::memcpy(&rgba[(y * 4 + x) * 4], &pixels[((size_t)py * width + px) * 4], 4);
+				}
+			}
+			CompressBlock(rgba, format, output + ((size_t)by * blocksWide + bx) * blockBytes);
+		}
+	}
+}
+
+bool BlockCompressor::IsSimdEnabled()
+{
+	return BC_USE_SSE2 != 0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * BlockCompression.h
+ * CPU encoder (and reference decoder) for the BCn block compressed texture formats.
+ * Every format stores each 4x4 block of pixels in a fixed number of bytes, which the GPU decodes
+ * when sampling, so the texture stays compressed in VRAM:
+ *
+ *		BC1 - 8 bytes per block (4 bits per pixel). Two RGB565 endpoints and a 2 bit index per pixel.
+ *			Opaque only. 1/8 the size of RGBA8.
+ *		BC3 - 16 bytes per block. A BC1 color block plus two 8 bit alpha endpoints with a 3 bit index per pixel.
+ *		BC7 - 16 bytes per block. Encoded in mode 6 only (one subset, RGBA endpoints with 7 bits + a shared p-bit,
+ *			4 bit indices), which is a good quality/speed tradeoff for an offline encoder of this size.
+ *
+ * Endpoints come from the principal axis of the block's colors and are refined with a least squares fit
+ * to the chosen indices. Picking the closest palette entry for every pixel is the hot loop, and uses SSE2
+ * when the compiler targets it, with a scalar fallback.
+ *
+ * Usage:
+ *		Allocate GetCompressedSize() bytes and call CompressImage() with RGBA8 pixels.
+ *		Blocks along the right and top edge of images that aren't a multiple of 4 repeat the edge pixels.
+ *		To split the work across threads, give each thread its own range of block rows.
+ */
+
+enum class BlockFormat
+{
+	BC1,
+	BC3,
+	BC7
+};
+
+class BlockCompressor
+{
+public:
+	static unsigned int GetBlockBytes(BlockFormat format);
+	static size_t GetCompressedSize(BlockFormat format, int width, int height);
+	static const char* GetFormatName(BlockFormat format);
+
+	/*
+	 * Compresses block rows [firstBlockRow, firstBlockRow + blockRowCount) of the RGBA8 image into [output],
+	 * which holds the whole compressed image. A blockRowCount of -1 compresses every row from firstBlockRow on.
+	 */
+	static void CompressImage(const unsigned char* pixels, int width, int height, BlockFormat format,
+		unsigned char* output, int firstBlockRow = 0, int blockRowCount = -1);
+
+	static void CompressBlock(const unsigned char* rgba, BlockFormat format, unsigned char* output);	// 16 RGBA8 pixels, row by row
+	static void DecompressBlock(const unsigned char* input, BlockFormat format, unsigned char* rgba);
+
+	static bool IsSimdEnabled();
+};
@@ -1,10 +1,15 @@
 #include "Display.h"
 #include "GLErrorManager.h"
+#include "FrameArena.h"
+
+#include <thread>
 
 /*
  * Creates the m_Window and OpenGL context.
  */
-Display::Display()
+Display::Display(int width, int height, bool visible)
+    : m_SwapMode(visible ? SwapMode::VSync : SwapMode::Uncapped), m_SwapInterval(visible ? 1 : 0),
+    m_AppliedSwapInterval(visible ? 1 : 0), m_FrameLimitHz(120.0)
 {
     /* Initialize the library */
     if (!glfwInit()) {
@@ -17,9 +22,15 @@ Display::Display()
     glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#if GL_ERROR_CHECK_MODE == GL_ERROR_CHECK_DEBUG_OUTPUT
+    // Debug contexts are guaranteed to report errors through the debug message callback
+    glfwWindowHint(GLFW_OPENGL_DEBUG_CONTEXT, GLFW_TRUE);
+#endif
+    if (!visible)
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
 
     /* Create a windowed mode m_Window and its OpenGL context */
-    m_Window = glfwCreateWindow(960, 540, "Hello World", NULL, NULL);
+    m_Window = glfwCreateWindow(width, height, "Hello World", NULL, NULL);
     if (!m_Window)
     {
         glfwTerminate();
@@ -29,7 +40,7 @@ Display::Display()
     /* Make the window's context current */
     glfwMakeContextCurrent(m_Window);
 
-    glfwSwapInterval(1);    // Synchronize frame updates with V sync
+    glfwSwapInterval(m_AppliedSwapInterval);    // Synchronize frame updates with V sync, unless nobody sees them
 
     // How OpenGL handles writing to a pixel that already has a color value
     GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
@@ -56,14 +67,76 @@ bool Display::WindowShouldClose()
 
 /*
  * Calls window functions that occur at the end of a frame.
- *  - Swaps the buffers to display the frame
+ *  - Swaps the buffers to display the frame (unless [swapBuffers] is false)
+ *  - Waits until the next frame may start, in the Limited swap mode
  *  - Polls for events (like closing the window)
+ *  - Frees the frame's data in the FrameArena
  */
-void Display::EndFrame()
+void Display::EndFrame(bool swapBuffers)
 {
-    /* Swap front and back buffers */
-    glfwSwapBuffers(m_Window);
+    if (swapBuffers)
+        SwapBuffers();
+
+    if (m_SwapMode == SwapMode::Limited)
+    {
+        // Sleeps most of the way, then yields, since a sleep can overshoot by a millisecond or more
+        Clock::time_point now = Clock::now();
+        if (m_NextFrame > now)
+        {
+            std::this_thread::sleep_until(m_NextFrame - std::chrono::milliseconds(1));
+            while (Clock::now() < m_NextFrame)
+                std::this_thread::yield();
+        }
+        else
+            m_NextFrame = now;  // Late, so don't try to catch up with shorter frames
+        m_NextFrame += std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / m_FrameLimitHz));
+    }
 
     /* Poll for and process events */
     glfwPollEvents();
+
+    // Everything allocated for this frame is done with
+    FrameArena::Reset();
+}
+
+/*
+ * Swaps front and back buffers. Called by the thread the context is current on.
+ */
+void Display::SwapBuffers()
+{
+    int interval = m_SwapInterval.load(std::memory_order_relaxed);
+    if (interval != m_AppliedSwapInterval)
+    {
+        glfwSwapInterval(interval);
+        m_AppliedSwapInterval = interval;
+    }
+    glfwSwapBuffers(m_Window);
+}
+
+/*
+ * Uncapped and Limited swap without waiting for V sync, VSync waits for it.
+ * Call it from the main thread. The swap interval changes at the next SwapBuffers().
+ */
+void Display::SetSwapMode(SwapMode mode)
+{
+    if (mode == SwapMode::Limited && m_SwapMode != SwapMode::Limited)
+        m_NextFrame = Clock::now();
+    m_SwapMode = mode;
+    m_SwapInterval.store(mode == SwapMode::VSync ? 1 : 0, std::memory_order_relaxed);
+}
+
+/*
+ * Makes the window's context current on the calling thread. It must not be current on any other thread.
+ */
+void Display::MakeContextCurrent()
+{
+    glfwMakeContextCurrent(m_Window);
+}
+
+/*
+ * Detaches the calling thread from its context, so another thread can make it current
+ */
+void Display::ReleaseContext()
+{
+    glfwMakeContextCurrent(NULL);
 }
@@ -1,6 +1,9 @@
 #pragma once
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+
+#include <atomic>
+#include <chrono>
 /*
  * Display.h
  * Display handles the window and OpenGL context through GLFW.
@@ -10,7 +13,18 @@
  *		must exist before calling OpenGL functions, so this should be the first action.
  * 
  *		Create a while loop that runs until WindowShouldClose() returns false for a loop that keeps the window open.
- *		Call EndFrame() at the end of this loop to swap buffers (display thed frame) and poll for events.
+ *		Call EndFrame() at the end of this loop to swap buffers (display thed frame), poll for events,
+ *		and reset the FrameArena.
+ * 
+ *		With a RenderThread, the context belongs to that thread: it calls SwapBuffers(), and the main thread
+ *		calls EndFrame(false) to only poll events and reset the FrameArena.
+ * 
+ *		Pass [visible] false for a hidden window, which still has a full OpenGL context and default framebuffer
+ *		of the given size but never appears on screen (for benchmarks). Hidden windows don't wait for V sync.
+ * 
+ *		SetSwapMode() picks how frames are paced: Uncapped swaps right away, VSync waits for the monitor's refresh,
+ *		and Limited sleeps in EndFrame() so frames start at most SetFrameLimit() times per second.
+ *		The swap interval is applied by the next SwapBuffers(), on whichever thread owns the context.
  * 
  *		When this object is destroyed (out of scope), it will call glfwTerminate().
  *		Because this object was created before the OpenGL objects (hopefully), it will be destroyed
@@ -20,16 +34,38 @@
  * @credit @p9malino267 YouTube comment (https://www.youtube.com/watch?v=bTHqmzjm2UI&list=PLlrATfBNZ98foTJPJ_Ev03o2oq3-GGOS2&index=14)
  * @date 16 Februrary 2024
  */
+enum class SwapMode
+{
+	Uncapped, VSync, Limited
+};
+
 class Display
 {
 private:
+	typedef std::chrono::steady_clock Clock;
+
 	GLFWwindow* m_Window;
+
+	SwapMode m_SwapMode;
+	std::atomic<int> m_SwapInterval;	// Wanted, set by the main thread
+	int m_AppliedSwapInterval;			// Only touched by the thread the context is current on
+	double m_FrameLimitHz;
+	Clock::time_point m_NextFrame;		// When a Limited frame may start
 public:
-	Display();
+	Display(int width = 960, int height = 540, bool visible = true);
 	~Display();
 
 	bool WindowShouldClose();
-	void EndFrame();
+	void EndFrame(bool swapBuffers = true);
+	void SwapBuffers();
+
+	void SetSwapMode(SwapMode mode);
+	inline SwapMode GetSwapMode() const { return m_SwapMode; }
+	inline void SetFrameLimit(double framesPerSecond) { m_FrameLimitHz = framesPerSecond > 1.0 ? framesPerSecond : 1.0; }
+	inline double GetFrameLimit() const { return m_FrameLimitHz; }
+
+	void MakeContextCurrent();
+	static void ReleaseContext();
 
 	inline GLFWwindow* GetWindow() { return m_Window; }
 };
\ No newline at end of file
@@ -0,0 +1,108 @@
+#include "FrameArena.h"
+#include "GLErrorManager.h"
+
+#include <cstdint>
+#include <cstdlib>
+
+static const size_t s_InitialCapacity = 1024 * 1024;
+
+unsigned char* FrameArena::s_Block = nullptr;
+size_t FrameArena::s_Capacity = 0;
+size_t FrameArena::s_Used = 0;
+unsigned char* FrameArena::s_Overflow = nullptr;
+size_t FrameArena::s_OverflowCapacity = 0;
+size_t FrameArena::s_OverflowUsed = 0;
+unsigned long long FrameArena::s_Frame = 0;
+FrameArenaStats FrameArena::s_Stats = { 0, 0, 0, 0 };
+FrameArenaStats FrameArena::s_LastFrameStats = { 0, 0, 0, 0 };
+
+/*
+ * Returns [size] bytes aligned to [alignment] (a power of 2), valid until the next Reset().
+ */
+void* FrameArena::Allocate(size_t size, size_t alignment)
+{
+	ASSERT(alignment > 0 && (alignment & (alignment - 1)) == 0);
+
+	if (!s_Block)
+	{
+		s_Block = (unsigned char*)std::malloc(s_InitialCapacity);
+		ASSERT(s_Block);
+		s_Capacity = s_InitialCapacity;
+		s_Stats.Capacity = s_Capacity;
+	}
+
+	s_Stats.Allocations++;
+	s_Stats.BytesUsed += size;
+
+	uintptr_t start = ((uintptr_t)s_Block + s_Used + alignment - 1) & ~(uintptr_t)(alignment - 1);
+	size_t end = (size_t)(start - (uintptr_t)s_Block) + size;
+	if (end <= s_Capacity)
+	{
+		s_Used = end;
+		return (void*)start;
+	}
+
+	return AllocateOverflow(size, alignment);
+}
+
+/*
+ * Frees everything allocated since the last Reset(). Called by Display::EndFrame().
+ * If the frame overflowed, the main block is replaced by one that fits the whole frame.
+ */
+void FrameArena::Reset()
+{
+	while (s_Overflow)
+	{
+		unsigned char* previous;
+		std::memcpy(&previous, s_Overflow, sizeof(previous));
+		std::free(s_Overflow);
+		s_Overflow = previous;
+	}
+	if (s_Stats.Overflows > 0)
+	{
+		// Room for this frame's data, plus its alignment padding, with some to spare
+		size_t needed = s_Stats.BytesUsed + s_Stats.Allocations * alignof(std::max_align_t);
+		std::free(s_Block);
+		s_Capacity = needed + needed / 2;
+		s_Block = (unsigned char*)std::malloc(s_Capacity);
+		ASSERT(s_Block);
+	}
+
+	s_LastFrameStats = s_Stats;
+	s_Stats = { 0, 0, s_Capacity, 0 };
+	s_Used = 0;
+	s_OverflowCapacity = s_OverflowUsed = 0;
+	s_Frame++;
+}
+
+/*
+ * Allocates from the current overflow block, chaining a new one from the heap when it is full.
+ * Overflow blocks start with a pointer to the block before them, so Reset() can free them all.
+ */
+void* FrameArena::AllocateOverflow(size_t size, size_t alignment)
+{
+	if (s_Overflow)
+	{
+		uintptr_t start = ((uintptr_t)s_Overflow + s_OverflowUsed + alignment - 1) & ~(uintptr_t)(alignment - 1);
+		size_t end = (size_t)(start - (uintptr_t)s_Overflow) + size;
+		if (end <= s_OverflowCapacity)
+		{
+			s_OverflowUsed = end;
+			return (void*)start;
+		}
+	}
+
+	size_t header = alignof(std::max_align_t) > sizeof(void*) ? alignof(std::max_align_t) : sizeof(void*);
+	size_t capacity = header + size + alignment;
+	capacity = capacity > s_Capacity ? capacity : s_Capacity;
+
+	unsigned char* block = (unsigned char*)std::malloc(capacity);
+	ASSERT(block);
+	std::memcpy(block, &s_Overflow, sizeof(s_Overflow));
+	s_Overflow = block;
+	s_OverflowCapacity = capacity;
+	s_OverflowUsed = header;
+	s_Stats.Overflows++;
+
+	return AllocateOverflow(size, alignment);
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * FrameArena.h
+ * A linear (bump) allocator for data that only lives for one frame, like the render queue's commands and the
+ * batch renderer's vertices. Allocating moves a pointer forward in one big block, and Display::EndFrame() calls
+ * Reset() to free the whole frame's data at once, so a steady frame never touches the heap.
+ *
+ * If a frame needs more than the block holds, extra blocks come from the heap (counted as overflows), and the
+ * next Reset() replaces everything with one block big enough for that frame.
+ * Only the render thread may use the arena.
+ *
+ * Usage:
+ *		Allocate<T>(count) returns uninitialized space for [count] T's, New<T>(...) constructs a single T.
+ *		Nothing is destroyed on Reset(), so only put trivially destructible data in it.
+ *
+ *		FrameArray<T> is a growable array in the arena, for members that are refilled every frame. After a Reset()
+ *		it starts out empty, with room for as many elements as it held the frame before.
+ *		FrameAllocator<T> lets STL containers allocate from the arena (FrameVector<T> is a std::vector using it).
+ *		Such a container must be destroyed before the frame ends, so use it for locals, not members.
+ */
+
+/*
+ * FrameArenaStats
+ * Allocations made from the arena, for the current frame or the last complete one.
+ */
+struct FrameArenaStats
+{
+	unsigned int Allocations;
+	size_t BytesUsed;
+	size_t Capacity;			// Size of the main block
+	unsigned int Overflows;		// Extra heap blocks the frame needed
+};
+
+class FrameArena
+{
+private:
+	static unsigned char* s_Block;
+	static size_t s_Capacity;
+	static size_t s_Used;
+	static unsigned char* s_Overflow;		// Current overflow block, linked to the previous ones through its first bytes
+	static size_t s_OverflowCapacity;
+	static size_t s_OverflowUsed;
+	static unsigned long long s_Frame;
+	static FrameArenaStats s_Stats;
+	static FrameArenaStats s_LastFrameStats;
+
+public:
+	static void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	template<typename T>
+	static T* Allocate(size_t count)
+	{
+		return (T*)Allocate(count * sizeof(T), alignof(T));
+	}
+
+	template<typename T, typename... Args>
+	static T* New(Args&&... args)
+	{
+		static_assert(std::is_trivially_destructible<T>::value, "The frame arena never runs destructors");
+		return new (Allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+	}
+
+	static void Reset();
+
+	// Increases by one every Reset(), so data allocated in an earlier frame can be recognized
+	inline static unsigned long long GetFrameIndex() { return s_Frame; }
+	inline static const FrameArenaStats& GetStats() { return s_Stats; }
+	inline static const FrameArenaStats& GetLastFrameStats() { return s_LastFrameStats; }
+
+private:
+	static void* AllocateOverflow(size_t size, size_t alignment);
+};
+
+/*
+ * FrameArray
+ * A growable array of trivially copyable elements stored in the FrameArena. Its contents last until the
+ * next FrameArena::Reset(), after which it is empty again. Growing copies the elements to a bigger allocation;
+ * the old one is only reclaimed at the end of the frame.
+ * The member names follow std::vector, so it can replace one.
+ */
+template<typename T>
+class FrameArray
+{
+	static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_destructible<T>::value,
+		"FrameArray copies elements with memcpy and never destroys them");
+
+private:
+	T* m_Data;
+	size_t m_Size;
+	size_t m_Capacity;
+	size_t m_PeakSize;		// Largest size this frame, reserved up front next frame
+	unsigned long long m_Frame;
+
+public:
+	FrameArray()
+		: m_Data(nullptr), m_Size(0), m_Capacity(0), m_PeakSize(0), m_Frame(FrameArena::GetFrameIndex())
+	{
+	}
+
+	void push_back(const T& value)
+	{
+		Refresh();
+		if (m_Size == m_Capacity)
+			Grow(m_Size + 1);
+		m_Data[m_Size++] = value;
+		m_PeakSize = m_Size > m_PeakSize ? m_Size : m_PeakSize;
+	}
+
+	// New elements are left uninitialized
+	void resize(size_t size)
+	{
+		Refresh();
+		if (size > m_Capacity)
+			Grow(size);
+		m_Size = size;
+		m_PeakSize = m_Size > m_PeakSize ? m_Size : m_PeakSize;
+	}
+
+	void reserve(size_t capacity)
+	{
+		Refresh();
+		if (capacity > m_Capacity)
+			Grow(capacity);
+	}
+
+	void clear()
+	{
+		Refresh();
+		m_Size = 0;
+	}
+
+	void swap(FrameArray& other)
+	{
+		Refresh();
+		other.Refresh();
+		std::swap(m_Data, other.m_Data);
+		std::swap(m_Size, other.m_Size);
+		std::swap(m_Capacity, other.m_Capacity);
+		std::swap(m_PeakSize, other.m_PeakSize);
+	}
+
+	inline size_t size() const { return IsCurrent() ? m_Size : 0; }
+	inline bool empty() const { return size() == 0; }
+	inline T* data() { return IsCurrent() ? m_Data : nullptr; }
+	inline const T* data() const { return IsCurrent() ? m_Data : nullptr; }
+	inline T& operator[](size_t index) { return m_Data[index]; }
+	inline const T& operator[](size_t index) const { return m_Data[index]; }
+	inline T& back() { return m_Data[m_Size - 1]; }
+	inline T* begin() { return data(); }
+	inline T* end() { return data() + size(); }
+	inline const T* begin() const { return data(); }
+	inline const T* end() const { return data() + size(); }
+
+private:
+	inline bool IsCurrent() const { return m_Frame == FrameArena::GetFrameIndex(); }
+
+	// Drops storage from an earlier frame (without touching it) and reserves last frame's peak
+	void Refresh()
+	{
+		if (IsCurrent())
+			return;
+
+		size_t peak = m_PeakSize;
+		m_Data = nullptr;
+		m_Size = m_Capacity = m_PeakSize = 0;
+		m_Frame = FrameArena::GetFrameIndex();
+		if (peak > 0)
+			Grow(peak);
+	}
+
+	void Grow(size_t minimum)
+	{
+		size_t capacity = m_Capacity * 2 > minimum ? m_Capacity * 2 : minimum;
+		capacity = capacity < 16 ? 16 : capacity;
+		T* data = FrameArena::Allocate<T>(capacity);
+		if (m_Size > 0)
+			std::memcpy((void*)data, m_Data, m_Size * sizeof(T));
+		m_Data = data;
+		m_Capacity = capacity;
+	}
+};
+
+/*
+ * FrameAllocator
+ * STL allocator taking memory from the FrameArena. Deallocating does nothing, the memory is reclaimed by Reset().
+ */
+template<typename T>
+struct FrameAllocator
+{
+	using value_type = T;
+
+	FrameAllocator() = default;
+	template<typename U>
+	FrameAllocator(const FrameAllocator<U>&) {}
+
+	T* allocate(size_t count) { return FrameArena::Allocate<T>(count); }
+	void deallocate(T*, size_t) {}
+};
+
+template<typename T, typename U>
+inline bool operator==(const FrameAllocator<T>&, const FrameAllocator<U>&) { return true; }
+template<typename T, typename U>
+inline bool operator!=(const FrameAllocator<T>&, const FrameAllocator<U>&) { return false; }
+
+template<typename T>
+using FrameVector = std::vector<T, FrameAllocator<T>>;
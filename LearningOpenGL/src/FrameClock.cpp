@@ -0,0 +1,74 @@
+#include "FrameClock.h"
+
+FrameClock::FrameClock(double updateHz, unsigned int maxCatchUp)
+	: m_Started(false), m_FixedStep(true), m_StepSeconds(1.0 / updateHz), m_Accumulator(0.0), m_MaxCatchUp(maxCatchUp > 0 ? maxCatchUp : 1),
+	m_DeltaTime(0.0f), m_UpdateStep((float)m_StepSeconds), m_Alpha(1.0f), m_DroppedUpdates(0),
+	m_WindowFrames(0), m_WindowUpdates(0), m_RenderHz(0.0f), m_UpdateHz(0.0f)
+{
+}
+
+/*
+ * Starts a frame: measures the time since the last one and returns how many updates to run before rendering
+ */
+unsigned int FrameClock::BeginFrame()
+{
+	Clock::time_point now = Clock::now();
+	if (!m_Started)
+	{
+		m_LastFrame = m_WindowStart = now;
+		m_Started = true;
+	}
+
+	double seconds = std::chrono::duration<double>(now - m_LastFrame).count();
+	m_LastFrame = now;
+	m_DeltaTime = (float)seconds;
+
+	unsigned int updates = 1;
+	if (m_FixedStep)
+	{
+		m_Accumulator += seconds;
+		unsigned long long due = (unsigned long long)(m_Accumulator / m_StepSeconds);
+		m_Accumulator -= due * m_StepSeconds;
+		if (due > m_MaxCatchUp)
+		{
+			m_DroppedUpdates += due - m_MaxCatchUp;
+			due = m_MaxCatchUp;
+		}
+		updates = (unsigned int)due;
+		m_UpdateStep = (float)m_StepSeconds;
+		m_Alpha = (float)(m_Accumulator / m_StepSeconds);
+	}
+	else
+	{
+		m_UpdateStep = m_DeltaTime;
+		m_Alpha = 1.0f;
+	}
+
+	m_WindowFrames++;
+	m_WindowUpdates += updates;
+	double windowSeconds = std::chrono::duration<double>(now - m_WindowStart).count();
+	if (windowSeconds >= 0.5)
+	{
+		m_RenderHz = (float)(m_WindowFrames / windowSeconds);
+		m_UpdateHz = (float)(m_WindowUpdates / windowSeconds);
+		m_WindowStart = now;
+		m_WindowFrames = m_WindowUpdates = 0;
+	}
+
+	return updates;
+}
+
+/*
+ * Sets the length of a fixed update to 1 / [updateHz] seconds. Time already accumulated is kept.
+ */
+void FrameClock::SetUpdateRate(double updateHz)
+{
+	if (updateHz > 0.0)
+		m_StepSeconds = 1.0 / updateHz;
+}
+
+void FrameClock::SetFixedStepEnabled(bool fixedStep)
+{
+	m_FixedStep = fixedStep;
+	m_Accumulator = 0.0;
+}
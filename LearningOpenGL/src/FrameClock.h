@@ -0,0 +1,64 @@
+#pragma once
+
+#include <chrono>
+
+/*
+ * FrameClock.h
+ * Measures real frame times with std::chrono::steady_clock and turns them into updates of a fixed length,
+ * so a simulation advances at the same speed whatever the frame rate. Each frame's time is added to an
+ * accumulator, and every whole step in it is one update. What is left over (less than a step) becomes the
+ * interpolation alpha: how far the frame is between the last update and the next.
+ *
+ * After a long frame (a hitch, a dragged window, a breakpoint) at most MaxCatchUp updates run, and the rest of the
+ * backlog is dropped, so slow updates can't make every following frame slower still.
+ *
+ * Usage:
+ *		Call BeginFrame() at the start of every frame. It returns how many updates are due:
+ *		call OnUpdate(GetUpdateStep()) that many times, then render with GetAlpha().
+ *		SetFixedStepEnabled(false) makes it one update per frame of the real frame time, with an alpha of 1.
+ */
+
+class FrameClock
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point m_LastFrame;
+	bool m_Started;
+	bool m_FixedStep;
+	double m_StepSeconds;
+	double m_Accumulator;		// Seconds not simulated yet
+	unsigned int m_MaxCatchUp;
+
+	float m_DeltaTime;			// Real time since the last frame
+	float m_UpdateStep;
+	float m_Alpha;
+	unsigned long long m_DroppedUpdates;
+
+	// Rates, averaged over about half a second
+	Clock::time_point m_WindowStart;
+	unsigned int m_WindowFrames;
+	unsigned int m_WindowUpdates;
+	float m_RenderHz;
+	float m_UpdateHz;
+
+public:
+	FrameClock(double updateHz = 60.0, unsigned int maxCatchUp = 5);
+
+	unsigned int BeginFrame();
+
+	void SetUpdateRate(double updateHz);
+	inline void SetMaxCatchUp(unsigned int updates) { m_MaxCatchUp = updates > 0 ? updates : 1; }
+	void SetFixedStepEnabled(bool fixedStep);
+
+	inline double GetUpdateRate() const { return 1.0 / m_StepSeconds; }
+	inline unsigned int GetMaxCatchUp() const { return m_MaxCatchUp; }
+	inline bool IsFixedStepEnabled() const { return m_FixedStep; }
+
+	inline float GetDeltaTime() const { return m_DeltaTime; }
+	inline float GetUpdateStep() const { return m_UpdateStep; }
+	inline float GetAlpha() const { return m_Alpha; }
+	inline unsigned long long GetDroppedUpdates() const { return m_DroppedUpdates; }
+	inline float GetRenderHz() const { return m_RenderHz; }
+	inline float GetUpdateHz() const { return m_UpdateHz; }
+};
@@ -0,0 +1,71 @@
+#include "GLCommandLog.h"
+#include "GLErrorManager.h"
+
+#include <cstring>
+
+GLCommandLog::GLCommandLog()
+	: m_LastCommand(0), m_CommandCount(0), m_Counts{}
+{
+}
+
+void GLCommandLog::Clear()
+{
+	m_Data.clear();
+	m_LastCommand = 0;
+	m_CommandCount = 0;
+	std::memset(m_Counts, 0, sizeof(m_Counts));
+}
+
+/*
+ * Adds a call to [entry] with [argBytes] bytes of packed arguments.
+ */
+void GLCommandLog::Append(GLEntryPoint entry, const void* args, unsigned int argBytes)
+{
+	Header header = { (unsigned short)entry, (unsigned short)argBytes, 0 };
+
+	m_LastCommand = m_Data.size();
+	m_Data.resize(m_LastCommand + sizeof(Header) + argBytes);
+	std::memcpy(m_Data.data() + m_LastCommand, &header, sizeof(Header));
+	if (argBytes > 0)
+		std::memcpy(m_Data.data() + m_LastCommand + sizeof(Header), args, argBytes);
+
+	m_Counts[(size_t)entry]++;
+	m_CommandCount++;
+}
+
+/*
+ * Adds [bytes] bytes of [data] to the payload of the newest command. Can be called several times.
+ */
+void GLCommandLog::AppendPayload(const void* data, size_t bytes)
+{
+	ASSERT(m_CommandCount > 0);
+	if (bytes == 0)
+		return;
+
+	size_t offset = m_Data.size();
+	m_Data.resize(offset + bytes);
+	std::memcpy(m_Data.data() + offset, data, bytes);
+
+	Header header;
+	std::memcpy(&header, m_Data.data() + m_LastCommand, sizeof(Header));
+	header.PayloadBytes += (unsigned int)bytes;
+	std::memcpy(m_Data.data() + m_LastCommand, &header, sizeof(Header));
+}
+
+/*
+ * Reads the command at [offset] into [command] and moves [offset] to the next one.
+ * Returns false at the end of the log. Start with an offset of 0.
+ */
+bool GLCommandLog::Next(size_t& offset, GLCommand& command) const
+{
+	if (offset + sizeof(Header) > m_Data.size())
+		return false;
+
+	Header header;
+	std::memcpy(&header, m_Data.data() + offset, sizeof(Header));
+	const unsigned char* args = m_Data.data() + offset + sizeof(Header);
+
+	command = { (GLEntryPoint)header.Entry, args, header.ArgBytes, args + header.ArgBytes, header.PayloadBytes };
+	offset += sizeof(Header) + header.ArgBytes + header.PayloadBytes;
+	return true;
+}
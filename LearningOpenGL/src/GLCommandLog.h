@@ -0,0 +1,72 @@
+#pragma once
+
+#include "GLDispatch.h"
+
+#include <unordered_map>
+#include <vector>
+
+/*
+ * GLCommandLog.h
+ * The OpenGL calls made while GLDispatch was recording, packed back to back in one byte array:
+ * an 8 byte header, the arguments exactly as passed (no padding), then any data the call read from memory
+ * (buffer contents, pixels, uniform values, shader source) so it can be replayed later.
+ *
+ * Usage:
+ *		Pass a log to GLDispatch::BeginRecording(). Afterwards, GetCount() tells how often each function was called,
+ *		and Next() walks the commands in order. Clear() empties the log but keeps its memory for the next recording.
+ */
+
+/*
+ * GLCommand
+ * One recorded call, pointing into the log's memory. Read the arguments with memcpy, they aren't aligned.
+ */
+struct GLCommand
+{
+	GLEntryPoint Entry;
+	const unsigned char* Args;
+	unsigned int ArgBytes;
+	const unsigned char* Payload;
+	unsigned int PayloadBytes;
+};
+
+class GLCommandLog
+{
+private:
+	struct Header
+	{
+		unsigned short Entry;
+		unsigned short ArgBytes;
+		unsigned int PayloadBytes;
+	};
+
+	std::vector<unsigned char> m_Data;
+	size_t m_LastCommand;	// Offset of the newest header, which AppendPayload() adds to
+	size_t m_CommandCount;
+	unsigned int m_Counts[(size_t)GLEntryPoint::Count];
+
+public:
+	GLCommandLog();
+
+	void Clear();
+
+	void Append(GLEntryPoint entry, const void* args, unsigned int argBytes);
+	void AppendPayload(const void* data, size_t bytes);
+
+	bool Next(size_t& offset, GLCommand& command) const;
+
+	inline unsigned int GetCount(GLEntryPoint entry) const { return m_Counts[(size_t)entry]; }
+	inline size_t GetCommandCount() const { return m_CommandCount; }
+	inline size_t GetSize() const { return m_Data.size(); }
+};
+
+/*
+ * GLReplayState
+ * The real objects replay created for recorded ones, by recorded name, location or sync.
+ * Recorded names that aren't in the maps (objects created before recording started) are used as they are.
+ */
+struct GLReplayState
+{
+	std::unordered_map<GLuint, GLuint> Names;
+	std::unordered_map<GLint, GLint> Locations;
+	std::unordered_map<GLsync, GLsync> Syncs;
+};
@@ -0,0 +1,997 @@
+// The native backend has to reach the real functions, so this file doesn't redirect the gl* names
+#define GL_DISPATCH_NO_REDIRECT
+#include "GLDispatch.h"
+#include "GLCommandLog.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/* ~~~~~~~~~~ Native backend ~~~~~~~~~~ */
+
+// Forwarders, because GLEW only loads most entry points in glewInit(), after the table is initialized
+#define GL_DISPATCH_NATIVE_COMMAND(name, params, args, kinds) static void GLAPIENTRY Native##name params { gl##name args; }
+#define GL_DISPATCH_NATIVE_CUSTOM(ret, name, params, args) static ret GLAPIENTRY Native##name params { return gl##name args; }
+GL_DISPATCH_COMMANDS(GL_DISPATCH_NATIVE_COMMAND)
+GL_DISPATCH_CUSTOM(GL_DISPATCH_NATIVE_CUSTOM)
+#undef GL_DISPATCH_NATIVE_COMMAND
+#undef GL_DISPATCH_NATIVE_CUSTOM
+
+#define GL_DISPATCH_NATIVE_COMMAND_ENTRY(name, params, args, kinds) Native##name,
+#define GL_DISPATCH_NATIVE_CUSTOM_ENTRY(ret, name, params, args) Native##name,
+static const GLDispatchTable s_Native = {
+	GL_DISPATCH_COMMANDS(GL_DISPATCH_NATIVE_COMMAND_ENTRY)
+	GL_DISPATCH_CUSTOM(GL_DISPATCH_NATIVE_CUSTOM_ENTRY)
+};
+#undef GL_DISPATCH_NATIVE_COMMAND_ENTRY
+#undef GL_DISPATCH_NATIVE_CUSTOM_ENTRY
+
+GLDispatchTable GLDispatch::Table = s_Native;
+GLCommandLog* GLDispatch::s_Log = nullptr;
+
+/* ~~~~~~~~~~ Null backend ~~~~~~~~~~ */
+
+/*
+ * CPU memory standing in for a mapped buffer range. Its contents are logged when the buffer is unmapped.
+ */
+struct NullMapping
+{
+	GLintptr Offset;
+	std::vector<unsigned char> Data;
+};
+
+// Fake names and locations start far above what drivers hand out, so they never match real ones made before recording
+static GLCommandLog* s_RecordLog = nullptr;
+static GLuint s_NextName = 1u << 30;		// Fake object names, unique across recordings
+static GLint s_NextLocation = 1 << 24;	// Fake uniform locations and block indices
+static std::uintptr_t s_NextSync = 1;
+static std::unordered_map<GLenum, GLuint> s_BoundBuffers;	// By target, to find mappings and tell pixel offsets from pointers
+static std::unordered_map<GLuint, NullMapping> s_Mappings;	// By buffer
+
+/*
+ * Appends a call to [entry], with its arguments packed back to back
+ */
+template<typename... A>
+static void Record(GLEntryPoint entry, A... args)
+{
+	constexpr size_t size = (sizeof(A) + ... + 0);
+	unsigned char packed[size > 0 ? size : 1] = {};	// Zeroed, as commands without arguments copy it untouched
+	size_t offset = 0;
+	((std::memcpy(packed + offset, &args, sizeof(A)), offset += sizeof(A)), ...);
+	s_RecordLog->Append(entry, packed, (unsigned int)size);
+}
+
+template<GLEntryPoint Entry, typename... A>
+static void RecordCommand(A... args)
+{
+	Record(Entry, args...);
+}
+
+#define GL_DISPATCH_NULL_COMMAND(name, params, args, kinds) static void GLAPIENTRY Null##name params { RecordCommand<GLEntryPoint::name> args; }
+GL_DISPATCH_COMMANDS(GL_DISPATCH_NULL_COMMAND)
+#undef GL_DISPATCH_NULL_COMMAND
+
+/*
+ * True if pixel arguments are offsets into a bound GL_PIXEL_UNPACK_BUFFER rather than pointers
+ */
+static bool IsUnpackBufferBound()
+{
+	auto it = s_BoundBuffers.find(GL_PIXEL_UNPACK_BUFFER);
+	return it != s_BoundBuffers.end() && it->second != 0;
+}
+
+/*
+ * Bytes of client memory a width x height pixel upload reads, with the default GL_UNPACK_ALIGNMENT of 4.
+ * Returns 0 for formats this doesn't know.
+ */
+static size_t GetPixelDataSize(GLsizei width, GLsizei height, GLenum format, GLenum type)
+{
+	size_t components = 0;
+	switch (format)
+	{
+	case GL_RED: case GL_RED_INTEGER: components = 1; break;
+	case GL_RG: case GL_RG_INTEGER: components = 2; break;
+	case GL_RGB: case GL_BGR: components = 3; break;
+	case GL_RGBA: case GL_BGRA: components = 4; break;
+	}
+
+	size_t componentSize = 0;
+	switch (type)
+	{
+	case GL_UNSIGNED_BYTE: case GL_BYTE: componentSize = 1; break;
+	case GL_UNSIGNED_SHORT: case GL_SHORT: case GL_HALF_FLOAT: componentSize = 2; break;
+	case GL_UNSIGNED_INT: case GL_INT: case GL_FLOAT: componentSize = 4; break;
+	}
+
+	size_t rowSize = ((size_t)width * components * componentSize + 3) & ~(size_t)3;
+	return rowSize * height;
+}
+
+/*
+ * Records a pixel upload. The pixels are copied unless they come from a pixel unpack buffer.
+ */
+static void AppendPixels(const void* pixels, size_t size)
+{
+	if (pixels && !IsUnpackBufferBound())
+	{
+		if (size == 0)
+			std::cout << "Warning: pixel format not known to the null GL backend, the upload won't replay" << std::endl;
+		s_RecordLog->AppendPayload(pixels, size);
+	}
+}
+
+static GLuint NextName()
+{
+	return s_NextName++;
+}
+
+static void GLAPIENTRY NullBindBuffer(GLenum target, GLuint buffer)
+{
+	Record(GLEntryPoint::BindBuffer, target, buffer);
+	s_BoundBuffers[target] = buffer;
+}
+
+static void GLAPIENTRY NullBufferData(GLenum target, GLsizeiptr size, const void* data, GLenum usage)
+{
+	Record(GLEntryPoint::BufferData, target, size, data, usage);
+	if (data)
+		s_RecordLog->AppendPayload(data, size);
+}
+
+static void GLAPIENTRY NullBufferStorage(GLenum target, GLsizeiptr size, const void* data, GLbitfield flags)
+{
+	Record(GLEntryPoint::BufferStorage, target, size, data, flags);
+	if (data)
+		s_RecordLog->AppendPayload(data, size);
+}
+
+static void GLAPIENTRY NullBufferSubData(GLenum target, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	Record(GLEntryPoint::BufferSubData, target, offset, size, data);
+	s_RecordLog->AppendPayload(data, size);
+}
+
+static GLenum GLAPIENTRY NullClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout)
+{
+	Record(GLEntryPoint::ClientWaitSync, sync, flags, timeout);
+	return GL_ALREADY_SIGNALED;
+}
+
+static void GLAPIENTRY NullCompressedTexImage2D(GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height,
+	GLint border, GLsizei imageSize, const void* data)
+{
+	Record(GLEntryPoint::CompressedTexImage2D, target, level, internalformat, width, height, border, imageSize, data);
+	AppendPixels(data, imageSize);
+}
+
+static void GLAPIENTRY NullCompressedTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+	GLenum format, GLsizei imageSize, const void* data)
+{
+	Record(GLEntryPoint::CompressedTexSubImage2D, target, level, xoffset, yoffset, width, height, format, imageSize, data);
+	AppendPixels(data, imageSize);
+}
+
+static GLuint GLAPIENTRY NullCreateProgram()
+{
+	GLuint program = NextName();
+	Record(GLEntryPoint::CreateProgram, program);
+	return program;
+}
+
+static GLuint GLAPIENTRY NullCreateShader(GLenum type)
+{
+	GLuint shader = NextName();
+	Record(GLEntryPoint::CreateShader, type, shader);
+	return shader;
+}
+
+/*
+ * Records the [n] names created or deleted by [entry] as its payload
+ */
+static void RecordNames(GLEntryPoint entry, GLsizei n, const GLuint* names)
+{
+	Record(entry, n);
+	s_RecordLog->AppendPayload(names, n * sizeof(GLuint));
+}
+
+static void GLAPIENTRY NullDeleteBuffers(GLsizei n, const GLuint* buffers)
+{
+	RecordNames(GLEntryPoint::DeleteBuffers, n, buffers);
+	for (GLsizei i = 0; i < n; i++)
+		s_Mappings.erase(buffers[i]);
+}
+
+static void GLAPIENTRY NullDeleteQueries(GLsizei n, const GLuint* ids)
+{
+	RecordNames(GLEntryPoint::DeleteQueries, n, ids);
+}
+
+static void GLAPIENTRY NullDeleteTextures(GLsizei n, const GLuint* textures)
+{
+	RecordNames(GLEntryPoint::DeleteTextures, n, textures);
+}
+
+static void GLAPIENTRY NullDeleteVertexArrays(GLsizei n, const GLuint* arrays)
+{
+	RecordNames(GLEntryPoint::DeleteVertexArrays, n, arrays);
+}
+
+static void GLAPIENTRY NullDeleteSync(GLsync sync)
+{
+	Record(GLEntryPoint::DeleteSync, sync);
+}
+
+static GLsync GLAPIENTRY NullFenceSync(GLenum condition, GLbitfield flags)
+{
+	GLsync sync = (GLsync)s_NextSync++;
+	Record(GLEntryPoint::FenceSync, condition, flags, sync);
+	return sync;
+}
+
+static void GenNames(GLEntryPoint entry, GLsizei n, GLuint* names)
+{
+	for (GLsizei i = 0; i < n; i++)
+		names[i] = NextName();
+	RecordNames(entry, n, names);
+}
+
+static void GLAPIENTRY NullGenBuffers(GLsizei n, GLuint* buffers)
+{
+	GenNames(GLEntryPoint::GenBuffers, n, buffers);
+}
+
+static void GLAPIENTRY NullGenQueries(GLsizei n, GLuint* ids)
+{
+	GenNames(GLEntryPoint::GenQueries, n, ids);
+}
+
+static void GLAPIENTRY NullGenTextures(GLsizei n, GLuint* textures)
+{
+	GenNames(GLEntryPoint::GenTextures, n, textures);
+}
+
+static void GLAPIENTRY NullGenVertexArrays(GLsizei n, GLuint* arrays)
+{
+	GenNames(GLEntryPoint::GenVertexArrays, n, arrays);
+}
+
+static void GLAPIENTRY NullGetActiveUniform(GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name)
+{
+	// GL_ACTIVE_UNIFORMS is 0, so this is only reached by code that doesn't ask first
+	Record(GLEntryPoint::GetActiveUniform, program, index);
+	if (length)
+		*length = 0;
+	if (size)
+		*size = 0;
+	if (type)
+		*type = 0;
+	if (name && bufSize > 0)
+		name[0] = '\0';
+}
+
+static GLenum GLAPIENTRY NullGetError()
+{
+	// Not recorded: GLCall() asks after every call in debug builds, which would make the counts depend on the build
+	return GL_NO_ERROR;
+}
+
+static void GLAPIENTRY NullGetFloatv(GLenum pname, GLfloat* data)
+{
+	Record(GLEntryPoint::GetFloatv, pname);
+	*data = pname == GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT ? 1.0f : 0.0f;
+}
+
+static void GLAPIENTRY NullGetInteger64v(GLenum pname, GLint64* data)
+{
+	Record(GLEntryPoint::GetInteger64v, pname);
+	*data = 0;
+}
+
+static void GLAPIENTRY NullGetIntegerv(GLenum pname, GLint* data)
+{
+	Record(GLEntryPoint::GetIntegerv, pname);
+	switch (pname)
+	{
+	case GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT: *data = 256; break;
+	case GL_MAX_TEXTURE_IMAGE_UNITS: *data = 16; break;
+	case GL_MAX_TEXTURE_SIZE: *data = 16384; break;
+	default: *data = 0; break;	// Including GL_NUM_PROGRAM_BINARY_FORMATS, so nothing is saved to the shader cache
+	}
+}
+
+static void GLAPIENTRY NullGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary)
+{
+	Record(GLEntryPoint::GetProgramBinary, program);
+	if (length)
+		*length = 0;
+	*binaryFormat = 0;
+}
+
+static void GLAPIENTRY NullGetProgramiv(GLuint program, GLenum pname, GLint* params)
+{
+	Record(GLEntryPoint::GetProgramiv, program, pname);
+	*params = (pname == GL_LINK_STATUS || pname == GL_VALIDATE_STATUS) ? GL_TRUE : 0;
+}
+
+static void GLAPIENTRY NullGetQueryObjectiv(GLuint id, GLenum pname, GLint* params)
+{
+	Record(GLEntryPoint::GetQueryObjectiv, id, pname);
+	*params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void GLAPIENTRY NullGetQueryObjectui64v(GLuint id, GLenum pname, GLuint64* params)
+{
+	Record(GLEntryPoint::GetQueryObjectui64v, id, pname);
+	*params = pname == GL_QUERY_RESULT_AVAILABLE ? GL_TRUE : 0;
+}
+
+static void GLAPIENTRY NullGetShaderInfoLog(GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog)
+{
+	Record(GLEntryPoint::GetShaderInfoLog, shader);
+	if (length)
+		*length = 0;
+	if (bufSize > 0)
+		infoLog[0] = '\0';
+}
+
+static void GLAPIENTRY NullGetShaderiv(GLuint shader, GLenum pname, GLint* params)
+{
+	Record(GLEntryPoint::GetShaderiv, shader, pname);
+	*params = pname == GL_COMPILE_STATUS ? GL_TRUE : 0;
+}
+
+static const GLubyte* GLAPIENTRY NullGetString(GLenum name)
+{
+	Record(GLEntryPoint::GetString, name);
+	switch (name)
+	{
+	case GL_VENDOR: return (const GLubyte*)"LearningOpenGL";
+	case GL_RENDERER: return (const GLubyte*)"Null GL backend";
+	case GL_VERSION: return (const GLubyte*)"3.3 (null)";
+	case GL_SHADING_LANGUAGE_VERSION: return (const GLubyte*)"3.30 (null)";
+	default: return (const GLubyte*)"";
+	}
+}
+
+/*
+ * Records a lookup by [name] that returns a fake location, which replay maps to the real one
+ */
+static GLint RecordLocation(GLEntryPoint entry, GLuint program, const GLchar* name)
+{
+	GLint location = s_NextLocation++;
+	Record(entry, program, location);
+	s_RecordLog->AppendPayload(name, std::strlen(name) + 1);
+	return location;
+}
+
+static GLuint GLAPIENTRY NullGetUniformBlockIndex(GLuint program, const GLchar* uniformBlockName)
+{
+	return (GLuint)RecordLocation(GLEntryPoint::GetUniformBlockIndex, program, uniformBlockName);
+}
+
+static GLint GLAPIENTRY NullGetUniformLocation(GLuint program, const GLchar* name)
+{
+	return RecordLocation(GLEntryPoint::GetUniformLocation, program, name);
+}
+
+static GLboolean GLAPIENTRY NullIsEnabled(GLenum cap)
+{
+	Record(GLEntryPoint::IsEnabled, cap);
+	return GL_FALSE;
+}
+
+static void* GLAPIENTRY NullMapBufferRange(GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access)
+{
+	Record(GLEntryPoint::MapBufferRange, target, offset, length, access);
+
+	NullMapping& mapping = s_Mappings[s_BoundBuffers[target]];
+	mapping.Offset = offset;
+	mapping.Data.resize(length);
+	return mapping.Data.data();
+}
+
+static void GLAPIENTRY NullProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length)
+{
+	Record(GLEntryPoint::ProgramBinary, program, binaryFormat, binary, length);
+	s_RecordLog->AppendPayload(binary, length);
+}
+
+static void GLAPIENTRY NullShaderSource(GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length)
+{
+	// Payload: the length of each string, followed by its characters
+	Record(GLEntryPoint::ShaderSource, shader, count);
+	for (GLsizei i = 0; i < count; i++)
+	{
+		GLint size = (length && length[i] >= 0) ? length[i] : (GLint)std::strlen(string[i]);
+		s_RecordLog->AppendPayload(&size, sizeof(size));
+		s_RecordLog->AppendPayload(string[i], size);
+	}
+}
+
+static void GLAPIENTRY NullTexImage2D(GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border,
+	GLenum format, GLenum type, const void* pixels)
+{
+	Record(GLEntryPoint::TexImage2D, target, level, internalformat, width, height, border, format, type, pixels);
+	AppendPixels(pixels, GetPixelDataSize(width, height, format, type));
+}
+
+static void GLAPIENTRY NullTexSubImage2D(GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height,
+	GLenum format, GLenum type, const void* pixels)
+{
+	Record(GLEntryPoint::TexSubImage2D, target, level, xoffset, yoffset, width, height, format, type, pixels);
+	AppendPixels(pixels, GetPixelDataSize(width, height, format, type));
+}
+
+static void GLAPIENTRY NullUniform1iv(GLint location, GLsizei count, const GLint* value)
+{
+	Record(GLEntryPoint::Uniform1iv, location, count, value);
+	s_RecordLog->AppendPayload(value, count * sizeof(GLint));
+}
+
+static void GLAPIENTRY NullUniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+{
+	Record(GLEntryPoint::UniformMatrix4fv, location, count, transpose, value);
+	s_RecordLog->AppendPayload(value, count * 16 * sizeof(GLfloat));
+}
+
+static GLboolean GLAPIENTRY NullUnmapBuffer(GLenum target)
+{
+	// Payload: the mapped offset, then what was written to the mapping
+	Record(GLEntryPoint::UnmapBuffer, target);
+	auto it = s_Mappings.find(s_BoundBuffers[target]);
+	if (it != s_Mappings.end())
+	{
+		s_RecordLog->AppendPayload(&it->second.Offset, sizeof(GLintptr));
+		s_RecordLog->AppendPayload(it->second.Data.data(), it->second.Data.size());
+		s_Mappings.erase(it);
+	}
+	return GL_TRUE;
+}
+
+static void GLAPIENTRY NullVertexAttrib4fv(GLuint index, const GLfloat* v)
+{
+	Record(GLEntryPoint::VertexAttrib4fv, index, v);
+	s_RecordLog->AppendPayload(v, 4 * sizeof(GLfloat));
+}
+
+#define GL_DISPATCH_NULL_COMMAND_ENTRY(name, params, args, kinds) Null##name,
+#define GL_DISPATCH_NULL_CUSTOM_ENTRY(ret, name, params, args) Null##name,
+static const GLDispatchTable s_Null = {
+	GL_DISPATCH_COMMANDS(GL_DISPATCH_NULL_COMMAND_ENTRY)
+	GL_DISPATCH_CUSTOM(GL_DISPATCH_NULL_CUSTOM_ENTRY)
+};
+#undef GL_DISPATCH_NULL_COMMAND_ENTRY
+#undef GL_DISPATCH_NULL_CUSTOM_ENTRY
+
+/*
+ * Switches to the null backend, appending every call to [log] until EndRecording().
+ * Returns false if already recording, or if GL_DISPATCH_ENABLED is 0.
+ */
+bool GLDispatch::BeginRecording(GLCommandLog& log)
+{
+#if GL_DISPATCH_ENABLED
+	if (s_Log)
+	{
+		std::cout << "Warning: GLDispatch is already recording" << std::endl;
+		return false;
+	}
+
+	// The cache would skip binds of objects that are bound in the real context
+	GLStateCache::Invalidate();
+	s_Log = &log;
+	s_RecordLog = &log;
+	Table = s_Null;
+	return true;
+#else
+	std::cout << "Warning: GL_DISPATCH_ENABLED is 0, OpenGL calls can't be recorded" << std::endl;
+	return false;
+#endif
+}
+
+/*
+ * Appends the following calls to [log] instead, while staying on the null backend. Objects stay bound and mapped.
+ */
+void GLDispatch::SetRecordingLog(GLCommandLog& log)
+{
+	ASSERT(s_Log);
+	s_Log = &log;
+	s_RecordLog = &log;
+}
+
+/*
+ * Switches back to the native backend
+ */
+void GLDispatch::EndRecording()
+{
+	if (!s_Log)
+		return;
+
+	Table = s_Native;
+	s_Log = nullptr;
+	s_RecordLog = nullptr;
+	s_BoundBuffers.clear();
+	s_Mappings.clear();
+
+	// Forget the fake names
+	GLStateCache::Invalidate();
+}
+
+/* ~~~~~~~~~~ Replay ~~~~~~~~~~ */
+
+/*
+ * Reads packed arguments in order
+ */
+struct ArgReader
+{
+	const unsigned char* Cursor;
+
+	template<typename T>
+	T Read()
+	{
+		T value;
+		std::memcpy(&value, Cursor, sizeof(T));
+		Cursor += sizeof(T);
+		return value;
+	}
+};
+
+template<typename K>
+static K Translate(const std::unordered_map<K, K>& map, K value)
+{
+	auto it = map.find(value);
+	return it == map.end() ? value : it->second;
+}
+
+// Maps an argument to its replayed value, by its kind letter from GL_DISPATCH_COMMANDS
+static GLuint Remap(GLuint value, char kind, const GLReplayState& state)
+{
+	if (kind == 'n')
+		return Translate(state.Names, value);
+	if (kind == 'l')
+		return (GLuint)Translate(state.Locations, (GLint)value);
+	return value;
+}
+
+static GLint Remap(GLint value, char kind, const GLReplayState& state)
+{
+	return kind == 'l' ? Translate(state.Locations, value) : value;
+}
+
+template<typename T>
+static T Remap(T value, char kind, const GLReplayState& state)
+{
+	return value;
+}
+
+/*
+ * Calls [function] with the command's arguments, translated according to [kinds]
+ */
+template<typename... A, size_t... I>
+static void ReplayArgs(void (GLAPIENTRY* function)(A...), const char* kinds, const GLCommand& command, const GLReplayState& state,
+	std::index_sequence<I...>)
+{
+	ArgReader reader = { command.Args };
+	std::tuple<A...> args{ reader.Read<A>()... };	// Braces, so the arguments are read in order
+	(void)reader;	// Unused by commands without arguments
+	(void)args;
+	GLCall(function(Remap(std::get<I>(args), kinds[I], state)...));
+}
+
+template<typename... A>
+static void ReplayCommand(void (GLAPIENTRY* function)(A...), const char* kinds, const GLCommand& command, const GLReplayState& state)
+{
+	ReplayArgs(function, kinds, command, state, std::index_sequence_for<A...>());
+}
+
+#define GL_DISPATCH_REPLAY_COMMAND(name, params, args, kinds) \
+	static void Replay##name(const GLCommand& command, GLReplayState& state) { ReplayCommand(s_Native.name, kinds, command, state); }
+GL_DISPATCH_COMMANDS(GL_DISPATCH_REPLAY_COMMAND)
+#undef GL_DISPATCH_REPLAY_COMMAND
+
+// Queries only return something to the code that made them, so there is nothing to replay
+static void ReplayNothing(const GLCommand& command, GLReplayState& state)
+{
+}
+
+#define ReplayGetActiveUniform ReplayNothing
+#define ReplayGetError ReplayNothing
+#define ReplayGetFloatv ReplayNothing
+#define ReplayGetInteger64v ReplayNothing
+#define ReplayGetIntegerv ReplayNothing
+#define ReplayGetProgramBinary ReplayNothing
+#define ReplayGetProgramiv ReplayNothing
+#define ReplayGetQueryObjectiv ReplayNothing
+#define ReplayGetQueryObjectui64v ReplayNothing
+#define ReplayGetShaderInfoLog ReplayNothing
+#define ReplayGetShaderiv ReplayNothing
+#define ReplayGetString ReplayNothing
+#define ReplayIsEnabled ReplayNothing
+#define ReplayMapBufferRange ReplayNothing	// What was written is replayed when the buffer is unmapped
+
+static void ReplayBindBuffer(const GLCommand& command, GLReplayState& state)
+{
+	ReplayCommand(s_Native.BindBuffer, "vn", command, state);
+}
+
+/*
+ * The data of an upload: the payload if the log has one, else the recorded pointer (an offset into a bound buffer)
+ */
+static const void* GetData(const GLCommand& command, const void* recorded)
+{
+	return command.PayloadBytes > 0 ? command.Payload : recorded;
+}
+
+static void ReplayBufferData(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLsizeiptr size = reader.Read<GLsizeiptr>();
+	const void* data = reader.Read<const void*>();
+	GLenum usage = reader.Read<GLenum>();
+	GLCall(s_Native.BufferData(target, size, data ? command.Payload : nullptr, usage));
+}
+
+static void ReplayBufferStorage(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLsizeiptr size = reader.Read<GLsizeiptr>();
+	const void* data = reader.Read<const void*>();
+	GLbitfield flags = reader.Read<GLbitfield>();
+	GLCall(s_Native.BufferStorage(target, size, data ? command.Payload : nullptr, flags));
+}
+
+static void ReplayBufferSubData(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLintptr offset = reader.Read<GLintptr>();
+	GLsizeiptr size = reader.Read<GLsizeiptr>();
+	GLCall(s_Native.BufferSubData(target, offset, size, command.Payload));
+}
+
+static void ReplayClientWaitSync(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLsync sync = Translate(state.Syncs, reader.Read<GLsync>());
+	GLbitfield flags = reader.Read<GLbitfield>();
+	GLuint64 timeout = reader.Read<GLuint64>();
+	GLCall(s_Native.ClientWaitSync(sync, flags, timeout));
+}
+
+static void ReplayCompressedTexImage2D(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLint level = reader.Read<GLint>();
+	GLenum internalformat = reader.Read<GLenum>();
+	GLsizei width = reader.Read<GLsizei>();
+	GLsizei height = reader.Read<GLsizei>();
+	GLint border = reader.Read<GLint>();
+	GLsizei imageSize = reader.Read<GLsizei>();
+	const void* data = GetData(command, reader.Read<const void*>());
+	GLCall(s_Native.CompressedTexImage2D(target, level, internalformat, width, height, border, imageSize, data));
+}
+
+static void ReplayCompressedTexSubImage2D(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLint level = reader.Read<GLint>();
+	GLint xoffset = reader.Read<GLint>();
+	GLint yoffset = reader.Read<GLint>();
+	GLsizei width = reader.Read<GLsizei>();
+	GLsizei height = reader.Read<GLsizei>();
+	GLenum format = reader.Read<GLenum>();
+	GLsizei imageSize = reader.Read<GLsizei>();
+	const void* data = GetData(command, reader.Read<const void*>());
+	GLCall(s_Native.CompressedTexSubImage2D(target, level, xoffset, yoffset, width, height, format, imageSize, data));
+}
+
+static void ReplayCreateProgram(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLuint recorded = reader.Read<GLuint>();
+	GLCall(state.Names[recorded] = s_Native.CreateProgram());
+}
+
+static void ReplayCreateShader(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum type = reader.Read<GLenum>();
+	GLuint recorded = reader.Read<GLuint>();
+	GLCall(state.Names[recorded] = s_Native.CreateShader(type));
+}
+
+/*
+ * The recorded names of a Delete call, translated to the real ones, which the state then forgets
+ */
+static std::vector<GLuint> TakeNames(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLsizei n = reader.Read<GLsizei>();
+	std::vector<GLuint> names(n);
+	std::memcpy(names.data(), command.Payload, n * sizeof(GLuint));
+	for (GLuint& name : names)
+	{
+		auto it = state.Names.find(name);
+		if (it != state.Names.end())
+		{
+			name = it->second;
+			state.Names.erase(it);
+		}
+	}
+	return names;
+}
+
+static void ReplayDeleteBuffers(const GLCommand& command, GLReplayState& state)
+{
+	std::vector<GLuint> names = TakeNames(command, state);
+	GLCall(s_Native.DeleteBuffers((GLsizei)names.size(), names.data()));
+}
+
+static void ReplayDeleteQueries(const GLCommand& command, GLReplayState& state)
+{
+	std::vector<GLuint> names = TakeNames(command, state);
+	GLCall(s_Native.DeleteQueries((GLsizei)names.size(), names.data()));
+}
+
+static void ReplayDeleteTextures(const GLCommand& command, GLReplayState& state)
+{
+	std::vector<GLuint> names = TakeNames(command, state);
+	GLCall(s_Native.DeleteTextures((GLsizei)names.size(), names.data()));
+}
+
+static void ReplayDeleteVertexArrays(const GLCommand& command, GLReplayState& state)
+{
+	std::vector<GLuint> names = TakeNames(command, state);
+	GLCall(s_Native.DeleteVertexArrays((GLsizei)names.size(), names.data()));
+}
+
+static void ReplayDeleteSync(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLsync sync = reader.Read<GLsync>();
+	auto it = state.Syncs.find(sync);
+	if (it != state.Syncs.end())
+	{
+		sync = it->second;
+		state.Syncs.erase(it);
+	}
+	GLCall(s_Native.DeleteSync(sync));
+}
+
+static void ReplayFenceSync(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum condition = reader.Read<GLenum>();
+	GLbitfield flags = reader.Read<GLbitfield>();
+	GLsync recorded = reader.Read<GLsync>();
+	GLCall(state.Syncs[recorded] = s_Native.FenceSync(condition, flags));
+}
+
+/*
+ * Creates real objects with [gen] and remembers them as the recorded names
+ */
+static void ReplayGen(void (GLAPIENTRY* gen)(GLsizei, GLuint*), const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLsizei n = reader.Read<GLsizei>();
+	std::vector<GLuint> names(n);
+	GLCall(gen(n, names.data()));
+
+	for (GLsizei i = 0; i < n; i++)
+	{
+		GLuint recorded;
+		std::memcpy(&recorded, command.Payload + i * sizeof(GLuint), sizeof(GLuint));
+		state.Names[recorded] = names[i];
+	}
+}
+
+static void ReplayGenBuffers(const GLCommand& command, GLReplayState& state)
+{
+	ReplayGen(s_Native.GenBuffers, command, state);
+}
+
+static void ReplayGenQueries(const GLCommand& command, GLReplayState& state)
+{
+	ReplayGen(s_Native.GenQueries, command, state);
+}
+
+static void ReplayGenTextures(const GLCommand& command, GLReplayState& state)
+{
+	ReplayGen(s_Native.GenTextures, command, state);
+}
+
+static void ReplayGenVertexArrays(const GLCommand& command, GLReplayState& state)
+{
+	ReplayGen(s_Native.GenVertexArrays, command, state);
+}
+
+static void ReplayGetUniformBlockIndex(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLuint program = Translate(state.Names, reader.Read<GLuint>());
+	GLint recorded = reader.Read<GLint>();
+	GLCall(state.Locations[recorded] = (GLint)s_Native.GetUniformBlockIndex(program, (const GLchar*)command.Payload));
+}
+
+static void ReplayGetUniformLocation(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLuint program = Translate(state.Names, reader.Read<GLuint>());
+	GLint recorded = reader.Read<GLint>();
+	GLCall(state.Locations[recorded] = s_Native.GetUniformLocation(program, (const GLchar*)command.Payload));
+}
+
+static void ReplayProgramBinary(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLuint program = Translate(state.Names, reader.Read<GLuint>());
+	GLenum binaryFormat = reader.Read<GLenum>();
+	GLCall(s_Native.ProgramBinary(program, binaryFormat, command.Payload, (GLsizei)command.PayloadBytes));
+}
+
+static void ReplayShaderSource(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLuint shader = Translate(state.Names, reader.Read<GLuint>());
+	GLsizei count = reader.Read<GLsizei>();
+
+	std::vector<const GLchar*> strings(count);
+	std::vector<GLint> lengths(count);
+	ArgReader payload = { command.Payload };
+	for (GLsizei i = 0; i < count; i++)
+	{
+		lengths[i] = payload.Read<GLint>();
+		strings[i] = (const GLchar*)payload.Cursor;
+		payload.Cursor += lengths[i];
+	}
+	GLCall(s_Native.ShaderSource(shader, count, strings.data(), lengths.data()));
+}
+
+static void ReplayTexImage2D(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLint level = reader.Read<GLint>();
+	GLint internalformat = reader.Read<GLint>();
+	GLsizei width = reader.Read<GLsizei>();
+	GLsizei height = reader.Read<GLsizei>();
+	GLint border = reader.Read<GLint>();
+	GLenum format = reader.Read<GLenum>();
+	GLenum type = reader.Read<GLenum>();
+	const void* pixels = GetData(command, reader.Read<const void*>());
+	GLCall(s_Native.TexImage2D(target, level, internalformat, width, height, border, format, type, pixels));
+}
+
+static void ReplayTexSubImage2D(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	GLint level = reader.Read<GLint>();
+	GLint xoffset = reader.Read<GLint>();
+	GLint yoffset = reader.Read<GLint>();
+	GLsizei width = reader.Read<GLsizei>();
+	GLsizei height = reader.Read<GLsizei>();
+	GLenum format = reader.Read<GLenum>();
+	GLenum type = reader.Read<GLenum>();
+	const void* pixels = GetData(command, reader.Read<const void*>());
+	GLCall(s_Native.TexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels));
+}
+
+static void ReplayUniform1iv(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLint location = Translate(state.Locations, reader.Read<GLint>());
+	GLsizei count = reader.Read<GLsizei>();
+	GLCall(s_Native.Uniform1iv(location, count, (const GLint*)command.Payload));
+}
+
+static void ReplayUniformMatrix4fv(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLint location = Translate(state.Locations, reader.Read<GLint>());
+	GLsizei count = reader.Read<GLsizei>();
+	GLboolean transpose = reader.Read<GLboolean>();
+	GLCall(s_Native.UniformMatrix4fv(location, count, transpose, (const GLfloat*)command.Payload));
+}
+
+static void ReplayUnmapBuffer(const GLCommand& command, GLReplayState& state)
+{
+	// Nothing was mapped during replay, so the written range is uploaded instead
+	if (command.PayloadBytes <= sizeof(GLintptr))
+		return;
+
+	ArgReader reader = { command.Args };
+	GLenum target = reader.Read<GLenum>();
+	ArgReader payload = { command.Payload };
+	GLintptr offset = payload.Read<GLintptr>();
+	GLCall(s_Native.BufferSubData(target, offset, command.PayloadBytes - sizeof(GLintptr), payload.Cursor));
+}
+
+static void ReplayVertexAttrib4fv(const GLCommand& command, GLReplayState& state)
+{
+	ArgReader reader = { command.Args };
+	GLuint index = reader.Read<GLuint>();
+	GLCall(s_Native.VertexAttrib4fv(index, (const GLfloat*)command.Payload));
+}
+
+typedef void (*ReplayFunction)(const GLCommand& command, GLReplayState& state);
+
+#define GL_DISPATCH_REPLAY_COMMAND_ENTRY(name, params, args, kinds) Replay##name,
+#define GL_DISPATCH_REPLAY_CUSTOM_ENTRY(ret, name, params, args) Replay##name,
+static const ReplayFunction s_ReplayFunctions[] = {
+	GL_DISPATCH_COMMANDS(GL_DISPATCH_REPLAY_COMMAND_ENTRY)
+	GL_DISPATCH_CUSTOM(GL_DISPATCH_REPLAY_CUSTOM_ENTRY)
+};
+#undef GL_DISPATCH_REPLAY_COMMAND_ENTRY
+#undef GL_DISPATCH_REPLAY_CUSTOM_ENTRY
+
+/*
+ * Executes every command of [log] in the real context, on its own: objects it uses must be created in it,
+ * or before recording. Returns false if OpenGL reported an error (or if called while recording).
+ */
+bool GLDispatch::Replay(const GLCommandLog& log)
+{
+	if (s_Log)
+	{
+		std::cout << "Warning: can't replay a GLCommandLog while recording" << std::endl;
+		return false;
+	}
+
+	// Bindings change underneath the cache, and a name the log deletes may have been cached
+	GLStateCache::Invalidate();
+	while (s_Native.GetError() != GL_NO_ERROR)
+		;
+
+	GLReplayState state;
+	bool succeeded = Replay(log, state);
+	GLStateCache::Invalidate();
+	return succeeded;
+}
+
+/*
+ * Executes every command of [log] in the current context, as the next log of a stream replayed with [state].
+ * Unlike the other overload this leaves GLStateCache and the recording alone, so it can run on another thread
+ * while recording continues. Returns false if OpenGL reported an error.
+ */
+bool GLDispatch::Replay(const GLCommandLog& log, GLReplayState& state)
+{
+	size_t offset = 0;
+	GLCommand command;
+	while (log.Next(offset, command))
+		s_ReplayFunctions[(size_t)command.Entry](command, state);
+
+	GLenum error = s_Native.GetError();
+	if (error != GL_NO_ERROR)
+	{
+		std::cout << "Warning: OpenGL error " << error << " while replaying a GLCommandLog" << std::endl;
+		return false;
+	}
+	return true;
+}
+
+/*
+ * The OpenGL name of [entry], like "glBindBuffer"
+ */
+const char* GLDispatch::GetEntryPointName(GLEntryPoint entry)
+{
+#define GL_DISPATCH_COMMAND_NAME(name, params, args, kinds) "gl" #name,
+#define GL_DISPATCH_CUSTOM_NAME(ret, name, params, args) "gl" #name,
+	static const char* names[] = {
+		GL_DISPATCH_COMMANDS(GL_DISPATCH_COMMAND_NAME)
+		GL_DISPATCH_CUSTOM(GL_DISPATCH_CUSTOM_NAME)
+	};
+#undef GL_DISPATCH_COMMAND_NAME
+#undef GL_DISPATCH_CUSTOM_NAME
+
+	return entry < GLEntryPoint::Count ? names[(size_t)entry] : "unknown";
+}
@@ -0,0 +1,349 @@
+#pragma once
+#include <GL/glew.h>
+
+/*
+ * GLDispatch.h
+ * Every OpenGL function the engine calls goes through GLDispatch::Table, so the calls can be sent somewhere
+ * other than the driver without touching the code that makes them. GLErrorManager.h includes this header,
+ * and it redefines each gl* name below (glBindBuffer, glDrawElements, ...) as the matching entry of the table.
+ *
+ * Backends:
+ *		Native - the default. Each entry forwards to the real function (through GLEW).
+ *		Null - nothing reaches the driver. Each call is appended to a GLCommandLog instead, and calls that
+ *			return something get a plausible answer: new objects get unique fake names, compiles and links
+ *			succeed, queries are available and 0, and mapped buffers point to CPU memory.
+ *			This measures the pure CPU cost of submitting a frame, and counts exactly which calls it makes.
+ *
+ * Usage:
+ *		Call GLDispatch::BeginRecording(log) to switch to the null backend and EndRecording() to switch back.
+ *		Objects created while recording have fake names, so they must also be destroyed while recording.
+ *		GLDispatch::Replay(log) executes a recorded log in the real context. Object names and uniform locations
+ *		are translated to the ones the driver hands out, and the data of buffer, texture and uniform uploads
+ *		is stored in the log, so a log replays correctly after the memory it came from is gone.
+ *		Writes through a persistently mapped buffer (that is never unmapped) can't be seen, so they don't replay.
+ *
+ *		To stream frames, keep recording and call SetRecordingLog() with a new log for each frame, and replay
+ *		every log in order with the same GLReplayState, so objects created in one frame can be used in the next.
+ *		That replay may run on another thread (which has the context) while the next frame is recorded.
+ *
+ *		To make a new OpenGL function available, add it to GL_DISPATCH_COMMANDS if it returns nothing and its
+ *		pointer arguments are offsets (replayed as they are), or to GL_DISPATCH_CUSTOM with hand-written null
+ *		and replay functions in GLDispatch.cpp. Then add its redirect at the bottom of this file.
+ *
+ *		Define GL_DISPATCH_ENABLED as 0 to call OpenGL directly (recording then isn't available).
+ *
+ * Only one thread may record: the one that makes the OpenGL calls.
+ */
+
+#ifndef GL_DISPATCH_ENABLED
+#define GL_DISPATCH_ENABLED 1
+#endif
+
+/*
+ * Functions recorded and replayed with their arguments as they are.
+ * X(Name, (parameters), (arguments), "kinds"), where kinds has one letter per argument:
+ *		v - a plain value, n - an object name, l - a uniform location or block index
+ */
+#define GL_DISPATCH_COMMANDS(X) \
+	X(ActiveTexture, (GLenum texture), (texture), "v") \
+	X(AttachShader, (GLuint program, GLuint shader), (program, shader), "nn") \
+	X(BeginQuery, (GLenum target, GLuint id), (target, id), "vn") \
+	X(BindBufferBase, (GLenum target, GLuint index, GLuint buffer), (target, index, buffer), "vvn") \
+	X(BindBufferRange, (GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size), (target, index, buffer, offset, size), "vvnvv") \
+	X(BindTexture, (GLenum target, GLuint texture), (target, texture), "vn") \
+	X(BindVertexArray, (GLuint array), (array), "n") \
+	X(BlendFunc, (GLenum sfactor, GLenum dfactor), (sfactor, dfactor), "vv") \
+	X(Clear, (GLbitfield mask), (mask), "v") \
+	X(ClearColor, (GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha), (red, green, blue, alpha), "vvvv") \
+	X(CompileShader, (GLuint shader), (shader), "n") \
+	X(DebugMessageCallback, (GLDEBUGPROC callback, const void* userParam), (callback, userParam), "vv") \
+	X(DeleteProgram, (GLuint program), (program), "n") \
+	X(DeleteShader, (GLuint shader), (shader), "n") \
+	X(Disable, (GLenum cap), (cap), "v") \
+	X(DrawElements, (GLenum mode, GLsizei count, GLenum type, const void* indices), (mode, count, type, indices), "vvvv") \
+	X(DrawElementsBaseVertex, (GLenum mode, GLsizei count, GLenum type, void* indices, GLint basevertex), (mode, count, type, indices, basevertex), "vvvvv") \
+	X(DrawElementsInstanced, (GLenum mode, GLsizei count, GLenum type, const void* indices, GLsizei instancecount), (mode, count, type, indices, instancecount), "vvvvv") \
+	X(Enable, (GLenum cap), (cap), "v") \
+	X(EnableVertexAttribArray, (GLuint index), (index), "v") \
+	X(EndQuery, (GLenum target), (target), "v") \
+	X(Finish, (void), (), "") \
+	X(GenerateMipmap, (GLenum target), (target), "v") \
+	X(LinkProgram, (GLuint program), (program), "n") \
+	X(MultiDrawElementsIndirect, (GLenum mode, GLenum type, const void* indirect, GLsizei drawcount, GLsizei stride), (mode, type, indirect, drawcount, stride), "vvvvv") \
+	X(ProgramParameteri, (GLuint program, GLenum pname, GLint value), (program, pname, value), "nvv") \
+	X(QueryCounter, (GLuint id, GLenum target), (id, target), "nv") \
+	X(TexParameterf, (GLenum target, GLenum pname, GLfloat param), (target, pname, param), "vvv") \
+	X(TexParameteri, (GLenum target, GLenum pname, GLint param), (target, pname, param), "vvv") \
+	X(TexStorage2D, (GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height), (target, levels, internalformat, width, height), "vvvvv") \
+	X(Uniform1i, (GLint location, GLint v0), (location, v0), "lv") \
+	X(Uniform4f, (GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3), (location, v0, v1, v2, v3), "lvvvv") \
+	X(UniformBlockBinding, (GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding), (program, uniformBlockIndex, uniformBlockBinding), "nlv") \
+	X(UseProgram, (GLuint program), (program), "n") \
+	X(ValidateProgram, (GLuint program), (program), "n") \
+	X(VertexAttribDivisor, (GLuint index, GLuint divisor), (index, divisor), "vv") \
+	X(VertexAttribPointer, (GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer), (index, size, type, normalized, stride, pointer), "vvvvvv")
+
+/*
+ * Functions that return something, read memory the log has to copy, or create and delete objects.
+ * Each has its own null and replay function. X(ReturnType, Name, (parameters), (arguments))
+ */
+#define GL_DISPATCH_CUSTOM(X) \
+	X(void, BindBuffer, (GLenum target, GLuint buffer), (target, buffer)) \
+	X(void, BufferData, (GLenum target, GLsizeiptr size, const void* data, GLenum usage), (target, size, data, usage)) \
+	X(void, BufferStorage, (GLenum target, GLsizeiptr size, const void* data, GLbitfield flags), (target, size, data, flags)) \
+	X(void, BufferSubData, (GLenum target, GLintptr offset, GLsizeiptr size, const void* data), (target, offset, size, data)) \
+	X(GLenum, ClientWaitSync, (GLsync sync, GLbitfield flags, GLuint64 timeout), (sync, flags, timeout)) \
+	X(void, CompressedTexImage2D, (GLenum target, GLint level, GLenum internalformat, GLsizei width, GLsizei height, GLint border, GLsizei imageSize, const void* data), (target, level, internalformat, width, height, border, imageSize, data)) \
+	X(void, CompressedTexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLsizei imageSize, const void* data), (target, level, xoffset, yoffset, width, height, format, imageSize, data)) \
+	X(GLuint, CreateProgram, (void), ()) \
+	X(GLuint, CreateShader, (GLenum type), (type)) \
+	X(void, DeleteBuffers, (GLsizei n, const GLuint* buffers), (n, buffers)) \
+	X(void, DeleteQueries, (GLsizei n, const GLuint* ids), (n, ids)) \
+	X(void, DeleteSync, (GLsync sync), (sync)) \
+	X(void, DeleteTextures, (GLsizei n, const GLuint* textures), (n, textures)) \
+	X(void, DeleteVertexArrays, (GLsizei n, const GLuint* arrays), (n, arrays)) \
+	X(GLsync, FenceSync, (GLenum condition, GLbitfield flags), (condition, flags)) \
+	X(void, GenBuffers, (GLsizei n, GLuint* buffers), (n, buffers)) \
+	X(void, GenQueries, (GLsizei n, GLuint* ids), (n, ids)) \
+	X(void, GenTextures, (GLsizei n, GLuint* textures), (n, textures)) \
+	X(void, GenVertexArrays, (GLsizei n, GLuint* arrays), (n, arrays)) \
+	X(void, GetActiveUniform, (GLuint program, GLuint index, GLsizei bufSize, GLsizei* length, GLint* size, GLenum* type, GLchar* name), (program, index, bufSize, length, size, type, name)) \
+	X(GLenum, GetError, (void), ()) \
+	X(void, GetFloatv, (GLenum pname, GLfloat* data), (pname, data)) \
+	X(void, GetInteger64v, (GLenum pname, GLint64* data), (pname, data)) \
+	X(void, GetIntegerv, (GLenum pname, GLint* data), (pname, data)) \
+	X(void, GetProgramBinary, (GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary), (program, bufSize, length, binaryFormat, binary)) \
+	X(void, GetProgramiv, (GLuint program, GLenum pname, GLint* params), (program, pname, params)) \
+	X(void, GetQueryObjectiv, (GLuint id, GLenum pname, GLint* params), (id, pname, params)) \
+	X(void, GetQueryObjectui64v, (GLuint id, GLenum pname, GLuint64* params), (id, pname, params)) \
+	X(void, GetShaderInfoLog, (GLuint shader, GLsizei bufSize, GLsizei* length, GLchar* infoLog), (shader, bufSize, length, infoLog)) \
+	X(void, GetShaderiv, (GLuint shader, GLenum pname, GLint* params), (shader, pname, params)) \
+	X(const GLubyte*, GetString, (GLenum name), (name)) \
+	X(GLuint, GetUniformBlockIndex, (GLuint program, const GLchar* uniformBlockName), (program, uniformBlockName)) \
+	X(GLint, GetUniformLocation, (GLuint program, const GLchar* name), (program, name)) \
+	X(GLboolean, IsEnabled, (GLenum cap), (cap)) \
+	X(void*, MapBufferRange, (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access), (target, offset, length, access)) \
+	X(void, ProgramBinary, (GLuint program, GLenum binaryFormat, const void* binary, GLsizei length), (program, binaryFormat, binary, length)) \
+	X(void, ShaderSource, (GLuint shader, GLsizei count, const GLchar* const* string, const GLint* length), (shader, count, string, length)) \
+	X(void, TexImage2D, (GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void* pixels), (target, level, internalformat, width, height, border, format, type, pixels)) \
+	X(void, TexSubImage2D, (GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void* pixels), (target, level, xoffset, yoffset, width, height, format, type, pixels)) \
+	X(void, Uniform1iv, (GLint location, GLsizei count, const GLint* value), (location, count, value)) \
+	X(void, UniformMatrix4fv, (GLint location, GLsizei count, GLboolean transpose, const GLfloat* value), (location, count, transpose, value)) \
+	X(GLboolean, UnmapBuffer, (GLenum target), (target)) \
+	X(void, VertexAttrib4fv, (GLuint index, const GLfloat* v), (index, v))
+
+/*
+ * GLEntryPoint
+ * Identifies a dispatched function, in the log and for counting.
+ */
+enum class GLEntryPoint : unsigned short
+{
+#define GL_DISPATCH_COMMAND_ENTRY(name, params, args, kinds) name,
+#define GL_DISPATCH_CUSTOM_ENTRY(ret, name, params, args) name,
+	GL_DISPATCH_COMMANDS(GL_DISPATCH_COMMAND_ENTRY)
+	GL_DISPATCH_CUSTOM(GL_DISPATCH_CUSTOM_ENTRY)
+#undef GL_DISPATCH_COMMAND_ENTRY
+#undef GL_DISPATCH_CUSTOM_ENTRY
+	Count
+};
+
+/*
+ * GLDispatchTable
+ * One function pointer per entry point, named without the gl prefix.
+ */
+struct GLDispatchTable
+{
+#define GL_DISPATCH_COMMAND_MEMBER(name, params, args, kinds) void (GLAPIENTRY* name) params;
+#define GL_DISPATCH_CUSTOM_MEMBER(ret, name, params, args) ret (GLAPIENTRY* name) params;
+	GL_DISPATCH_COMMANDS(GL_DISPATCH_COMMAND_MEMBER)
+	GL_DISPATCH_CUSTOM(GL_DISPATCH_CUSTOM_MEMBER)
+#undef GL_DISPATCH_COMMAND_MEMBER
+#undef GL_DISPATCH_CUSTOM_MEMBER
+};
+
+class GLCommandLog;
+struct GLReplayState;
+
+class GLDispatch
+{
+public:
+	static GLDispatchTable Table;	// What every gl* call goes through
+
+	static bool BeginRecording(GLCommandLog& log);
+	static void SetRecordingLog(GLCommandLog& log);
+	static void EndRecording();
+	inline static bool IsRecording() { return s_Log != nullptr; }
+
+	static bool Replay(const GLCommandLog& log);
+	static bool Replay(const GLCommandLog& log, GLReplayState& state);
+
+	static const char* GetEntryPointName(GLEntryPoint entry);
+
+private:
+	static GLCommandLog* s_Log;
+};
+
+// Redirects the gl* names to the table. GLDispatch.cpp defines GL_DISPATCH_NO_REDIRECT to reach the real functions.
+#if GL_DISPATCH_ENABLED && !defined(GL_DISPATCH_NO_REDIRECT)
+#undef glActiveTexture
+#define glActiveTexture GLDispatch::Table.ActiveTexture
+#undef glAttachShader
+#define glAttachShader GLDispatch::Table.AttachShader
+#undef glBeginQuery
+#define glBeginQuery GLDispatch::Table.BeginQuery
+#undef glBindBufferBase
+#define glBindBufferBase GLDispatch::Table.BindBufferBase
+#undef glBindBufferRange
+#define glBindBufferRange GLDispatch::Table.BindBufferRange
+#undef glBindTexture
+#define glBindTexture GLDispatch::Table.BindTexture
+#undef glBindVertexArray
+#define glBindVertexArray GLDispatch::Table.BindVertexArray
+#undef glBlendFunc
+#define glBlendFunc GLDispatch::Table.BlendFunc
+#undef glClear
+#define glClear GLDispatch::Table.Clear
+#undef glClearColor
+#define glClearColor GLDispatch::Table.ClearColor
+#undef glCompileShader
+#define glCompileShader GLDispatch::Table.CompileShader
+#undef glDebugMessageCallback
+#define glDebugMessageCallback GLDispatch::Table.DebugMessageCallback
+#undef glDeleteProgram
+#define glDeleteProgram GLDispatch::Table.DeleteProgram
+#undef glDeleteShader
+#define glDeleteShader GLDispatch::Table.DeleteShader
+#undef glDisable
+#define glDisable GLDispatch::Table.Disable
+#undef glDrawElements
+#define glDrawElements GLDispatch::Table.DrawElements
+#undef glDrawElementsBaseVertex
+#define glDrawElementsBaseVertex GLDispatch::Table.DrawElementsBaseVertex
+#undef glDrawElementsInstanced
+#define glDrawElementsInstanced GLDispatch::Table.DrawElementsInstanced
+#undef glEnable
+#define glEnable GLDispatch::Table.Enable
+#undef glEnableVertexAttribArray
+#define glEnableVertexAttribArray GLDispatch::Table.EnableVertexAttribArray
+#undef glEndQuery
+#define glEndQuery GLDispatch::Table.EndQuery
+#undef glFinish
+#define glFinish GLDispatch::Table.Finish
+#undef glGenerateMipmap
+#define glGenerateMipmap GLDispatch::Table.GenerateMipmap
+#undef glLinkProgram
+#define glLinkProgram GLDispatch::Table.LinkProgram
+#undef glMultiDrawElementsIndirect
+#define glMultiDrawElementsIndirect GLDispatch::Table.MultiDrawElementsIndirect
+#undef glProgramParameteri
+#define glProgramParameteri GLDispatch::Table.ProgramParameteri
+#undef glQueryCounter
+#define glQueryCounter GLDispatch::Table.QueryCounter
+#undef glTexParameterf
+#define glTexParameterf GLDispatch::Table.TexParameterf
+#undef glTexParameteri
+#define glTexParameteri GLDispatch::Table.TexParameteri
+#undef glTexStorage2D
+#define glTexStorage2D GLDispatch::Table.TexStorage2D
+#undef glUniform1i
+#define glUniform1i GLDispatch::Table.Uniform1i
+#undef glUniform4f
+#define glUniform4f GLDispatch::Table.Uniform4f
+#undef glUniformBlockBinding
+#define glUniformBlockBinding GLDispatch::Table.UniformBlockBinding
+#undef glUseProgram
+#define glUseProgram GLDispatch::Table.UseProgram
+#undef glValidateProgram
+#define glValidateProgram GLDispatch::Table.ValidateProgram
+#undef glVertexAttribDivisor
+#define glVertexAttribDivisor GLDispatch::Table.VertexAttribDivisor
+#undef glVertexAttribPointer
+#define glVertexAttribPointer GLDispatch::Table.VertexAttribPointer
+
+#undef glBindBuffer
+#define glBindBuffer GLDispatch::Table.BindBuffer
+#undef glBufferData
+#define glBufferData GLDispatch::Table.BufferData
+#undef glBufferStorage
+#define glBufferStorage GLDispatch::Table.BufferStorage
+#undef glBufferSubData
+#define glBufferSubData GLDispatch::Table.BufferSubData
+#undef glClientWaitSync
+#define glClientWaitSync GLDispatch::Table.ClientWaitSync
+#undef glCompressedTexImage2D
+#define glCompressedTexImage2D GLDispatch::Table.CompressedTexImage2D
+#undef glCompressedTexSubImage2D
+#define glCompressedTexSubImage2D GLDispatch::Table.CompressedTexSubImage2D
+#undef glCreateProgram
+#define glCreateProgram GLDispatch::Table.CreateProgram
+#undef glCreateShader
+#define glCreateShader GLDispatch::Table.CreateShader
+#undef glDeleteBuffers
+#define glDeleteBuffers GLDispatch::Table.DeleteBuffers
+#undef glDeleteQueries
+#define glDeleteQueries GLDispatch::Table.DeleteQueries
+#undef glDeleteSync
+#define glDeleteSync GLDispatch::Table.DeleteSync
+#undef glDeleteTextures
+#define glDeleteTextures GLDispatch::Table.DeleteTextures
+#undef glDeleteVertexArrays
+#define glDeleteVertexArrays GLDispatch::Table.DeleteVertexArrays
+#undef glFenceSync
+#define glFenceSync GLDispatch::Table.FenceSync
+#undef glGenBuffers
+#define glGenBuffers GLDispatch::Table.GenBuffers
+#undef glGenQueries
+#define glGenQueries GLDispatch::Table.GenQueries
+#undef glGenTextures
+#define glGenTextures GLDispatch::Table.GenTextures
+#undef glGenVertexArrays
+#define glGenVertexArrays GLDispatch::Table.GenVertexArrays
+#undef glGetActiveUniform
+#define glGetActiveUniform GLDispatch::Table.GetActiveUniform
+#undef glGetError
+#define glGetError GLDispatch::Table.GetError
+#undef glGetFloatv
+#define glGetFloatv GLDispatch::Table.GetFloatv
+#undef glGetInteger64v
+#define glGetInteger64v GLDispatch::Table.GetInteger64v
+#undef glGetIntegerv
+#define glGetIntegerv GLDispatch::Table.GetIntegerv
+#undef glGetProgramBinary
+#define glGetProgramBinary GLDispatch::Table.GetProgramBinary
+#undef glGetProgramiv
+#define glGetProgramiv GLDispatch::Table.GetProgramiv
+#undef glGetQueryObjectiv
+#define glGetQueryObjectiv GLDispatch::Table.GetQueryObjectiv
+#undef glGetQueryObjectui64v
+#define glGetQueryObjectui64v GLDispatch::Table.GetQueryObjectui64v
+#undef glGetShaderInfoLog
+#define glGetShaderInfoLog GLDispatch::Table.GetShaderInfoLog
+#undef glGetShaderiv
+#define glGetShaderiv GLDispatch::Table.GetShaderiv
+#undef glGetString
+#define glGetString GLDispatch::Table.GetString
+#undef glGetUniformBlockIndex
+#define glGetUniformBlockIndex GLDispatch::Table.GetUniformBlockIndex
+#undef glGetUniformLocation
+#define glGetUniformLocation GLDispatch::Table.GetUniformLocation
+#undef glIsEnabled
+#define glIsEnabled GLDispatch::Table.IsEnabled
+#undef glMapBufferRange
+#define glMapBufferRange GLDispatch::Table.MapBufferRange
+#undef glProgramBinary
+#define glProgramBinary GLDispatch::Table.ProgramBinary
+#undef glShaderSource
+#define glShaderSource GLDispatch::Table.ShaderSource
+#undef glTexImage2D
+#define glTexImage2D GLDispatch::Table.TexImage2D
+#undef glTexSubImage2D
+#define glTexSubImage2D GLDispatch::Table.TexSubImage2D
+#undef glUniform1iv
+#define glUniform1iv GLDispatch::Table.Uniform1iv
+#undef glUniformMatrix4fv
+#define glUniformMatrix4fv GLDispatch::Table.UniformMatrix4fv
+#undef glUnmapBuffer
+#define glUnmapBuffer GLDispatch::Table.UnmapBuffer
+#undef glVertexAttrib4fv
+#define glVertexAttrib4fv GLDispatch::Table.VertexAttrib4fv
+#endif
@@ -21,4 +21,60 @@ bool GLLogCall(const char* function, const char* file, int line)
         return false;
     }
     return true;
-}
\ No newline at end of file
+}
+
+#if GL_ERROR_CHECK_MODE == GL_ERROR_CHECK_DEBUG_OUTPUT
+/*
+ * Called by the driver for every debug message (KHR_debug).
+ * Errors break into the debugger, other messages are only printed.
+ */
+static void GLAPIENTRY GLDebugMessageCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
+    GLsizei length, const GLchar* message, const void* userParam)
+{
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION)
+        return;
+
+    std::cout << "[OpenGL Debug] (0x" << std::hex << id << std::dec << "): " << message << std::endl;
+
+#ifndef NDEBUG
+    if (type == GL_DEBUG_TYPE_ERROR)
+        DEBUG_BREAK();
+#endif
+}
+#endif
+
+/*
+ * Installs the debug message callback when using the GL_ERROR_CHECK_DEBUG_OUTPUT mode.
+ * Must be called after glewInit(). Returns true if the callback is installed.
+ */
+bool GLEnableDebugOutput()
+{
+#if GL_ERROR_CHECK_MODE == GL_ERROR_CHECK_DEBUG_OUTPUT
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug)
+    {
+        std::cout << "Warning: KHR_debug is not supported, OpenGL errors will not be reported." << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+#ifndef NDEBUG
+    // Report errors inside the call that caused them, so the call stack points at it
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+#endif
+    glDebugMessageCallback(GLDebugMessageCallback, nullptr);
+    return true;
+#else
+    return false;
+#endif
+}
+
+const char* GLGetErrorCheckModeName()
+{
+#if GL_ERROR_CHECK_MODE == GL_ERROR_CHECK_OFF
+    return "Off";
+#elif GL_ERROR_CHECK_MODE == GL_ERROR_CHECK_DEBUG_OUTPUT
+    return "Debug output";
+#else
+    return "Full";
+#endif
+}
@@ -8,19 +8,64 @@
  * Usage:
  *      Wrap every OpenGL method in GLCall() to cause errors to print / breakpoint the code.
  *      Wrap a conditional in ASSERT() to create a debug break if something is false.
+ *      Call GLEnableDebugOutput() once after glewInit() (it only does something in the debug output mode).
+ *
+ *      What GLCall() does is chosen at compile time by defining GL_ERROR_CHECK_MODE as:
+ *          GL_ERROR_CHECK_OFF - GLCall(x) is just x. The default for release builds (NDEBUG).
+ *          GL_ERROR_CHECK_DEBUG_OUTPUT - GLCall(x) is just x, and errors are reported by the driver through a
+ *              KHR_debug callback instead. Output is synchronous in debug builds, so the break happens in the failing call.
+ *          GL_ERROR_CHECK_FULL - clears the error flags before x and checks glGetError() after it.
+ *              The default for debug builds. This makes the driver synchronize on every call, so it is slow.
  * 
  * @credit The Cherno
  * @credit @superpb600 in YouTube comments for abstracting this to its own class (https://www.youtube.com/watch?v=jjaTTRFXRAk&list=PLlrATfBNZ98foTJPJ_Ev03o2oq3-GGOS2&index=17)
  * @date 16 February 2024
  */
 
+#define GL_ERROR_CHECK_OFF          0
+#define GL_ERROR_CHECK_DEBUG_OUTPUT 1
+#define GL_ERROR_CHECK_FULL         2
+
+#ifndef GL_ERROR_CHECK_MODE
+#ifdef NDEBUG
+#define GL_ERROR_CHECK_MODE GL_ERROR_CHECK_OFF
+#else
+#define GL_ERROR_CHECK_MODE GL_ERROR_CHECK_FULL
+#endif
+#endif
+
+// Breakpoint that works with every compiler (__debugbreak only exists on MSVC)
+#if defined(_MSC_VER)
+#define DEBUG_BREAK() __debugbreak()
+#elif defined(__clang__)
+#define DEBUG_BREAK() __builtin_debugtrap()
+#elif defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#define DEBUG_BREAK() __asm__ volatile("int3")
+#else
+#include <csignal>
+#define DEBUG_BREAK() std::raise(SIGTRAP)
+#endif
+
 // Macro for error checking
 // Wrap OpenGL functions in GLCall() to detect errors from GL Calls
-// In modern versions of OpenGL, there is a debug callback function that can do this
-#define ASSERT(x) if (!(x)) __debugbreak();
-#define GLCall(x) GLClearError();\
+#define ASSERT(x) if (!(x)) DEBUG_BREAK();
+
+// Always checks for errors, no matter the mode (used by GLCall in the full mode)
+#define GLCallChecked(x) GLClearError();\
     x;\
     ASSERT(GLLogCall(#x, __FILE__, __LINE__))
 
+#if GL_ERROR_CHECK_MODE == GL_ERROR_CHECK_FULL
+#define GLCall(x) GLCallChecked(x)
+#else
+#define GLCall(x) x
+#endif
+
 void GLClearError();
-bool GLLogCall(const char* function, const char* file, int line);
\ No newline at end of file
+bool GLLogCall(const char* function, const char* file, int line);
+
+bool GLEnableDebugOutput();
+const char* GLGetErrorCheckModeName();
+
+// Routes every gl* call through GLDispatch, so calls can be recorded instead of executed
+#include "GLDispatch.h"
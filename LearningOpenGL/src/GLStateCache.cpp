@@ -0,0 +1,200 @@
+#include "GLStateCache.h"
+#include "GLErrorManager.h"
+
+unsigned int GLStateCache::s_Program = GLStateCache::Unknown;
+unsigned int GLStateCache::s_VertexArray = GLStateCache::Unknown;
+unsigned int GLStateCache::s_Buffers[BufferSlotCount] = { Unknown, Unknown, Unknown, Unknown };
+std::unordered_map<unsigned int, unsigned int> GLStateCache::s_ElementBuffers;
+unsigned int GLStateCache::s_ActiveTextureUnit = GLStateCache::Unknown;
+unsigned int GLStateCache::s_Textures[MaxTextureUnits];	// Zero: every unit starts with no texture bound
+GLStateCacheStats GLStateCache::s_Stats = { 0, 0 };
+
+void GLStateCache::UseProgram(unsigned int program)
+{
+	if (s_Program == program)
+	{
+		s_Stats.SkippedBinds++;
+		return;
+	}
+
+	GLCall(glUseProgram(program));
+	s_Program = program;
+	s_Stats.IssuedBinds++;
+}
+
+void GLStateCache::BindVertexArray(unsigned int vertexArray)
+{
+	if (s_VertexArray == vertexArray)
+	{
+		s_Stats.SkippedBinds++;
+		return;
+	}
+
+	GLCall(glBindVertexArray(vertexArray));
+	s_VertexArray = vertexArray;
+	s_Stats.IssuedBinds++;
+}
+
+/*
+ * Binds [buffer] to [target]. Targets the cache does not know about are always issued.
+ */
+void GLStateCache::BindBuffer(unsigned int target, unsigned int buffer)
+{
+	if (target == GL_ELEMENT_ARRAY_BUFFER && s_VertexArray != Unknown)
+	{
+		// The binding belongs to the current VAO
+		auto it = s_ElementBuffers.find(s_VertexArray);
+		if (it != s_ElementBuffers.end() && it->second == buffer)
+		{
+			s_Stats.SkippedBinds++;
+			return;
+		}
+
+		GLCall(glBindBuffer(target, buffer));
+		s_ElementBuffers[s_VertexArray] = buffer;
+		s_Stats.IssuedBinds++;
+		return;
+	}
+
+	int slot = GetBufferSlot(target);
+	if (slot >= 0 && s_Buffers[slot] == buffer)
+	{
+		s_Stats.SkippedBinds++;
+		return;
+	}
+
+	GLCall(glBindBuffer(target, buffer));
+	if (slot >= 0)
+		s_Buffers[slot] = buffer;
+	s_Stats.IssuedBinds++;
+}
+
+/*
+ * Binds [buffer] to binding point [index] of an indexed target (like GL_UNIFORM_BUFFER).
+ * Indexed bindings are not cached, but glBindBufferBase also binds the generic target, so that is remembered.
+ */
+void GLStateCache::BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer)
+{
+	GLCall(glBindBufferBase(target, index, buffer));
+	int slot = GetBufferSlot(target);
+	if (slot >= 0)
+		s_Buffers[slot] = buffer;
+	s_Stats.IssuedBinds++;
+}
+
+/*
+ * Binds [size] bytes of [buffer], from [offset], to binding point [index]. Like BindBufferBase(), only the generic
+ * target is remembered.
+ */
+void GLStateCache::BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size)
+{
+	GLCall(glBindBufferRange(target, index, buffer, offset, size));
+	int slot = GetBufferSlot(target);
+	if (slot >= 0)
+		s_Buffers[slot] = buffer;
+	s_Stats.IssuedBinds++;
+}
+
+/*
+ * Binds [texture] as the GL_TEXTURE_2D of texture unit [unit] (0 for GL_TEXTURE0).
+ * Only switches the active texture unit if the bind is actually needed.
+ */
+void GLStateCache::BindTexture(unsigned int unit, unsigned int texture)
+{
+	ASSERT(unit < MaxTextureUnits);
+	if (s_Textures[unit] == texture)
+	{
+		s_Stats.SkippedBinds++;
+		return;
+	}
+
+	ActiveTexture(unit);
+	GLCall(glBindTexture(GL_TEXTURE_2D, texture));
+	s_Textures[unit] = texture;
+	s_Stats.IssuedBinds++;
+}
+
+void GLStateCache::ActiveTexture(unsigned int unit)
+{
+	if (s_ActiveTextureUnit == unit)
+		return;
+
+	GLCall(glActiveTexture(GL_TEXTURE0 + unit));
+	s_ActiveTextureUnit = unit;
+}
+
+/*
+ * OpenGL unbinds an object when it is deleted, and may hand out its name again,
+ * so the cache must not think a deleted object is still bound.
+ */
+void GLStateCache::OnProgramDeleted(unsigned int program)
+{
+	if (s_Program == program)
+		s_Program = Unknown;
+}
+
+void GLStateCache::OnVertexArrayDeleted(unsigned int vertexArray)
+{
+	if (s_VertexArray == vertexArray)
+		s_VertexArray = Unknown;
+	s_ElementBuffers.erase(vertexArray);
+}
+
+void GLStateCache::OnBufferDeleted(unsigned int buffer)
+{
+	for (unsigned int& bound : s_Buffers)
+	{
+		if (bound == buffer)
+			bound = Unknown;
+	}
+	for (auto& vertexArray : s_ElementBuffers)
+	{
+		if (vertexArray.second == buffer)
+			vertexArray.second = Unknown;
+	}
+}
+
+void GLStateCache::OnTextureDeleted(unsigned int texture)
+{
+	for (unsigned int& bound : s_Textures)
+	{
+		if (bound == texture)
+			bound = Unknown;
+	}
+}
+
+/*
+ * Forgets every binding, so the next bind of each kind is issued.
+ */
+void GLStateCache::Invalidate()
+{
+	s_Program = Unknown;
+	s_VertexArray = Unknown;
+	for (unsigned int& bound : s_Buffers)
+		bound = Unknown;
+	s_ElementBuffers.clear();
+	s_ActiveTextureUnit = Unknown;
+	for (unsigned int& bound : s_Textures)
+		bound = Unknown;
+}
+
+void GLStateCache::ResetStats()
+{
+	s_Stats = { 0, 0 };
+}
+
+int GLStateCache::GetBufferSlot(unsigned int target)
+{
+	switch (target)
+	{
+	case GL_ARRAY_BUFFER:
+		return ArrayBufferSlot;
+	case GL_UNIFORM_BUFFER:
+		return UniformBufferSlot;
+	case GL_PIXEL_UNPACK_BUFFER:
+		return PixelUnpackBufferSlot;
+	case GL_DRAW_INDIRECT_BUFFER:
+		return DrawIndirectBufferSlot;
+	}
+	return -1;
+}
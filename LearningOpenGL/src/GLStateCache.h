@@ -0,0 +1,80 @@
+#pragma once
+
+#include <unordered_map>
+
+/*
+ * GLStateCache.h
+ * Remembers which OpenGL objects are currently bound, so binding an object that is already bound
+ * skips the GL call (and the error checking around it) entirely.
+ *
+ * Usage:
+ *		Bind objects through the cache instead of calling glUseProgram/glBindVertexArray/glBindBuffer/
+ *		glBindTexture directly. The Bind() methods of Shader, VertexArrayObject, VertexBuffer,
+ *		IndexBuffer, and Texture already do this.
+ *		Call the matching On...Deleted() method when deleting an object, since OpenGL may reuse its name.
+ *		Call Invalidate() after code outside of the cache changes bindings without restoring them.
+ *		Call ResetStats() at the start of every frame to count the binds issued and skipped that frame.
+ *
+ *		The element array buffer binding is part of the VAO's state, so it is remembered per VAO.
+ */
+
+/*
+ * GLStateCacheStats
+ * Number of bind calls since the last ResetStats(), split by whether they reached OpenGL.
+ */
+struct GLStateCacheStats
+{
+	unsigned int IssuedBinds;
+	unsigned int SkippedBinds;
+};
+
+class GLStateCache
+{
+public:
+	static const unsigned int MaxTextureUnits = 32;
+
+private:
+	static const unsigned int Unknown = 0xFFFFFFFF;	// Binding that has to be issued no matter what
+
+	// Buffer targets that are cached (the element array buffer is stored per VAO instead)
+	enum BufferSlot
+	{
+		ArrayBufferSlot,
+		UniformBufferSlot,
+		PixelUnpackBufferSlot,
+		DrawIndirectBufferSlot,
+		BufferSlotCount
+	};
+
+	static unsigned int s_Program;
+	static unsigned int s_VertexArray;
+	static unsigned int s_Buffers[BufferSlotCount];
+	static std::unordered_map<unsigned int, unsigned int> s_ElementBuffers;	// VAO -> element array buffer
+	static unsigned int s_ActiveTextureUnit;
+	static unsigned int s_Textures[MaxTextureUnits];
+	static GLStateCacheStats s_Stats;
+
+public:
+	static void UseProgram(unsigned int program);
+	static void BindVertexArray(unsigned int vertexArray);
+	static void BindBuffer(unsigned int target, unsigned int buffer);
+	static void BindBufferBase(unsigned int target, unsigned int index, unsigned int buffer);
+	static void BindBufferRange(unsigned int target, unsigned int index, unsigned int buffer, unsigned int offset, unsigned int size);
+	static void BindTexture(unsigned int unit, unsigned int texture);
+	static void ActiveTexture(unsigned int unit);
+
+	inline static unsigned int GetActiveTextureUnit() { return s_ActiveTextureUnit == Unknown ? 0 : s_ActiveTextureUnit; }
+
+	static void OnProgramDeleted(unsigned int program);
+	static void OnVertexArrayDeleted(unsigned int vertexArray);
+	static void OnBufferDeleted(unsigned int buffer);
+	static void OnTextureDeleted(unsigned int texture);
+
+	static void Invalidate();
+
+	static void ResetStats();
+	inline static const GLStateCacheStats& GetStats() { return s_Stats; }
+
+private:
+	static int GetBufferSlot(unsigned int target);
+};
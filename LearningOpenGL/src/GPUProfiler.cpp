@@ -0,0 +1,252 @@
+#include "GPUProfiler.h"
+#include "GLErrorManager.h"
+
+#include <GL/glew.h>
+#include <iostream>
+
+static const unsigned int s_QueriesPerFrame = 2 + 2 * GPUProfiler::MaxSections;	// Frame start and end, then a pair per section
+static const unsigned int s_CalibrationInterval = 120;	// Frames between re-measuring the GPU clock against the CPU's
+
+/*
+ * A section issued in a frame, with the indices of its two timestamp queries in the frame's set
+ */
+struct GPUSection
+{
+	const char* Name;
+	unsigned int Depth;
+	unsigned int BeginQuery;
+	unsigned int EndQuery;
+};
+
+/*
+ * One frame in flight: its queries, and the sections they belong to
+ */
+struct GPUFrame
+{
+	unsigned int Queries[s_QueriesPerFrame];
+	GPUSection Sections[GPUProfiler::MaxSections];
+	unsigned int SectionCount;
+	unsigned long long Index;
+	bool Pending;	// Issued, and not yet read back
+};
+
+double GPUProfiler::s_FrameMs = 0.0;
+GPUSectionTiming GPUProfiler::s_Results[GPUProfiler::MaxSections];
+unsigned int GPUProfiler::s_ResultCount = 0;
+unsigned int GPUProfiler::s_Latency = 0;
+unsigned int GPUProfiler::s_DroppedFrames = 0;
+
+/*
+ * The GPU time of a resolved frame
+ */
+struct GPUFrameTime
+{
+	unsigned long long Index;
+	double Ms;
+};
+
+static GPUFrame s_Frames[GPUProfiler::FrameLatency];
+static GPUFrameTime s_History[GPUProfiler::HistorySize];
+static unsigned long long s_FrameIndex = 0;
+static bool s_Initialized = false;
+static bool s_InFrame = false;
+
+// Sections currently open, as indices into the frame's Sections (-1 for one that didn't fit)
+static int s_Stack[GPUProfiler::MaxDepth];
+static unsigned int s_StackSize = 0;
+static unsigned int s_IgnoredDepth = 0;	// Sections opened past MaxDepth
+
+// A GPU timestamp and the CPU tick read at the same moment, to place GPU sections on the Profiler's timeline
+static ProfileThreadBuffer* s_Track = nullptr;
+static long long s_CalibrationGpuNs = 0;
+static unsigned long long s_CalibrationTicks = 0;
+static unsigned long long s_CalibrationFrame = 0;
+
+static void Calibrate()
+{
+	GLint64 gpuNs = 0;
+	GLCall(glGetInteger64v(GL_TIMESTAMP, &gpuNs));
+	s_CalibrationTicks = Profiler::Now();
+	s_CalibrationGpuNs = gpuNs;
+	s_CalibrationFrame = s_FrameIndex;
+}
+
+static unsigned long long GpuToTicks(unsigned long long gpuNs)
+{
+	double ms = ((long long)gpuNs - s_CalibrationGpuNs) / 1e6;
+	return s_CalibrationTicks + (long long)(ms * Profiler::GetTicksPerMillisecond());
+}
+
+/*
+ * Reads back [frame]'s timestamps, which must all be available, into the results and the Profiler's track.
+ */
+static void Resolve(GPUFrame& frame, double& frameMs, GPUSectionTiming* results, unsigned int& resultCount)
+{
+	GLuint64 frameStart = 0, frameEnd = 0;
+	GLCall(glGetQueryObjectui64v(frame.Queries[0], GL_QUERY_RESULT, &frameStart));
+	GLCall(glGetQueryObjectui64v(frame.Queries[1], GL_QUERY_RESULT, &frameEnd));
+	frameMs = (frameEnd - frameStart) / 1e6;
+	s_History[frame.Index % GPUProfiler::HistorySize] = { frame.Index, frameMs };
+
+	bool record = Profiler::IsEnabled();
+	if (record)
+		Profiler::Record(s_Track, "GPU frame", GpuToTicks(frameStart), GpuToTicks(frameEnd));
+
+	for (unsigned int i = 0; i < frame.SectionCount; i++)
+	{
+		const GPUSection& section = frame.Sections[i];
+		GLuint64 start = 0, end = 0;
+		GLCall(glGetQueryObjectui64v(frame.Queries[section.BeginQuery], GL_QUERY_RESULT, &start));
+		GLCall(glGetQueryObjectui64v(frame.Queries[section.EndQuery], GL_QUERY_RESULT, &end));
+
+		results[i] = { section.Name, section.Depth, (start - frameStart) / 1e6, (end - start) / 1e6 };
+		if (record)
+			Profiler::Record(s_Track, section.Name, GpuToTicks(start), GpuToTicks(end));
+	}
+	resultCount = frame.SectionCount;
+	frame.Pending = false;
+}
+
+/*
+ * Reads back every frame the GPU has finished, without waiting, then starts timing a new frame.
+ */
+void GPUProfiler::BeginFrame()
+{
+	if (!s_Initialized)
+	{
+		for (GPUFrame& frame : s_Frames)
+		{
+			GLCall(glGenQueries(s_QueriesPerFrame, frame.Queries));
+			frame.SectionCount = 0;
+			frame.Index = 0;
+			frame.Pending = false;
+		}
+		for (GPUFrameTime& entry : s_History)
+			entry.Index = ~0ull;	// Not a frame yet
+		s_Track = Profiler::CreateTrack("GPU");
+		Calibrate();
+		s_Initialized = true;
+	}
+	ASSERT(!s_InFrame);
+
+	// Frames finish in order, and a frame's last query is its end, so stop at the first one that isn't available
+	for (unsigned long long index = s_FrameIndex >= FrameLatency ? s_FrameIndex - FrameLatency : 0; index < s_FrameIndex; index++)
+	{
+		GPUFrame& frame = s_Frames[index % FrameLatency];
+		if (!frame.Pending)
+			continue;
+
+		GLint available = 0;
+		GLCall(glGetQueryObjectiv(frame.Queries[1], GL_QUERY_RESULT_AVAILABLE, &available));
+		if (!available)
+			break;
+
+		Resolve(frame, s_FrameMs, s_Results, s_ResultCount);
+		s_Latency = (unsigned int)(s_FrameIndex - frame.Index);
+	}
+
+	GPUFrame& frame = s_Frames[s_FrameIndex % FrameLatency];
+	if (frame.Pending)
+	{
+		// Still running on the GPU after FrameLatency frames. Reading it would stall, so its results are lost.
+		frame.Pending = false;
+		s_DroppedFrames++;
+	}
+
+	if (s_FrameIndex - s_CalibrationFrame >= s_CalibrationInterval)
+		Calibrate();
+
+	frame.SectionCount = 0;
+	frame.Index = s_FrameIndex;
+	s_StackSize = 0;
+	s_IgnoredDepth = 0;
+	s_InFrame = true;
+	GLCall(glQueryCounter(frame.Queries[0], GL_TIMESTAMP));
+}
+
+/*
+ * Stops timing the frame. Its results are read in a later BeginFrame(), once the GPU has finished it.
+ */
+void GPUProfiler::EndFrame()
+{
+	if (!s_InFrame)
+		return;
+	ASSERT(s_StackSize == 0);
+
+	GPUFrame& frame = s_Frames[s_FrameIndex % FrameLatency];
+	GLCall(glQueryCounter(frame.Queries[1], GL_TIMESTAMP));
+	frame.Pending = true;
+	s_InFrame = false;
+	s_FrameIndex++;
+}
+
+/*
+ * Starts a section named [name] inside the current section, if any. Ignored outside BeginFrame() and EndFrame().
+ */
+void GPUProfiler::BeginSection(const char* name)
+{
+	if (!s_InFrame)
+		return;
+
+	if (s_StackSize >= MaxDepth)
+	{
+		std::cout << "Warning: GPU sections nested more than " << MaxDepth << " deep, \"" << name << "\" is not timed" << std::endl;
+		s_IgnoredDepth++;
+		return;
+	}
+
+	GPUFrame& frame = s_Frames[s_FrameIndex % FrameLatency];
+	if (frame.SectionCount >= MaxSections)
+	{
+		s_Stack[s_StackSize++] = -1;
+		return;
+	}
+
+	unsigned int index = frame.SectionCount++;
+	frame.Sections[index] = { name, s_StackSize, 2 + 2 * index, 3 + 2 * index };
+	GLCall(glQueryCounter(frame.Queries[frame.Sections[index].BeginQuery], GL_TIMESTAMP));
+	s_Stack[s_StackSize++] = (int)index;
+}
+
+/*
+ * Ends the most recently started section
+ */
+void GPUProfiler::EndSection()
+{
+	if (!s_InFrame || s_StackSize == 0)
+		return;
+	if (s_IgnoredDepth > 0)
+	{
+		s_IgnoredDepth--;
+		return;
+	}
+
+	int index = s_Stack[--s_StackSize];
+	if (index < 0)
+		return;
+
+	GPUFrame& frame = s_Frames[s_FrameIndex % FrameLatency];
+	GLCall(glQueryCounter(frame.Queries[frame.Sections[index].EndQuery], GL_TIMESTAMP));
+}
+
+/*
+ * The index of the frame being timed, or of the next one between EndFrame() and BeginFrame()
+ */
+unsigned long long GPUProfiler::GetFrameIndex()
+{
+	return s_FrameIndex;
+}
+
+/*
+ * Sets [ms] to the GPU time of the frame with index [frameIndex].
+ * Returns false if it hasn't been resolved yet, was dropped, or is more than HistorySize frames old.
+ */
+bool GPUProfiler::GetFrameMs(unsigned long long frameIndex, double& ms)
+{
+	const GPUFrameTime& entry = s_History[frameIndex % HistorySize];
+	if (!s_Initialized || entry.Index != frameIndex)
+		return false;
+
+	ms = entry.Ms;
+	return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Profiler.h"
+
+/*
+ * GPUProfiler.h
+ * Measures how long the GPU spends on named sections of a frame, with GL_TIMESTAMP queries written by
+ * glQueryCounter() at the start and end of every section (and of the whole frame). Timestamps nest,
+ * unlike GL_TIME_ELAPSED queries, of which only one can be active at a time.
+ *
+ * Each of the FrameLatency frames in flight has its own set of queries. A frame's results are read once its
+ * last query is available, normally FrameLatency - 1 frames later, so reading them never waits on the GPU.
+ * If a frame's queries are needed again before the GPU has finished it, that frame is dropped.
+ *
+ * Resolved sections are also added to the Profiler's "GPU" track, converted to CPU ticks, so they appear
+ * next to the CPU scopes in Profiler::WriteChromeTrace().
+ *
+ * Usage:
+ *		Call BeginFrame() at the start of every frame and EndFrame() before swapping buffers, on the thread
+ *		that owns the OpenGL context.
+ *		Put GPU_PROFILE_SCOPE("name") at the top of a block that issues OpenGL commands. [name] must be a string
+ *		that is never freed (a literal).
+ *		GetResults() returns the sections of the most recently resolved frame, in the order they began.
+ *		GetFrameMs(index, ms) looks up the GPU time of any of the last HistorySize frames, by the index
+ *		GetFrameIndex() returned while it was being timed.
+ */
+
+/*
+ * GPUSectionTiming
+ * One section of a resolved frame, with its start relative to the frame's start.
+ */
+struct GPUSectionTiming
+{
+	const char* Name;
+	unsigned int Depth;
+	double StartMs;
+	double Ms;
+};
+
+class GPUProfiler
+{
+public:
+	static const unsigned int FrameLatency = 4;		// Frames in flight, each with its own queries
+	static const unsigned int MaxSections = 128;	// Per frame, later ones are ignored
+	static const unsigned int MaxDepth = 32;
+	static const unsigned int HistorySize = 64;		// Resolved frame times kept for GetFrameMs(index, ms)
+
+	static void BeginFrame();
+	static void EndFrame();
+
+	static void BeginSection(const char* name);
+	static void EndSection();
+
+	static unsigned long long GetFrameIndex();
+	static bool GetFrameMs(unsigned long long frameIndex, double& ms);
+
+	inline static double GetFrameMs() { return s_FrameMs; }
+	inline static const GPUSectionTiming* GetResults() { return s_Results; }
+	inline static unsigned int GetResultCount() { return s_ResultCount; }
+	inline static unsigned int GetLatency() { return s_Latency; }
+	inline static unsigned int GetDroppedFrames() { return s_DroppedFrames; }
+
+private:
+	static double s_FrameMs;
+	static GPUSectionTiming s_Results[MaxSections];
+	static unsigned int s_ResultCount;
+	static unsigned int s_Latency;
+	static unsigned int s_DroppedFrames;
+};
+
+/*
+ * GPUProfileScope
+ * Times the OpenGL commands issued from its construction to its destruction. Created by GPU_PROFILE_SCOPE().
+ */
+class GPUProfileScope
+{
+public:
+	GPUProfileScope(const char* name) { GPUProfiler::BeginSection(name); }
+	~GPUProfileScope() { GPUProfiler::EndSection(); }
+
+	GPUProfileScope(const GPUProfileScope&) = delete;
+	GPUProfileScope& operator=(const GPUProfileScope&) = delete;
+};
+
+#if PROFILING_ENABLED
+#define GPU_PROFILE_SCOPE(name) GPUProfileScope PROFILE_CONCAT(gpuProfileScope, __LINE__)(name)
+#else
+#define GPU_PROFILE_SCOPE(name)
+#endif
@@ -0,0 +1,156 @@
+#include "HeapTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+#ifdef _MSC_VER
+#include <malloc.h>	// _aligned_malloc
+#endif
+
+static std::atomic<unsigned long long> s_TotalAllocations(0);
+static thread_local unsigned long long s_ThreadAllocations = 0;
+
+unsigned long long HeapTracker::GetThreadAllocations()
+{
+	return s_ThreadAllocations;
+}
+
+unsigned long long HeapTracker::GetTotalAllocations()
+{
+	return s_TotalAllocations.load(std::memory_order_relaxed);
+}
+
+void HeapTracker::CountAllocation()
+{
+	s_ThreadAllocations++;
+	s_TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void* HeapTracker::ImGuiAlloc(size_t size, void* userData)
+{
+	CountAllocation();
+	return std::malloc(size);
+}
+
+void HeapTracker::ImGuiFree(void* pointer, void* userData)
+{
+	std::free(pointer);
+}
+
+/*
+ * Replacements for the global operator new and delete. The nothrow and array forms of the library call these.
+ */
+void* operator new(std::size_t size)
+{
+	HeapTracker::CountAllocation();
+	void* pointer = std::malloc(size > 0 ? size : 1);
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](std::size_t size)
+{
+	return operator new(size);
+}
+
+void operator delete(void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete(void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t) noexcept
+{
+	std::free(pointer);
+}
+
+/*
+ * Over-aligned types (alignas larger than the default new alignment, like JobSystem's per-thread state) use
+ * these instead. MSVC's aligned memory has to be released with _aligned_free, and aligned_alloc wants a
+ * multiple of the alignment as the size.
+ */
+void* operator new(std::size_t size, std::align_val_t alignment)
+{
+	HeapTracker::CountAllocation();
+	std::size_t align = (std::size_t)alignment;
+#ifdef _MSC_VER
+	void* pointer = _aligned_malloc(size > 0 ? size : 1, align);
+#else
+	void* pointer = std::aligned_alloc(align, size > 0 ? (size + align - 1) / align * align : align);
+#endif
+	if (!pointer)
+		throw std::bad_alloc();
+	return pointer;
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment)
+{
+	return operator new(size, alignment);
+}
+
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+	try
+	{
+		return operator new(size, alignment);
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t& tag) noexcept
+{
+	return operator new(size, alignment, tag);
+}
+
+static void FreeAligned(void* pointer)
+{
+#ifdef _MSC_VER
+	_aligned_free(pointer);
+#else
+	std::free(pointer);
+#endif
+}
+
+void operator delete(void* pointer, std::align_val_t) noexcept
+{
+	FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t) noexcept
+{
+	FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::size_t, std::align_val_t) noexcept
+{
+	FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::size_t, std::align_val_t) noexcept
+{
+	FreeAligned(pointer);
+}
+
+void operator delete(void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(pointer);
+}
+
+void operator delete[](void* pointer, std::align_val_t, const std::nothrow_t&) noexcept
+{
+	FreeAligned(pointer);
+}
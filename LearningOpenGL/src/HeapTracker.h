@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+/*
+ * HeapTracker.h
+ * Counts heap allocations, to check that a steady frame doesn't make any.
+ * HeapTracker.cpp replaces the global operator new and delete, so every C++ allocation is counted,
+ * both in total and for the thread making it. ImGui allocates with malloc, so Main.cpp routes it through
+ * ImGuiAlloc()/ImGuiFree() to count those too. (GLFW's and the driver's own mallocs are not seen.)
+ *
+ * Usage:
+ *		Read GetThreadAllocations() at the start and end of a frame on the render thread. The difference is the
+ *		number of allocations the frame made, ignoring worker threads like the TextureLoader's.
+ */
+class HeapTracker
+{
+public:
+	static unsigned long long GetThreadAllocations();
+	static unsigned long long GetTotalAllocations();
+
+	static void CountAllocation();
+
+	static void* ImGuiAlloc(size_t size, void* userData);
+	static void ImGuiFree(void* pointer, void* userData);
+};
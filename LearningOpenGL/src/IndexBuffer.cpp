@@ -1,5 +1,6 @@
 #include "IndexBuffer.h"
 #include "GLErrorManager.h"
+#include "GLStateCache.h"
 
 
 IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
@@ -8,20 +9,45 @@ IndexBuffer::IndexBuffer(const unsigned int* data, unsigned int count)
 	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
 
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID));
+	Bind();	// Note: this attaches the index buffer to the currently bound VAO
 	GLCall(glBufferData(GL_ELEMENT_ARRAY_BUFFER, count * sizeof(unsigned int), data, GL_STATIC_DRAW));
 }
 
+/*
+ * Creates an index buffer with space for [count] indices, to be filled with SetSubData().
+ */
+IndexBuffer::IndexBuffer(unsigned int count)
+	: m_Count(count)
+{
+	ASSERT(sizeof(unsigned int) == sizeof(GLuint));
+
+	// Allocated through the copy write target, so no VAO's index buffer binding is changed
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_COPY_WRITE_BUFFER, count * sizeof(unsigned int), nullptr, GL_DYNAMIC_DRAW));
+}
+
 IndexBuffer::~IndexBuffer()
 {
+	GLStateCache::OnBufferDeleted(m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+/*
+ * Uploads [count] indices starting at index [firstIndex]. The buffer never grows, so they must fit in it.
+ */
+void IndexBuffer::SetSubData(const unsigned int* data, unsigned int count, unsigned int firstIndex)
+{
+	ASSERT(firstIndex + count <= m_Count);
+	GLStateCache::BindBuffer(GL_COPY_WRITE_BUFFER, m_RendererID);
+	GLCall(glBufferSubData(GL_COPY_WRITE_BUFFER, firstIndex * sizeof(unsigned int), count * sizeof(unsigned int), data));
+}
+
 void IndexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_RendererID);
 }
 void IndexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
+	GLStateCache::BindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
\ No newline at end of file
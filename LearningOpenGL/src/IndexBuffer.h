@@ -4,6 +4,9 @@
  * Manages an OpenGL Index Buffer.
  * The index buffer specifies how the vertices (from the currentlty bound VAO)
  * are grouped into primitives.
+ *
+ * Pass the indices to the constructor for an index buffer that never changes (GL_STATIC_DRAW),
+ * or construct it with only a count and fill ranges of it with SetSubData().
  */
 class IndexBuffer
 {
@@ -12,8 +15,11 @@ private:
 	unsigned int m_Count;	// Number of indices
 public:
 	IndexBuffer(const unsigned int* data, unsigned int count);
+	IndexBuffer(unsigned int count);
 	~IndexBuffer();
 
+	void SetSubData(const unsigned int* data, unsigned int count, unsigned int firstIndex);
+
 	void Bind() const;
 	void Unbind() const;
 	inline unsigned int GetCount() const { return m_Count; }
@@ -0,0 +1,256 @@
+#include "JobSystem.h"
+#include "GLErrorManager.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "WorkStealingQueue.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+static const unsigned int s_NoThread = ~0u;
+static const unsigned int s_SpinsBeforeSleeping = 64;
+
+static thread_local unsigned int t_ThreadIndex = s_NoThread;
+
+// Idle workers sleep here until a job is submitted
+static std::mutex s_SleepMutex;
+static std::condition_variable s_WakeUp;
+static std::atomic<unsigned int> s_Sleeping(0);
+
+struct JobSystem::ThreadState
+{
+	WorkStealingQueue<Job*, QueueCapacity> Queue;
+	Job Jobs[QueueCapacity];		// Recycled in order, so at most QueueCapacity of them are unfinished
+	unsigned int NextJob = 0;
+	unsigned int Random = 0;		// Picks which thread to steal from first
+	std::thread Thread;
+
+	// Only written by the owning thread
+	std::atomic<unsigned long long> JobsRun{ 0 };
+	std::atomic<unsigned long long> Steals{ 0 };
+};
+
+JobSystem::ThreadState** JobSystem::s_Threads = nullptr;
+unsigned int JobSystem::s_ThreadCount = 0;
+std::atomic<unsigned int> JobSystem::s_ActiveWorkers(0);
+std::atomic<bool> JobSystem::s_Running(false);
+
+static void Increment(std::atomic<unsigned long long>& counter)
+{
+	counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+/*
+ * Starts [workerCount] workers (0 picks ThreadPool::DefaultWorkerCount()) and makes the calling thread the main one
+ */
+void JobSystem::Init(unsigned int workerCount)
+{
+	ASSERT(!s_Running);
+	if (workerCount == 0)
+		workerCount = ThreadPool::DefaultWorkerCount();
+
+	s_ThreadCount = workerCount + 1;
+	s_Threads = new ThreadState*[s_ThreadCount];
+	for (unsigned int i = 0; i < s_ThreadCount; i++)
+	{
+		s_Threads[i] = new ThreadState();
+		s_Threads[i]->Random = i * 2654435761u + 1;
+	}
+
+	t_ThreadIndex = 0;
+	s_ActiveWorkers = workerCount;
+	s_Running = true;
+	for (unsigned int i = 1; i < s_ThreadCount; i++)
+		s_Threads[i]->Thread = std::thread(&JobSystem::WorkerLoop, i);
+}
+
+/*
+ * Stops the workers. Wait for every counter first: jobs still queued are dropped.
+ */
+void JobSystem::Shutdown()
+{
+	if (!s_Running)
+		return;
+
+	{
+		std::lock_guard<std::mutex> lock(s_SleepMutex);
+		s_Running = false;
+	}
+	s_WakeUp.notify_all();
+
+	for (unsigned int i = 1; i < s_ThreadCount; i++)
+		s_Threads[i]->Thread.join();
+	for (unsigned int i = 0; i < s_ThreadCount; i++)
+		delete s_Threads[i];
+	delete[] s_Threads;
+
+	s_Threads = nullptr;
+	s_ThreadCount = 0;
+	t_ThreadIndex = s_NoThread;
+}
+
+/*
+ * Runs jobs (or yields, outside the system's threads) until [counter] is done
+ */
+void JobSystem::Wait(const JobCounter& counter)
+{
+	unsigned int index = t_ThreadIndex;
+	while (!counter.IsDone())
+	{
+		if (index == s_NoThread || !RunOneJob(index))
+			std::this_thread::yield();
+	}
+}
+
+void JobSystem::SetActiveWorkerCount(unsigned int count)
+{
+	unsigned int workers = GetWorkerCount();
+	{
+		std::lock_guard<std::mutex> lock(s_SleepMutex);
+		s_ActiveWorkers = count < workers ? count : workers;
+	}
+	s_WakeUp.notify_all();
+}
+
+unsigned int JobSystem::GetActiveWorkerCount()
+{
+	return s_ActiveWorkers.load(std::memory_order_relaxed);
+}
+
+JobSystemStats JobSystem::GetStats()
+{
+	JobSystemStats stats = {};
+	for (unsigned int i = 0; i < s_ThreadCount; i++)
+	{
+		stats.Jobs += s_Threads[i]->JobsRun.load(std::memory_order_relaxed);
+		stats.Steals += s_Threads[i]->Steals.load(std::memory_order_relaxed);
+	}
+	return stats;
+}
+
+unsigned int JobSystem::GetThreadIndex()
+{
+	unsigned int index = t_ThreadIndex;
+	ASSERT(index != s_NoThread);	// Jobs can only be started on the main thread or in jobs
+	return index;
+}
+
+/*
+ * Takes the calling thread's next Job, or returns null if it hasn't finished yet. Waiting for it isn't safe:
+ * it may be running further up this thread's own stack, below a nested Wait().
+ */
+Job* JobSystem::AllocateJob()
+{
+	unsigned int index = GetThreadIndex();
+	ThreadState& state = *s_Threads[index];
+	Job* job = &state.Jobs[state.NextJob % QueueCapacity];
+	if (!job->Finished.load(std::memory_order_acquire))
+		return nullptr;
+
+	state.NextJob++;
+	job->Finished.store(false, std::memory_order_relaxed);
+	return job;
+}
+
+void JobSystem::Submit(Job* job)
+{
+	unsigned int index = GetThreadIndex();
+	if (!s_Threads[index]->Queue.Push(job))
+	{
+		Execute(job, index);	// Can't happen while QueueCapacity Jobs are recycled, but never drop one
+		return;
+	}
+
+	// Pairs with the sleeping worker checking the queues after announcing itself
+	std::atomic_thread_fence(std::memory_order_seq_cst);
+	if (s_Sleeping.load(std::memory_order_relaxed) > 0)
+	{
+		std::lock_guard<std::mutex> lock(s_SleepMutex);
+		s_WakeUp.notify_one();
+	}
+}
+
+/*
+ * Runs the newest job of the thread's own queue, or else steals the oldest one of another thread.
+ * Returns false if there was nothing to run.
+ */
+bool JobSystem::RunOneJob(unsigned int threadIndex)
+{
+	ThreadState& state = *s_Threads[threadIndex];
+	Job* job = nullptr;
+	if (!state.Queue.Pop(job))
+	{
+		// Start at a random thread, so thieves spread over the queues
+		state.Random ^= state.Random << 13;
+		state.Random ^= state.Random >> 17;
+		state.Random ^= state.Random << 5;
+		unsigned int first = state.Random % s_ThreadCount;
+
+		bool stolen = false;
+		for (unsigned int i = 0; i < s_ThreadCount && !stolen; i++)
+		{
+			unsigned int victim = (first + i) % s_ThreadCount;
+			if (victim != threadIndex)
+				stolen = s_Threads[victim]->Queue.Steal(job);
+		}
+		if (!stolen)
+			return false;
+		Increment(state.Steals);
+	}
+
+	Execute(job, threadIndex);
+	return true;
+}
+
+void JobSystem::Execute(Job* job, unsigned int threadIndex)
+{
+	if (job->Dependency)
+		Wait(*job->Dependency);
+	job->Function(*job);
+
+	// The creator may reuse the Job as soon as it is finished, so the counter is read first
+	JobCounter* counter = job->Counter;
+	job->Finished.store(true, std::memory_order_release);
+	counter->m_Pending.fetch_sub(1, std::memory_order_acq_rel);
+	Increment(s_Threads[threadIndex]->JobsRun);
+}
+
+void JobSystem::WorkerLoop(unsigned int threadIndex)
+{
+	t_ThreadIndex = threadIndex;
+	Profiler::SetThreadName("Job worker");
+
+	unsigned int idleSpins = 0;
+	while (s_Running.load(std::memory_order_relaxed))
+	{
+		bool active = threadIndex <= s_ActiveWorkers.load(std::memory_order_relaxed);
+		if (active && RunOneJob(threadIndex))
+		{
+			idleSpins = 0;
+			continue;
+		}
+
+		if (active && ++idleSpins < s_SpinsBeforeSleeping)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(s_SleepMutex);
+		s_Sleeping.fetch_add(1, std::memory_order_seq_cst);
+		// A job submitted before the increment is seen here, one submitted after it wakes this thread up.
+		// The timeout only guards against a missed wake up.
+		bool hasWork = false;
+		if (threadIndex <= s_ActiveWorkers.load(std::memory_order_relaxed))
+		{
+			for (unsigned int i = 0; i < s_ThreadCount && !hasWork; i++)
+				hasWork = s_Threads[i]->Queue.GetSize() > 0;
+		}
+		if (!hasWork && s_Running.load(std::memory_order_relaxed))
+			s_WakeUp.wait_for(lock, std::chrono::milliseconds(10));
+		s_Sleeping.fetch_sub(1, std::memory_order_relaxed);
+		idleSpins = 0;
+	}
+}
@@ -0,0 +1,207 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <type_traits>
+
+/*
+ * JobSystem.h
+ * Small CPU jobs spread over worker threads by work stealing. Every thread of the system (the main thread and
+ * the workers) owns a WorkStealingQueue: new jobs go to the bottom of the creating thread's queue, which it
+ * runs newest first, and a thread that runs out of work steals the oldest job of another one. So related jobs
+ * stay on one core while the others pick up the big leftover pieces.
+ *
+ * A job is a callable of up to Job::DataSize bytes (a lambda capturing a few pointers or references), copied into a
+ * preallocated Job, so running one never allocates. Jobs report to a JobCounter: it counts the jobs still
+ * pending, and Wait() runs other jobs until it reaches zero. A job can also depend on a counter, and waits for it
+ * (running other jobs meanwhile) before it starts.
+ *
+ * Usage:
+ *		Init() once on the main thread at startup, Shutdown() before exiting. Jobs can be started from the main
+ *		thread (e.g. in Test::OnUpdate) and from other jobs, but not from threads outside the system.
+ *
+ *		JobCounter counter;
+ *		JobSystem::Run([&]() { ... }, counter);
+ *		JobSystem::Run([&]() { ... }, counter, otherCounter);	// Starts once otherCounter is done
+ *		JobSystem::Wait(counter);
+ *
+ *		JobSystem::ParallelFor(data, count, grainSize, [](T* first, size_t count) { ... }) calls back with spans of
+ *		at most grainSize elements, on every thread, and returns when all of them are done.
+ *
+ *		Jobs run without an OpenGL context, so they must only do CPU work. Everything they capture by reference
+ *		must outlive them: wait for their counter before it goes out of scope.
+ */
+
+/*
+ * JobCounter
+ * Number of jobs started with it that haven't finished. Done (and reusable) when it is zero.
+ */
+class JobCounter
+{
+private:
+	friend class JobSystem;
+	std::atomic<unsigned int> m_Pending;
+
+public:
+	JobCounter() : m_Pending(0) {}
+
+	JobCounter(const JobCounter&) = delete;
+	JobCounter& operator=(const JobCounter&) = delete;
+
+	inline bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+};
+
+/*
+ * Job
+ * One scheduled callable, stored inline. Jobs are recycled by the thread that created them.
+ */
+struct Job
+{
+	static const size_t DataSize = 48;
+
+	void (*Function)(Job& job);
+	JobCounter* Counter;
+	const JobCounter* Dependency;	// Waited for before running, may be null
+	std::atomic<bool> Finished;
+	alignas(std::max_align_t) unsigned char Data[DataSize];
+
+	Job() : Function(nullptr), Counter(nullptr), Dependency(nullptr), Finished(true) {}
+};
+
+/*
+ * JobSystemStats
+ * Totals since Init()
+ */
+struct JobSystemStats
+{
+	unsigned long long Jobs;		// Jobs run
+	unsigned long long Steals;		// Jobs taken from another thread's queue
+};
+
+class JobSystem
+{
+public:
+	static const unsigned int QueueCapacity = 4096;	// Unfinished jobs a thread can have queued at once, the rest run inline
+
+private:
+	struct ThreadState;
+
+	static ThreadState** s_Threads;		// The main thread's, then each worker's
+	static unsigned int s_ThreadCount;
+	static std::atomic<unsigned int> s_ActiveWorkers;
+	static std::atomic<bool> s_Running;
+
+public:
+	static void Init(unsigned int workerCount = 0);
+	static void Shutdown();
+
+	/*
+	 * Starts [function] as a job that counts towards [counter]
+	 */
+	template<typename F>
+	static void Run(const F& function, JobCounter& counter)
+	{
+		Schedule(function, counter, nullptr);
+	}
+
+	/*
+	 * Starts [function] as a job that counts towards [counter], once [dependency] is done
+	 */
+	template<typename F>
+	static void Run(const F& function, JobCounter& counter, const JobCounter& dependency)
+	{
+		Schedule(function, counter, &dependency);
+	}
+
+	static void Wait(const JobCounter& counter);
+
+	/*
+	 * Calls [function](first, count) on spans of at most [grainSize] of the [count] elements at [data], in parallel,
+	 * and counts them towards [counter]. [function] must stay alive until the counter is done.
+	 * The range is split in halves by the jobs themselves, so idle threads steal large pieces.
+	 */
+	template<typename T, typename F>
+	static void ParallelFor(T* data, size_t count, size_t grainSize, const F& function, JobCounter& counter)
+	{
+		if (count > 0)
+			Run(RangeJob<T, F>{ data, count, grainSize > 0 ? grainSize : 1, &function, &counter }, counter);
+	}
+
+	/*
+	 * Same, on the calling thread too, and returns once every span is done
+	 */
+	template<typename T, typename F>
+	static void ParallelFor(T* data, size_t count, size_t grainSize, const F& function)
+	{
+		if (count == 0)
+			return;
+
+		JobCounter counter;
+		RangeJob<T, F>{ data, count, grainSize > 0 ? grainSize : 1, &function, &counter }();
+		Wait(counter);
+	}
+
+	// Lets only the first [count] workers take jobs, to measure how work scales with threads (0 leaves the main thread alone)
+	static void SetActiveWorkerCount(unsigned int count);
+	static unsigned int GetActiveWorkerCount();
+	inline static unsigned int GetWorkerCount() { return s_ThreadCount > 0 ? s_ThreadCount - 1 : 0; }
+	static JobSystemStats GetStats();
+
+private:
+	template<typename T, typename F>
+	struct RangeJob
+	{
+		T* Data;
+		size_t Count;
+		size_t GrainSize;
+		const F* Function;
+		JobCounter* Counter;
+
+		// Hands the upper half to other threads until the rest is small enough, then runs it
+		void operator()() const
+		{
+			size_t count = Count;
+			while (count > GrainSize)
+			{
+				size_t half = count / 2;
+				Run(RangeJob{ Data + half, count - half, GrainSize, Function, Counter }, *Counter);
+				count = half;
+			}
+			(*Function)(Data, count);
+		}
+	};
+
+	template<typename F>
+	static void Schedule(const F& function, JobCounter& counter, const JobCounter* dependency)
+	{
+		static_assert(sizeof(F) <= Job::DataSize && alignof(F) <= alignof(std::max_align_t),
+			"Jobs are stored inline: capture less, or capture a pointer to the data");
+		static_assert(std::is_trivially_copyable<F>::value && std::is_trivially_destructible<F>::value,
+			"Jobs are copied with their bytes and never destroyed: capture pointers and references, not owning objects");
+
+		Job* job = AllocateJob();
+		if (!job)
+		{
+			// Every Job of this thread is in use: run it right away instead
+			if (dependency)
+				Wait(*dependency);
+			function();
+			return;
+		}
+
+		new (job->Data) F(function);
+		job->Function = [](Job& self) { (*reinterpret_cast<F*>(self.Data))(); };
+		job->Counter = &counter;
+		job->Dependency = dependency;
+		counter.m_Pending.fetch_add(1, std::memory_order_relaxed);
+		Submit(job);
+	}
+
+	static Job* AllocateJob();
+	static void Submit(Job* job);
+	static bool RunOneJob(unsigned int threadIndex);
+	static void Execute(Job* job, unsigned int threadIndex);
+	static void WorkerLoop(unsigned int threadIndex);
+	static unsigned int GetThreadIndex();
+};
@@ -0,0 +1,250 @@
+#include "KtxFile.h"
+
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+
+static const unsigned char s_Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+static const unsigned int s_HeaderSize = 80;		// Identifier, header, and index
+static const unsigned int s_LevelIndexEntrySize = 24;
+
+// Data format descriptor values (Khronos Data Format Specification)
+static const unsigned int KHR_DF_MODEL_BC1A = 128;
+static const unsigned int KHR_DF_MODEL_BC3 = 130;
+static const unsigned int KHR_DF_MODEL_BC7 = 134;
+static const unsigned int KHR_DF_CHANNEL_COLOR = 0;
+static const unsigned int KHR_DF_CHANNEL_BC3_ALPHA = 15;
+static const unsigned int KHR_DF_PRIMARIES_BT709 = 1;
+static const unsigned int KHR_DF_TRANSFER_LINEAR = 1;
+static const unsigned int KHR_DF_TRANSFER_SRGB = 2;
+static const unsigned int KHR_DF_SAMPLE_LINEAR = 1 << 28;
+
+static void Append32(std::vector<unsigned char>& data, unsigned int value)
+{
+	for (int i = 0; i < 4; i++)
+		data.push_back((unsigned char)(value >> (i * 8)));
+}
+
+static void Append64(std::vector<unsigned char>& data, unsigned long long value)
+{
+	for (int i = 0; i < 8; i++)
+		data.push_back((unsigned char)(value >> (i * 8)));
+}
+
+static unsigned int Read32(const unsigned char* data)
+{
+	return data[0] | (data[1] << 8) | (data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+static unsigned long long Read64(const unsigned char* data)
+{
+	return Read32(data) | ((unsigned long long)Read32(data + 4) << 32);
+}
+
+KtxFile::KtxFile()
+	: Format(BlockFormat::BC1), SRGB(false), Width(0), Height(0)
+{
+}
+
+unsigned int KtxFile::GetVkFormat(BlockFormat format, bool srgb)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1:	return srgb ? 132 : 131;	// VK_FORMAT_BC1_RGB_(SRGB|UNORM)_BLOCK
+	case BlockFormat::BC3:	return srgb ? 138 : 137;	// VK_FORMAT_BC3_(SRGB|UNORM)_BLOCK
+	default:				return srgb ? 146 : 145;	// VK_FORMAT_BC7_(SRGB|UNORM)_BLOCK
+	}
+}
+
+bool KtxFile::FromVkFormat(unsigned int vkFormat, BlockFormat& format, bool& srgb)
+{
+	switch (vkFormat)
+	{
+	case 131: case 132:	format = BlockFormat::BC1; break;
+	case 137: case 138:	format = BlockFormat::BC3; break;
+	case 145: case 146:	format = BlockFormat::BC7; break;
+	default:			return false;
+	}
+	srgb = vkFormat == 132 || vkFormat == 138 || vkFormat == 146;
+	return true;
+}
+
+size_t KtxFile::GetDataSize() const
+{
+	size_t size = 0;
+	for (const std::vector<unsigned char>& level : Levels)
+		size += level.size();
+	return size;
+}
+
+bool KtxFile::Write(const std::string& filepath) const
+{
+	unsigned int levelCount = (unsigned int)Levels.size();
+	unsigned int blockBytes = BlockCompressor::GetBlockBytes(Format);
+
+	/* Data format descriptor: one basic block, with one sample per 64 bit half of the block */
+	std::vector<unsigned char> dfd;
+	unsigned int sampleCount = Format == BlockFormat::BC3 ? 2 : 1;
+	unsigned int blockSize = 24 + 16 * sampleCount;
+	unsigned int model = Format == BlockFormat::BC1 ? KHR_DF_MODEL_BC1A : Format == BlockFormat::BC3 ? KHR_DF_MODEL_BC3 : KHR_DF_MODEL_BC7;
+	unsigned int transfer = SRGB ? KHR_DF_TRANSFER_SRGB : KHR_DF_TRANSFER_LINEAR;
+
+	Append32(dfd, 4 + blockSize);								// dfdTotalSize
+	Append32(dfd, 0);											// vendorId, descriptorType
+	Append32(dfd, 2 | (blockSize << 16));						// versionNumber, descriptorBlockSize
+	Append32(dfd, model | (KHR_DF_PRIMARIES_BT709 << 8) | (transfer << 16));
+	Append32(dfd, 3 | (3 << 8));								// 4x4 texel blocks (stored as size - 1)
+	Append32(dfd, blockBytes);									// bytesPlane0
+	Append32(dfd, 0);
+	if (Format == BlockFormat::BC3)
+	{
+		// Alpha is never sRGB encoded
+		Append32(dfd, 0 | (63 << 16) | (KHR_DF_CHANNEL_BC3_ALPHA << 24) | KHR_DF_SAMPLE_LINEAR);
+		Append32(dfd, 0);
+		Append32(dfd, 0);
+		Append32(dfd, 0xFFFFFFFF);
+		Append32(dfd, 64 | (63 << 16) | (KHR_DF_CHANNEL_COLOR << 24));
+	}
+	else
+	{
+		Append32(dfd, 0 | ((blockBytes * 8 - 1) << 16) | (KHR_DF_CHANNEL_COLOR << 24));
+	}
+	Append32(dfd, 0);
+	Append32(dfd, 0);
+	Append32(dfd, 0xFFFFFFFF);
+
+	/* Level data goes after the descriptor, smallest level first, each aligned to the block size */
+	unsigned int dfdOffset = s_HeaderSize + levelCount * s_LevelIndexEntrySize;
+	std::vector<unsigned long long> levelOffsets(levelCount);
+	unsigned long long offset = dfdOffset + dfd.size();
+	for (int level = (int)levelCount - 1; level >= 0; level--)
+	{
+		offset = (offset + blockBytes - 1) / blockBytes * blockBytes;
+		levelOffsets[level] = offset;
+		offset += Levels[level].size();
+	}
+
+	std::vector<unsigned char> file(s_Identifier, s_Identifier + sizeof(s_Identifier));
+	Append32(file, GetVkFormat(Format, SRGB));
+	Append32(file, 1);				// typeSize
+	Append32(file, Width);
+	Append32(file, Height);
+	Append32(file, 0);				// pixelDepth
+	Append32(file, 0);				// layerCount
+	Append32(file, 1);				// faceCount
+	Append32(file, levelCount);
+	Append32(file, 0);				// supercompressionScheme
+	Append32(file, dfdOffset);
+	Append32(file, (unsigned int)dfd.size());
+	Append32(file, 0);				// No key/value data
+	Append32(file, 0);
+	Append64(file, 0);				// No supercompression global data
+	Append64(file, 0);
+
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		Append64(file, levelOffsets[level]);
+		Append64(file, Levels[level].size());
+		Append64(file, Levels[level].size());	// uncompressedByteLength, the same without supercompression
+	}
+
+	file.insert(file.end(), dfd.begin(), dfd.end());
+	for (int level = (int)levelCount - 1; level >= 0; level--)
+	{
+		file.resize((size_t)levelOffsets[level], 0);
+		file.insert(file.end(), Levels[level].begin(), Levels[level].end());
+	}
+
+	std::ofstream stream(filepath, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Warning: could not write " << filepath << std::endl;
+		return false;
+	}
+	stream.write((const char*)file.data(), file.size());
+	return stream.good();
+}
+
+bool KtxFile::Read(const std::string& filepath)
+{
+	std::ifstream stream(filepath, std::ios::binary);
+	if (!stream)
+	{
+		std::cout << "Warning: could not open " << filepath << std::endl;
+		return false;
+	}
+	std::vector<unsigned char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+	if (file.size() < s_HeaderSize || std::memcmp(file.data(), s_Identifier, sizeof(s_Identifier)) != 0)
+	{
+		std::cout << "Warning: " << filepath << " is not a KTX2 file" << std::endl;
+		return false;
+	}
+
+	const unsigned char* header = file.data() + sizeof(s_Identifier);
+	unsigned int vkFormat = Read32(header + 0);
+	unsigned int width = Read32(header + 8);
+	unsigned int height = Read32(header + 12);
+	unsigned int depth = Read32(header + 16);
+	unsigned int layers = Read32(header + 20);
+	unsigned int faces = Read32(header + 24);
+	unsigned int levelCount = std::max(Read32(header + 28), 1u);
+	unsigned int supercompression = Read32(header + 32);
+
+	if (!FromVkFormat(vkFormat, Format, SRGB))
+	{
+		std::cout << "Warning: " << filepath << " has unsupported vkFormat " << vkFormat << std::endl;
+		return false;
+	}
+	if (depth > 1 || layers > 1 || faces != 1 || supercompression != 0 || width == 0 || height == 0)
+	{
+		std::cout << "Warning: " << filepath << " is not a plain 2D texture without supercompression" << std::endl;
+		return false;
+	}
+	if (width > INT_MAX || height > INT_MAX)
+	{
+		std::cout << "Warning: " << filepath << " is too large (" << width << "x" << height << ")" << std::endl;
+		return false;
+	}
+	Width = (int)width;
+	Height = (int)height;
+
+	// A full mip chain ends at 1x1, so more levels than that can't be valid (and would shift the size too far)
+	unsigned int maxLevels = 1;
+	while ((std::max(width, height) >> maxLevels) > 0)
+		maxLevels++;
+	if (levelCount > maxLevels)
+	{
+		std::cout << "Warning: " << filepath << " has " << levelCount << " levels, more than a full mip chain" << std::endl;
+		return false;
+	}
+	if (file.size() < s_HeaderSize + (size_t)levelCount * s_LevelIndexEntrySize)
+	{
+		std::cout << "Warning: " << filepath << " is truncated" << std::endl;
+		return false;
+	}
+
+	Levels.clear();
+	for (unsigned int level = 0; level < levelCount; level++)
+	{
+		const unsigned char* entry = file.data() + s_HeaderSize + level * s_LevelIndexEntrySize;
+		unsigned long long offset = Read64(entry);
+		unsigned long long length = Read64(entry + 8);
+
+		int levelWidth = std::max(Width >> level, 1);
+		int levelHeight = std::max(Height >> level, 1);
+		// Compared without adding, so offset + length can't wrap around past the check
+		if (length != BlockCompressor::GetCompressedSize(Format, levelWidth, levelHeight) ||
+			offset > file.size() || length > file.size() - offset)
+		{
+			std::cout << "Warning: " << filepath << " has an invalid level " << level << std::endl;
+			return false;
+		}
+		Levels.emplace_back(file.begin() + (size_t)offset, file.begin() + (size_t)(offset + length));
+	}
+	return true;
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include "BlockCompression.h"
+
+#include <string>
+#include <vector>
+
+/*
+ * KtxFile.h
+ * Reads and writes block compressed 2D textures, with their mip levels, in the KTX2 container format
+ * (https://registry.khronos.org/KTX/specs/2.0/ktxspec.v2.html).
+ *
+ * Only what this project produces is supported: a single 2D image (no array layers, cube faces, or depth),
+ * a BC1/BC3/BC7 vkFormat, and no supercompression. The file has the KTX2 header, level index and a
+ * basic data format descriptor, so other KTX2 tools can open it too.
+ *
+ * Usage:
+ *		Fill in the format and the compressed levels (level 0 first), then call Write().
+ *		Or call Read(), which returns false (with a warning) for anything it can't load.
+ */
+
+class KtxFile
+{
+public:
+	BlockFormat Format;
+	bool SRGB;
+	int Width, Height;
+	std::vector<std::vector<unsigned char>> Levels;	// Compressed blocks of each mip level, largest first
+
+public:
+	KtxFile();
+
+	bool Read(const std::string& filepath);
+	bool Write(const std::string& filepath) const;
+
+	size_t GetDataSize() const;	// Bytes of every level together
+
+	static unsigned int GetVkFormat(BlockFormat format, bool srgb);
+	static bool FromVkFormat(unsigned int vkFormat, BlockFormat& format, bool& srgb);
+};
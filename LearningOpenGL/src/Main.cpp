@@ -1,5 +1,6 @@
 #include <GL/glew.h>
 #include <GLFW/glfw3.h>
+#include <chrono>
 #include <cstdio>
 #include <iostream>
 #include <fstream>
@@ -14,6 +15,14 @@
 #include "Shader.h"
 #include "Renderer.h"
 #include "Texture.h"
+#include "GLStateCache.h"
+#include "FrameArena.h"
+#include "HeapTracker.h"
+#include "Profiler.h"
+#include "GPUProfiler.h"
+#include "RenderThread.h"
+#include "JobSystem.h"
+#include "FrameClock.h"
 
 #include "glm/glm.hpp"
 #include "glm/gtc/matrix_transform.hpp"
@@ -24,10 +33,41 @@
 
 #include "tests/TestClearColor.h"
 #include "tests/TestTexture2D.h"
+#include "tests/TestBatchRenderer.h"
+#include "tests/TestInstancing.h"
+#include "tests/TestStreaming.h"
+#include "tests/TestGLCallOverhead.h"
+#include "tests/TestShaderCache.h"
+#include "tests/TestUniformLookup.h"
+#include "tests/TestTextureLoading.h"
+#include "tests/TestTextureFiltering.h"
+#include "tests/TestTextureAtlas.h"
+#include "tests/TestCompressedTextures.h"
+#include "tests/TestTextureCache.h"
+#include "tests/TestPixelConvert.h"
+#include "tests/TestRenderQueue.h"
+#include "tests/TestMeshPool.h"
+#include "tests/TestZeroAlloc.h"
+#include "tests/TestProfiler.h"
+#include "tests/TestGPUProfiler.h"
+#include "tests/TestNullBackend.h"
+#include "tests/TestRenderThread.h"
+#include "tests/TestParallelRecording.h"
+#include "tests/TestJobSystem.h"
+#include "tests/BenchmarkRunner.h"
 
-int main(void)
+int main(int argc, char** argv)
 {
-    Display window;
+    test::BenchmarkOptions benchmark;
+    if (!test::ParseBenchmarkArgs(argc, argv, benchmark))
+        return 1;
+
+    // A benchmark's stdout carries only its JSON results, so everything else printed goes to stderr
+    std::ostream standardOutput(std::cout.rdbuf());
+    if (benchmark.Enabled)
+        std::cout.rdbuf(std::cerr.rdbuf());
+
+    Display window(benchmark.Width, benchmark.Height, !benchmark.Enabled);
 
     /* Initialize GLEW */
     GLenum err = glewInit();
@@ -36,9 +76,11 @@ int main(void)
         /* Problem: glewInit failed, something is seriously wrong. */
         fprintf(stderr, "Error: %s\n", glewGetErrorString(err));
     }
-    fprintf(stdout, "Status: Using GLEW %s\n", glewGetString(GLEW_VERSION));
+    std::cout << "Status: Using GLEW " << glewGetString(GLEW_VERSION) << std::endl;
 
     std::cout << "Using OpenGL: " << glGetString(GL_VERSION) << std::endl;
+    std::cout << "GLCall error checking: " << GLGetErrorCheckModeName() << std::endl;
+    GLEnableDebugOutput();
 
 
 
@@ -46,10 +88,52 @@ int main(void)
 
     /* ~~~~~~~~~~ Initialize scene ~~~~~~~~~~ */
 
+    JobSystem::Init();    // Tests can run jobs from here on, this thread being the main one
+
     Renderer renderer;
 
+    test::Test* currentTest = nullptr;
+    test::TestMenu* testMenu = new test::TestMenu(currentTest);
+    currentTest = testMenu;
+
+
+    testMenu->RegisterTest<test::TestClearColor>("Clear Color");
+    testMenu->RegisterTest<test::TestTexture2D>("2D Texture");
+    testMenu->RegisterTest<test::TestBatchRenderer>("Batch Renderer");
+    testMenu->RegisterTest<test::TestInstancing>("Instancing");
+    testMenu->RegisterTest<test::TestStreaming>("Streaming Vertex Buffer");
+    testMenu->RegisterTest<test::TestGLCallOverhead>("GLCall Overhead");
+    testMenu->RegisterTest<test::TestShaderCache>("Shader Binary Cache");
+    testMenu->RegisterTest<test::TestUniformLookup>("Uniform Lookup");
+    testMenu->RegisterTest<test::TestTextureLoading>("Texture Loading");
+    testMenu->RegisterTest<test::TestTextureFiltering>("Texture Filtering");
+    testMenu->RegisterTest<test::TestTextureAtlas>("Texture Atlas");
+    testMenu->RegisterTest<test::TestCompressedTextures>("Compressed Textures");
+    testMenu->RegisterTest<test::TestTextureCache>("Texture Cache");
+    testMenu->RegisterTest<test::TestPixelConvert>("Pixel Conversion");
+    testMenu->RegisterTest<test::TestRenderQueue>("Render Queue");
+    testMenu->RegisterTest<test::TestMeshPool>("Mesh Pool");
+    testMenu->RegisterTest<test::TestZeroAlloc>("Zero Allocation Frame");
+    testMenu->RegisterTest<test::TestProfiler>("Profiler");
+    testMenu->RegisterTest<test::TestGPUProfiler>("GPU Profiler");
+    testMenu->RegisterTest<test::TestNullBackend>("Null GL Backend");
+    testMenu->RegisterTest<test::TestRenderThread>("Render Thread");
+    testMenu->RegisterTest<test::TestParallelRecording>("Parallel Recording");
+    testMenu->RegisterTest<test::TestJobSystem>("Job System");
+
+    // Headless benchmark: run one test without ImGui, write its frame times, and exit
+    if (benchmark.Enabled)
+    {
+        int result = test::RunBenchmark(benchmark, *testMenu, window, renderer, standardOutput);
+        delete testMenu;
+        JobSystem::Shutdown();
+        std::cout.rdbuf(standardOutput.rdbuf());
+        return result;
+    }
+
     /* Initialize ImGUI */
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(HeapTracker::ImGuiAlloc, HeapTracker::ImGuiFree);   // So its allocations are counted
     ImGui::CreateContext();
     ImGui_ImplGlfw_InitForOpenGL(window.GetWindow(), true);
     ImGui::StyleColorsDark();
@@ -59,21 +143,59 @@ int main(void)
 
     ImGui_ImplOpenGL3_Init("#version 130");
 
-    test::Test* currentTest = nullptr;
-    test::TestMenu* testMenu = new test::TestMenu(currentTest);
-    currentTest = testMenu;
 
+    unsigned long long frameAllocations = 0;   // Heap allocations the render thread made last frame
+    float cpuFrameMs = 0.0f;                    // Last frame's CPU time, up to the buffer swap
+    bool showProfiler = false;
+    Profiler::SetThreadName("Render");
 
-    testMenu->RegisterTest<test::TestClearColor>("Clear Color");
-    testMenu->RegisterTest<test::TestTexture2D>("2D Texture");
+    // With the render thread on, this thread only records OpenGL calls, and another one executes them
+    RenderThread renderThread(window);
+    bool useRenderThread = false;
+    FrameLatencyStats singleThreadLatency;
 
+    // Tests update at a fixed rate, however fast frames are rendered
+    FrameClock frameClock;
+    bool fixedTimestep = frameClock.IsFixedStepEnabled();
+    int updateHz = (int)frameClock.GetUpdateRate();
+    int maxCatchUp = (int)frameClock.GetMaxCatchUp();
+    int swapMode = (int)window.GetSwapMode();
+    int frameLimit = (int)window.GetFrameLimit();
 
     /* Loop until the user closes the window */
     while (!window.WindowShouldClose())
     {
+        // Switch between modes. The open test is recreated, because its objects only exist in one mode.
+        if (useRenderThread != renderThread.IsRunning())
+        {
+            bool restart = currentTest != testMenu;
+            if (restart)
+                delete currentTest;
+            if (useRenderThread)
+                useRenderThread = renderThread.Start();
+            else
+                renderThread.Stop();
+            currentTest = restart ? testMenu->CreateTest(testMenu->GetCurrentTestName()) : nullptr;
+            if (!currentTest)
+                currentTest = testMenu;
+        }
+        bool threaded = renderThread.IsRunning();
+
+        unsigned long long frameStartAllocations = HeapTracker::GetThreadAllocations();
+        auto frameStart = std::chrono::steady_clock::now();
+        unsigned int updates = frameClock.BeginFrame();
+        Profiler::MarkFrame();
+        if (!threaded)
+            GPUProfiler::BeginFrame();      // Query results aren't available while recording, so GPU sections do nothing
+
         GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
         /* Render here */
-        renderer.Clear();
+        {
+            GPU_PROFILE_SCOPE("Clear");
+            renderer.Clear();
+        }
+        Renderer::ResetStats();
+        GLStateCache::ResetStats();
 
 
         // ImGui frame setup
@@ -83,36 +205,126 @@ int main(void)
 
         if (currentTest)
         {
-            currentTest->OnUpdate(0.0f);
-            currentTest->OnRender();
+            for (unsigned int update = 0; update < updates; update++)
+            {
+                PROFILE_SCOPE("Test::OnUpdate");
+                currentTest->OnUpdate(frameClock.GetUpdateStep());
+            }
+            {
+                PROFILE_SCOPE("Test::OnRender");
+                GPU_PROFILE_SCOPE("Test::OnRender");
+                currentTest->OnRenderInterpolated(frameClock.GetAlpha());
+            }
             ImGui::Begin("Test");
             if (currentTest != testMenu && ImGui::Button("<-"))
             {
                 delete currentTest;
                 currentTest = testMenu;
             }
-            currentTest->OnImGuiRender();
+            {
+                PROFILE_SCOPE("Test::OnImGuiRender");
+                currentTest->OnImGuiRender();
+            }
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+            ImGui::Text("Updates: %.1f Hz, rendering: %.1f Hz", frameClock.GetUpdateHz(), frameClock.GetRenderHz());
+            if (ImGui::TreeNode("Frame clock"))
+            {
+                if (ImGui::Checkbox("Fixed timestep", &fixedTimestep))
+                    frameClock.SetFixedStepEnabled(fixedTimestep);
+                if (ImGui::SliderInt("Update rate (Hz)", &updateHz, 10, 240))
+                    frameClock.SetUpdateRate(updateHz);
+                if (ImGui::SliderInt("Max catch-up updates", &maxCatchUp, 1, 20))
+                    frameClock.SetMaxCatchUp(maxCatchUp);
+                ImGui::Text("Frame time: %.3f ms, alpha %.2f, %llu updates dropped", frameClock.GetDeltaTime() * 1000.0f,
+                    frameClock.GetAlpha(), frameClock.GetDroppedUpdates());
+                if (ImGui::Combo("Swap", &swapMode, "Uncapped\0V sync\0Frame limit\0"))
+                    window.SetSwapMode((SwapMode)swapMode);
+                if (swapMode == (int)SwapMode::Limited && ImGui::SliderInt("Frame limit (FPS)", &frameLimit, 10, 500))
+                    window.SetFrameLimit(frameLimit);
+                ImGui::TreePop();
+            }
+            if (threaded)
+                ImGui::Text("CPU frame: %.3f ms, GPU frame: not measured with the render thread", cpuFrameMs);
+            else
+                ImGui::Text("CPU frame: %.3f ms, GPU frame: %.3f ms (%u frames behind)", cpuFrameMs, GPUProfiler::GetFrameMs(),
+                    GPUProfiler::GetLatency());
+            if (ImGui::TreeNode("GPU sections"))
+            {
+                for (unsigned int i = 0; i < GPUProfiler::GetResultCount(); i++)
+                {
+                    const GPUSectionTiming& section = GPUProfiler::GetResults()[i];
+                    ImGui::Text("%*s%s: %.3f ms", (int)section.Depth * 2, "", section.Name, section.Ms);
+                }
+                if (GPUProfiler::GetDroppedFrames() > 0)
+                    ImGui::TextDisabled("%u frames dropped, the GPU was more than %u frames behind", GPUProfiler::GetDroppedFrames(),
+                        GPUProfiler::FrameLatency);
+                ImGui::TreePop();
+            }
+            ImGui::Text("Draw calls: %u", Renderer::GetStats().DrawCalls);
+            ImGui::Text("Binds: %u issued, %u skipped", GLStateCache::GetStats().IssuedBinds, GLStateCache::GetStats().SkippedBinds);
+            const FrameArenaStats& arena = FrameArena::GetLastFrameStats();
+            ImGui::Text("Heap allocations: %llu, frame arena: %u (%.1f KB)", frameAllocations, arena.Allocations, arena.BytesUsed / 1024.0f);
+            ImGui::Checkbox("Render thread", &useRenderThread);
+            ImGui::Text("Latency %.2f ms, %.1f FPS on one thread", singleThreadLatency.GetLatencyMs(),
+                singleThreadLatency.GetFramesPerSecond());
+            ImGui::Text("Latency %.2f ms, %.1f FPS with the render thread", renderThread.GetLatencyStats().GetLatencyMs(),
+                renderThread.GetLatencyStats().GetFramesPerSecond());
+            if (threaded)
+            {
+                const RenderThreadStats& stats = renderThread.GetStats();
+                ImGui::Text("Replay: %.3f ms for %zu calls (%.1f KB), waited %.3f ms for a free frame", stats.ReplayMs,
+                    stats.Commands, stats.Bytes / 1024.0f, stats.WaitMs);
+                if (stats.FailedReplays > 0)
+                    ImGui::TextDisabled("%u frames raised OpenGL errors in replay", stats.FailedReplays);
+            }
+            ImGui::Checkbox("Profiler", &showProfiler);
             ImGui::End();
+
+            if (showProfiler)
+                Profiler::DrawImGuiPanel(&showProfiler);
             
         }
 
 
         // Render ImGUI
-        ImGui::Render();
-        ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        {
+            PROFILE_SCOPE("ImGui render");
+            GPU_PROFILE_SCOPE("ImGui render");
+            ImGui::Render();
+            if (!threaded)
+                ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        }
 
-        window.EndFrame();
+        if (threaded)
+        {
+            // The render thread draws and swaps this frame while the next one is recorded
+            cpuFrameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            renderThread.SubmitFrame(*ImGui::GetDrawData(), frameStart);
+            PROFILE_SCOPE("Display::EndFrame");
+            window.EndFrame(false);
+        }
+        else
+        {
+            GPUProfiler::EndFrame();
+            cpuFrameMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+            PROFILE_SCOPE("Display::EndFrame");
+            window.SwapBuffers();
+            singleThreadLatency.AddFrame(frameStart, std::chrono::steady_clock::now());
+            window.EndFrame(false);
+        }
+        frameAllocations = HeapTracker::GetThreadAllocations() - frameStartAllocations;
     }
 
     delete currentTest;
     if (currentTest != testMenu)
         delete testMenu;
+    renderThread.Stop();    // Executes the recorded deletes, and gives the context back for ImGui's shutdown
 
     // Destroy ImGUI things
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplGlfw_Shutdown();
     ImGui::DestroyContext();
 
+    JobSystem::Shutdown();
     return 0;
 }
\ No newline at end of file
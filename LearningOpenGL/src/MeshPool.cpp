@@ -0,0 +1,139 @@
+#include "MeshPool.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "FrameArena.h"
+
+#include <iostream>
+
+static const unsigned int s_InitialInstanceCapacity = 1024;
+
+/*
+ * Creates a pool with room for [vertexCapacity] vertices of [layout] and [indexCapacity] indices.
+ * The space is allocated up front and never grows.
+ */
+MeshPool::MeshPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity)
+	: m_IndirectBuffer(0), m_Stride(layout.GetStride()), m_VertexCapacity(vertexCapacity), m_VertexCount(0),
+	m_IndexCapacity(indexCapacity), m_IndexCount(0), m_InstanceLocation(0), m_MultiDraw(true)
+{
+	m_Vertices = std::make_unique<VertexBuffer>(vertexCapacity * m_Stride);
+	m_Indices = std::make_unique<IndexBuffer>(indexCapacity);
+	m_InstanceBuffer = std::make_unique<VertexBuffer>((unsigned int)(s_InitialInstanceCapacity * sizeof(MeshInstance)));
+
+	VertexBufferLayout instanceLayout;
+	instanceLayout.Push<float>(4);	// Model matrix, one column per attribute
+	instanceLayout.Push<float>(4);
+	instanceLayout.Push<float>(4);
+	instanceLayout.Push<float>(4);
+	instanceLayout.Push<float>(4);	// Color
+
+	m_VertexArray = std::make_unique<VertexArrayObject>();
+	m_VertexArray->AddBuffer(*m_Vertices, layout);
+	m_InstanceLocation = m_VertexArray->GetAttributeCount();
+	m_VertexArray->AddInstanceBuffer(*m_InstanceBuffer, instanceLayout);
+
+	// The instance attributes are left disabled here, so the shader reads the values set with glVertexAttrib
+	m_LoopVertexArray = std::make_unique<VertexArrayObject>();
+	m_LoopVertexArray->AddBuffer(*m_Vertices, layout);
+
+	GLCall(glGenBuffers(1, &m_IndirectBuffer));
+}
+
+MeshPool::~MeshPool()
+{
+	GLStateCache::OnBufferDeleted(m_IndirectBuffer);
+	GLCall(glDeleteBuffers(1, &m_IndirectBuffer));
+}
+
+/*
+ * Copies a mesh into the pool. [indices] refer to the mesh's own [vertices], starting at 0.
+ * Returns the mesh's id, or -1 if the pool doesn't have room for it.
+ */
+int MeshPool::AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount)
+{
+	if (m_VertexCount + vertexCount > m_VertexCapacity || m_IndexCount + indexCount > m_IndexCapacity)
+	{
+		std::cout << "Warning: MeshPool is full, could not add a mesh of " << vertexCount << " vertices and "
+			<< indexCount << " indices" << std::endl;
+		return -1;
+	}
+
+	m_Vertices->SetSubData(vertices, vertexCount * m_Stride, m_VertexCount * m_Stride);
+	m_Indices->SetSubData(indices, indexCount, m_IndexCount);
+	m_Meshes.push_back({ indexCount, m_IndexCount, (int)m_VertexCount });
+
+	m_VertexCount += vertexCount;
+	m_IndexCount += indexCount;
+	return (int)m_Meshes.size() - 1;
+}
+
+void MeshPool::Submit(int mesh, const glm::mat4& model, const glm::vec4& color)
+{
+	ASSERT(mesh >= 0 && mesh < (int)m_Meshes.size());
+	m_Instances.push_back({ model, color });
+	m_DrawMeshes.push_back((unsigned int)mesh);
+}
+
+/*
+ * Draws every submitted mesh, with one multi-draw call if it is supported and enabled, then clears the submissions.
+ */
+void MeshPool::Draw(const Shader& shader)
+{
+	if (m_Instances.empty())
+		return;
+
+	unsigned int indexCount = 0;
+	for (unsigned int mesh : m_DrawMeshes)
+		indexCount += m_Meshes[mesh].IndexCount;
+
+	if (IsMultiDrawEnabled())
+		DrawIndirect(shader, indexCount);
+	else
+		DrawLoop(shader);
+
+	// Capacity is kept, so later frames of a similar size don't allocate
+	m_Instances.clear();
+	m_DrawMeshes.clear();
+}
+
+bool MeshPool::IsMultiDrawIndirectSupported()
+{
+	return GLEW_VERSION_4_3 || (GLEW_ARB_multi_draw_indirect && GLEW_ARB_base_instance);
+}
+
+void MeshPool::DrawIndirect(const Shader& shader, unsigned int indexCount)
+{
+	unsigned int drawCount = (unsigned int)m_Instances.size();
+
+	FrameVector<DrawElementsIndirectCommand> commands;
+	commands.reserve(drawCount);
+	for (unsigned int i = 0; i < drawCount; i++)
+	{
+		const MeshRange& mesh = m_Meshes[m_DrawMeshes[i]];
+		commands.push_back({ mesh.IndexCount, 1, mesh.FirstIndex, mesh.BaseVertex, i });
+	}
+
+	m_InstanceBuffer->SetData(m_Instances.data(), (unsigned int)(drawCount * sizeof(MeshInstance)));
+
+	// New storage every frame (orphaning), so writing this frame's commands never waits for the GPU to read last frame's
+	GLStateCache::BindBuffer(GL_DRAW_INDIRECT_BUFFER, m_IndirectBuffer);
+	GLCall(glBufferData(GL_DRAW_INDIRECT_BUFFER, drawCount * sizeof(DrawElementsIndirectCommand), commands.data(), GL_STREAM_DRAW));
+
+	m_Renderer.MultiDrawIndirect(*m_VertexArray, *m_Indices, shader, drawCount, drawCount, indexCount);
+}
+
+void MeshPool::DrawLoop(const Shader& shader)
+{
+	shader.Bind();
+	for (size_t i = 0; i < m_Instances.size(); i++)
+	{
+		const MeshInstance& instance = m_Instances[i];
+		for (unsigned int column = 0; column < 4; column++)
+		{
+			GLCall(glVertexAttrib4fv(m_InstanceLocation + column, &instance.Model[column][0]));
+		}
+		GLCall(glVertexAttrib4fv(m_InstanceLocation + 4, &instance.Color[0]));
+
+		const MeshRange& mesh = m_Meshes[m_DrawMeshes[i]];
+		m_Renderer.Draw(*m_LoopVertexArray, *m_Indices, shader, mesh.IndexCount, mesh.FirstIndex, mesh.BaseVertex);
+	}
+}
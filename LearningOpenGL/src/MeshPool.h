@@ -0,0 +1,105 @@
+#pragma once
+
+#include "Renderer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+/*
+ * MeshPool.h
+ * Keeps many static meshes in one shared VertexBuffer and IndexBuffer, so they can all be drawn with a single
+ * glMultiDrawElementsIndirect instead of one Renderer::Draw (and one VAO/index buffer bind) per mesh.
+ *
+ * Meshes are suballocated one after another: AddMesh() copies the vertices and indices to the end of the
+ * used space and returns an id. Its indices stay relative to its own vertices, the draw adds the base vertex.
+ *
+ * Every Submit() adds a MeshInstance (model matrix and color), read by the shader as per-instance attributes
+ * right after the layout's attributes, like res/shaders/Instanced.vert. Draw() then:
+ *		Multi-draw indirect - uploads the instances and one DrawElementsIndirectCommand per submission to a
+ *			GL_DRAW_INDIRECT_BUFFER, and draws them all with one call. Each command's base instance picks its
+ *			MeshInstance. Needs GL 4.3, or ARB_multi_draw_indirect and ARB_base_instance.
+ *		CPU loop - on GL 3.3 (or when multi-draw is disabled), sets the instance attributes with glVertexAttrib4fv
+ *			and calls Renderer::Draw with a base vertex for every submission. Still no VAO or buffer switches.
+ *
+ * Usage:
+ *		Create the pool with the vertex layout and room for every mesh, then AddMesh() them once.
+ *		Each frame, Submit() the meshes to draw and call Draw() once. The submissions are then cleared.
+ */
+
+/*
+ * MeshRange
+ * Where a mesh lives in the pool's buffers.
+ */
+struct MeshRange
+{
+	unsigned int IndexCount;
+	unsigned int FirstIndex;
+	int BaseVertex;
+};
+
+/*
+ * MeshInstance
+ * Per-draw data, 5 vec4 attributes (the model matrix's columns, then the color).
+ */
+struct MeshInstance
+{
+	glm::mat4 Model;
+	glm::vec4 Color;
+};
+
+class MeshPool
+{
+private:
+	// Laid out as glMultiDrawElementsIndirect reads it
+	struct DrawElementsIndirectCommand
+	{
+		unsigned int Count;
+		unsigned int InstanceCount;
+		unsigned int FirstIndex;
+		int BaseVertex;
+		unsigned int BaseInstance;
+	};
+
+	Renderer m_Renderer;
+	std::unique_ptr<VertexBuffer> m_Vertices;
+	std::unique_ptr<IndexBuffer> m_Indices;
+	std::unique_ptr<VertexBuffer> m_InstanceBuffer;
+	std::unique_ptr<VertexArrayObject> m_VertexArray;		// Mesh and instance attributes, for multi-draw
+	std::unique_ptr<VertexArrayObject> m_LoopVertexArray;	// Mesh attributes only, for the CPU loop
+	unsigned int m_IndirectBuffer;
+
+	unsigned int m_Stride;
+	unsigned int m_VertexCapacity, m_VertexCount;
+	unsigned int m_IndexCapacity, m_IndexCount;
+	unsigned int m_InstanceLocation;	// Attribute index of the model matrix's first column
+
+	std::vector<MeshRange> m_Meshes;
+	std::vector<MeshInstance> m_Instances;
+	std::vector<unsigned int> m_DrawMeshes;		// Mesh id of each submission
+
+	bool m_MultiDraw;
+
+public:
+	MeshPool(const VertexBufferLayout& layout, unsigned int vertexCapacity, unsigned int indexCapacity);
+	~MeshPool();
+
+	int AddMesh(const void* vertices, unsigned int vertexCount, const unsigned int* indices, unsigned int indexCount);
+	void Submit(int mesh, const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f));
+	void Draw(const Shader& shader);
+
+	inline void SetMultiDrawEnabled(bool multiDraw) { m_MultiDraw = multiDraw; }
+	inline bool IsMultiDrawEnabled() const { return m_MultiDraw && IsMultiDrawIndirectSupported(); }
+
+	inline const MeshRange& GetMesh(int mesh) const { return m_Meshes[mesh]; }
+	inline unsigned int GetMeshCount() const { return (unsigned int)m_Meshes.size(); }
+	inline unsigned int GetVertexCount() const { return m_VertexCount; }
+	inline unsigned int GetIndexCount() const { return m_IndexCount; }
+
+	static bool IsMultiDrawIndirectSupported();
+
+private:
+	void DrawIndirect(const Shader& shader, unsigned int indexCount);
+	void DrawLoop(const Shader& shader);
+};
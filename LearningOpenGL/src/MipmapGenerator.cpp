@@ -0,0 +1,180 @@
+#include "MipmapGenerator.h"
+#include "PixelConvert.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const float s_Pi = 3.14159265f;
+static const float s_KaiserRadius = 3.0f;	// In destination pixels
+static const float s_KaiserAlpha = 4.0f;
+
+// Source pixel and weight contributing to one destination pixel along an axis
+struct Tap
+{
+	int Index;
+	float Weight;
+};
+
+/*
+ * Zeroth order modified Bessel function of the first kind, by its power series
+ */
+static float BesselI0(float x)
+{
+	float sum = 1.0f, term = 1.0f;
+	float halfX = x * 0.5f;
+	for (int k = 1; k < 32; k++)
+	{
+		term *= (halfX / k) * (halfX / k);
+		sum += term;
+		if (term < sum * 1e-8f)
+			break;
+	}
+	return sum;
+}
+
+static float KaiserSinc(float x)
+{
+	float t = x / s_KaiserRadius;
+	if (t <= -1.0f || t >= 1.0f)
+		return 0.0f;
+
+	float sinc = x == 0.0f ? 1.0f : std::sin(s_Pi * x) / (s_Pi * x);
+	return sinc * BesselI0(s_KaiserAlpha * std::sqrt(1.0f - t * t)) / BesselI0(s_KaiserAlpha);
+}
+
+/*
+ * Works out which source pixels feed each destination pixel along one axis, with normalized weights.
+ * Distances are measured in destination pixels, so the kernel widens with the reduction factor.
+ */
+static std::vector<std::vector<Tap>> ComputeTaps(int srcSize, int dstSize, MipmapFilter filter, bool wrap)
+{
+	float scale = (float)srcSize / dstSize;
+	float support = (filter == MipmapFilter::Box ? 0.5f : s_KaiserRadius) * scale;
+
+	std::vector<std::vector<Tap>> taps(dstSize);
+	for (int d = 0; d < dstSize; d++)
+	{
+		float center = (d + 0.5f) * scale;
+		int first = (int)std::floor(center - support);
+		int last = (int)std::ceil(center + support);
+
+		float total = 0.0f;
+		for (int s = first; s <= last; s++)
+		{
+			float distance = (s + 0.5f - center) / scale;
+			float weight;
+			if (filter == MipmapFilter::Box)
+			{
+				// Fraction of the source pixel inside the destination pixel's footprint
+				float left = std::max(distance - 0.5f / scale, -0.5f);
+				float right = std::min(distance + 0.5f / scale, 0.5f);
+				weight = std::max(right - left, 0.0f);
+			}
+			else
+			{
+				weight = KaiserSinc(distance);
+			}
+
+			if (weight == 0.0f)
+				continue;
+
+			int index = wrap ? ((s % srcSize) + srcSize) % srcSize : std::min(std::max(s, 0), srcSize - 1);
+			taps[d].push_back({ index, weight });
+			total += weight;
+		}
+
+		for (Tap& tap : taps[d])
+			tap.Weight /= total;
+	}
+	return taps;
+}
+
+static float LinearToSrgb(float c)
+{
+	return c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f;
+}
+
+int MipmapGenerator::GetLevelCount(int width, int height)
+{
+	int levels = 1;
+	int size = std::max(width, height);
+	while (size > 1)
+	{
+		size /= 2;
+		levels++;
+	}
+	return levels;
+}
+
+std::vector<std::vector<unsigned char>> MipmapGenerator::Generate(const unsigned char* pixels, int width, int height,
+	MipmapFilter filter, bool srgb, bool wrapS, bool wrapT)
+{
+	std::vector<float> level((size_t)width * height * 4);
+	PixelConvert::ToLinear(pixels, level.data(), (size_t)width * height, srgb);
+
+	std::vector<std::vector<unsigned char>> levels;
+	std::vector<float> next;
+	while (width > 1 || height > 1)
+	{
+		int nextWidth = std::max(width / 2, 1);
+		int nextHeight = std::max(height / 2, 1);
+		Resample(level, width, height, next, nextWidth, nextHeight, filter, wrapS, wrapT);
+
+		std::vector<unsigned char> bytes(next.size());
+		for (size_t i = 0; i < next.size(); i++)
+		{
+			// Kaiser has negative lobes, so values can overshoot
+			float c = std::min(std::max(next[i], 0.0f), 1.0f);
+			if (srgb && i % 4 != 3)
+				c = LinearToSrgb(c);
+			bytes[i] = (unsigned char)(c * 255.0f + 0.5f);
+		}
+		levels.push_back(std::move(bytes));
+
+		level.swap(next);
+		width = nextWidth;
+		height = nextHeight;
+	}
+	return levels;
+}
+
+/*
+ * Separable resample: horizontally into a temporary image, then vertically into [dst]
+ */
+void MipmapGenerator::Resample(const std::vector<float>& src, int srcWidth, int srcHeight,
+	std::vector<float>& dst, int dstWidth, int dstHeight, MipmapFilter filter, bool wrapS, bool wrapT)
+{
+	std::vector<std::vector<Tap>> columns = ComputeTaps(srcWidth, dstWidth, filter, wrapS);
+	std::vector<std::vector<Tap>> rows = ComputeTaps(srcHeight, dstHeight, filter, wrapT);
+
+	std::vector<float> horizontal((size_t)dstWidth * srcHeight * 4);
+	for (int y = 0; y < srcHeight; y++)
+	{
+		const float* srcRow = &src[(size_t)y * srcWidth * 4];
+		float* out = &horizontal[(size_t)y * dstWidth * 4];
+		for (int x = 0; x < dstWidth; x++, out += 4)
+		{
+			float sum[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+			for (const Tap& tap : columns[x])
+			{
+				const float* p = srcRow + tap.Index * 4;
+				for (int c = 0; c < 4; c++)
+					sum[c] += p[c] * tap.Weight;
+			}
+			for (int c = 0; c < 4; c++)
+				out[c] = sum[c];
+		}
+	}
+
+	dst.assign((size_t)dstWidth * dstHeight * 4, 0.0f);
+	for (int y = 0; y < dstHeight; y++)
+	{
+		float* out = &dst[(size_t)y * dstWidth * 4];
+		for (const Tap& tap : rows[y])
+		{
+			const float* in = &horizontal[(size_t)tap.Index * dstWidth * 4];
+			for (int i = 0; i < dstWidth * 4; i++)
+				out[i] += in[i] * tap.Weight;
+		}
+	}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <vector>
+
+/*
+ * MipmapGenerator.h
+ * Builds the mipmap chain of an RGBA8 image on the CPU, as an alternative to glGenerateMipmap
+ * (whose filter is up to the driver, and is usually a plain 2x2 box).
+ *
+ *		Box - averages the source pixels each destination pixel covers. Cheap, but slightly blurry and
+ *			prone to aliasing on fine repeating detail.
+ *		Kaiser - Kaiser-windowed sinc over a 3 destination pixel radius. Keeps more detail with less
+ *			aliasing, at a much higher cost per pixel.
+ *
+ * Filtering happens in linear space with floating point precision across the whole chain,
+ * so sRGB images are decoded first and every level is only rounded to 8 bits once.
+ */
+
+enum class MipmapFilter
+{
+	Box,
+	Kaiser
+};
+
+class MipmapGenerator
+{
+public:
+	/*
+	 * Returns levels 1 through the 1x1 level (level 0 is [pixels] itself), each half the size of the one before.
+	 * [wrapS]/[wrapT] sample across the opposite edge instead of clamping, for repeating textures.
+	 */
+	static std::vector<std::vector<unsigned char>> Generate(const unsigned char* pixels, int width, int height,
+		MipmapFilter filter, bool srgb, bool wrapS, bool wrapT);
+
+	static int GetLevelCount(int width, int height);
+
+private:
+	static void Resample(const std::vector<float>& src, int srcWidth, int srcHeight,
+		std::vector<float>& dst, int dstWidth, int dstHeight, MipmapFilter filter, bool wrapS, bool wrapT);
+};
@@ -0,0 +1,466 @@
+#include "PixelConvert.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#define PIXEL_USE_SSE2 1
+	#define PIXEL_USE_AVX2 1	// Compiled for every x86 target, but only run if the CPU has it
+	#include <immintrin.h>
+	#ifdef _MSC_VER
+		#include <intrin.h>
+		#define PIXEL_TARGET_AVX2		// MSVC allows AVX2 intrinsics in any function
+	#else
+		#define PIXEL_TARGET_AVX2 __attribute__((target("avx2")))
+	#endif
+#else
+	#define PIXEL_USE_SSE2 0
+	#define PIXEL_USE_AVX2 0
+#endif
+
+#if defined(__ARM_NEON) || defined(_M_ARM64)
+	#define PIXEL_USE_NEON 1
+	#include <arm_neon.h>
+#else
+	#define PIXEL_USE_NEON 0
+#endif
+
+std::atomic<PixelBackend> PixelConvert::s_ForcedBackend(PixelBackend::Scalar);
+std::atomic<bool> PixelConvert::s_BackendForced(false);
+
+/*
+ * c * a / 255, rounded to nearest. Exact for every c and a, using only 16 bit adds and shifts,
+ * so the SIMD versions compute the same thing lane by lane.
+ */
+static inline unsigned char MultiplyDiv255(unsigned int c, unsigned int a)
+{
+	unsigned int t = c * a + 128;
+	return (unsigned char)((t + (t >> 8)) >> 8);
+}
+
+/* Scalar ------------------------------------------------------------------------------------------------ */
+
+static void SwapRowsScalar(unsigned char* a, unsigned char* b, size_t size)
+{
+	unsigned char temp[256];
+	for (size_t offset = 0; offset < size; offset += sizeof(temp))
+	{
+		size_t count = std::min(sizeof(temp), size - offset);
+		std::memcpy(temp, a + offset, count);
+		std::memcpy(a + offset, b + offset, count);
+		std::memcpy(b + offset, temp, count);
+	}
+}
+
+/*
+ * Expands pixels [first, last) walking backwards, so the RGBA writes never overtake the RGB reads
+ */
+static void ExpandScalar(unsigned char* pixels, size_t first, size_t last)
+{
+	for (size_t i = last; i-- > first;)
+	{
+		unsigned char r = pixels[i * 3], g = pixels[i * 3 + 1], b = pixels[i * 3 + 2];
+		pixels[i * 4] = r;
+		pixels[i * 4 + 1] = g;
+		pixels[i * 4 + 2] = b;
+		pixels[i * 4 + 3] = 255;
+	}
+}
+
+static void PremultiplyScalar(unsigned char* pixels, size_t first, size_t last)
+{
+	for (size_t i = first; i < last; i++)
+	{
+		unsigned char* pixel = pixels + i * 4;
+		pixel[0] = MultiplyDiv255(pixel[0], pixel[3]);
+		pixel[1] = MultiplyDiv255(pixel[1], pixel[3]);
+		pixel[2] = MultiplyDiv255(pixel[2], pixel[3]);
+	}
+}
+
+static void ToLinearScalar(const unsigned char* pixels, float* output, size_t first, size_t last, const float* table, const float* linear)
+{
+	for (size_t i = first * 4; i < last * 4; i += 4)
+	{
+		output[i] = table[pixels[i]];
+		output[i + 1] = table[pixels[i + 1]];
+		output[i + 2] = table[pixels[i + 2]];
+		output[i + 3] = linear[pixels[i + 3]];
+	}
+}
+
+/* SSE2 -------------------------------------------------------------------------------------------------- */
+
+#if PIXEL_USE_SSE2
+static void SwapRowsSSE2(unsigned char* a, unsigned char* b, size_t size)
+{
+	size_t offset = 0;
+	for (; offset + 16 <= size; offset += 16)
+	{
+		__m128i rowA = _mm_loadu_si128((const __m128i*)(a + offset));
+		__m128i rowB = _mm_loadu_si128((const __m128i*)(b + offset));
+		_mm_storeu_si128((__m128i*)(a + offset), rowB);
+		_mm_storeu_si128((__m128i*)(b + offset), rowA);
+	}
+	SwapRowsScalar(a + offset, b + offset, size - offset);
+}
+
+/*
+ * Premultiplies the 4 pixels of a register. Each pixel's alpha multiplies its color, and 255 multiplies the alpha itself.
+ */
+static inline __m128i PremultiplyHalfSSE2(__m128i pixels16)
+{
+	const __m128i alphaLanes = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+	__m128i alpha = _mm_shufflehi_epi16(_mm_shufflelo_epi16(pixels16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm_or_si128(_mm_andnot_si128(alphaLanes, alpha), _mm_and_si128(alphaLanes, _mm_set1_epi16(255)));
+
+	__m128i t = _mm_add_epi16(_mm_mullo_epi16(pixels16, alpha), _mm_set1_epi16(128));
+	return _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+}
+
+static void PremultiplySSE2(unsigned char* pixels, size_t pixelCount)
+{
+	const __m128i zero = _mm_setzero_si128();
+	size_t i = 0;
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i source = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+		__m128i low = PremultiplyHalfSSE2(_mm_unpacklo_epi8(source, zero));
+		__m128i high = PremultiplyHalfSSE2(_mm_unpackhi_epi8(source, zero));
+		_mm_storeu_si128((__m128i*)(pixels + i * 4), _mm_packus_epi16(low, high));
+	}
+	PremultiplyScalar(pixels, i, pixelCount);
+}
+
+static void ToLinearSSE2(const unsigned char* pixels, float* output, size_t pixelCount, bool srgb, const float* table, const float* linear)
+{
+	if (srgb)
+	{
+		// No gather before AVX2, so sRGB color is looked up one channel at a time
+		ToLinearScalar(pixels, output, 0, pixelCount, table, linear);
+		return;
+	}
+
+	// The table holds i / 255.0f, and a correctly rounded divide gives the same floats
+	const __m128i zero = _mm_setzero_si128();
+	const __m128 divisor = _mm_set1_ps(255.0f);
+	size_t i = 0;
+	for (; i + 4 <= pixelCount; i += 4)
+	{
+		__m128i source = _mm_loadu_si128((const __m128i*)(pixels + i * 4));
+		__m128i low = _mm_unpacklo_epi8(source, zero);
+		__m128i high = _mm_unpackhi_epi8(source, zero);
+		float* destination = output + i * 4;
+		_mm_storeu_ps(destination, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(low, zero)), divisor));
+		_mm_storeu_ps(destination + 4, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(low, zero)), divisor));
+		_mm_storeu_ps(destination + 8, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpacklo_epi16(high, zero)), divisor));
+		_mm_storeu_ps(destination + 12, _mm_div_ps(_mm_cvtepi32_ps(_mm_unpackhi_epi16(high, zero)), divisor));
+	}
+	ToLinearScalar(pixels, output, i, pixelCount, table, linear);
+}
+#endif
+
+/* AVX2 -------------------------------------------------------------------------------------------------- */
+
+#if PIXEL_USE_AVX2
+PIXEL_TARGET_AVX2 static void SwapRowsAVX2(unsigned char* a, unsigned char* b, size_t size)
+{
+	size_t offset = 0;
+	for (; offset + 32 <= size; offset += 32)
+	{
+		__m256i rowA = _mm256_loadu_si256((const __m256i*)(a + offset));
+		__m256i rowB = _mm256_loadu_si256((const __m256i*)(b + offset));
+		_mm256_storeu_si256((__m256i*)(a + offset), rowB);
+		_mm256_storeu_si256((__m256i*)(b + offset), rowA);
+	}
+	SwapRowsScalar(a + offset, b + offset, size - offset);
+}
+
+PIXEL_TARGET_AVX2 static void ExpandAVX2(unsigned char* pixels, size_t pixelCount)
+{
+	// 8 pixels per step, 4 in each 128 bit lane. Reading 16 bytes per lane goes 4 bytes past the lane's 12,
+	// which stays inside the buffer and only lands on bytes the shuffle drops
+	const __m256i shuffle = _mm256_setr_epi8(
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1,
+		0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+	const __m256i alpha = _mm256_set1_epi32((int)0xFF000000);
+
+	size_t vectorCount = pixelCount >= 8 ? pixelCount / 8 * 8 : 0;
+	ExpandScalar(pixels, vectorCount, pixelCount);
+	for (size_t i = vectorCount; i >= 8;)
+	{
+		i -= 8;
+		__m128i low = _mm_loadu_si128((const __m128i*)(pixels + i * 3));
+		__m128i high = _mm_loadu_si128((const __m128i*)(pixels + i * 3 + 12));
+		__m256i source = _mm256_inserti128_si256(_mm256_castsi128_si256(low), high, 1);
+		__m256i expanded = _mm256_or_si256(_mm256_shuffle_epi8(source, shuffle), alpha);
+		_mm256_storeu_si256((__m256i*)(pixels + i * 4), expanded);
+	}
+}
+
+PIXEL_TARGET_AVX2 static inline __m256i PremultiplyHalfAVX2(__m256i pixels16)
+{
+	const __m256i alphaLanes = _mm256_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0, -1, 0, 0, 0);
+	__m256i alpha = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(pixels16, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+	alpha = _mm256_blendv_epi8(alpha, _mm256_set1_epi16(255), alphaLanes);
+
+	__m256i t = _mm256_add_epi16(_mm256_mullo_epi16(pixels16, alpha), _mm256_set1_epi16(128));
+	return _mm256_srli_epi16(_mm256_add_epi16(t, _mm256_srli_epi16(t, 8)), 8);
+}
+
+PIXEL_TARGET_AVX2 static void PremultiplyAVX2(unsigned char* pixels, size_t pixelCount)
+{
+	// Unpacking and packing both work within 128 bit lanes, so the pixels come back in order
+	const __m256i zero = _mm256_setzero_si256();
+	size_t i = 0;
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		__m256i source = _mm256_loadu_si256((const __m256i*)(pixels + i * 4));
+		__m256i low = PremultiplyHalfAVX2(_mm256_unpacklo_epi8(source, zero));
+		__m256i high = PremultiplyHalfAVX2(_mm256_unpackhi_epi8(source, zero));
+		_mm256_storeu_si256((__m256i*)(pixels + i * 4), _mm256_packus_epi16(low, high));
+	}
+	PremultiplyScalar(pixels, i, pixelCount);
+}
+
+PIXEL_TARGET_AVX2 static void ToLinearAVX2(const unsigned char* pixels, float* output, size_t pixelCount, const float* table, const float* linear)
+{
+	// Two pixels per register. Color comes from [table], alpha from [linear], both gathered by byte value
+	const __m256i alphaLanes = _mm256_setr_epi32(0, 0, 0, -1, 0, 0, 0, -1);
+	size_t i = 0;
+	for (; i + 2 <= pixelCount; i += 2)
+	{
+		__m256i indices = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(pixels + i * 4)));
+		__m256 color = _mm256_i32gather_ps(table, indices, 4);
+		__m256 alpha = _mm256_i32gather_ps(linear, indices, 4);
+		_mm256_storeu_ps(output + i * 4, _mm256_blendv_ps(color, alpha, _mm256_castsi256_ps(alphaLanes)));
+	}
+	ToLinearScalar(pixels, output, i, pixelCount, table, linear);
+}
+#endif
+
+/* NEON -------------------------------------------------------------------------------------------------- */
+
+#if PIXEL_USE_NEON
+static void SwapRowsNEON(unsigned char* a, unsigned char* b, size_t size)
+{
+	size_t offset = 0;
+	for (; offset + 16 <= size; offset += 16)
+	{
+		uint8x16_t rowA = vld1q_u8(a + offset);
+		uint8x16_t rowB = vld1q_u8(b + offset);
+		vst1q_u8(a + offset, rowB);
+		vst1q_u8(b + offset, rowA);
+	}
+	SwapRowsScalar(a + offset, b + offset, size - offset);
+}
+
+static void ExpandNEON(unsigned char* pixels, size_t pixelCount)
+{
+	size_t vectorCount = pixelCount / 16 * 16;
+	ExpandScalar(pixels, vectorCount, pixelCount);
+	for (size_t i = vectorCount; i >= 16;)
+	{
+		i -= 16;
+		uint8x16x3_t rgb = vld3q_u8(pixels + i * 3);
+		uint8x16x4_t rgba = { { rgb.val[0], rgb.val[1], rgb.val[2], vdupq_n_u8(255) } };
+		vst4q_u8(pixels + i * 4, rgba);
+	}
+}
+
+/*
+ * vraddhn(t, vrshr(t, 8)) is (t + ((t + 128) >> 8) + 128) >> 8, the same rounding as MultiplyDiv255
+ */
+static inline uint8x8_t MultiplyDiv255NEON(uint8x8_t c, uint8x8_t a)
+{
+	uint16x8_t t = vmull_u8(c, a);
+	return vraddhn_u16(t, vrshrq_n_u16(t, 8));
+}
+
+static void PremultiplyNEON(unsigned char* pixels, size_t pixelCount)
+{
+	size_t i = 0;
+	for (; i + 8 <= pixelCount; i += 8)
+	{
+		uint8x8x4_t rgba = vld4_u8(pixels + i * 4);
+		rgba.val[0] = MultiplyDiv255NEON(rgba.val[0], rgba.val[3]);
+		rgba.val[1] = MultiplyDiv255NEON(rgba.val[1], rgba.val[3]);
+		rgba.val[2] = MultiplyDiv255NEON(rgba.val[2], rgba.val[3]);
+		vst4_u8(pixels + i * 4, rgba);
+	}
+	PremultiplyScalar(pixels, i, pixelCount);
+}
+#endif
+
+/* Dispatch ---------------------------------------------------------------------------------------------- */
+
+/*
+ * Flips the image upside down, in place
+ */
+void PixelConvert::FlipVertical(unsigned char* pixels, int width, int height, int channels)
+{
+	size_t rowSize = (size_t)width * channels;
+	PixelBackend backend = GetBackend();
+
+	for (int y = 0; y < height / 2; y++)
+	{
+		unsigned char* top = pixels + y * rowSize;
+		unsigned char* bottom = pixels + (height - 1 - y) * rowSize;
+		switch (backend)
+		{
+#if PIXEL_USE_SSE2
+		case PixelBackend::SSE2:	SwapRowsSSE2(top, bottom, rowSize); break;
+#endif
+#if PIXEL_USE_AVX2
+		case PixelBackend::AVX2:	SwapRowsAVX2(top, bottom, rowSize); break;
+#endif
+#if PIXEL_USE_NEON
+		case PixelBackend::NEON:	SwapRowsNEON(top, bottom, rowSize); break;
+#endif
+		default:					SwapRowsScalar(top, bottom, rowSize); break;
+		}
+	}
+}
+
+void PixelConvert::ExpandRGBToRGBA(unsigned char* pixels, size_t pixelCount)
+{
+	switch (GetBackend())
+	{
+#if PIXEL_USE_AVX2
+	case PixelBackend::AVX2:	ExpandAVX2(pixels, pixelCount); break;
+#endif
+#if PIXEL_USE_NEON
+	case PixelBackend::NEON:	ExpandNEON(pixels, pixelCount); break;
+#endif
+	default:					ExpandScalar(pixels, 0, pixelCount); break;
+	}
+}
+
+void PixelConvert::PremultiplyAlpha(unsigned char* pixels, size_t pixelCount)
+{
+	switch (GetBackend())
+	{
+#if PIXEL_USE_SSE2
+	case PixelBackend::SSE2:	PremultiplySSE2(pixels, pixelCount); break;
+#endif
+#if PIXEL_USE_AVX2
+	case PixelBackend::AVX2:	PremultiplyAVX2(pixels, pixelCount); break;
+#endif
+#if PIXEL_USE_NEON
+	case PixelBackend::NEON:	PremultiplyNEON(pixels, pixelCount); break;
+#endif
+	default:					PremultiplyScalar(pixels, 0, pixelCount); break;
+	}
+}
+
+/*
+ * Writes 4 floats per pixel to [output]
+ */
+void PixelConvert::ToLinear(const unsigned char* pixels, float* output, size_t pixelCount, bool srgb)
+{
+	const float* table = GetLinearTable(srgb);
+	const float* linear = GetLinearTable(false);
+
+	switch (GetBackend())
+	{
+#if PIXEL_USE_SSE2
+	case PixelBackend::SSE2:	ToLinearSSE2(pixels, output, pixelCount, srgb, table, linear); break;
+#endif
+#if PIXEL_USE_AVX2
+	case PixelBackend::AVX2:	ToLinearAVX2(pixels, output, pixelCount, table, linear); break;
+#endif
+	default:					ToLinearScalar(pixels, output, 0, pixelCount, table, linear); break;
+	}
+}
+
+/*
+ * Float value of each byte: i / 255, or the sRGB decoding of it
+ */
+const float* PixelConvert::GetLinearTable(bool srgb)
+{
+	struct Tables
+	{
+		float Linear[256];
+		float SRGB[256];
+
+		Tables()
+		{
+			for (int i = 0; i < 256; i++)
+			{
+				float c = i / 255.0f;
+				Linear[i] = c;
+				SRGB[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+			}
+		}
+	};
+	static const Tables tables;
+	return srgb ? tables.SRGB : tables.Linear;
+}
+
+PixelBackend PixelConvert::GetBackend()
+{
+	if (s_BackendForced.load(std::memory_order_acquire))
+		return s_ForcedBackend.load(std::memory_order_relaxed);
+
+	static const PixelBackend best = ChooseBackend();	// Thread-safe initialization on first use
+	return best;
+}
+
+void PixelConvert::SetBackend(PixelBackend backend)
+{
+	s_ForcedBackend.store(IsSupported(backend) ? backend : PixelBackend::Scalar, std::memory_order_relaxed);
+	s_BackendForced.store(true, std::memory_order_release);
+}
+
+PixelBackend PixelConvert::ChooseBackend()
+{
+	if (IsSupported(PixelBackend::AVX2))
+		return PixelBackend::AVX2;
+	if (IsSupported(PixelBackend::SSE2))
+		return PixelBackend::SSE2;
+	if (IsSupported(PixelBackend::NEON))
+		return PixelBackend::NEON;
+	return PixelBackend::Scalar;
+}
+
+bool PixelConvert::IsSupported(PixelBackend backend)
+{
+	switch (backend)
+	{
+	case PixelBackend::Scalar:
+		return true;
+	case PixelBackend::SSE2:
+		return PIXEL_USE_SSE2;
+	case PixelBackend::AVX2:
+#if PIXEL_USE_AVX2 && defined(_MSC_VER)
+	{
+		// AVX2 flag, and the OS saving the YMM registers
+		int info[4];
+		__cpuid(info, 1);
+		bool osSavesYmm = (info[2] & (1 << 27)) && (_xgetbv(0) & 6) == 6;
+		__cpuidex(info, 7, 0);
+		return osSavesYmm && (info[1] & (1 << 5));
+	}
+#elif PIXEL_USE_AVX2
+		return __builtin_cpu_supports("avx2");
+#else
+		return false;
+#endif
+	case PixelBackend::NEON:
+		return PIXEL_USE_NEON;
+	default:
+		return false;
+	}
+}
+
+const char* PixelConvert::GetBackendName(PixelBackend backend)
+{
+	switch (backend)
+	{
+	case PixelBackend::SSE2:	return "SSE2";
+	case PixelBackend::AVX2:	return "AVX2";
+	case PixelBackend::NEON:	return "NEON";
+	default:					return "Scalar";
+	}
+}
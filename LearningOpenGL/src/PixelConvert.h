@@ -0,0 +1,49 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * PixelConvert.h
+ * Conversions applied to decoded images before they are uploaded, with SSE2, AVX2 and NEON versions
+ * and a scalar fallback. Every version gives exactly the same result as the scalar one.
+ *
+ * The best backend the CPU supports is picked the first time a conversion runs. SetBackend() forces another
+ * one (falling back to scalar if it isn't supported), so the versions can be compared.
+ *
+ *		FlipVertical - swaps rows in place, so the first row is the bottom one as OpenGL expects.
+ *		ExpandRGBToRGBA - adds an opaque alpha channel in place. SSE2 has no byte shuffle, so it uses the scalar loop.
+ *		PremultiplyAlpha - multiplies color by alpha, rounded to the nearest value.
+ *		ToLinear - converts RGBA8 to floats in [0, 1], decoding sRGB color. Alpha is always linear.
+ */
+
+enum class PixelBackend
+{
+	Scalar,
+	SSE2,
+	AVX2,
+	NEON
+};
+
+class PixelConvert
+{
+private:
+	// Conversions run on TextureLoader workers while SetBackend() runs on the main thread
+	static std::atomic<PixelBackend> s_ForcedBackend;
+	static std::atomic<bool> s_BackendForced;
+
+public:
+	static void FlipVertical(unsigned char* pixels, int width, int height, int channels);
+	static void ExpandRGBToRGBA(unsigned char* pixels, size_t pixelCount);	// [pixels] must hold pixelCount * 4 bytes
+	static void PremultiplyAlpha(unsigned char* pixels, size_t pixelCount);
+	static void ToLinear(const unsigned char* pixels, float* output, size_t pixelCount, bool srgb);
+
+	static PixelBackend GetBackend();
+	static void SetBackend(PixelBackend backend);
+	static bool IsSupported(PixelBackend backend);
+	static const char* GetBackendName(PixelBackend backend);
+
+private:
+	static const float* GetLinearTable(bool srgb);
+	static PixelBackend ChooseBackend();
+};
@@ -0,0 +1,424 @@
+#include "Profiler.h"
+#include "imgui/imgui.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+static const unsigned int s_FrameHistory = 16;	// Frame starts remembered, a power of 2
+static const unsigned int s_MaxPanelDepth = 32;
+
+/*
+ * The ring of one thread. Only the owning thread writes Events and Head.
+ * Buffers are never freed: when a thread exits its buffer is handed to the next new thread,
+ * dropping the old events (FirstValid), so short-lived threads don't keep adding buffers.
+ */
+struct ProfileThreadBuffer
+{
+	ProfileEvent Events[Profiler::EventCapacity];
+	std::atomic<unsigned long long> Head;
+	unsigned long long FirstValid;
+	std::atomic<bool> InUse;
+	unsigned int ID;
+	char Name[32];
+};
+
+/*
+ * Gives the thread's buffer back when the thread exits
+ */
+struct ProfileThreadRelease
+{
+	ProfileThreadBuffer* Buffer = nullptr;
+
+	~ProfileThreadRelease()
+	{
+		if (Buffer)
+			Buffer->InUse.store(false, std::memory_order_release);
+	}
+};
+
+/*
+ * A thread's events in the frame shown by the panel, sorted by start, with their nesting depth.
+ */
+struct ProfilePanelThread
+{
+	unsigned int ID;
+	char Name[32];
+	std::vector<ProfileEvent> Events;
+	std::vector<unsigned int> Depths;
+	unsigned int MaxDepth;
+};
+
+std::atomic<bool> Profiler::s_Enabled(true);
+
+static std::mutex s_ThreadsMutex;
+static std::vector<ProfileThreadBuffer*> s_Threads;
+static thread_local ProfileThreadBuffer* t_Buffer = nullptr;
+static thread_local ProfileThreadRelease t_Release;
+
+// Tick to time conversion, measured against steady_clock since startup
+static const unsigned long long s_StartTicks = Profiler::Now();
+static const std::chrono::steady_clock::time_point s_StartTime = std::chrono::steady_clock::now();
+static double s_TicksPerMs = 0.0;
+
+// Render thread only
+static unsigned long long s_FrameStarts[s_FrameHistory];
+static unsigned long long s_FrameCount = 0;
+static std::vector<ProfileEvent> s_Scratch;
+static std::vector<ProfilePanelThread> s_PanelThreads;
+static unsigned long long s_PanelFrameStart = 0, s_PanelFrameEnd = 0;
+static bool s_PanelPaused = false;
+static int s_ExportResult = -1;		// -1 nothing exported yet, then 0 or 1
+
+static const char* s_TracePath = "profiles/trace.json";
+
+/*
+ * Gives the calling thread a buffer, reusing one whose thread has exited if there is one
+ */
+static ProfileThreadBuffer* RegisterThread()
+{
+	std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+
+	ProfileThreadBuffer* buffer = nullptr;
+	for (size_t i = 0; i < s_Threads.size() && !buffer; i++)
+	{
+		if (!s_Threads[i]->InUse.load(std::memory_order_acquire))
+		{
+			buffer = s_Threads[i];
+			buffer->FirstValid = buffer->Head.load(std::memory_order_relaxed);
+		}
+	}
+
+	if (!buffer)
+	{
+		buffer = new ProfileThreadBuffer();
+		buffer->Head.store(0);
+		buffer->FirstValid = 0;
+		buffer->ID = (unsigned int)s_Threads.size();
+		s_Threads.push_back(buffer);
+	}
+
+	buffer->InUse.store(true);
+	snprintf(buffer->Name, sizeof(buffer->Name), "Thread %u", buffer->ID);
+
+	t_Buffer = buffer;
+	t_Release.Buffer = buffer;
+	return buffer;
+}
+
+/*
+ * Copies the valid events of [buffer] into s_Scratch. Events the writer overwrote while they were
+ * being copied are dropped. The thread list lock must be held.
+ */
+static void CopyEvents(const ProfileThreadBuffer& buffer)
+{
+	unsigned long long head = buffer.Head.load(std::memory_order_acquire);
+	unsigned long long first = head > Profiler::EventCapacity ? head - Profiler::EventCapacity : 0;
+	first = std::max(first, buffer.FirstValid);
+
+	s_Scratch.clear();
+	for (unsigned long long i = first; i < head; i++)
+		s_Scratch.push_back(buffer.Events[i & (Profiler::EventCapacity - 1)]);
+
+	// Orders the copies above before reading how far the writer got. The writer may be filling the slot at
+	// newHead already, which holds event newHead - EventCapacity, so only the events after that one are intact.
+	std::atomic_thread_fence(std::memory_order_acquire);
+	unsigned long long newHead = buffer.Head.load(std::memory_order_relaxed);
+	unsigned long long intact = newHead + 1 > Profiler::EventCapacity ? newHead + 1 - Profiler::EventCapacity : 0;
+	if (intact > first)
+	{
+		size_t overwritten = (size_t)std::min(intact - first, (unsigned long long)s_Scratch.size());
+		s_Scratch.erase(s_Scratch.begin(), s_Scratch.begin() + overwritten);
+	}
+}
+
+static void UpdateCalibration()
+{
+#if PROFILER_USE_TSC
+	// Measured over at least a millisecond, so the two clocks' read times don't matter
+	double ms;
+	unsigned long long ticks;
+	do
+	{
+		ticks = Profiler::Now() - s_StartTicks;
+		ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - s_StartTime).count();
+	} while (ms < 1.0);
+	s_TicksPerMs = ticks / ms;
+#else
+	s_TicksPerMs = (double)std::chrono::steady_clock::period::den / std::chrono::steady_clock::period::num / 1000.0;
+#endif
+}
+
+void Profiler::SetEnabled(bool enabled)
+{
+	s_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+/*
+ * Adds a finished scope to the calling thread's ring. Lock free, except the first time a thread records.
+ */
+void Profiler::Record(const char* name, unsigned long long start, unsigned long long end)
+{
+	Record(t_Buffer ? t_Buffer : RegisterThread(), name, start, end);
+}
+
+/*
+ * Adds an event to [track], a thread's ring or one from CreateTrack().
+ */
+void Profiler::Record(ProfileThreadBuffer* track, const char* name, unsigned long long start, unsigned long long end)
+{
+	unsigned long long head = track->Head.load(std::memory_order_relaxed);
+	track->Events[head & (EventCapacity - 1)] = { name, start, end };
+	track->Head.store(head + 1, std::memory_order_release);
+}
+
+/*
+ * Creates a ring that belongs to no thread, shown in the trace and the panel as [name].
+ */
+ProfileThreadBuffer* Profiler::CreateTrack(const char* name)
+{
+	std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+
+	ProfileThreadBuffer* track = new ProfileThreadBuffer();
+	track->Head.store(0);
+	track->FirstValid = 0;
+	track->InUse.store(true);	// Never released, so no thread takes it over
+	track->ID = (unsigned int)s_Threads.size();
+	snprintf(track->Name, sizeof(track->Name), "%s", name);
+	s_Threads.push_back(track);
+	return track;
+}
+
+/*
+ * Names the calling thread in the trace and the panel.
+ */
+void Profiler::SetThreadName(const char* name)
+{
+	ProfileThreadBuffer* buffer = t_Buffer ? t_Buffer : RegisterThread();
+
+	std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+	snprintf(buffer->Name, sizeof(buffer->Name), "%s", name);
+}
+
+/*
+ * Marks the start of a frame. Called on the render thread.
+ */
+void Profiler::MarkFrame()
+{
+	s_FrameStarts[s_FrameCount % s_FrameHistory] = Now();
+	s_FrameCount++;
+
+	if (s_TicksPerMs == 0.0 || s_FrameCount % 256 == 0)
+		UpdateCalibration();
+}
+
+double Profiler::TicksToMilliseconds(unsigned long long ticks)
+{
+	return ticks / GetTicksPerMillisecond();
+}
+
+double Profiler::GetTicksPerMillisecond()
+{
+	if (s_TicksPerMs == 0.0)
+		UpdateCalibration();
+	return s_TicksPerMs;
+}
+
+static void WriteJsonString(std::ofstream& file, const char* text)
+{
+	file << '"';
+	for (const char* c = text; *c; c++)
+	{
+		if (*c == '"' || *c == '\\')
+			file << '\\';
+		if ((unsigned char)*c >= 0x20)
+			file << *c;
+	}
+	file << '"';
+}
+
+/*
+ * Writes every event still in the rings as Chrome trace event JSON. Returns false if the file can't be written.
+ */
+bool Profiler::WriteChromeTrace(const std::string& path)
+{
+	UpdateCalibration();
+
+	std::error_code error;
+	std::filesystem::path parent = std::filesystem::path(path).parent_path();
+	if (!parent.empty())
+		std::filesystem::create_directories(parent, error);
+
+	std::ofstream file(path);
+	if (!file)
+	{
+		std::cout << "Warning: could not write profiler trace " << path << std::endl;
+		return false;
+	}
+
+	file << "{\"traceEvents\":[\n";
+	bool firstEvent = true;
+
+	std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+	for (const ProfileThreadBuffer* buffer : s_Threads)
+	{
+		file << (firstEvent ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->ID
+			<< ",\"args\":{\"name\":";
+		WriteJsonString(file, buffer->Name);
+		file << "}}";
+		firstEvent = false;
+
+		CopyEvents(*buffer);
+		for (const ProfileEvent& event : s_Scratch)
+		{
+			// Microseconds since startup
+			double start = event.Start > s_StartTicks ? TicksToMilliseconds(event.Start - s_StartTicks) * 1000.0 : 0.0;
+			double duration = TicksToMilliseconds(event.End - event.Start) * 1000.0;
+
+			file << ",\n{\"name\":";
+			WriteJsonString(file, event.Name);
+			file << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->ID
+				<< ",\"ts\":" << std::fixed << start << ",\"dur\":" << duration << "}";
+		}
+	}
+
+	file << "\n]}\n";
+	return (bool)file;
+}
+
+/*
+ * Copies every thread's events of the frame between [start] and [end] into the panel, and works out their depths.
+ */
+static void CapturePanelFrame(unsigned long long start, unsigned long long end)
+{
+	s_PanelFrameStart = start;
+	s_PanelFrameEnd = end;
+
+	std::lock_guard<std::mutex> lock(s_ThreadsMutex);
+	if (s_PanelThreads.size() < s_Threads.size())
+		s_PanelThreads.resize(s_Threads.size());
+
+	for (size_t t = 0; t < s_Threads.size(); t++)
+	{
+		const ProfileThreadBuffer& buffer = *s_Threads[t];
+		ProfilePanelThread& thread = s_PanelThreads[t];
+		thread.ID = buffer.ID;
+		std::memcpy(thread.Name, buffer.Name, sizeof(thread.Name));
+		thread.Events.clear();
+		thread.Depths.clear();
+		thread.MaxDepth = 0;
+
+		CopyEvents(buffer);
+		for (const ProfileEvent& event : s_Scratch)
+		{
+			if (event.End > start && event.Start < end)
+				thread.Events.push_back(event);
+		}
+
+		// Outer scopes first, so each event's parents are on the stack when it is reached
+		std::sort(thread.Events.begin(), thread.Events.end(), [](const ProfileEvent& a, const ProfileEvent& b)
+			{
+				return a.Start != b.Start ? a.Start < b.Start : a.End > b.End;
+			});
+
+		unsigned long long stack[s_MaxPanelDepth];
+		unsigned int depth = 0;
+		for (const ProfileEvent& event : thread.Events)
+		{
+			while (depth > 0 && stack[depth - 1] <= event.Start)
+				depth--;
+			thread.Depths.push_back(depth);
+			thread.MaxDepth = std::max(thread.MaxDepth, depth);
+			if (depth < s_MaxPanelDepth)
+				stack[depth++] = event.End;
+		}
+	}
+}
+
+/*
+ * Shows the last complete frame of every thread as a flame graph, with a button to export the trace.
+ */
+void Profiler::DrawImGuiPanel(bool* open)
+{
+	ImGui::SetNextWindowSize(ImVec2(900.0f, 360.0f), ImGuiCond_FirstUseEver);
+	if (!ImGui::Begin("Profiler", open))
+	{
+		ImGui::End();
+		return;
+	}
+
+	if (!s_PanelPaused && s_FrameCount >= 2)
+	{
+		CapturePanelFrame(s_FrameStarts[(s_FrameCount - 2) % s_FrameHistory],
+			s_FrameStarts[(s_FrameCount - 1) % s_FrameHistory]);
+	}
+
+	bool enabled = IsEnabled();
+	if (ImGui::Checkbox("Record", &enabled))
+		SetEnabled(enabled);
+	ImGui::SameLine();
+	ImGui::Checkbox("Pause", &s_PanelPaused);
+	ImGui::SameLine();
+	if (ImGui::Button("Export Chrome trace"))
+		s_ExportResult = WriteChromeTrace(s_TracePath) ? 1 : 0;
+	if (s_ExportResult >= 0)
+	{
+		ImGui::SameLine();
+		if (s_ExportResult)
+			ImGui::Text("Saved %s", s_TracePath);
+		else
+			ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Could not write %s", s_TracePath);
+	}
+
+	double frameMs = TicksToMilliseconds(s_PanelFrameEnd - s_PanelFrameStart);
+	ImGui::Text("Frame: %.3f ms", frameMs);
+
+	const float rowHeight = ImGui::GetTextLineHeight() + 4.0f;
+	float width = ImGui::GetContentRegionAvail().x;
+	double pixelsPerMs = frameMs > 0.0 ? width / frameMs : 0.0;
+	ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+	for (const ProfilePanelThread& thread : s_PanelThreads)
+	{
+		if (thread.Events.empty())
+			continue;
+
+		ImGui::TextDisabled("%s", thread.Name);
+		ImVec2 origin = ImGui::GetCursorScreenPos();
+		ImGui::Dummy(ImVec2(width, (thread.MaxDepth + 1) * rowHeight));
+
+		for (size_t i = 0; i < thread.Events.size(); i++)
+		{
+			const ProfileEvent& event = thread.Events[i];
+			unsigned long long start = std::max(event.Start, s_PanelFrameStart);
+			unsigned long long end = std::min(event.End, s_PanelFrameEnd);
+
+			float x0 = origin.x + (float)(TicksToMilliseconds(start - s_PanelFrameStart) * pixelsPerMs);
+			float x1 = origin.x + (float)(TicksToMilliseconds(end - s_PanelFrameStart) * pixelsPerMs);
+			x1 = std::max(x1, x0 + 1.0f);
+			float y0 = origin.y + thread.Depths[i] * rowHeight;
+			ImVec2 min(x0, y0), max(x1, y0 + rowHeight - 1.0f);
+
+			// Same color for the same name every frame
+			float hue = (float)(((size_t)event.Name >> 3) * 2654435761u % 1000) / 1000.0f;
+			drawList->AddRectFilled(min, max, ImColor::HSV(hue, 0.45f, 0.7f));
+			if (x1 - x0 > 20.0f)
+			{
+				ImVec4 clip(x0, y0, x1 - 2.0f, y0 + rowHeight);
+				drawList->AddText(nullptr, 0.0f, ImVec2(x0 + 2.0f, y0 + 2.0f), IM_COL32(255, 255, 255, 255),
+					event.Name, nullptr, 0.0f, &clip);
+			}
+
+			if (ImGui::IsMouseHoveringRect(min, max))
+				ImGui::SetTooltip("%s\n%.3f ms", event.Name, TicksToMilliseconds(event.End - event.Start));
+		}
+	}
+
+	ImGui::End();
+}
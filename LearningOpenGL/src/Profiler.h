@@ -0,0 +1,129 @@
+#pragma once
+
+#include <atomic>
+#include <string>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define PROFILER_USE_TSC 1
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <x86intrin.h>
+#define PROFILER_USE_TSC 1
+#else
+#include <chrono>
+#define PROFILER_USE_TSC 0
+#endif
+
+/*
+ * Profiler.h
+ * Lightweight CPU instrumentation. PROFILE_SCOPE("name") times the rest of the enclosing block, and
+ * PROFILE_FUNCTION() does the same named after the function.
+ *
+ * Every thread writes its scopes to its own ring buffer of the last EventCapacity events, so recording never
+ * takes a lock: the owning thread writes an event, then publishes it by advancing the buffer's head.
+ * Readers copy the ring and drop anything the writer may have overwritten meanwhile.
+ * Timestamps are CPU ticks (rdtsc on x86, which needs an invariant TSC), converted to time only when read.
+ * A scope costs two timestamps and one store.
+ *
+ * What is recorded can be saved with WriteChromeTrace() and opened in chrome://tracing or ui.perfetto.dev,
+ * or viewed live with DrawImGuiPanel(), which shows the last frame of every thread as a flame graph.
+ *
+ * Usage:
+ *		Put PROFILE_SCOPE("name") at the top of a block. [name] must be a string that is never freed (a literal).
+ *		Call MarkFrame() at the start of every frame on the render thread, so the panel knows where frames begin.
+ *		Name threads with SetThreadName() so they are recognizable in the trace.
+ *		Events that don't happen on a CPU thread (like the GPUProfiler's) go on a track from CreateTrack(),
+ *		which is written like a thread's ring, by one thread at a time.
+ *
+ *		Define PROFILING_ENABLED as 0 to compile every scope out. SetEnabled(false) skips them at run time.
+ */
+
+#ifndef PROFILING_ENABLED
+#define PROFILING_ENABLED 1
+#endif
+
+/*
+ * ProfileEvent
+ * One finished scope, with its start and end in ticks. How deeply it is nested is worked out when it is read,
+ * from the scopes around it, so recording doesn't have to track it.
+ */
+struct ProfileEvent
+{
+	const char* Name;
+	unsigned long long Start;
+	unsigned long long End;
+};
+
+struct ProfileThreadBuffer;
+
+class Profiler
+{
+public:
+	static const unsigned int EventCapacity = 1 << 16;	// Per thread, a power of 2
+
+	static inline unsigned long long Now()
+	{
+#if PROFILER_USE_TSC
+		return __rdtsc();
+#else
+		return (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count();
+#endif
+	}
+
+	inline static bool IsEnabled() { return s_Enabled.load(std::memory_order_relaxed); }
+	static void SetEnabled(bool enabled);
+
+	static void Record(const char* name, unsigned long long start, unsigned long long end);
+	static void Record(ProfileThreadBuffer* track, const char* name, unsigned long long start, unsigned long long end);
+	static ProfileThreadBuffer* CreateTrack(const char* name);
+
+	static void SetThreadName(const char* name);
+	static void MarkFrame();
+
+	static double TicksToMilliseconds(unsigned long long ticks);
+	static double GetTicksPerMillisecond();
+	static bool WriteChromeTrace(const std::string& path);
+	static void DrawImGuiPanel(bool* open);
+
+private:
+	static std::atomic<bool> s_Enabled;
+};
+
+/*
+ * ProfileScope
+ * Records the time from its construction to its destruction. Created by PROFILE_SCOPE().
+ */
+class ProfileScope
+{
+private:
+	const char* m_Name;
+	unsigned long long m_Start;
+	bool m_Active;
+
+public:
+	ProfileScope(const char* name)
+		: m_Name(name), m_Start(0), m_Active(Profiler::IsEnabled())
+	{
+		if (m_Active)
+			m_Start = Profiler::Now();
+	}
+
+	~ProfileScope()
+	{
+		if (m_Active)
+			Profiler::Record(m_Name, m_Start, Profiler::Now());
+	}
+
+	ProfileScope(const ProfileScope&) = delete;
+	ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#if PROFILING_ENABLED
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(name)
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__func__)
+#else
+#define PROFILE_SCOPE(name)
+#define PROFILE_FUNCTION()
+#endif
@@ -0,0 +1,370 @@
+#include "RenderQueue.h"
+#include "GLErrorManager.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+// Below this many keys per thread, splitting the sort costs more than it saves
+static const size_t s_MinKeysPerSortThread = 4096;
+
+static size_t AlignUp(size_t offset, size_t alignment)
+{
+	return (offset + alignment - 1) / alignment * alignment;
+}
+
+DrawCommandBuffer::DrawCommandBuffer(unsigned int uniformAlignment)
+	: m_UniformAlignment(uniformAlignment), m_CommandBase(0), m_UniformBase(0)
+{
+}
+
+/*
+ * Same as RenderQueue::PushUniforms(). The offset is moved to the block's place in the queue when merging.
+ */
+unsigned int DrawCommandBuffer::PushUniforms(const void* data, unsigned int size)
+{
+	size_t offset = AlignUp(m_UniformData.size(), m_UniformAlignment);
+	m_UniformData.resize(offset + size);
+	std::memcpy(m_UniformData.data() + offset, data, size);
+	return (unsigned int)offset;
+}
+
+void DrawCommandBuffer::Submit(const DrawCommand& command)
+{
+	ASSERT(command.VertexArray && command.Indices && command.Program);
+	m_Keys.push_back(RenderQueue::MakeSortKey(command));
+	m_Commands.push_back(command);
+}
+
+// Keeps the capacity, so a steady frame doesn't allocate
+void DrawCommandBuffer::Clear()
+{
+	m_Commands.clear();
+	m_Keys.clear();
+	m_UniformData.clear();
+}
+
+RenderQueue::RenderQueue(unsigned int bindingPoint)
+	: m_UniformAlignment(256), m_BindingPoint(bindingPoint), m_SortPool(nullptr), m_SortThreads(1), m_RecordMs(0.0), m_MergeMs(0.0),
+	m_Sorting(true), m_Stats{}
+{
+	int alignment = 0;
+	GLCall(glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment));
+	if (alignment > 0)
+		m_UniformAlignment = alignment;
+}
+
+/*
+ * Copies a uniform block of [size] bytes into this frame's uniform data and returns its offset,
+ * for the DrawCommand's UniformOffset.
+ */
+unsigned int RenderQueue::PushUniforms(const void* data, unsigned int size)
+{
+	size_t offset = AlignUp(m_UniformData.size(), m_UniformAlignment);
+	m_UniformData.resize(offset + size);
+	std::memcpy(m_UniformData.data() + offset, data, size);
+	return (unsigned int)offset;
+}
+
+void RenderQueue::Submit(const DrawCommand& command)
+{
+	ASSERT(command.VertexArray && command.Indices && command.Program);
+	m_Order.push_back({ MakeSortKey(command), (unsigned int)m_Commands.size() });
+	m_Commands.push_back(command);
+}
+
+/*
+ * Splits [itemCount] items into [threadCount] ranges and calls [record] once per range, with the range and an empty
+ * DrawCommandBuffer, on the pool's workers and the calling thread. Returns once every range is recorded and
+ * merged into the queue, after the commands submitted so far. [record] must only touch its own buffer.
+ * The next Execute() sorts on as many threads.
+ */
+void RenderQueue::Record(ThreadPool& pool, unsigned int threadCount, unsigned int itemCount, const RecordFunction& record)
+{
+	PROFILE_SCOPE("RenderQueue::Record");
+	threadCount = std::max(threadCount, 1u);
+	while (m_Buffers.size() < threadCount)
+		m_Buffers.emplace_back(m_UniformAlignment);
+
+	auto start = std::chrono::steady_clock::now();
+	pool.ParallelFor(threadCount, [&](unsigned int index)
+	{
+		PROFILE_SCOPE("Record draw commands");
+		DrawCommandBuffer& buffer = m_Buffers[index];
+		buffer.Clear();
+		unsigned int first = (unsigned int)((unsigned long long)itemCount * index / threadCount);
+		unsigned int end = (unsigned int)((unsigned long long)itemCount * (index + 1) / threadCount);
+		record(buffer, first, end);
+	});
+	auto recorded = std::chrono::steady_clock::now();
+
+	Merge(pool, threadCount);
+
+	m_RecordMs += std::chrono::duration<double, std::milli>(recorded - start).count();
+	m_MergeMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - recorded).count();
+	m_SortPool = &pool;
+	m_SortThreads = std::max(m_SortThreads, threadCount);
+}
+
+/*
+ * Appends the first [bufferCount] buffers to the queue. The space is allocated here, on the render thread,
+ * and each buffer is copied into its own part of it by the pool, moving its uniform offsets along.
+ */
+void RenderQueue::Merge(ThreadPool& pool, unsigned int bufferCount)
+{
+	size_t commandCount = m_Commands.size();
+	size_t uniformSize = m_UniformData.size();
+	for (unsigned int i = 0; i < bufferCount; i++)
+	{
+		DrawCommandBuffer& buffer = m_Buffers[i];
+		buffer.m_CommandBase = commandCount;
+		buffer.m_UniformBase = AlignUp(uniformSize, m_UniformAlignment);
+		commandCount += buffer.m_Commands.size();
+		if (!buffer.m_UniformData.empty())
+			uniformSize = buffer.m_UniformBase + buffer.m_UniformData.size();
+	}
+
+	m_Commands.resize(commandCount);
+	m_Order.resize(commandCount);
+	m_UniformData.resize(uniformSize);
+
+	DrawCommand* commands = m_Commands.data();
+	SortEntry* order = m_Order.data();
+	unsigned char* uniformData = m_UniformData.data();
+	pool.ParallelFor(bufferCount, [&](unsigned int index)
+	{
+		PROFILE_SCOPE("Merge draw commands");
+		const DrawCommandBuffer& buffer = m_Buffers[index];
+		for (size_t i = 0; i < buffer.m_Commands.size(); i++)
+		{
+			size_t position = buffer.m_CommandBase + i;
+			commands[position] = buffer.m_Commands[i];
+			commands[position].UniformOffset += (unsigned int)buffer.m_UniformBase;
+			order[position] = { buffer.m_Keys[i], (unsigned int)position };
+		}
+		if (!buffer.m_UniformData.empty())
+			std::memcpy(uniformData + buffer.m_UniformBase, buffer.m_UniformData.data(), buffer.m_UniformData.size());
+	});
+}
+
+/*
+ * Draws every submitted command, sorted by key unless sorting is disabled, then empties the queue.
+ */
+void RenderQueue::Execute()
+{
+	auto start = std::chrono::steady_clock::now();
+	m_Stats = {};
+	m_Stats.Commands = (unsigned int)m_Commands.size();
+	m_Stats.SortThreads = 1;
+	m_Stats.RecordMs = m_RecordMs;
+	m_Stats.MergeMs = m_MergeMs;
+
+	if (m_Sorting)
+	{
+		unsigned int sortThreads = (unsigned int)std::min<size_t>(m_SortThreads, m_Order.size() / s_MinKeysPerSortThread);
+		if (m_SortPool && sortThreads > 1)
+		{
+			ParallelSort(sortThreads);
+			m_Stats.SortThreads = sortThreads;
+		}
+		else
+			Sort();
+		m_Stats.SortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	UploadUniforms();
+
+	const DrawCommand* previous = nullptr;
+	for (const SortEntry& entry : m_Order)
+	{
+		const DrawCommand& command = m_Commands[entry.Command];
+
+		if (!previous || previous->Program != command.Program)
+			m_Stats.ProgramChanges++;
+		if (!previous || previous->VertexArray != command.VertexArray)
+			m_Stats.VertexArrayChanges++;
+
+		for (unsigned int slot = 0; slot < DrawCommand::MaxTextures; slot++)
+		{
+			const Texture* texture = command.Textures[slot];
+			if (texture && (!previous || previous->Textures[slot] != texture))
+			{
+				texture->Bind(slot);
+				m_Stats.TextureChanges++;
+			}
+		}
+
+		if (command.UniformSize > 0 && (!previous || previous->UniformOffset != command.UniformOffset || previous->UniformSize != command.UniformSize))
+		{
+			m_UniformBuffer->BindRange(command.UniformOffset, command.UniformSize);
+			m_Stats.UniformRangeChanges++;
+		}
+
+		// The Renderer binds the program, VAO and index buffer through the GLStateCache, which skips repeats
+		unsigned int indexCount = command.IndexCount > 0 ? command.IndexCount : command.Indices->GetCount();
+		m_Renderer.Draw(*command.VertexArray, *command.Indices, *command.Program, indexCount, command.FirstIndex);
+
+		previous = &command;
+	}
+
+	// The storage stays in the FrameArena until the frame ends
+	m_Commands.clear();
+	m_Order.clear();
+	m_UniformData.clear();
+	m_SortPool = nullptr;
+	m_SortThreads = 1;
+	m_RecordMs = m_MergeMs = 0.0;
+
+	m_Stats.ExecuteMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/*
+ * Packs the command's state into a key whose order groups shader, then texture, then VAO, then depth
+ */
+unsigned long long RenderQueue::MakeSortKey(const DrawCommand& command)
+{
+	unsigned long long program = command.Program->GetRendererID() & 0xFFF;
+	unsigned long long texture = command.Textures[0] ? command.Textures[0]->GetRendererID() & 0xFFFF : 0;
+	unsigned long long vertexArray = command.VertexArray->GetRendererID() & 0xFFF;
+	unsigned long long depth = (unsigned long long)(std::min(std::max(command.Depth, 0.0f), 1.0f) * 0xFFFFFF);
+
+	return (program << 52) | (texture << 36) | (vertexArray << 24) | depth;
+}
+
+/*
+ * LSD radix sort of the keys, one byte per pass. All 8 histograms are built in one read of the keys,
+ * and a byte that is the same in every key (like the shader bits when there are few shaders) skips its pass.
+ * Stable, so commands with equal keys keep their submission order.
+ */
+void RenderQueue::Sort()
+{
+	size_t count = m_Order.size();
+	if (count < 2)
+		return;
+
+	unsigned int histograms[8][256] = {};
+	for (const SortEntry& entry : m_Order)
+	{
+		for (int pass = 0; pass < 8; pass++)
+			histograms[pass][(entry.Key >> (pass * 8)) & 0xFF]++;
+	}
+
+	m_SortScratch.resize(count);
+	for (int pass = 0; pass < 8; pass++)
+	{
+		unsigned int* histogram = histograms[pass];
+		if (histogram[(m_Order[0].Key >> (pass * 8)) & 0xFF] == count)
+			continue;
+
+		// Histogram to starting offsets
+		unsigned int offset = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			unsigned int digitCount = histogram[digit];
+			histogram[digit] = offset;
+			offset += digitCount;
+		}
+
+		for (const SortEntry& entry : m_Order)
+			m_SortScratch[histogram[(entry.Key >> (pass * 8)) & 0xFF]++] = entry;
+		m_Order.swap(m_SortScratch);
+	}
+}
+
+/*
+ * The same radix sort split over [threadCount] threads of the pool that recorded the commands. Each thread owns a
+ * contiguous part of the entries. Every pass, each thread counts the digits in its part, the counts are turned into
+ * offsets ordered by digit then by part (so the sort stays stable), and each thread moves its part's entries.
+ */
+void RenderQueue::ParallelSort(unsigned int threadCount)
+{
+	PROFILE_SCOPE("RenderQueue::ParallelSort");
+	size_t count = m_Order.size();
+	m_SortScratch.resize(count);
+	m_SortHistograms.resize((size_t)threadCount * 8 * 256);
+
+	auto partBegin = [count, threadCount](unsigned int part) { return count * part / threadCount; };
+	auto histogram = [this](unsigned int part, int pass) { return &m_SortHistograms[((size_t)part * 8 + pass) * 256]; };
+
+	// All 8 histograms of every part in one read. The first pass uses them as they are,
+	// and their totals tell which passes can be skipped.
+	const SortEntry* entries = m_Order.data();
+	m_SortPool->ParallelFor(threadCount, [&](unsigned int part)
+	{
+		unsigned int* counts = histogram(part, 0);
+		std::fill(counts, counts + 8 * 256, 0u);
+		for (size_t i = partBegin(part); i < partBegin(part + 1); i++)
+		{
+			for (int pass = 0; pass < 8; pass++)
+				counts[pass * 256 + ((entries[i].Key >> (pass * 8)) & 0xFF)]++;
+		}
+	});
+
+	bool moved = false;
+	for (int pass = 0; pass < 8; pass++)
+	{
+		unsigned int firstDigit = (m_Order[0].Key >> (pass * 8)) & 0xFF;
+		size_t sameDigit = 0;
+		for (unsigned int part = 0; part < threadCount; part++)
+			sameDigit += histogram(part, pass)[firstDigit];
+		if (sameDigit == count)
+			continue;
+
+		const SortEntry* source = m_Order.data();
+		SortEntry* destination = m_SortScratch.data();
+
+		// After the first move, the parts hold different entries, so their histograms are counted again
+		if (moved)
+		{
+			m_SortPool->ParallelFor(threadCount, [&](unsigned int part)
+			{
+				unsigned int* counts = histogram(part, pass);
+				std::fill(counts, counts + 256, 0u);
+				for (size_t i = partBegin(part); i < partBegin(part + 1); i++)
+					counts[(source[i].Key >> (pass * 8)) & 0xFF]++;
+			});
+		}
+
+		// Histograms to starting offsets
+		unsigned int offset = 0;
+		for (int digit = 0; digit < 256; digit++)
+		{
+			for (unsigned int part = 0; part < threadCount; part++)
+			{
+				unsigned int* counts = histogram(part, pass);
+				unsigned int digitCount = counts[digit];
+				counts[digit] = offset;
+				offset += digitCount;
+			}
+		}
+
+		m_SortPool->ParallelFor(threadCount, [&](unsigned int part)
+		{
+			unsigned int* offsets = histogram(part, pass);
+			for (size_t i = partBegin(part); i < partBegin(part + 1); i++)
+				destination[offsets[(source[i].Key >> (pass * 8)) & 0xFF]++] = source[i];
+		});
+
+		m_Order.swap(m_SortScratch);
+		moved = true;
+	}
+}
+
+/*
+ * Uploads every block pushed this frame with one call, growing the buffer if they don't fit
+ */
+void RenderQueue::UploadUniforms()
+{
+	if (m_UniformData.empty())
+		return;
+
+	unsigned int size = (unsigned int)m_UniformData.size();
+	if (!m_UniformBuffer || m_UniformBuffer->GetSize() < size)
+	{
+		unsigned int capacity = std::max(size, m_UniformBuffer ? m_UniformBuffer->GetSize() * 2 : 64 * 1024);
+		m_UniformBuffer = std::make_unique<UniformBuffer>(capacity, m_BindingPoint);
+	}
+	m_UniformBuffer->SetData(m_UniformData.data(), size);
+}
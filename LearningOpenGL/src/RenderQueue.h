@@ -0,0 +1,159 @@
+#pragma once
+
+#include "FrameArena.h"
+#include "Renderer.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class ThreadPool;
+
+/*
+ * RenderQueue.h
+ * Collects draw commands for a frame and executes them in an order that minimizes state changes,
+ * instead of drawing each one the moment it is submitted like Renderer::Draw().
+ *
+ * Every command gets a 64 bit sort key, packed from most to least significant as
+ *		shader (12 bits) | first texture (16 bits) | VAO (12 bits) | depth (24 bits)
+ * using the low bits of the OpenGL object names. Execute() radix sorts the keys, so commands sharing a shader
+ * are drawn together, then those sharing a texture, then a VAO, front to back within each group.
+ * (Two objects whose names share the low bits only cost an extra state change, never a wrong draw.)
+ *
+ * Per-draw uniforms go in one buffer for the whole frame. PushUniforms() copies a block into it and returns its
+ * offset, and each command's range is attached to the queue's binding point with glBindBufferRange before it draws.
+ *
+ * Usage:
+ *		Each frame, fill a DrawCommand for every object (pushing its uniform block first) and Submit() it.
+ *		Call Execute() once to sort, upload the uniforms, and draw everything. The queue is then empty again.
+ *		Objects referenced by commands must stay alive until Execute() returns.
+ *		Commands are stored in the FrameArena, so they must be executed in the frame they were submitted.
+ *
+ *		To build the commands on several threads, call Record() instead of submitting them one by one. It splits the
+ *		items into ranges and calls back once per range, on the workers of a ThreadPool and the calling thread, each
+ *		with its own DrawCommandBuffer. The buffers are merged into the queue, and the next Execute() sorts them on
+ *		the same threads before drawing on the render thread as usual.
+ */
+
+/*
+ * DrawCommand
+ * Everything needed to draw one object.
+ */
+struct DrawCommand
+{
+	static const unsigned int MaxTextures = 4;
+
+	const VertexArrayObject* VertexArray = nullptr;
+	const IndexBuffer* Indices = nullptr;
+	const Shader* Program = nullptr;
+	const Texture* Textures[MaxTextures] = {};	// Bound to units 0, 1, ... (null slots are left alone)
+	unsigned int UniformOffset = 0;				// Returned by RenderQueue::PushUniforms()
+	unsigned int UniformSize = 0;				// 0 if the draw has no uniform block
+	unsigned int IndexCount = 0;				// 0 draws the whole index buffer
+	unsigned int FirstIndex = 0;
+	float Depth = 0.0f;							// 0 (near) to 1 (far)
+};
+
+/*
+ * DrawCommandBuffer
+ * Commands and uniform blocks recorded by one thread during RenderQueue::Record(), pushed and submitted like
+ * on the queue itself. It keeps its storage from frame to frame instead of using the FrameArena,
+ * which only the render thread may allocate from.
+ */
+class DrawCommandBuffer
+{
+private:
+	friend class RenderQueue;
+
+	std::vector<DrawCommand> m_Commands;
+	std::vector<unsigned long long> m_Keys;
+	std::vector<unsigned char> m_UniformData;
+	unsigned int m_UniformAlignment;
+
+	// Where the buffer's commands and uniforms go in the queue, set when merging
+	size_t m_CommandBase;
+	size_t m_UniformBase;
+
+public:
+	DrawCommandBuffer(unsigned int uniformAlignment = 256);
+
+	unsigned int PushUniforms(const void* data, unsigned int size);
+	void Submit(const DrawCommand& command);
+	void Clear();
+
+	inline size_t GetCount() const { return m_Commands.size(); }
+};
+
+/*
+ * RenderQueueStats
+ * What the last Execute() did. A change is counted when a command needs different state than the one before it.
+ */
+struct RenderQueueStats
+{
+	unsigned int Commands;
+	unsigned int ProgramChanges;
+	unsigned int TextureChanges;
+	unsigned int VertexArrayChanges;
+	unsigned int UniformRangeChanges;
+	unsigned int SortThreads;	// More than 1 after Record() with several threads
+	double RecordMs;		// Building commands in Record() calls since the last Execute()
+	double MergeMs;			// Copying the recorded buffers into the queue
+	double SortMs;
+	double ExecuteMs;		// Including the sort and the uniform upload
+};
+
+class RenderQueue
+{
+private:
+	struct SortEntry
+	{
+		unsigned long long Key;
+		unsigned int Command;
+	};
+
+	Renderer m_Renderer;
+	// Only needed until Execute() returns, so they live in the FrameArena
+	FrameArray<DrawCommand> m_Commands;
+	FrameArray<SortEntry> m_Order;
+	FrameArray<SortEntry> m_SortScratch;
+
+	FrameArray<unsigned char> m_UniformData;		// Blocks pushed this frame, uploaded by Execute()
+	std::unique_ptr<UniformBuffer> m_UniformBuffer;	// Grows to the largest frame's blocks
+	unsigned int m_UniformAlignment;
+	unsigned int m_BindingPoint;
+
+	// Parallel recording
+	std::vector<DrawCommandBuffer> m_Buffers;	// One per range of the last Record()
+	ThreadPool* m_SortPool;						// Set by Record(), for the next Execute()
+	unsigned int m_SortThreads;
+	std::vector<unsigned int> m_SortHistograms;	// 8 histograms of 256 digits per sort thread
+	double m_RecordMs;
+	double m_MergeMs;
+
+	bool m_Sorting;
+	RenderQueueStats m_Stats;
+
+public:
+	typedef std::function<void(DrawCommandBuffer& buffer, unsigned int first, unsigned int end)> RecordFunction;
+
+	RenderQueue(unsigned int bindingPoint = UniformBlockBinding::Object);
+
+	unsigned int PushUniforms(const void* data, unsigned int size);
+	void Submit(const DrawCommand& command);
+	void Record(ThreadPool& pool, unsigned int threadCount, unsigned int itemCount, const RecordFunction& record);
+	void Execute();
+
+	inline void SetSortingEnabled(bool sorting) { m_Sorting = sorting; }
+	inline bool IsSortingEnabled() const { return m_Sorting; }
+	inline const RenderQueueStats& GetStats() const { return m_Stats; }
+
+	static unsigned long long MakeSortKey(const DrawCommand& command);
+
+private:
+	void Sort();
+	void ParallelSort(unsigned int threadCount);
+	void Merge(ThreadPool& pool, unsigned int bufferCount);
+	void UploadUniforms();
+};
@@ -0,0 +1,268 @@
+#include "RenderThread.h"
+#include "GLErrorManager.h"
+#include "Profiler.h"
+
+#include "imgui/imgui_impl_opengl3.h"
+
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+FrameLatencyStats::FrameLatencyStats()
+	: m_Started(false), m_LatencySumMs(0.0), m_Frames(0), m_LatencyMs(0.0f), m_FramesPerSecond(0.0f)
+{
+}
+
+/*
+ * Adds a frame that started at [start] and was on screen at [presented]
+ */
+void FrameLatencyStats::AddFrame(Clock::time_point start, Clock::time_point presented)
+{
+	if (!m_Started)
+	{
+		m_WindowStart = presented;
+		m_Started = true;
+		return;
+	}
+
+	m_LatencySumMs += std::chrono::duration<double, std::milli>(presented - start).count();
+	m_Frames++;
+
+	double windowSeconds = std::chrono::duration<double>(presented - m_WindowStart).count();
+	if (windowSeconds >= 0.5)
+	{
+		m_LatencyMs = (float)(m_LatencySumMs / m_Frames);
+		m_FramesPerSecond = (float)(m_Frames / windowSeconds);
+		m_WindowStart = presented;
+		m_LatencySumMs = 0.0;
+		m_Frames = 0;
+	}
+}
+
+/*
+ * Waits until [condition] is true. Yields at first, so a short wait ends quickly,
+ * then sleeps, so a long one doesn't keep a core busy.
+ */
+template<typename F>
+static void WaitUntil(F condition)
+{
+	for (unsigned int tries = 0; !condition(); tries++)
+	{
+		if (tries < 1000)
+			std::this_thread::yield();
+		else
+			std::this_thread::sleep_for(std::chrono::microseconds(100));
+	}
+}
+
+template<typename T>
+static void CopyVector(const ImVector<T>& source, ImVector<T>& destination)
+{
+	destination.resize(source.Size);	// Keeps the capacity, so a steady frame doesn't allocate
+	if (source.Size > 0)
+		std::memcpy(destination.Data, source.Data, source.size_in_bytes());
+}
+
+RenderThread::RenderThread(Display& window)
+	: m_Window(window), m_Running(false), m_Current(nullptr), m_Stats{}
+{
+}
+
+RenderThread::~RenderThread()
+{
+	Stop();
+}
+
+/*
+ * Starts recording on the calling (main) thread and hands the context to the render thread.
+ * Call it between frames, after ImGui has rendered at least once (so its OpenGL objects exist).
+ * Returns false, and nothing changes, if OpenGL calls can't be recorded.
+ */
+bool RenderThread::Start()
+{
+	if (m_Running)
+		return true;
+
+	Frame* first = &m_Frames[0];
+	first->Commands.Clear();
+	if (!GLDispatch::BeginRecording(first->Commands))
+	{
+		std::cout << "Warning: the render thread needs GLDispatch to record OpenGL calls" << std::endl;
+		return false;
+	}
+	first->Done = false;
+	m_Current = first;
+
+	// The thread isn't running, so this thread can use both ends of the queues
+	Frame* leftover;
+	while (m_Submitted.TryPop(leftover))
+		;
+	while (m_Free.TryPop(leftover))
+		;
+	for (unsigned int i = 1; i < FrameCount; i++)
+	{
+		m_Frames[i].Done = false;
+		m_Free.TryPush(&m_Frames[i]);
+	}
+
+	m_Stats = {};
+	Display::ReleaseContext();
+	m_Running = true;
+	m_Thread = std::thread(&RenderThread::ThreadLoop, this);
+	return true;
+}
+
+/*
+ * Executes everything recorded since the last SubmitFrame() (without showing it), stops the render thread,
+ * and makes the context current on the calling thread again
+ */
+void RenderThread::Stop()
+{
+	if (!m_Running)
+		return;
+
+	m_Current->Present = false;
+	m_Current->Start = Clock::now();
+	bool submitted = m_Submitted.TryPush(m_Current);
+	ASSERT(submitted);
+	m_Thread.join();
+
+	m_Running = false;
+	m_Current = nullptr;
+	GLDispatch::EndRecording();
+	m_Window.MakeContextCurrent();
+}
+
+/*
+ * Hands the frame recorded since the last call, and a copy of [drawData], to the render thread,
+ * then continues recording into the next free frame. [frameStart] is when the main thread began the frame.
+ * Waits if the render thread still has every other frame.
+ */
+void RenderThread::SubmitFrame(const ImDrawData& drawData, Clock::time_point frameStart)
+{
+	PROFILE_SCOPE("RenderThread::SubmitFrame");
+	ASSERT(m_Running);
+
+	Frame* frame = m_Current;
+	frame->Start = frameStart;
+	frame->Present = true;
+	CopyDrawData(drawData, *frame);
+	bool submitted = m_Submitted.TryPush(frame);
+	ASSERT(submitted);
+
+	Frame* next = nullptr;
+	auto waitStart = Clock::now();
+	{
+		PROFILE_SCOPE("Wait for a free frame");
+		WaitUntil([&]() { return m_Free.TryPop(next); });
+	}
+	m_Stats.WaitMs = std::chrono::duration<float, std::milli>(Clock::now() - waitStart).count();
+
+	// A frame that comes back has been shown, unless it was never used
+	if (next->Done)
+	{
+		m_LatencyStats.AddFrame(next->Start, next->Presented);
+		m_Stats.ReplayMs = next->ReplayMs;
+		m_Stats.Commands = next->Commands.GetCommandCount();
+		m_Stats.Bytes = next->Commands.GetSize();
+		if (!next->ReplaySucceeded)
+			m_Stats.FailedReplays++;
+	}
+
+	next->Done = false;
+	next->Commands.Clear();
+	GLDispatch::SetRecordingLog(next->Commands);
+	m_Current = next;
+}
+
+void RenderThread::ThreadLoop()
+{
+	m_Window.MakeContextCurrent();
+	Profiler::SetThreadName("GL");
+
+	bool stopping = false;
+	while (!stopping)
+	{
+		Frame* frame = nullptr;
+		{
+			PROFILE_SCOPE("Wait for a frame");
+			WaitUntil([&]() { return m_Submitted.TryPop(frame); });
+		}
+
+		auto replayStart = Clock::now();
+		{
+			PROFILE_SCOPE("Replay");
+			frame->ReplaySucceeded = GLDispatch::Replay(frame->Commands, m_ReplayState);
+		}
+		frame->ReplayMs = std::chrono::duration<float, std::milli>(Clock::now() - replayStart).count();
+
+		if (frame->Present)
+		{
+			{
+				PROFILE_SCOPE("ImGui render");
+				TranslateTextures(*frame);
+				ImGui_ImplOpenGL3_RenderDrawData(&frame->DrawData);
+			}
+			{
+				PROFILE_SCOPE("Display::SwapBuffers");
+				m_Window.SwapBuffers();
+			}
+		}
+		else
+			stopping = true;
+
+		frame->Presented = Clock::now();
+		frame->Done = true;
+		bool returned = m_Free.TryPush(frame);
+		ASSERT(returned);
+	}
+
+	Display::ReleaseContext();
+}
+
+/*
+ * Copies [source] into the frame's own draw lists, since ImGui reuses its lists for the next frame
+ */
+void RenderThread::CopyDrawData(const ImDrawData& source, Frame& frame)
+{
+	ImDrawData& copy = frame.DrawData;
+	copy.Valid = source.Valid;
+	copy.CmdListsCount = source.CmdListsCount;
+	copy.TotalIdxCount = source.TotalIdxCount;
+	copy.TotalVtxCount = source.TotalVtxCount;
+	copy.DisplayPos = source.DisplayPos;
+	copy.DisplaySize = source.DisplaySize;
+	copy.FramebufferScale = source.FramebufferScale;
+	copy.OwnerViewport = nullptr;
+
+	while ((int)frame.DrawLists.size() < source.CmdListsCount)
+		frame.DrawLists.push_back(std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData()));
+
+	copy.CmdLists.resize(source.CmdListsCount);
+	for (int i = 0; i < source.CmdListsCount; i++)
+	{
+		const ImDrawList& from = *source.CmdLists[i];
+		ImDrawList& to = *frame.DrawLists[i];
+		CopyVector(from.CmdBuffer, to.CmdBuffer);
+		CopyVector(from.IdxBuffer, to.IdxBuffer);
+		CopyVector(from.VtxBuffer, to.VtxBuffer);
+		to.Flags = from.Flags;
+		copy.CmdLists[i] = &to;
+	}
+}
+
+/*
+ * Textures created while recording are drawn by ImGui under their recorded names. Swaps in the real ones.
+ */
+void RenderThread::TranslateTextures(Frame& frame)
+{
+	for (int i = 0; i < frame.DrawData.CmdListsCount; i++)
+	{
+		for (ImDrawCmd& command : frame.DrawData.CmdLists[i]->CmdBuffer)
+		{
+			auto it = m_ReplayState.Names.find((GLuint)(intptr_t)command.TextureId);
+			if (it != m_ReplayState.Names.end())
+				command.TextureId = (ImTextureID)(intptr_t)it->second;
+		}
+	}
+}
@@ -0,0 +1,131 @@
+#pragma once
+
+#include "Display.h"
+#include "GLCommandLog.h"
+#include "SPSCQueue.h"
+
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+
+/*
+ * RenderThread.h
+ * Moves OpenGL execution off the main thread. While the RenderThread runs, the main thread records every
+ * OpenGL call of a frame into a GLCommandLog (through GLDispatch's null backend) and hands the log, with a copy
+ * of ImGui's draw data, to the render thread. The render thread owns the context: it replays the log, draws ImGui
+ * and swaps buffers, while the main thread already updates and records the next frame. A long OnUpdate() then
+ * delays the next frame instead of the swap of the current one.
+ *
+ * There are 3 frames: one being recorded, one being executed and one waiting in between. They go to the render
+ * thread and back through two lock-free SPSCQueues. If all 3 are in use, the main thread waits for one to come back.
+ *
+ * Usage:
+ *		Start() hands the window's context to the render thread. From then on, each main loop iteration records
+ *		as usual and ends with SubmitFrame() (instead of rendering ImGui and swapping), then Display::EndFrame(false).
+ *		Stop() executes what was recorded so far, waits for the thread and takes the context back.
+ *		Objects created while running have recorded names, so destroy them before Stop().
+ *
+ *		Answers to queries made while running come from the null backend, not the driver, so query results
+ *		(GPUProfiler and timer queries) are zero, and writes through persistently mapped buffers are lost.
+ */
+
+/*
+ * FrameLatencyStats
+ * End-to-end latency (from the start of a frame on the main thread until its buffer swap returns)
+ * and throughput (frames presented per second), averaged over about half a second.
+ */
+class FrameLatencyStats
+{
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	Clock::time_point m_WindowStart;
+	bool m_Started;
+	double m_LatencySumMs;
+	unsigned int m_Frames;
+
+	float m_LatencyMs;
+	float m_FramesPerSecond;
+
+public:
+	FrameLatencyStats();
+
+	void AddFrame(Clock::time_point start, Clock::time_point presented);
+
+	inline float GetLatencyMs() const { return m_LatencyMs; }
+	inline float GetFramesPerSecond() const { return m_FramesPerSecond; }
+};
+
+/*
+ * RenderThreadStats
+ * About the latest frame the render thread finished.
+ */
+struct RenderThreadStats
+{
+	float ReplayMs;				// Executing the recorded calls
+	float WaitMs;				// The main thread waiting for a free frame in the last SubmitFrame()
+	size_t Commands;			// Recorded calls
+	size_t Bytes;				// Size of the recorded log
+	unsigned int FailedReplays;	// Frames whose replay raised an OpenGL error, since Start()
+};
+
+class RenderThread
+{
+public:
+	static const unsigned int FrameCount = 3;
+
+private:
+	typedef std::chrono::steady_clock Clock;
+
+	struct Frame
+	{
+		GLCommandLog Commands;
+		ImDrawData DrawData;							// Points into DrawLists
+		std::vector<std::unique_ptr<ImDrawList>> DrawLists;	// Copies of ImGui's lists, reused every time the frame is
+		Clock::time_point Start;
+		bool Present;		// Draw ImGui and swap. False for the frame Stop() executes.
+
+		// Written by the render thread
+		bool Done;
+		bool ReplaySucceeded;
+		float ReplayMs;
+		Clock::time_point Presented;
+	};
+
+	Display& m_Window;
+	std::thread m_Thread;
+	bool m_Running;
+
+	Frame m_Frames[FrameCount];
+	Frame* m_Current;				// Being recorded by the main thread
+	SPSCQueue<Frame*, FrameCount> m_Submitted;	// Main thread to render thread
+	SPSCQueue<Frame*, FrameCount> m_Free;		// Render thread back to the main thread
+	GLReplayState m_ReplayState;	// Only touched by the render thread while it runs
+
+	FrameLatencyStats m_LatencyStats;
+	RenderThreadStats m_Stats;
+
+public:
+	RenderThread(Display& window);
+	~RenderThread();
+
+	RenderThread(const RenderThread&) = delete;
+	RenderThread& operator=(const RenderThread&) = delete;
+
+	bool Start();
+	void Stop();
+	inline bool IsRunning() const { return m_Running; }
+
+	void SubmitFrame(const ImDrawData& drawData, Clock::time_point frameStart);
+
+	inline const FrameLatencyStats& GetLatencyStats() const { return m_LatencyStats; }
+	inline const RenderThreadStats& GetStats() const { return m_Stats; }
+
+private:
+	void ThreadLoop();
+	void CopyDrawData(const ImDrawData& source, Frame& frame);
+	void TranslateTextures(Frame& frame);
+};
@@ -1,4 +1,7 @@
 #include "Renderer.h"
+#include "Profiler.h"
+
+RendererStats Renderer::s_Stats = { 0, 0, 0 };
 
 void Renderer::Clear() const
 {
@@ -7,8 +10,75 @@ void Renderer::Clear() const
 
 void Renderer::Draw(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader) const
 {
+	Draw(va, ib, shader, ib.GetCount(), 0);
+}
+
+/*
+ * Draws [indexCount] indices of the index buffer, starting at index [firstIndex].
+ * [baseVertex] is added to every index, for vertices that start partway into the vertex buffer.
+ */
+void Renderer::Draw(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader,
+	unsigned int indexCount, unsigned int firstIndex, int baseVertex) const
+{
+	PROFILE_SCOPE("Renderer::Draw");
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+	void* offset = (void*)(firstIndex * sizeof(unsigned int));
+	if (baseVertex == 0)
+	{
+		GLCall(glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, offset));
+	}
+	else
+	{
+		GLCall(glDrawElementsBaseVertex(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, offset, baseVertex));
+	}
+
+	s_Stats.DrawCalls++;
+	s_Stats.Indices += indexCount;
+	s_Stats.Instances++;
+}
+
+/*
+ * Draws the whole index buffer [instanceCount] times with a single draw call.
+ * Per-instance data comes from buffers added with VertexArrayObject::AddInstanceBuffer().
+ */
+void Renderer::DrawInstanced(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const
+{
+	PROFILE_SCOPE("Renderer::DrawInstanced");
+
 	shader.Bind();
 	va.Bind();
 	ib.Bind();
-	GLCall(glDrawElements(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr));
+	GLCall(glDrawElementsInstanced(GL_TRIANGLES, ib.GetCount(), GL_UNSIGNED_INT, nullptr, instanceCount));
+
+	s_Stats.DrawCalls++;
+	s_Stats.Indices += ib.GetCount() * instanceCount;
+	s_Stats.Instances += instanceCount;
+}
+
+/*
+ * Issues [drawCount] draws in a single call, reading a DrawElementsIndirectCommand for each from the
+ * bound GL_DRAW_INDIRECT_BUFFER. [instanceCount] and [indexCount] are the totals of those commands, for the stats.
+ * Needs GL 4.3 or ARB_multi_draw_indirect.
+ */
+void Renderer::MultiDrawIndirect(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader,
+	unsigned int drawCount, unsigned int instanceCount, unsigned int indexCount) const
+{
+	PROFILE_SCOPE("Renderer::MultiDrawIndirect");
+
+	shader.Bind();
+	va.Bind();
+	ib.Bind();
+	GLCall(glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, nullptr, drawCount, 0));
+
+	s_Stats.DrawCalls++;
+	s_Stats.Indices += indexCount;
+	s_Stats.Instances += instanceCount;
+}
+
+void Renderer::ResetStats()
+{
+	s_Stats = { 0, 0, 0 };
 }
@@ -4,11 +4,30 @@
 #include "IndexBuffer.h"
 #include "Shader.h"
 
+/*
+ * RendererStats
+ * Counts the work submitted through the Renderer since the last ResetStats() call.
+ */
+struct RendererStats
+{
+	unsigned int DrawCalls;
+	unsigned int Indices;
+	unsigned int Instances;
+};
+
 class Renderer
 {
 private:
-
+	static RendererStats s_Stats;
 public:
 	void Clear() const;
 	void Draw(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader) const;
-};
\ No newline at end of file
+	void Draw(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader,
+		unsigned int indexCount, unsigned int firstIndex, int baseVertex = 0) const;
+	void DrawInstanced(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader, unsigned int instanceCount) const;
+	void MultiDrawIndirect(const VertexArrayObject& va, const IndexBuffer& ib, const Shader& shader,
+		unsigned int drawCount, unsigned int instanceCount, unsigned int indexCount) const;
+
+	static void ResetStats();
+	inline static const RendererStats& GetStats() { return s_Stats; }
+};
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * SPSCQueue.h
+ * A fixed size, lock-free queue for handing values from exactly one producer thread to exactly one consumer thread.
+ * The producer only writes the tail and the consumer only writes the head, so neither ever waits for a lock.
+ * Each index sits in its own cache line, so the two threads don't keep stealing it from each other.
+ *
+ * Usage:
+ *		SPSCQueue<T, Capacity> holds up to Capacity values. T should be cheap to copy, like a pointer or an index.
+ *		The producer calls TryPush(), the consumer TryPop(). Both return false instead of blocking when the queue
+ *		is full or empty, so the caller chooses how to wait.
+ */
+
+template<typename T, size_t Capacity>
+class SPSCQueue
+{
+private:
+	static const size_t CacheLineSize = 64;
+	static const size_t Slots = Capacity + 1;	// One slot always stays empty, to tell full from empty
+
+	T m_Values[Slots];
+	alignas(CacheLineSize) std::atomic<size_t> m_Head;	// Next value to pop, written by the consumer
+	alignas(CacheLineSize) std::atomic<size_t> m_Tail;	// Next slot to push to, written by the producer
+
+public:
+	SPSCQueue()
+		: m_Values(), m_Head(0), m_Tail(0)
+	{
+	}
+
+	SPSCQueue(const SPSCQueue&) = delete;
+	SPSCQueue& operator=(const SPSCQueue&) = delete;
+
+	/*
+	 * Adds [value] at the back. Returns false if the queue is full. Only call from the producer thread.
+	 */
+	bool TryPush(const T& value)
+	{
+		size_t tail = m_Tail.load(std::memory_order_relaxed);
+		size_t next = (tail + 1) % Slots;
+		if (next == m_Head.load(std::memory_order_acquire))
+			return false;
+
+		m_Values[tail] = value;
+		m_Tail.store(next, std::memory_order_release);	// Publishes the value to the consumer
+		return true;
+	}
+
+	/*
+	 * Removes the front value into [value]. Returns false if the queue is empty. Only call from the consumer thread.
+	 */
+	bool TryPop(T& value)
+	{
+		size_t head = m_Head.load(std::memory_order_relaxed);
+		if (head == m_Tail.load(std::memory_order_acquire))
+			return false;
+
+		value = m_Values[head];
+		m_Head.store((head + 1) % Slots, std::memory_order_release);	// Hands the slot back to the producer
+		return true;
+	}
+
+	/*
+	 * True if nothing is waiting. Exact on the consumer thread, possibly out of date anywhere else.
+	 */
+	bool IsEmpty() const
+	{
+		return m_Head.load(std::memory_order_acquire) == m_Tail.load(std::memory_order_acquire);
+	}
+};
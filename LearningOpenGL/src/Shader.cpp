@@ -2,21 +2,62 @@
 
 #include <sstream>
 #include <fstream>
+#include <algorithm>
 #include <GL/glew.h>
 #include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <vector>
 #include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "Profiler.h"
+#include "UniformBuffer.h"
 
+// Directory the program binaries are saved in (relative to the working directory, like res/)
+static const char* s_BinaryCacheDirectory = "cache/shaders";
+static const unsigned int s_BinaryCacheMagic = 0x42505347;	// "GSPB"
+
+bool Shader::s_BinaryCacheEnabled = true;
+std::vector<std::pair<std::string, unsigned int>> Shader::s_UniformBlockBindings = {
+    { "Camera", UniformBlockBinding::Camera },
+    { "Material", UniformBlockBinding::Material },
+    { "Object", UniformBlockBinding::Object }
+};
 
 
 Shader::Shader(const std::string& vertexShaderFilepath, const std::string& fragmentShaderFilepath)
-	: m_RendererID(0)
+	: m_RendererID(0), m_LoadedFromBinary(false), m_LoadMs(0.0f)
 {
+    PROFILE_SCOPE("Shader load");
+    auto start = std::chrono::steady_clock::now();
+
     ShaderProgramSource source = ParseShader(vertexShaderFilepath, fragmentShaderFilepath);
-    m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+
+    std::string cachePath;
+    if (s_BinaryCacheEnabled && IsBinaryCacheSupported())
+    {
+        cachePath = GetBinaryCachePath(source);
+        m_RendererID = LoadProgramBinary(cachePath);
+        m_LoadedFromBinary = m_RendererID != 0;
+    }
+
+    if (!m_LoadedFromBinary)
+        m_RendererID = CreateShader(source.VertexSource, source.FragmentSource);
+
+    ReflectUniforms();
+    BindUniformBlocks();
+
+    m_LoadMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Saved after the timing, so a cold load measures compiling and linking only
+    if (!m_LoadedFromBinary && !cachePath.empty())
+        SaveProgramBinary(m_RendererID, cachePath);
 }
 
 Shader::~Shader()
 {
+    GLStateCache::OnProgramDeleted(m_RendererID);
     GLCall(glDeleteProgram(m_RendererID));
 }
 
@@ -48,6 +89,7 @@ ShaderProgramSource Shader::ParseShader(const std::string& vertexFilepath, const
  */
 unsigned int Shader::CompileShader(unsigned int type, const std::string& source)
 {
+    PROFILE_SCOPE("Shader::CompileShader");
 
     GLCall(unsigned int id = glCreateShader(type)); // Create space for the shader
     const char* src = source.c_str();   // Get char* version of string
@@ -90,6 +132,11 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     // Create the shader program
     GLCall(glAttachShader(program, vs));
     GLCall(glAttachShader(program, fs));
+    if (s_BinaryCacheEnabled && IsBinaryCacheSupported())
+    {
+        // Let the driver know we will ask for the binary, so it keeps it around
+        GLCall(glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE));
+    }
     GLCall(glLinkProgram(program));
     GLCall(glValidateProgram(program));
 
@@ -100,44 +147,282 @@ unsigned int Shader::CreateShader(const std::string& vertexShader, const std::st
     return program;
 }
 
+/*
+ * Returns the path of the cached binary for these sources.
+ * The file name is a hash (64-bit FNV-1a) of both sources and the GL renderer + version, because a binary
+ * is only valid for the exact driver that created it.
+ */
+std::string Shader::GetBinaryCachePath(const ShaderProgramSource& source)
+{
+    unsigned long long hash = 14695981039346656037ull;
+    auto hashString = [&hash](const char* string)
+    {
+        // Include the terminator so "ab" + "c" and "a" + "bc" hash differently
+        do
+        {
+            hash ^= (unsigned char)*string;
+            hash *= 1099511628211ull;
+        } while (*string++);
+    };
+
+    hashString(source.VertexSource.c_str());
+    hashString(source.FragmentSource.c_str());
+    GLCall(hashString((const char*)glGetString(GL_RENDERER)));
+    GLCall(hashString((const char*)glGetString(GL_VERSION)));
+
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bin", hash);
+    return std::string(s_BinaryCacheDirectory) + "/" + name;
+}
+
+/*
+ * Creates a program from a cached binary.
+ * Returns 0 if there is no cached binary, or if the driver rejects it (for example after a driver update).
+ */
+unsigned int Shader::LoadProgramBinary(const std::string& cachePath)
+{
+    std::error_code error;
+    unsigned long long fileSize = std::filesystem::file_size(cachePath, error);
+    if (error)
+        return 0;
+
+    std::ifstream file(cachePath, std::ios::binary);
+    if (!file)
+        return 0;
+
+    // Header: magic, binary format, binary length. A truncated or corrupt file must not size the allocation.
+    unsigned int header[3];
+    if (!file.read((char*)header, sizeof(header)) || header[0] != s_BinaryCacheMagic)
+        return 0;
+    if (header[2] == 0 || header[2] != fileSize - sizeof(header))
+        return 0;
+
+    std::vector<char> binary(header[2]);
+    if (!file.read(binary.data(), binary.size()))
+        return 0;
+
+    GLCall(unsigned int program = glCreateProgram());
+
+    // Not wrapped in GLCall: a driver that no longer accepts the format raises GL_INVALID_ENUM, which only
+    // means the cache is stale. The link status below reports it, so the error is cleared instead of asserting.
+    glProgramBinary(program, header[1], binary.data(), (GLsizei)binary.size());
+    GLClearError();
+
+    int linked;
+    GLCall(glGetProgramiv(program, GL_LINK_STATUS, &linked));
+    if (linked == GL_FALSE)
+    {
+        std::cout << "Cached shader binary " << cachePath << " was rejected, compiling instead." << std::endl;
+        GLCall(glDeleteProgram(program));
+        return 0;
+    }
+    return program;
+}
+
+/*
+ * Saves the linked [program]'s binary to the cache.
+ */
+void Shader::SaveProgramBinary(unsigned int program, const std::string& cachePath)
+{
+    int length = 0;
+    GLCall(glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length));
+    if (length <= 0)
+        return;
+
+    std::vector<char> binary(length);
+    GLenum format;
+    GLCall(glGetProgramBinary(program, length, &length, &format, binary.data()));
+
+    std::error_code error;
+    std::filesystem::create_directories(s_BinaryCacheDirectory, error);
+    std::ofstream file(cachePath, std::ios::binary);
+    if (!file)
+    {
+        std::cout << "Warning: could not write shader binary cache " << cachePath << std::endl;
+        return;
+    }
+
+    unsigned int header[3] = { s_BinaryCacheMagic, format, (unsigned int)length };
+    file.write((const char*)header, sizeof(header));
+    file.write(binary.data(), length);
+}
+
+/*
+ * Program binaries need OpenGL 4.1 or ARB_get_program_binary, and a driver that supports at least one format.
+ */
+bool Shader::IsBinaryCacheSupported()
+{
+    if (!GLEW_VERSION_4_1 && !GLEW_ARB_get_program_binary)
+        return false;
+
+    int formats = 0;
+    GLCall(glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats));
+    return formats > 0;
+}
+
+/*
+ * Deletes every cached program binary.
+ */
+void Shader::ClearBinaryCache()
+{
+    std::error_code error;
+    std::filesystem::remove_all(s_BinaryCacheDirectory, error);
+}
+
 void Shader::Bind() const
 {
-    GLCall(glUseProgram(m_RendererID));
+    GLStateCache::UseProgram(m_RendererID);
 }
 
 void Shader::Unbind() const
 {
-    GLCall(glUseProgram(0));
+    GLStateCache::UseProgram(0);
 }
 
-void Shader::SetUniform1i(const std::string& name, int value)
+void Shader::SetUniform1i(std::string_view name, int value)
 {
-    GLCall(glUniform1i(GetUniformLocation(name), value));
+    SetUniform1i(GetUniformHandle(name), value);
 }
 
-void Shader::SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3)
+void Shader::SetUniform1iv(std::string_view name, int count, const int* values)
 {
-    GLCall(glUniform4f(GetUniformLocation(name), v0, v1, v2, v3));
+    SetUniform1iv(GetUniformHandle(name), count, values);
 }
 
-void Shader::SetUniformMat4f(const std::string& name, const glm::mat4& matrix)
+void Shader::SetUniform4f(std::string_view name, float v0, float v1, float v2, float v3)
 {
-    GLCall(glUniformMatrix4fv(GetUniformLocation(name), 1, GL_FALSE, &matrix[0][0]));
+    SetUniform4f(GetUniformHandle(name), v0, v1, v2, v3);
 }
 
+void Shader::SetUniformMat4f(std::string_view name, const glm::mat4& matrix)
+{
+    SetUniformMat4f(GetUniformHandle(name), matrix);
+}
 
+void Shader::SetUniform1i(UniformHandle uniform, int value)
+{
+    GLCall(glUniform1i(uniform.Location, value));
+}
 
-int Shader::GetUniformLocation(const std::string& name)
+void Shader::SetUniform1iv(UniformHandle uniform, int count, const int* values)
 {
-    if (m_UniformsLocationCache.find(name) != m_UniformsLocationCache.end())
-        return m_UniformsLocationCache[name];
+    GLCall(glUniform1iv(uniform.Location, count, values));
+}
 
+void Shader::SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3)
+{
+    GLCall(glUniform4f(uniform.Location, v0, v1, v2, v3));
+}
 
-    GLCall(int location = glGetUniformLocation(m_RendererID, name.c_str()));
-    if (location == -1) // If uniform is not in shader OR not used in shader
+void Shader::SetUniformMat4f(UniformHandle uniform, const glm::mat4& matrix)
+{
+    ASSERT(uniform.Type == GL_FLOAT_MAT4 || uniform.Type == 0);	// Type is 0 when it was not reflected
+    GLCall(glUniformMatrix4fv(uniform.Location, 1, GL_FALSE, &matrix[0][0]));
+}
+
+/*
+ * Finds a uniform by name with a binary search over the reflected uniforms.
+ * Names that are not active uniforms are asked to OpenGL once and remembered (with a warning if they
+ * do not exist), so only the first lookup of an unknown name allocates.
+ */
+UniformHandle Shader::GetUniformHandle(std::string_view name)
+{
+    auto it = std::lower_bound(m_Uniforms.begin(), m_Uniforms.end(), name,
+        [](const UniformInfo& uniform, std::string_view name) { return uniform.Name < name; });
+    if (it != m_Uniforms.end() && it->Name == name)
+        return it->Handle;
+
+    UniformInfo uniform;
+    uniform.Name = std::string(name);
+    GLCall(uniform.Handle.Location = glGetUniformLocation(m_RendererID, uniform.Name.c_str()));
+    if (uniform.Handle.Location == -1) // If uniform is not in shader OR not used in shader
     {
         std::cout << "Warning: uniform '" << name << "' doesn't exist!" << std::endl;
     }
-    m_UniformsLocationCache[name] = location;
-    return location;
+    return m_Uniforms.insert(it, uniform)->Handle;
+}
+
+/*
+ * Connects this program's uniform block [blockName] to [bindingPoint].
+ * Returns false if the program has no active block with that name.
+ */
+bool Shader::BindUniformBlock(std::string_view blockName, unsigned int bindingPoint)
+{
+    std::string name(blockName);
+    GLCall(unsigned int index = glGetUniformBlockIndex(m_RendererID, name.c_str()));
+    if (index == GL_INVALID_INDEX)
+        return false;
+
+    GLCall(glUniformBlockBinding(m_RendererID, index, bindingPoint));
+    return true;
+}
+
+/*
+ * Registers the binding point for uniform blocks named [blockName], for every Shader created afterwards.
+ * The blocks in UniformBlockBinding are registered from the start.
+ */
+void Shader::SetUniformBlockBinding(std::string_view blockName, unsigned int bindingPoint)
+{
+    for (auto& binding : s_UniformBlockBindings)
+    {
+        if (binding.first == blockName)
+        {
+            binding.second = bindingPoint;
+            return;
+        }
+    }
+    s_UniformBlockBindings.emplace_back(std::string(blockName), bindingPoint);
+}
+
+/*
+ * Connects every registered uniform block this program uses to its binding point.
+ */
+void Shader::BindUniformBlocks()
+{
+    int blockCount = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_BLOCKS, &blockCount));
+    if (blockCount == 0)
+        return;
+
+    for (const auto& binding : s_UniformBlockBindings)
+        BindUniformBlock(binding.first, binding.second);
+}
+
+/*
+ * Fills the uniform table with every active uniform of the linked program.
+ * Uniforms inside uniform blocks have no location, so they are left out.
+ */
+void Shader::ReflectUniforms()
+{
+    m_Uniforms.clear();
+
+    int count = 0, maxLength = 0;
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORMS, &count));
+    GLCall(glGetProgramiv(m_RendererID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength));
+    if (count == 0 || maxLength == 0)
+        return;
+
+    std::vector<char> name(maxLength);
+    for (int i = 0; i < count; i++)
+    {
+        int length = 0, size = 0;
+        GLenum type = 0;
+        GLCall(glGetActiveUniform(m_RendererID, i, maxLength, &length, &size, &type, name.data()));
+
+        UniformInfo uniform;
+        uniform.Name.assign(name.data(), length);
+        GLCall(uniform.Handle.Location = glGetUniformLocation(m_RendererID, uniform.Name.c_str()));
+        uniform.Handle.Type = type;
+        if (uniform.Handle.Location == -1)
+            continue;
+
+        // Arrays are reported as "name[0]", but are looked up by "name"
+        if (uniform.Name.size() > 3 && uniform.Name.compare(uniform.Name.size() - 3, 3, "[0]") == 0)
+            uniform.Name.resize(uniform.Name.size() - 3);
+
+        m_Uniforms.push_back(uniform);
+    }
+
+    std::sort(m_Uniforms.begin(), m_Uniforms.end(),
+        [](const UniformInfo& a, const UniformInfo& b) { return a.Name < b.Name; });
 }
@@ -1,6 +1,7 @@
 #pragma once
 #include <string>
-#include <unordered_map>
+#include <string_view>
+#include <vector>
 
 #include "glm/glm.hpp"
 
@@ -9,11 +10,53 @@ struct ShaderProgramSource {
 	std::string FragmentSource;
 };
 
+/*
+ * UniformHandle
+ * A uniform's location and GL type, looked up once with Shader::GetUniformHandle() and then
+ * passed to the SetUniform methods, which skips the name lookup entirely.
+ * The handle is only valid for the Shader that created it.
+ */
+struct UniformHandle {
+	int Location = -1;
+	unsigned int Type = 0;	// GLenum type of the uniform (GL_FLOAT_MAT4, GL_SAMPLER_2D, ...)
+
+	inline bool IsValid() const { return Location != -1; }
+};
+
+/*
+ * Shader
+ * Compiles and links a shader program from a vertex and fragment shader file.
+ *
+ * Linked programs are saved to a binary cache (cache/shaders/) keyed by a hash of both sources and the
+ * GL renderer and version. Later constructions with the same sources load the binary with glProgramBinary
+ * instead of compiling, and fall back to compiling if the driver rejects it.
+ *
+ * The active uniforms are reflected after linking into a table sorted by name. Uniforms can be set by name
+ * (a binary search, no allocation) or, faster, through a UniformHandle cached by the caller.
+ *
+ * Uniform blocks are connected to the binding point registered for their name (see SetUniformBlockBinding()),
+ * so every program reads a shared block like "Camera" from the same UniformBuffer.
+ */
 class Shader {
 private:
+	/*
+	 * An active uniform of the linked program
+	 */
+	struct UniformInfo {
+		std::string Name;		// Without the "[0]" suffix for arrays
+		UniformHandle Handle;
+	};
+
 	unsigned int m_RendererID;
-	// Cache for uniform
-	std::unordered_map<std::string, int> m_UniformsLocationCache;
+	// Reflected uniforms, sorted by name
+	std::vector<UniformInfo> m_Uniforms;
+
+	bool m_LoadedFromBinary;	// True if the program came from the binary cache
+	float m_LoadMs;				// Time spent creating the program, including reading the files but not saving the binary cache
+
+	static bool s_BinaryCacheEnabled;
+	// Uniform block name -> binding point, applied to every program when it is created
+	static std::vector<std::pair<std::string, unsigned int>> s_UniformBlockBindings;
 public:
 	Shader(const std::string& vertexShaderFilepath, const std::string& fragmentShaderFilepath);
 	~Shader();
@@ -21,15 +64,39 @@ public:
 	void Bind() const;
 	void Unbind() const;
 
+	UniformHandle GetUniformHandle(std::string_view name);
+	bool BindUniformBlock(std::string_view blockName, unsigned int bindingPoint);
+	static void SetUniformBlockBinding(std::string_view blockName, unsigned int bindingPoint);
+
 	// Set uniforms
-	void SetUniform1i(const std::string& name, int value);
-	void SetUniform4f(const std::string& name, float v0, float v1, float v2, float v3);
-	void SetUniformMat4f(const std::string& name, const glm::mat4& matrix);
+	void SetUniform1i(std::string_view name, int value);
+	void SetUniform1iv(std::string_view name, int count, const int* values);
+	void SetUniform4f(std::string_view name, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(std::string_view name, const glm::mat4& matrix);
+
+	void SetUniform1i(UniformHandle uniform, int value);
+	void SetUniform1iv(UniformHandle uniform, int count, const int* values);
+	void SetUniform4f(UniformHandle uniform, float v0, float v1, float v2, float v3);
+	void SetUniformMat4f(UniformHandle uniform, const glm::mat4& matrix);
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline bool IsLoadedFromBinary() const { return m_LoadedFromBinary; }
+	inline float GetLoadMs() const { return m_LoadMs; }
+
+	// Program binary cache
+	static bool IsBinaryCacheSupported();
+	inline static void SetBinaryCacheEnabled(bool enabled) { s_BinaryCacheEnabled = enabled; }
+	static void ClearBinaryCache();
 
 private:
 	ShaderProgramSource ParseShader(const std::string& vertexFilepath, const std::string& fragFilepath);
 	unsigned int CompileShader(unsigned int type, const std::string& source);
 	unsigned int CreateShader(const std::string& vertexShader, const std::string& fragmentShader);
 
-	int GetUniformLocation(const std::string& name);
+	std::string GetBinaryCachePath(const ShaderProgramSource& source);
+	unsigned int LoadProgramBinary(const std::string& cachePath);
+	void SaveProgramBinary(unsigned int program, const std::string& cachePath);
+
+	void ReflectUniforms();
+	void BindUniformBlocks();
 };
\ No newline at end of file
@@ -0,0 +1,159 @@
+#include "StreamingVertexBuffer.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+StreamingVertexBuffer::StreamingVertexBuffer(unsigned int frameSize, StreamingMode mode)
+	: m_RendererID(0), m_Mode(mode), m_FrameSize(frameSize), m_Cursor(0), m_FrameStarted(false),
+	m_MappedData(nullptr), m_Region(0), m_Fences{ nullptr, nullptr, nullptr }, m_Stats{ 0, 0.0, 0 }
+{
+	if (m_Mode == StreamingMode::PersistentRing && !IsPersistentMappingSupported())
+	{
+		std::cout << "Warning: ARB_buffer_storage is not supported, streaming with buffer orphaning instead." << std::endl;
+		m_Mode = StreamingMode::Orphaning;
+	}
+
+	GLCall(glGenBuffers(1, &m_RendererID));
+	Bind();
+
+	if (m_Mode == StreamingMode::PersistentRing)
+	{
+		// Immutable storage that stays mapped for the lifetime of the buffer.
+		// Coherent mapping means writes become visible to the GPU without an explicit flush.
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+		GLCall(glBufferStorage(GL_ARRAY_BUFFER, (GLsizeiptr)m_FrameSize * FramesInFlight, nullptr, flags));
+		GLCall(m_MappedData = (unsigned char*)glMapBufferRange(GL_ARRAY_BUFFER, 0, (GLsizeiptr)m_FrameSize * FramesInFlight, flags));
+		ASSERT(m_MappedData);
+	}
+	else
+	{
+		GLCall(glBufferData(GL_ARRAY_BUFFER, m_FrameSize, nullptr, GL_STREAM_DRAW));
+	}
+}
+
+StreamingVertexBuffer::~StreamingVertexBuffer()
+{
+	for (void* fence : m_Fences)
+	{
+		if (fence)
+		{
+			GLCall(glDeleteSync((GLsync)fence));
+		}
+	}
+
+	if (m_MappedData)
+	{
+		Bind();
+		GLCall(glUnmapBuffer(GL_ARRAY_BUFFER));
+	}
+	GLStateCache::OnBufferDeleted(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+/*
+ * Copies [size] bytes into this frame's part of the buffer.
+ * Returns the byte offset from the start of the buffer where the data now lives.
+ */
+unsigned int StreamingVertexBuffer::Upload(const void* data, unsigned int size)
+{
+	if (!m_FrameStarted)
+		BeginFrame();
+
+	ASSERT(m_Cursor + size <= m_FrameSize);	// More data in one frame than the buffer was created for
+
+	auto start = std::chrono::steady_clock::now();
+	unsigned int offset;
+	if (m_Mode == StreamingMode::PersistentRing)
+	{
+		offset = m_Region * m_FrameSize + m_Cursor;
+		std::memcpy(m_MappedData + offset, data, size);
+	}
+	else
+	{
+		offset = m_Cursor;
+		Bind();
+		GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+		m_Stats.StallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	m_Cursor += size;
+	m_Stats.BytesUploaded += size;
+	return offset;
+}
+
+/*
+ * Prepares the buffer for the first upload of a frame.
+ */
+void StreamingVertexBuffer::BeginFrame()
+{
+	auto start = std::chrono::steady_clock::now();
+
+	if (m_Mode == StreamingMode::PersistentRing)
+	{
+		// Wait until the GPU is done with the last frame that used this region
+		GLsync fence = (GLsync)m_Fences[m_Region];
+		if (fence)
+		{
+			GLenum result;
+			do
+			{
+				GLCall(result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 1000000));	// 1 ms
+			} while (result == GL_TIMEOUT_EXPIRED);
+
+			GLCall(glDeleteSync(fence));
+			m_Fences[m_Region] = nullptr;
+		}
+	}
+	else
+	{
+		// Orphan the old storage, so we never write to memory the GPU is still reading
+		Bind();
+		GLCall(glBufferData(GL_ARRAY_BUFFER, m_FrameSize, nullptr, GL_STREAM_DRAW));
+	}
+
+	m_Stats.StallMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_Cursor = 0;
+	m_FrameStarted = true;
+}
+
+/*
+ * Marks the end of the frame's draw calls. Must be called after the draws that read this frame's data.
+ */
+void StreamingVertexBuffer::EndFrame()
+{
+	if (!m_FrameStarted)
+		return;
+
+	if (m_Mode == StreamingMode::PersistentRing)
+	{
+		// Signalled once the GPU has executed every command that reads this region
+		GLCall(m_Fences[m_Region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+		m_Region = (m_Region + 1) % FramesInFlight;
+	}
+
+	m_FrameStarted = false;
+	m_Stats.Frames++;
+}
+
+void StreamingVertexBuffer::ResetStats()
+{
+	m_Stats = { 0, 0.0, 0 };
+}
+
+bool StreamingVertexBuffer::IsPersistentMappingSupported()
+{
+	return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+void StreamingVertexBuffer::Bind() const
+{
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
+}
+
+void StreamingVertexBuffer::Unbind() const
+{
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/*
+ * StreamingVertexBuffer.h
+ * A vertex buffer for geometry that is rewritten every frame.
+ * The GPU may still be reading last frame's vertices while the CPU writes this frame's, so the buffer
+ * uses one of two strategies to avoid waiting on it:
+ *
+ *		Orphaning - glBufferData(nullptr) at the start of each frame hands the old storage back to the driver
+ *			and gives us fresh storage, then the data is copied in with glBufferSubData.
+ *		PersistentRing - the buffer is allocated once with glBufferStorage (ARB_buffer_storage) and stays mapped.
+ *			It is split into 3 regions, one per frame in flight, and each region is fenced with glFenceSync
+ *			so the CPU only waits if it gets 3 frames ahead of the GPU.
+ *
+ * Usage:
+ *		Create the buffer with the most bytes that will be uploaded in a single frame.
+ *		Add it to a VertexArrayObject with AddBuffer(), like a VertexBuffer.
+ *		Call Upload() with this frame's vertices. It returns the byte offset the data was written to,
+ *		so draw with a base vertex of (offset / stride).
+ *		Call EndFrame() after the draw calls that use this frame's data.
+ *
+ *		PersistentRing falls back to Orphaning when the context does not support ARB_buffer_storage.
+ */
+
+enum class StreamingMode
+{
+	Orphaning,
+	PersistentRing
+};
+
+/*
+ * StreamingStats
+ * Upload counters, used to compare the two streaming modes.
+ */
+struct StreamingStats
+{
+	unsigned long long BytesUploaded;
+	double StallMs;			// CPU time spent waiting on fences (ring) or inside glBufferData/glBufferSubData (orphaning)
+	unsigned int Frames;
+};
+
+class StreamingVertexBuffer
+{
+public:
+	static const unsigned int FramesInFlight = 3;
+
+private:
+	unsigned int m_RendererID;
+	StreamingMode m_Mode;
+	unsigned int m_FrameSize;	// Bytes available to a single frame
+	unsigned int m_Cursor;		// Bytes written so far this frame
+	bool m_FrameStarted;
+
+	// PersistentRing only
+	unsigned char* m_MappedData;
+	unsigned int m_Region;		// Region of the ring used by the current frame
+	void* m_Fences[FramesInFlight];	// GLsync objects, one per region
+
+	StreamingStats m_Stats;
+
+public:
+	StreamingVertexBuffer(unsigned int frameSize, StreamingMode mode);
+	~StreamingVertexBuffer();
+
+	unsigned int Upload(const void* data, unsigned int size);
+	void EndFrame();
+
+	void Bind() const;
+	void Unbind() const;
+
+	inline StreamingMode GetMode() const { return m_Mode; }
+	inline const StreamingStats& GetStats() const { return m_Stats; }
+	void ResetStats();
+
+	static bool IsPersistentMappingSupported();
+
+private:
+	void BeginFrame();
+};
@@ -1,46 +1,330 @@
 #include "Texture.h"
 #include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "KtxFile.h"
+#include "MipmapGenerator.h"
+#include "PixelConvert.h"
+#include "Profiler.h"
+#include "TextureCache.h"
 #include "stb_image/stb_image.h"
 
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
 
-Texture::Texture(const std::string& filepath)
-	: m_RendererID(0), m_Filepath(filepath), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0)
+// Magenta pixel used when an image fails to load
+static const unsigned char s_MissingPixel[4] = { 255, 0, 255, 255 };
+
+static GLint ToGLWrap(TextureWrap wrap)
 {
-	// Load file to CPU
-	stbi_set_flip_vertically_on_load(1);	// Flip texture for OpenGL because OpenGL (0,0) is bottom left
-	m_LocalBuffer = stbi_load(filepath.c_str(), &m_Width, &m_Height, &m_BPP, 4);
+	switch (wrap)
+	{
+	case TextureWrap::Repeat:			return GL_REPEAT;
+	case TextureWrap::MirroredRepeat:	return GL_MIRRORED_REPEAT;
+	default:							return GL_CLAMP_TO_EDGE;
+	}
+}
 
-	// Create texture in OpenGL
-	GLCall(glGenTextures(1, &m_RendererID));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+static GLenum ToGLCompressedFormat(BlockFormat format, bool srgb)
+{
+	switch (format)
+	{
+	case BlockFormat::BC1:	return srgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+	case BlockFormat::BC3:	return srgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+	default:				return srgb ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GL_COMPRESSED_RGBA_BPTC_UNORM;
+	}
+}
 
-	/* Required parameters to set for OpenGL */
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR));	// Setting an integer texture parameter
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));	// Horizontal wrap (S)	(S, T) is like (x, y)
-	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));	// Horizontal wrap (T)
+static bool HasExtension(const std::string& filepath, const std::string& extension)
+{
+	return filepath.size() >= extension.size() && filepath.compare(filepath.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+Texture::Texture(const std::string& filepath, const TextureSpec& spec)
+	: m_RendererID(0), m_Filepath(filepath), m_LocalBuffer(nullptr), m_Width(0), m_Height(0), m_BPP(0), m_Spec(spec),
+	m_MemorySize(0), m_Resident(true)
+{
+	PROFILE_SCOPE("Texture load");
+
+	// Block compressed textures are uploaded as they are, with the mip levels stored in the file
+	if (HasExtension(filepath, ".ktx2") && LoadCompressed(filepath))
+		return;
+
+	// Pixels decoded by an earlier load are uploaded straight from the mapped cache file
+	CachedImage cached;
+	if (TextureCache::Open(filepath, cached))
+	{
+		m_Width = cached.GetWidth();
+		m_Height = cached.GetHeight();
+		m_BPP = 4;
+		m_RendererID = CreateStorage(m_Spec, m_Width, m_Height);
+		m_MemorySize = GetMemorySize(m_Spec, m_Width, m_Height);
+		Upload(cached.GetPixels());
+		Unbind();
+		return;
+	}
+
+	// Load file to CPU
+	m_LocalBuffer = DecodeImage(filepath, m_Width, m_Height);
+	m_BPP = 4;
+
+	if (m_LocalBuffer)
+	{
+		TextureCache::Store(filepath, m_Width, m_Height, m_LocalBuffer);
+	}
+	else
+	{
+		std::cout << "Warning: failed to load texture " << filepath << ": " << stbi_failure_reason() << std::endl;
+		m_Width = m_Height = 1;
+	}
 
-	// Load in the actual data (or at least allocate the space for the data
-	GLCall(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, m_Width, m_Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, m_LocalBuffer));
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	// Create texture in OpenGL and load in the actual data
+	m_RendererID = CreateStorage(m_Spec, m_Width, m_Height);
+	m_MemorySize = GetMemorySize(m_Spec, m_Width, m_Height);
+	Upload(m_LocalBuffer ? m_LocalBuffer : s_MissingPixel);
+	Unbind();
 
 	// Remove data from CPU
 	if (m_LocalBuffer)
 		stbi_image_free(m_LocalBuffer);
+	m_LocalBuffer = nullptr;
+}
+
+Texture::Texture(int width, int height, const unsigned char* data, const TextureSpec& spec)
+	: m_RendererID(0), m_LocalBuffer(nullptr), m_Width(width), m_Height(height), m_BPP(4), m_Spec(spec),
+	m_MemorySize(0), m_Resident(true)
+{
+	m_RendererID = CreateStorage(m_Spec, m_Width, m_Height);
+	m_MemorySize = GetMemorySize(m_Spec, m_Width, m_Height);
+	Upload(data);
+	Unbind();
 }
 
 Texture::~Texture()
 {
+	GLStateCache::OnTextureDeleted(m_RendererID);
 	GLCall(glDeleteTextures(1, &m_RendererID));
 }
 
 void Texture::Bind(unsigned int slot) const
 {
-	GLCall(glActiveTexture(GL_TEXTURE0 + slot));
-	GLCall(glBindTexture(GL_TEXTURE_2D, m_RendererID));
+	GLStateCache::BindTexture(slot, m_RendererID);
 }
 
 void Texture::Unbind() const
 {
-	GLCall(glBindTexture(GL_TEXTURE_2D, 0));
+	GLStateCache::BindTexture(GLStateCache::GetActiveTextureUnit(), 0);
+}
+
+/*
+ * Decodes the image at [filepath] to RGBA8, bottom row first, because OpenGL's (0, 0) is the bottom left.
+ * Returns nullptr if it fails (see stbi_failure_reason()). Free the pixels with stbi_image_free().
+ */
+unsigned char* Texture::DecodeImage(const std::string& filepath, int& width, int& height)
+{
+	PROFILE_SCOPE("Texture::DecodeImage");
+
+	// RGB images are decoded as they are and expanded with PixelConvert, instead of by stb_image one pixel at a time
+	int channels;
+	if (!stbi_info(filepath.c_str(), &width, &height, &channels))
+		return nullptr;
+
+	int loadChannels = channels == 3 ? 3 : 4;
+	unsigned char* pixels = stbi_load(filepath.c_str(), &width, &height, &channels, loadChannels);
+	if (!pixels)
+		return nullptr;
+
+	// Flipped before expanding, while there are fewer bytes to move
+	PixelConvert::FlipVertical(pixels, width, height, loadChannels);
+
+	if (loadChannels == 3)
+	{
+		// stb_image allocates with malloc, so the buffer can grow with realloc and still go to stbi_image_free()
+		unsigned char* expanded = (unsigned char*)std::realloc(pixels, (size_t)width * height * 4);
+		if (!expanded)
+		{
+			stbi_image_free(pixels);
+			return nullptr;
+		}
+		pixels = expanded;
+		PixelConvert::ExpandRGBToRGBA(pixels, (size_t)width * height);
+	}
+	return pixels;
+}
+
+/*
+ * Fills every level of the bound texture from the RGBA8 [data] of level 0, as the spec's mipmap mode says.
+ */
+void Texture::Upload(const unsigned char* data)
+{
+	// [data] may be a mapped cache file, so premultiplying works on a copy
+	std::vector<unsigned char> premultiplied;
+	if (m_Spec.PremultiplyAlpha)
+	{
+		premultiplied.assign(data, data + (size_t)m_Width * m_Height * 4);
+		PixelConvert::PremultiplyAlpha(premultiplied.data(), (size_t)m_Width * m_Height);
+		data = premultiplied.data();
+	}
+
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_Width, m_Height, GL_RGBA, GL_UNSIGNED_BYTE, data));
+
+	if (m_Spec.Mipmaps == MipmapMode::GenerateGPU)
+	{
+		GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	}
+	else if (m_Spec.Mipmaps == MipmapMode::BoxCPU || m_Spec.Mipmaps == MipmapMode::KaiserCPU)
+	{
+		MipmapFilter filter = m_Spec.Mipmaps == MipmapMode::BoxCPU ? MipmapFilter::Box : MipmapFilter::Kaiser;
+		std::vector<std::vector<unsigned char>> levels = MipmapGenerator::Generate(data, m_Width, m_Height, filter,
+			m_Spec.SRGB, m_Spec.WrapS != TextureWrap::ClampToEdge, m_Spec.WrapT != TextureWrap::ClampToEdge);
+
+		int width = m_Width, height = m_Height;
+		for (size_t i = 0; i < levels.size(); i++)
+		{
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+			GLCall(glTexSubImage2D(GL_TEXTURE_2D, (GLint)i + 1, 0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, levels[i].data()));
+		}
+	}
+}
+
+/*
+ * Loads a KTX2 file written by the TextureCompressor tool. Returns false (leaving the texture empty)
+ * when the file can't be read or the driver doesn't support its format, so the caller can fall back.
+ */
+bool Texture::LoadCompressed(const std::string& filepath)
+{
+	KtxFile file;
+	if (!file.Read(filepath))
+		return false;
+
+	if (!IsCompressedFormatSupported(file.Format))
+	{
+		std::cout << "Warning: " << BlockCompressor::GetFormatName(file.Format) << " textures are not supported by this driver ("
+			<< filepath << ")" << std::endl;
+		return false;
+	}
+
+	m_Width = file.Width;
+	m_Height = file.Height;
+	m_BPP = 4;
+	m_Spec.SRGB = file.SRGB;
+	m_Spec.Mipmaps = file.Levels.size() > 1 ? MipmapMode::Prebuilt : MipmapMode::None;
+
+	GLenum internalFormat = ToGLCompressedFormat(file.Format, file.SRGB);
+	m_RendererID = CreateStorage(m_Spec, m_Width, m_Height, (int)file.Levels.size(), internalFormat);
+
+	bool immutable = IsImmutableStorageSupported();
+	for (size_t level = 0; level < file.Levels.size(); level++)
+	{
+		int width = std::max(m_Width >> level, 1);
+		int height = std::max(m_Height >> level, 1);
+		GLsizei size = (GLsizei)file.Levels[level].size();
+		if (immutable)
+		{
+			GLCall(glCompressedTexSubImage2D(GL_TEXTURE_2D, (GLint)level, 0, 0, width, height, internalFormat, size, file.Levels[level].data()));
+		}
+		else
+		{
+			GLCall(glCompressedTexImage2D(GL_TEXTURE_2D, (GLint)level, internalFormat, width, height, 0, size, file.Levels[level].data()));
+		}
+	}
+	Unbind();
+
+	m_MemorySize = file.GetDataSize();
+	return true;
+}
+
+int Texture::GetLevelCount(const TextureSpec& spec, int width, int height)
+{
+	return spec.Mipmaps == MipmapMode::None ? 1 : MipmapGenerator::GetLevelCount(width, height);
+}
+
+size_t Texture::GetMemorySize(const TextureSpec& spec, int width, int height)
+{
+	size_t size = 0;
+	for (int level = GetLevelCount(spec, width, height); level > 0; level--)
+	{
+		size += (size_t)width * height * 4;
+		width = std::max(width / 2, 1);
+		height = std::max(height / 2, 1);
+	}
+	return size;
+}
+
+/*
+ * Creates a texture with storage for every level the spec needs and sets its sampling parameters.
+ * The texture is left bound to the active unit, with the contents undefined.
+ * [levels] and [internalFormat] override the ones derived from the spec (0 keeps them).
+ * Without immutable storage, compressed levels are left for glCompressedTexImage2D to allocate.
+ */
+unsigned int Texture::CreateStorage(const TextureSpec& spec, int width, int height, int levels, unsigned int internalFormat)
+{
+	unsigned int id;
+	GLCall(glGenTextures(1, &id));
+	GLStateCache::BindTexture(GLStateCache::GetActiveTextureUnit(), id);
+
+	/* Required parameters to set for OpenGL */
+	bool compressed = internalFormat != 0;
+	if (levels == 0)
+		levels = GetLevelCount(spec, width, height);
+	if (!compressed)
+		internalFormat = spec.SRGB ? GL_SRGB8_ALPHA8 : GL_RGBA8;
+
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levels > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, ToGLWrap(spec.WrapS)));	// Horizontal wrap (S)	(S, T) is like (x, y)
+	GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, ToGLWrap(spec.WrapT)));	// Vertical wrap (T)
+
+	float anisotropy = std::min(spec.Anisotropy, GetMaxAnisotropy());
+	if (anisotropy > 1.0f)
+	{
+		GLCall(glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, anisotropy));
+	}
+
+	// Storage can't be filled from client memory while a pixel unpack buffer is bound
+	GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	if (IsImmutableStorageSupported())
+	{
+		// Immutable: the size and level count are fixed, so the driver never has to check the texture is complete
+		GLCall(glTexStorage2D(GL_TEXTURE_2D, levels, internalFormat, width, height));
+	}
+	else
+	{
+		for (int level = 0; level < levels && !compressed; level++)
+		{
+			GLCall(glTexImage2D(GL_TEXTURE_2D, level, internalFormat, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+			width = std::max(width / 2, 1);
+			height = std::max(height / 2, 1);
+		}
+		GLCall(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1));
+	}
+
+	return id;
+}
+
+bool Texture::IsImmutableStorageSupported()
+{
+	return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+}
+
+bool Texture::IsCompressedFormatSupported(BlockFormat format)
+{
+	if (format == BlockFormat::BC7)
+		return GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+	return GLEW_EXT_texture_compression_s3tc;
+}
+
+/*
+ * Highest anisotropy the driver supports, or 1 without anisotropic filtering
+ */
+float Texture::GetMaxAnisotropy()
+{
+	if (!GLEW_EXT_texture_filter_anisotropic && !GLEW_ARB_texture_filter_anisotropic)
+		return 1.0f;
+
+	float maxAnisotropy = 1.0f;
+	GLCall(glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &maxAnisotropy));
+	return maxAnisotropy;
 }
@@ -1,20 +1,77 @@
 #pragma once
 
+#include "BlockCompression.h"
+
 #include <string>
 
+enum class MipmapMode
+{
+	None,			// Single level, GL_LINEAR minification
+	GenerateGPU,	// glGenerateMipmap after the upload
+	BoxCPU,			// Levels built on the CPU with a box filter (see MipmapGenerator)
+	KaiserCPU,		// Levels built on the CPU with a Kaiser-windowed sinc filter
+	Prebuilt		// Levels read from a file (KTX2), nothing is generated
+};
+
+enum class TextureWrap
+{
+	ClampToEdge,
+	Repeat,
+	MirroredRepeat
+};
+
+/*
+ * TextureSpec
+ * How a texture is stored and sampled. The default matches a plain sprite: one level, clamped, linear color.
+ */
+struct TextureSpec
+{
+	MipmapMode Mipmaps = MipmapMode::None;
+	float Anisotropy = 1.0f;	// Max anisotropic samples, 1 disables it. Clamped to what the driver supports
+	TextureWrap WrapS = TextureWrap::ClampToEdge;
+	TextureWrap WrapT = TextureWrap::ClampToEdge;
+	bool SRGB = false;			// Stored as GL_SRGB8_ALPHA8, so sampling returns linear values
+	bool PremultiplyAlpha = false;	// Color multiplied by alpha on upload. Draw with glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA)
+};
+
 class Texture {
 private:
 	unsigned int m_RendererID;
 	std::string m_Filepath;
 	unsigned char* m_LocalBuffer;
 	int m_Width, m_Height, m_BPP;
+	TextureSpec m_Spec;
+	size_t m_MemorySize;	// Bytes of every level on the GPU
+	bool m_Resident;	// False while a TextureLoader is still loading the image (a placeholder is bound instead)
+
+	friend class TextureLoader;
 public:
-	Texture(const std::string& filepath);
+	Texture(const std::string& filepath, const TextureSpec& spec = TextureSpec());
+	Texture(int width, int height, const unsigned char* data, const TextureSpec& spec = TextureSpec());	// RGBA8 pixels already in memory
 	~Texture();
 
 	void Bind(unsigned int slot = 0) const;
 	void Unbind() const;
 
+	inline unsigned int GetRendererID() const { return m_RendererID; }
 	inline int GetWidth() const { return m_Width; }
 	inline int GetHeight() const { return m_Height; }
-};
\ No newline at end of file
+	inline const TextureSpec& GetSpec() const { return m_Spec; }
+	inline size_t GetMemorySize() const { return m_MemorySize; }
+	inline bool IsResident() const { return m_Resident; }
+	inline const std::string& GetFilepath() const { return m_Filepath; }
+
+	static bool IsImmutableStorageSupported();
+	static float GetMaxAnisotropy();
+	static bool IsCompressedFormatSupported(BlockFormat format);
+
+	static unsigned char* DecodeImage(const std::string& filepath, int& width, int& height);
+
+private:
+	void Upload(const unsigned char* data);
+	bool LoadCompressed(const std::string& filepath);
+
+	static int GetLevelCount(const TextureSpec& spec, int width, int height);
+	static size_t GetMemorySize(const TextureSpec& spec, int width, int height);	// Of RGBA8 storage
+	static unsigned int CreateStorage(const TextureSpec& spec, int width, int height, int levels = 0, unsigned int internalFormat = 0);
+};
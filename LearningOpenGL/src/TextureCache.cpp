@@ -0,0 +1,273 @@
+#include "TextureCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+static const char* s_CacheDirectory = "cache/textures";
+static const unsigned int s_CacheMagic = 0x58544347;		// "GCTX"
+static const unsigned int s_CacheVersion = 1;
+static const unsigned int s_PixelAlignment = 4096;		// Pixels start on a page boundary of the mapping
+
+/*
+ * Start of every cache file. The source path follows it, then the pixels at DataOffset.
+ */
+struct CacheHeader
+{
+	unsigned int Magic;
+	unsigned int Version;
+	unsigned int Width, Height;
+	unsigned long long SourceSize;
+	long long SourceTime;
+	unsigned int PathLength;
+	unsigned int DataOffset;
+};
+
+bool TextureCache::s_Enabled = true;
+
+CachedImage::CachedImage()
+	: m_Mapping(nullptr), m_MappedSize(0), m_Pixels(nullptr), m_Width(0), m_Height(0)
+#ifdef _WIN32
+	, m_File(INVALID_HANDLE_VALUE), m_FileMapping(nullptr)
+#endif
+{
+}
+
+CachedImage::~CachedImage()
+{
+	Unmap();
+}
+
+/*
+ * Maps the whole file at [path] read only. Returns false if it can't be opened or is empty.
+ */
+bool CachedImage::Map(const std::string& path)
+{
+	Unmap();
+
+#ifdef _WIN32
+	m_File = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_File == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(m_File, &size) || size.QuadPart == 0)
+	{
+		Unmap();
+		return false;
+	}
+
+	m_FileMapping = CreateFileMappingA(m_File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	m_Mapping = m_FileMapping ? MapViewOfFile(m_FileMapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+	if (!m_Mapping)
+	{
+		Unmap();
+		return false;
+	}
+	m_MappedSize = (size_t)size.QuadPart;
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+		return false;
+
+	struct stat status;
+	if (fstat(file, &status) != 0 || status.st_size == 0)
+	{
+		close(file);
+		return false;
+	}
+
+	// The mapping keeps the file alive, so the descriptor can be closed straight away
+	void* mapping = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+	if (mapping == MAP_FAILED)
+		return false;
+
+	// The upload reads the file front to back once, so start reading it in now
+	madvise(mapping, (size_t)status.st_size, MADV_SEQUENTIAL);
+	madvise(mapping, (size_t)status.st_size, MADV_WILLNEED);
+	m_Mapping = mapping;
+	m_MappedSize = (size_t)status.st_size;
+#endif
+
+	return true;
+}
+
+void CachedImage::Unmap()
+{
+#ifdef _WIN32
+	if (m_Mapping)
+		UnmapViewOfFile(m_Mapping);
+	if (m_FileMapping)
+		CloseHandle(m_FileMapping);
+	if (m_File != INVALID_HANDLE_VALUE)
+		CloseHandle(m_File);
+	m_File = INVALID_HANDLE_VALUE;
+	m_FileMapping = nullptr;
+#else
+	if (m_Mapping)
+		munmap(m_Mapping, m_MappedSize);
+#endif
+
+	m_Mapping = nullptr;
+	m_MappedSize = 0;
+	m_Pixels = nullptr;
+	m_Width = m_Height = 0;
+}
+
+/*
+ * Maps the cache file of the image at [filepath] into [image]. Returns false if there is none for the
+ * image's current size and modification time, or the cache is disabled.
+ */
+bool TextureCache::Open(const std::string& filepath, CachedImage& image)
+{
+	unsigned long long sourceSize;
+	long long sourceTime;
+	if (!s_Enabled || !GetSourceKey(filepath, sourceSize, sourceTime))
+		return false;
+
+	if (!image.Map(GetCachePath(filepath, sourceSize, sourceTime)))
+		return false;
+
+	// Check the header matches, in case two keys hash the same or the file was cut short
+	const unsigned char* file = (const unsigned char*)image.m_Mapping;
+	CacheHeader header;
+	if (image.m_MappedSize < sizeof(header))
+	{
+		image.Unmap();
+		return false;
+	}
+	std::memcpy(&header, file, sizeof(header));
+
+	size_t pixelBytes = (size_t)header.Width * header.Height * 4;
+	bool valid = header.Magic == s_CacheMagic && header.Version == s_CacheVersion
+		&& header.SourceSize == sourceSize && header.SourceTime == sourceTime
+		&& header.PathLength == filepath.size() && sizeof(header) + header.PathLength <= header.DataOffset
+		&& header.DataOffset + pixelBytes <= image.m_MappedSize
+		&& std::memcmp(file + sizeof(header), filepath.data(), filepath.size()) == 0;
+	if (!valid)
+	{
+		image.Unmap();
+		return false;
+	}
+
+	image.m_Pixels = file + header.DataOffset;
+	image.m_Width = header.Width;
+	image.m_Height = header.Height;
+	return true;
+}
+
+/*
+ * Writes the decoded RGBA8 [pixels] of the image at [filepath] to its cache file.
+ */
+void TextureCache::Store(const std::string& filepath, int width, int height, const unsigned char* pixels)
+{
+	unsigned long long sourceSize;
+	long long sourceTime;
+	if (!s_Enabled || !GetSourceKey(filepath, sourceSize, sourceTime))
+		return;
+
+	CacheHeader header = { s_CacheMagic, s_CacheVersion, (unsigned int)width, (unsigned int)height,
+		sourceSize, sourceTime, (unsigned int)filepath.size(), 0 };
+	header.DataOffset = (unsigned int)((sizeof(header) + filepath.size() + s_PixelAlignment - 1) / s_PixelAlignment * s_PixelAlignment);
+
+	std::error_code error;
+	std::filesystem::create_directories(s_CacheDirectory, error);
+
+	// Written under a temporary name and renamed, so a cache file is never seen half written
+	std::string cachePath = GetCachePath(filepath, sourceSize, sourceTime);
+	std::string temporaryPath = cachePath + ".tmp";
+	{
+		std::ofstream file(temporaryPath, std::ios::binary);
+		if (!file)
+		{
+			std::cout << "Warning: could not write texture cache " << temporaryPath << std::endl;
+			return;
+		}
+
+		std::vector<char> padding(header.DataOffset - sizeof(header) - filepath.size(), 0);
+		file.write((const char*)&header, sizeof(header));
+		file.write(filepath.data(), filepath.size());
+		file.write(padding.data(), padding.size());
+		file.write((const char*)pixels, (std::streamsize)width * height * 4);
+		if (!file)
+		{
+			std::cout << "Warning: could not write texture cache " << temporaryPath << std::endl;
+			return;
+		}
+	}
+
+	std::filesystem::rename(temporaryPath, cachePath, error);
+	if (error)
+		std::filesystem::remove(temporaryPath, error);
+}
+
+/*
+ * Deletes every cache file.
+ */
+void TextureCache::Clear()
+{
+	std::error_code error;
+	std::filesystem::remove_all(s_CacheDirectory, error);
+}
+
+size_t TextureCache::GetDiskSize()
+{
+	size_t size = 0;
+	std::error_code error;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(s_CacheDirectory, error))
+	{
+		if (entry.is_regular_file(error))
+			size += (size_t)entry.file_size(error);
+	}
+	return size;
+}
+
+/*
+ * Size and modification time of the image at [filepath]. Returns false if it doesn't exist.
+ */
+bool TextureCache::GetSourceKey(const std::string& filepath, unsigned long long& size, long long& time)
+{
+	std::error_code error;
+	size = std::filesystem::file_size(filepath, error);
+	if (error)
+		return false;
+
+	time = (long long)std::filesystem::last_write_time(filepath, error).time_since_epoch().count();
+	return !error;
+}
+
+std::string TextureCache::GetCachePath(const std::string& filepath, unsigned long long size, long long time)
+{
+	// FNV-1a over the path, size and time
+	unsigned long long hash = 14695981039346656037ull;
+	auto hashBytes = [&hash](const void* data, size_t length)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			hash ^= ((const unsigned char*)data)[i];
+			hash *= 1099511628211ull;
+		}
+	};
+	hashBytes(filepath.data(), filepath.size());
+	hashBytes(&size, sizeof(size));
+	hashBytes(&time, sizeof(time));
+
+	char name[32];
+	snprintf(name, sizeof(name), "%016llx.rgba", hash);
+	return std::string(s_CacheDirectory) + "/" + name;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <string>
+
+/*
+ * TextureCache.h
+ * Keeps the decoded pixels of every image loaded from disk in a cache file (cache/textures/), so later loads
+ * skip stb_image. The pixels are stored exactly as they are uploaded: RGBA8, tightly packed, bottom row first.
+ * The cache file is memory mapped and its pixels handed straight to OpenGL, without being copied first.
+ *
+ * Cache files are keyed by the image's path, size and modification time, so editing an image makes its old
+ * cache file unused (Clear() removes those).
+ *
+ * Usage:
+ *		CachedImage image;
+ *		if (TextureCache::Open(filepath, image))
+ *			upload image.GetPixels(), which stay mapped until [image] is destroyed
+ *		else
+ *			decode the image, then TextureCache::Store(filepath, width, height, pixels)
+ */
+
+/*
+ * CachedImage
+ * A memory mapped cache file. The pixels stay valid for the lifetime of the object.
+ */
+class CachedImage
+{
+private:
+	void* m_Mapping;		// Start of the mapped file
+	size_t m_MappedSize;
+	const unsigned char* m_Pixels;
+	int m_Width, m_Height;
+#ifdef _WIN32
+	void* m_File;			// HANDLEs of the file and of its mapping
+	void* m_FileMapping;
+#endif
+
+	friend class TextureCache;
+public:
+	CachedImage();
+	~CachedImage();
+
+	CachedImage(const CachedImage&) = delete;
+	CachedImage& operator=(const CachedImage&) = delete;
+
+	inline bool IsValid() const { return m_Pixels != nullptr; }
+	inline const unsigned char* GetPixels() const { return m_Pixels; }
+	inline int GetWidth() const { return m_Width; }
+	inline int GetHeight() const { return m_Height; }
+
+private:
+	bool Map(const std::string& path);
+	void Unmap();
+};
+
+class TextureCache
+{
+private:
+	static bool s_Enabled;
+
+public:
+	static bool Open(const std::string& filepath, CachedImage& image);
+	static void Store(const std::string& filepath, int width, int height, const unsigned char* pixels);
+
+	inline static void SetEnabled(bool enabled) { s_Enabled = enabled; }
+	inline static bool IsEnabled() { return s_Enabled; }
+	static void Clear();
+	static size_t GetDiskSize();	// Bytes of every cache file
+
+private:
+	static bool GetSourceKey(const std::string& filepath, unsigned long long& size, long long& time);
+	static std::string GetCachePath(const std::string& filepath, unsigned long long size, long long time);
+};
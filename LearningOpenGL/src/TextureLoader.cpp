@@ -0,0 +1,268 @@
+#include "TextureLoader.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "MipmapGenerator.h"
+#include "PixelConvert.h"
+#include "Profiler.h"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+
+// 2x2 magenta and grey checker, shown until the real image is resident
+static const unsigned char s_PlaceholderPixels[2 * 2 * 4] = {
+	255,   0, 255, 255,		128, 128, 128, 255,
+	128, 128, 128, 255,		255,   0, 255, 255
+};
+
+TextureLoader::TextureLoader(unsigned int uploadBudget, unsigned int workerCount)
+	: m_DecodesInFlight(0), m_ShuttingDown(false), m_PixelBuffers{ 0, 0, 0 }, m_NextPixelBuffer(0),
+	m_UploadBudget(uploadBudget), m_FrameBudgetMs(2.0), m_Stats{ 0, 0, 0, 0.0, 0.0, 0.0, 0 }
+{
+	GLCall(glGenBuffers(PixelBufferCount, m_PixelBuffers));
+	m_Pool = std::make_unique<ThreadPool>(workerCount);
+}
+
+TextureLoader::~TextureLoader()
+{
+	// Queued decodes see the flag and return without decoding, then the workers are joined
+	m_ShuttingDown = true;
+	m_Pool.reset();
+
+	for (DecodedImage& image : m_Decoded)
+		stbi_image_free(image.Pixels);
+
+	for (PendingUpload& upload : m_Uploads)
+	{
+		stbi_image_free(upload.Pixels);
+		GLStateCache::OnTextureDeleted(upload.RendererID);
+		GLCall(glDeleteTextures(1, &upload.RendererID));
+	}
+
+	for (unsigned int buffer : m_PixelBuffers)
+		GLStateCache::OnBufferDeleted(buffer);
+	GLCall(glDeleteBuffers(PixelBufferCount, m_PixelBuffers));
+}
+
+/*
+ * Starts loading the image at [filepath] and returns its Texture, which shows a placeholder until
+ * Update() has uploaded the whole image.
+ */
+std::shared_ptr<Texture> TextureLoader::Load(const std::string& filepath, const TextureSpec& spec)
+{
+	std::shared_ptr<Texture> texture = std::make_shared<Texture>(2, 2, s_PlaceholderPixels);
+	texture->m_Filepath = filepath;
+	texture->m_Resident = false;
+
+	m_Stats.Requested++;
+	m_DecodesInFlight++;
+
+	// The worker only holds a weak reference, so the Texture (and its GL object) is always destroyed on this thread
+	std::weak_ptr<Texture> target = texture;
+	m_Pool->Submit([this, target, filepath, spec]() { Decode(target, filepath, spec); });
+
+	return texture;
+}
+
+/*
+ * Runs on a worker thread.
+ */
+void TextureLoader::Decode(std::weak_ptr<Texture> target, const std::string& filepath, const TextureSpec& spec)
+{
+	DecodedImage image = { target, filepath, spec, nullptr, 0, 0, {}, 0.0, {} };
+
+	// Skip images nobody is waiting for anymore
+	if (!m_ShuttingDown && !target.expired())
+	{
+		auto start = std::chrono::steady_clock::now();
+
+		image.Pixels = Texture::DecodeImage(filepath, image.Width, image.Height);
+		if (!image.Pixels)
+		{
+			const char* reason = stbi_failure_reason();
+			image.Error = reason ? reason : "unknown error";
+		}
+		if (image.Pixels && spec.PremultiplyAlpha)
+			PixelConvert::PremultiplyAlpha(image.Pixels, (size_t)image.Width * image.Height);
+
+		if (image.Pixels && (spec.Mipmaps == MipmapMode::BoxCPU || spec.Mipmaps == MipmapMode::KaiserCPU))
+		{
+			MipmapFilter filter = spec.Mipmaps == MipmapMode::BoxCPU ? MipmapFilter::Box : MipmapFilter::Kaiser;
+			image.Mipmaps = MipmapGenerator::Generate(image.Pixels, image.Width, image.Height, filter,
+				spec.SRGB, spec.WrapS != TextureWrap::ClampToEdge, spec.WrapT != TextureWrap::ClampToEdge);
+		}
+
+		image.DecodeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		m_Decoded.push_back(std::move(image));
+	}
+	m_DecodesInFlight--;
+}
+
+/*
+ * Uploads at most the upload budget worth of decoded rows, and swaps finished textures in.
+ * Must be called on the render thread.
+ */
+void TextureLoader::Update()
+{
+	PROFILE_SCOPE("TextureLoader::Update");
+
+	auto start = std::chrono::steady_clock::now();
+
+	std::vector<DecodedImage> decoded;
+	{
+		std::lock_guard<std::mutex> lock(m_DecodedMutex);
+		decoded.swap(m_Decoded);
+	}
+	for (DecodedImage& image : decoded)
+		BeginUpload(image);
+
+	unsigned int budget = m_UploadBudget;
+	while (!m_Uploads.empty() && budget > 0)
+	{
+		PendingUpload& upload = m_Uploads.front();
+
+		std::shared_ptr<Texture> texture = upload.Target.lock();
+		if (!texture)
+		{
+			// Dropped while uploading
+			stbi_image_free(upload.Pixels);
+			GLStateCache::OnTextureDeleted(upload.RendererID);
+			GLCall(glDeleteTextures(1, &upload.RendererID));
+			m_Uploads.pop_front();
+			continue;
+		}
+
+		budget -= std::min(budget, UploadStrip(upload, budget));
+
+		int levelHeight = std::max(upload.Height >> upload.Level, 1);
+		if (upload.RowsUploaded == levelHeight)
+		{
+			upload.Level++;
+			upload.RowsUploaded = 0;
+			if (upload.Level > (int)upload.Mipmaps.size())
+			{
+				FinishUpload(upload, *texture);
+				m_Uploads.pop_front();
+			}
+		}
+	}
+
+	// Leaving a PBO bound would make every later glTexImage2D read from it instead of client memory
+	GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+	double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	m_Stats.UploadMs += ms;
+	m_Stats.MaxUpdateMs = std::max(m_Stats.MaxUpdateMs, ms);
+	if (ms > m_FrameBudgetMs)
+		m_Stats.FramesBlocked++;
+}
+
+/*
+ * Creates the GL texture a decoded image is uploaded into. Storage is allocated here, the rows follow in strips.
+ */
+void TextureLoader::BeginUpload(DecodedImage& image)
+{
+	m_Stats.DecodeMs += image.DecodeMs;
+
+	if (image.Target.expired())
+	{
+		stbi_image_free(image.Pixels);
+		return;
+	}
+
+	if (!image.Pixels)
+	{
+		std::cout << "Warning: failed to load texture " << image.Filepath << ": " << image.Error << std::endl;
+		m_Stats.Failed++;
+		return;
+	}
+
+	PendingUpload upload = { image.Target, image.Spec, image.Pixels, image.Width, image.Height, std::move(image.Mipmaps), 0, 0, 0 };
+	upload.RendererID = Texture::CreateStorage(upload.Spec, upload.Width, upload.Height);
+
+	m_Uploads.push_back(std::move(upload));
+}
+
+/*
+ * Copies the next strip of rows of the current level into a PBO and starts the transfer into the texture.
+ * The strip is as many whole rows as fit in [budget] (but at least one). Returns the bytes uploaded.
+ */
+unsigned int TextureLoader::UploadStrip(PendingUpload& upload, unsigned int budget)
+{
+	int width = std::max(upload.Width >> upload.Level, 1);
+	int height = std::max(upload.Height >> upload.Level, 1);
+	const unsigned char* pixels = upload.Level == 0 ? upload.Pixels : upload.Mipmaps[upload.Level - 1].data();
+
+	unsigned int rowSize = width * 4;
+	int rows = std::max(1, (int)(budget / rowSize));
+	rows = std::min(rows, height - upload.RowsUploaded);
+	unsigned int size = rows * rowSize;
+
+	unsigned int buffer = m_PixelBuffers[m_NextPixelBuffer];
+	m_NextPixelBuffer = (m_NextPixelBuffer + 1) % PixelBufferCount;
+
+	// Orphan the PBO's storage first, so the copy never waits for the GPU to finish reading the last strip
+	GLStateCache::BindBuffer(GL_PIXEL_UNPACK_BUFFER, buffer);
+	GLCall(glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW));
+
+	void* mapped;
+	GLCall(mapped = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT));
+	ASSERT(mapped);
+	std::memcpy(mapped, pixels + (size_t)upload.RowsUploaded * rowSize, size);
+	GLCall(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER));
+
+	// With a PBO bound the last argument is an offset into it, and the copy to the texture happens asynchronously
+	GLStateCache::BindTexture(GLStateCache::GetActiveTextureUnit(), upload.RendererID);
+	GLCall(glTexSubImage2D(GL_TEXTURE_2D, upload.Level, 0, upload.RowsUploaded, width, rows, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)0));
+
+	upload.RowsUploaded += rows;
+	return size;
+}
+
+/*
+ * Replaces the Texture's placeholder with the fully uploaded texture.
+ */
+void TextureLoader::FinishUpload(PendingUpload& upload, Texture& texture)
+{
+	stbi_image_free(upload.Pixels);
+	upload.Pixels = nullptr;
+
+	if (upload.Spec.Mipmaps == MipmapMode::GenerateGPU)
+	{
+		GLStateCache::BindTexture(GLStateCache::GetActiveTextureUnit(), upload.RendererID);
+		GLCall(glGenerateMipmap(GL_TEXTURE_2D));
+	}
+
+	GLStateCache::OnTextureDeleted(texture.m_RendererID);
+	GLCall(glDeleteTextures(1, &texture.m_RendererID));
+
+	texture.m_RendererID = upload.RendererID;
+	texture.m_Width = upload.Width;
+	texture.m_Height = upload.Height;
+	texture.m_BPP = 4;
+	texture.m_Spec = upload.Spec;
+	texture.m_MemorySize = Texture::GetMemorySize(upload.Spec, upload.Width, upload.Height);
+	texture.m_Resident = true;
+
+	m_Stats.Resident++;
+}
+
+/*
+ * True when nothing is decoding or waiting to be uploaded.
+ */
+bool TextureLoader::IsIdle()
+{
+	std::lock_guard<std::mutex> lock(m_DecodedMutex);
+	return m_DecodesInFlight == 0 && m_Decoded.empty() && m_Uploads.empty();
+}
+
+void TextureLoader::ResetStats()
+{
+	m_Stats = { 0, 0, 0, 0.0, 0.0, 0.0, 0 };
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include "Texture.h"
+#include "ThreadPool.h"
+
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/*
+ * TextureLoader.h
+ * Loads textures without stalling the render thread.
+ * Images are decoded by stb_image on a pool of worker threads. The decoded pixels are then uploaded
+ * in horizontal strips through pixel unpack buffers (PBOs), a few strips per frame, so even a large image
+ * only costs the render thread a bounded amount of time each frame.
+ *
+ * Usage:
+ *		Call Load() with a filepath (and optionally a TextureSpec). It returns a Texture straight away, which
+ *		samples a small placeholder until the image is resident. Check IsResident() on the Texture to know
+ *		when the real image is bound.
+ *		Call Update() once per frame on the render thread. This is where uploads happen.
+ *
+ *		Mipmaps built on the CPU are generated by the worker too, and uploaded after level 0.
+ *		A Texture dropped by its owner before it is resident is cancelled; its pixels are never uploaded.
+ */
+
+/*
+ * TextureLoaderStats
+ * Counters since the last ResetStats().
+ */
+struct TextureLoaderStats
+{
+	unsigned int Requested;
+	unsigned int Resident;
+	unsigned int Failed;
+	double DecodeMs;			// Worker time spent in stbi_load, summed over every image
+	double UploadMs;			// Render thread time spent in Update()
+	double MaxUpdateMs;			// Longest single Update()
+	unsigned int FramesBlocked;	// Frames where Update() took longer than the frame budget
+};
+
+class TextureLoader
+{
+public:
+	static const unsigned int PixelBufferCount = 3;	// PBOs used in turn, so a strip never waits on the previous one
+
+private:
+	// Image decoded by a worker, waiting for the render thread to pick it up
+	struct DecodedImage
+	{
+		std::weak_ptr<Texture> Target;
+		std::string Filepath;
+		TextureSpec Spec;
+		unsigned char* Pixels;
+		int Width, Height;
+		std::vector<std::vector<unsigned char>> Mipmaps;	// Levels 1 and up, for the CPU mipmap modes
+		double DecodeMs;
+		std::string Error;		// Why decoding failed. stb_image keeps it per thread, so it is read on the worker.
+	};
+
+	// Image being uploaded into a new GL texture, one strip of rows at a time
+	struct PendingUpload
+	{
+		std::weak_ptr<Texture> Target;
+		TextureSpec Spec;
+		unsigned char* Pixels;
+		int Width, Height;
+		std::vector<std::vector<unsigned char>> Mipmaps;
+		int Level;					// Level currently being uploaded
+		int RowsUploaded;			// Rows of that level uploaded so far
+		unsigned int RendererID;	// Swapped into the Texture once every level is uploaded
+	};
+
+	std::mutex m_DecodedMutex;
+	std::vector<DecodedImage> m_Decoded;	// Written by workers, taken by Update()
+	std::deque<PendingUpload> m_Uploads;	// Render thread only
+	std::atomic<unsigned int> m_DecodesInFlight;
+	std::atomic<bool> m_ShuttingDown;
+
+	unsigned int m_PixelBuffers[PixelBufferCount];
+	unsigned int m_NextPixelBuffer;
+	unsigned int m_UploadBudget;	// Bytes uploaded per frame at most (at least one row)
+	double m_FrameBudgetMs;
+
+	TextureLoaderStats m_Stats;
+
+	// Created last and destroyed first, so no worker outlives the members it writes to
+	std::unique_ptr<ThreadPool> m_Pool;
+
+public:
+	TextureLoader(unsigned int uploadBudget = 4 * 1024 * 1024, unsigned int workerCount = 0);
+	~TextureLoader();
+
+	TextureLoader(const TextureLoader&) = delete;
+	TextureLoader& operator=(const TextureLoader&) = delete;
+
+	std::shared_ptr<Texture> Load(const std::string& filepath, const TextureSpec& spec = TextureSpec());
+	void Update();
+
+	bool IsIdle();
+
+	inline void SetUploadBudget(unsigned int bytes) { m_UploadBudget = bytes; }
+	inline unsigned int GetUploadBudget() const { return m_UploadBudget; }
+	inline void SetFrameBudgetMs(double ms) { m_FrameBudgetMs = ms; }
+	inline double GetFrameBudgetMs() const { return m_FrameBudgetMs; }
+	inline unsigned int GetWorkerCount() const { return m_Pool->GetWorkerCount(); }
+
+	inline const TextureLoaderStats& GetStats() const { return m_Stats; }
+	void ResetStats();
+
+private:
+	void Decode(std::weak_ptr<Texture> target, const std::string& filepath, const TextureSpec& spec);
+	void BeginUpload(DecodedImage& image);
+	unsigned int UploadStrip(PendingUpload& upload, unsigned int budget);
+	void FinishUpload(PendingUpload& upload, Texture& texture);
+};
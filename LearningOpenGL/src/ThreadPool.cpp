@@ -0,0 +1,111 @@
+#include "ThreadPool.h"
+#include "Profiler.h"
+
+#include <algorithm>
+#include <atomic>
+
+ThreadPool::ThreadPool(unsigned int workerCount)
+	: m_Stopping(false)
+{
+	if (workerCount == 0)
+		workerCount = DefaultWorkerCount();
+
+	m_Workers.reserve(workerCount);
+	for (unsigned int i = 0; i < workerCount; i++)
+		m_Workers.emplace_back(&ThreadPool::WorkerLoop, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Stopping = true;
+	}
+	m_JobAvailable.notify_all();
+
+	for (std::thread& worker : m_Workers)
+		worker.join();
+}
+
+void ThreadPool::Submit(std::function<void()> job)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Jobs.push(std::move(job));
+	}
+	m_JobAvailable.notify_one();
+}
+
+/*
+ * Runs [job](0) to [job](count - 1) on up to count - 1 workers and the calling thread, and returns once all
+ * of them finished. Indices are handed out one at a time, so a slow one doesn't hold up the others.
+ * Don't call it from one of this pool's jobs: the helpers it queues might never get a free worker.
+ */
+void ThreadPool::ParallelFor(unsigned int count, const std::function<void(unsigned int)>& job)
+{
+	struct Batch
+	{
+		std::atomic<unsigned int> Next{ 0 };
+		unsigned int RunningHelpers = 0;	// Guarded by Mutex
+		std::mutex Mutex;
+		std::condition_variable Finished;
+	};
+
+	Batch batch;
+	auto run = [&batch, &job, count]()
+	{
+		for (unsigned int index = batch.Next++; index < count; index = batch.Next++)
+			job(index);
+	};
+
+	unsigned int helpers = count > 1 ? std::min(count - 1, GetWorkerCount()) : 0;
+	batch.RunningHelpers = helpers;
+	for (unsigned int i = 0; i < helpers; i++)
+	{
+		Submit([&batch, &run]()
+		{
+			run();
+			// Notified under the lock, so the batch can't go out of scope before notify_one() returns
+			std::lock_guard<std::mutex> lock(batch.Mutex);
+			if (--batch.RunningHelpers == 0)
+				batch.Finished.notify_one();
+		});
+	}
+
+	run();
+
+	std::unique_lock<std::mutex> lock(batch.Mutex);
+	batch.Finished.wait(lock, [&batch]() { return batch.RunningHelpers == 0; });
+}
+
+/*
+ * One worker per hardware thread, leaving one for the render thread
+ */
+unsigned int ThreadPool::DefaultWorkerCount()
+{
+	unsigned int threads = std::thread::hardware_concurrency();
+	return threads > 1 ? threads - 1 : 1;
+}
+
+void ThreadPool::WorkerLoop()
+{
+	Profiler::SetThreadName("Pool worker");
+
+	while (true)
+	{
+		std::function<void()> job;
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex);
+			m_JobAvailable.wait(lock, [this]() { return m_Stopping || !m_Jobs.empty(); });
+
+			// Drain the queue before stopping, so no submitted job is silently dropped
+			if (m_Jobs.empty())
+				return;
+
+			job = std::move(m_Jobs.front());
+			m_Jobs.pop();
+		}
+		PROFILE_SCOPE("ThreadPool job");
+		job();
+	}
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/*
+ * ThreadPool.h
+ * A fixed number of worker threads that run submitted jobs in the order they were submitted.
+ * Jobs run without an OpenGL context, so they must only do CPU work (decoding, converting, sorting, ...)
+ * and hand their results back to the render thread.
+ *
+ * Usage:
+ *		Create the pool with the number of workers (0 picks one less than the number of hardware threads).
+ *		Call Submit() with any callable. It is run on whichever worker is free first.
+ *		ParallelFor() splits a batch of work over the workers and the calling thread, and waits for all of it.
+ *		The destructor finishes every job that was already submitted, then joins the workers.
+ */
+
+class ThreadPool
+{
+private:
+	std::vector<std::thread> m_Workers;
+	std::queue<std::function<void()>> m_Jobs;
+	std::mutex m_Mutex;
+	std::condition_variable m_JobAvailable;
+	bool m_Stopping;
+
+public:
+	ThreadPool(unsigned int workerCount = 0);
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	void Submit(std::function<void()> job);
+	void ParallelFor(unsigned int count, const std::function<void(unsigned int)>& job);
+
+	inline unsigned int GetWorkerCount() const { return (unsigned int)m_Workers.size(); }
+
+	static unsigned int DefaultWorkerCount();
+
+private:
+	void WorkerLoop();
+};
@@ -0,0 +1,59 @@
+#include "UniformBuffer.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+
+UniformBuffer::UniformBuffer(const UniformBufferLayout& layout, unsigned int bindingPoint)
+	: UniformBuffer(layout.GetSize(), bindingPoint)
+{
+}
+
+/*
+ * Creates a buffer of [size] bytes and attaches it to [bindingPoint].
+ */
+UniformBuffer::UniformBuffer(unsigned int size, unsigned int bindingPoint)
+	: m_RendererID(0), m_Size(size), m_BindingPoint(bindingPoint)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+	GLCall(glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+	Bind();
+}
+
+UniformBuffer::~UniformBuffer()
+{
+	GLStateCache::OnBufferDeleted(m_RendererID);
+	GLCall(glDeleteBuffers(1, &m_RendererID));
+}
+
+/*
+ * Uploads [size] bytes, starting [offset] bytes into the buffer.
+ */
+void UniformBuffer::SetData(const void* data, unsigned int size, unsigned int offset)
+{
+	ASSERT(offset + size <= m_Size);
+	GLStateCache::BindBuffer(GL_UNIFORM_BUFFER, m_RendererID);
+	GLCall(glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data));
+}
+
+/*
+ * Attaches the buffer to its binding point, so blocks bound to that point read from it.
+ */
+void UniformBuffer::Bind() const
+{
+	GLStateCache::BindBufferBase(GL_UNIFORM_BUFFER, m_BindingPoint, m_RendererID);
+}
+
+/*
+ * Attaches [size] bytes starting at [offset] to the binding point, so one buffer can hold the blocks of many draws.
+ * [offset] must be a multiple of GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT.
+ */
+void UniformBuffer::BindRange(unsigned int offset, unsigned int size) const
+{
+	ASSERT(offset + size <= m_Size);
+	GLStateCache::BindBufferRange(GL_UNIFORM_BUFFER, m_BindingPoint, m_RendererID, offset, size);
+}
+
+void UniformBuffer::Unbind() const
+{
+	GLStateCache::BindBufferBase(GL_UNIFORM_BUFFER, m_BindingPoint, 0);
+}
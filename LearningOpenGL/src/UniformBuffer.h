@@ -0,0 +1,79 @@
+#pragma once
+
+#include "UniformBufferLayout.h"
+
+/*
+ * UniformBuffer.h
+ * Manages an OpenGL Uniform Buffer Object, which holds the data of a uniform block.
+ * One buffer can be read by every shader program that declares the block, so shared data
+ * (like the camera) only has to be uploaded once per frame instead of once per program or draw.
+ *
+ * Usage:
+ *		Describe the block with a UniformBufferLayout, and create the buffer with the block's binding point.
+ *		Upload data with SetData(), using the offsets returned by the layout.
+ *		Shaders connect their blocks to the binding points in UniformBlockBinding automatically (see Shader).
+ */
+
+/*
+ * Binding points of the uniform blocks shared between shaders
+ */
+namespace UniformBlockBinding {
+	enum : unsigned int {
+		Camera = 0,		// layout(std140) uniform Camera { mat4 u_ViewProjection; };
+		Material = 1,	// layout(std140) uniform Material { vec4 u_Tint; };
+		Object = 2		// layout(std140) uniform Object { mat4 u_Model; vec4 u_Color; };
+	};
+}
+
+/*
+ * Layouts of the shared uniform blocks, matching their declarations in res/shaders
+ */
+inline UniformBufferLayout CameraBlockLayout()
+{
+	UniformBufferLayout layout;
+	layout.Push<glm::mat4>();	// u_ViewProjection
+	return layout;
+}
+
+inline UniformBufferLayout MaterialBlockLayout()
+{
+	UniformBufferLayout layout;
+	layout.Push<glm::vec4>();	// u_Tint
+	return layout;
+}
+
+inline UniformBufferLayout ObjectBlockLayout()
+{
+	UniformBufferLayout layout;
+	layout.Push<glm::mat4>();	// u_Model
+	layout.Push<glm::vec4>();	// u_Color
+	return layout;
+}
+
+class UniformBuffer
+{
+private:
+	unsigned int m_RendererID;
+	unsigned int m_Size;
+	unsigned int m_BindingPoint;
+public:
+	UniformBuffer(const UniformBufferLayout& layout, unsigned int bindingPoint);
+	UniformBuffer(unsigned int size, unsigned int bindingPoint);
+	~UniformBuffer();
+
+	void SetData(const void* data, unsigned int size, unsigned int offset = 0);
+
+	template<typename T>
+	void Set(unsigned int offset, const T& value)
+	{
+		SetData(&value, sizeof(T), offset);
+	}
+
+	void Bind() const;
+	void BindRange(unsigned int offset, unsigned int size) const;
+	void Unbind() const;
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetSize() const { return m_Size; }
+	inline unsigned int GetBindingPoint() const { return m_BindingPoint; }
+};
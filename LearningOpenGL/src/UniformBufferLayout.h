@@ -0,0 +1,102 @@
+#pragma once
+#include <vector>
+#include "glm/glm.hpp"
+#include <stdexcept>
+/*
+ * UniformBufferLayout.h
+ * Describes the members of a uniform block using the std140 layout rules,
+ * so the CPU knows the byte offset of each member in the UniformBuffer.
+ */
+
+/*
+ * UniformBufferElement
+ * A single member of a uniform block
+ */
+struct UniformBufferElement
+{
+	unsigned int offset;	// Byte offset from the start of the block
+	unsigned int size;		// Bytes taken up by the member (for arrays, including the padding between elements)
+	unsigned int count;		// Array length, 1 for a single value
+};
+
+/*
+ * UniformBufferLayout
+ * Defines the members of a std140 uniform block.
+ *
+ * Usage:
+ *		Call Push<type>(count) for each member, in the order they are declared in the shader.
+ *		Push returns the member's byte offset, to be used with UniformBuffer::SetData().
+ *		Supported types are float, int, glm::vec2, glm::vec4, and glm::mat4
+ *		(vec3 is left out on purpose: std140 pads it to 16 bytes, which is easy to get wrong).
+ */
+class UniformBufferLayout
+{
+private:
+	std::vector<UniformBufferElement> m_Elements;
+	unsigned int m_Size;
+
+public:
+	UniformBufferLayout()
+		: m_Size(0) {}
+
+	template<typename T>
+	unsigned int Push(unsigned int count = 1)
+	{
+		throw std::runtime_error("Type is not supported in a std140 uniform block");
+	}
+
+	inline const std::vector<UniformBufferElement>& GetElements() const { return m_Elements; }
+
+	// std140 blocks are padded to a multiple of 16 bytes
+	inline unsigned int GetSize() const { return (m_Size + 15) & ~15u; }
+
+private:
+	/*
+	 * Adds a member with the given base alignment and size.
+	 * In std140, every element of an array is aligned (and padded) to 16 bytes.
+	 */
+	unsigned int PushElement(unsigned int alignment, unsigned int size, unsigned int count)
+	{
+		if (count > 1)
+		{
+			alignment = 16;
+			size = (size + 15) & ~15u;
+		}
+
+		unsigned int offset = (m_Size + alignment - 1) & ~(alignment - 1);
+		m_Elements.push_back({ offset, size * count, count });
+		m_Size = offset + size * count;
+		return offset;
+	}
+};
+
+template<>
+inline unsigned int UniformBufferLayout::Push<float>(unsigned int count)
+{
+	return PushElement(4, sizeof(float), count);
+}
+
+template<>
+inline unsigned int UniformBufferLayout::Push<int>(unsigned int count)
+{
+	return PushElement(4, sizeof(int), count);
+}
+
+template<>
+inline unsigned int UniformBufferLayout::Push<glm::vec2>(unsigned int count)
+{
+	return PushElement(8, sizeof(glm::vec2), count);
+}
+
+template<>
+inline unsigned int UniformBufferLayout::Push<glm::vec4>(unsigned int count)
+{
+	return PushElement(16, sizeof(glm::vec4), count);
+}
+
+template<>
+inline unsigned int UniformBufferLayout::Push<glm::mat4>(unsigned int count)
+{
+	// A mat4 is stored like an array of 4 vec4 columns
+	return PushElement(16, sizeof(glm::mat4), count);
+}
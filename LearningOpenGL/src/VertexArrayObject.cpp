@@ -1,7 +1,9 @@
 #include "VertexArrayObject.h"
 #include "GLErrorManager.h"
+#include "GLStateCache.h"
 
 VertexArrayObject::VertexArrayObject()
+	: m_AttributeCount(0)
 {
 	GLCall(glGenVertexArrays(1, &m_RendererID));
 	
@@ -9,6 +11,7 @@ VertexArrayObject::VertexArrayObject()
 
 VertexArrayObject::~VertexArrayObject()
 {
+	GLStateCache::OnVertexArrayDeleted(m_RendererID);
 	GLCall(glDeleteVertexArrays(1, &m_RendererID));
 }
 
@@ -16,20 +19,52 @@ void VertexArrayObject::AddBuffer(const VertexBuffer& vb, const VertexBufferLayo
 {
 	Bind();		// Bind this array so that the buffer is addded to THIS
 	vb.Bind();	// Bind the vertex buffer to load it into memory
+	AddAttributes(layout, 0);
+}
+
+void VertexArrayObject::AddBuffer(const StreamingVertexBuffer& vb, const VertexBufferLayout& layout)
+{
+	Bind();
+	vb.Bind();
+	AddAttributes(layout, 0);
+}
 
+/*
+ * Adds a buffer of per-instance attributes, which advance once every [divisor] instances.
+ * A mat4 attribute takes 4 attribute indices, so push it to the layout as 4 attributes of 4 floats.
+ */
+void VertexArrayObject::AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor)
+{
+	Bind();
+	vb.Bind();
+	AddAttributes(layout, divisor);
+}
+
+/*
+ * Creates the attribute pointers for [layout] in the currently bound buffer.
+ * This VAO and the buffer must already be bound.
+ */
+void VertexArrayObject::AddAttributes(const VertexBufferLayout& layout, unsigned int divisor)
+{
 	// Create a VertexAttribPointer for each attribute in the layout
 	const auto& attributes = layout.GetAttributes();
 	unsigned int offset = 0;
 	for (unsigned int i = 0; i < attributes.size(); i++) {
 		const auto& attribute = attributes[i];
+		unsigned int index = m_AttributeCount + i;
 
 		// Now use the layout to make attribute pointers to store in the current VAO
-		GLCall(glEnableVertexAttribArray(i));
-		GLCall(glVertexAttribPointer(i, attribute.count, attribute.type, attribute.normalized, 
-			layout.GetStride(), (const void*)offset));
+		GLCall(glEnableVertexAttribArray(index));
+		GLCall(glVertexAttribPointer(index, attribute.count, attribute.type, attribute.normalized, 
+			layout.GetStride(), (const void*)(size_t)offset));
+		if (divisor != 0)
+		{
+			GLCall(glVertexAttribDivisor(index, divisor));	// Advance once per [divisor] instances
+		}
 
 		offset += attribute.count * VertexBufferAttribute::GetSizeOfType(attribute.type);
 	}
+	m_AttributeCount += (unsigned int)attributes.size();
 
 	// A note on the glVertexAttribPointer method
 	// index: This attribute will be index 0
@@ -42,10 +77,10 @@ void VertexArrayObject::AddBuffer(const VertexBuffer& vb, const VertexBufferLayo
 
 void VertexArrayObject::Bind() const
 {
-	GLCall(glBindVertexArray(m_RendererID));
+	GLStateCache::BindVertexArray(m_RendererID);
 }
 
 void VertexArrayObject::Unbind() const
 {
-	GLCall(glBindVertexArray(0));
+	GLStateCache::BindVertexArray(0);
 }
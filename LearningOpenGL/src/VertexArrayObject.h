@@ -1,6 +1,7 @@
 #pragma once
 
 #include "VertexBuffer.h"
+#include "StreamingVertexBuffer.h"
 #include "VertexBufferLayout.h"
 
 /*
@@ -10,18 +11,33 @@
  * 
  * Usage:
  *		Use AddBuffer() to pair a vertex buffer with a vertex buffer layout, defining the verticies.
+ *		A StreamingVertexBuffer can be added the same way.
+ *		Use AddInstanceBuffer() to pair a vertex buffer with a layout that advances once per instance
+ *		(or once every [divisor] instances) instead of once per vertex, for instanced drawing.
+ *
+ *		Attribute indices continue from the buffers added before, so the first buffer's attributes
+ *		start at location 0, and the next buffer's attributes start right after them.
  */
 
 class VertexArrayObject
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_AttributeCount;	// Number of attribute indices already in use
 public:
 	VertexArrayObject();
 	~VertexArrayObject();
 
 	void AddBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddBuffer(const StreamingVertexBuffer& vb, const VertexBufferLayout& layout);
+	void AddInstanceBuffer(const VertexBuffer& vb, const VertexBufferLayout& layout, unsigned int divisor = 1);
 
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+
+	inline unsigned int GetRendererID() const { return m_RendererID; }
+	inline unsigned int GetAttributeCount() const { return m_AttributeCount; }
+
+private:
+	void AddAttributes(const VertexBufferLayout& layout, unsigned int divisor);
+};
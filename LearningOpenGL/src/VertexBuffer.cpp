@@ -1,23 +1,64 @@
 #include "VertexBuffer.h"
 #include "GLErrorManager.h"
+#include "GLStateCache.h"
 
 VertexBuffer::VertexBuffer(const void* data, unsigned int size)
+	: m_Size(size)
 {
 	GLCall(glGenBuffers(1, &m_RendererID));
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	Bind();
 	GLCall(glBufferData(GL_ARRAY_BUFFER, size, data, GL_STATIC_DRAW));
 }
 
+/*
+ * Creates a dynamic buffer with space for [size] bytes, to be filled with SetData().
+ */
+VertexBuffer::VertexBuffer(unsigned int size)
+	: m_Size(size)
+{
+	GLCall(glGenBuffers(1, &m_RendererID));
+	Bind();
+	GLCall(glBufferData(GL_ARRAY_BUFFER, size, nullptr, GL_DYNAMIC_DRAW));
+}
+
 VertexBuffer::~VertexBuffer()
 {
+	GLStateCache::OnBufferDeleted(m_RendererID);
 	GLCall(glDeleteBuffers(1, &m_RendererID));
 }
 
+/*
+ * Uploads [size] bytes to the start of the buffer.
+ * If the data does not fit, the storage is reallocated (at least doubling) before uploading.
+ * VAOs that reference this buffer stay valid, since they point at the buffer object, not its storage.
+ */
+void VertexBuffer::SetData(const void* data, unsigned int size)
+{
+	Bind();
+	if (size > m_Size)
+	{
+		m_Size = size > m_Size * 2 ? size : m_Size * 2;
+		GLCall(glBufferData(GL_ARRAY_BUFFER, m_Size, nullptr, GL_DYNAMIC_DRAW));
+	}
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, 0, size, data));
+}
+
+/*
+ * Uploads [size] bytes starting [offset] bytes into the buffer. Unlike SetData(), the buffer never grows,
+ * so the range must fit in its storage.
+ */
+void VertexBuffer::SetSubData(const void* data, unsigned int size, unsigned int offset)
+{
+	ASSERT(offset + size <= m_Size);
+	Bind();
+	GLCall(glBufferSubData(GL_ARRAY_BUFFER, offset, size, data));
+}
+
 void VertexBuffer::Bind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, m_RendererID));
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, m_RendererID);
 }
 void VertexBuffer::Unbind() const
 {
-	GLCall(glBindBuffer(GL_ARRAY_BUFFER, 0));
-}
\ No newline at end of file
+	GLStateCache::BindBuffer(GL_ARRAY_BUFFER, 0);
+}
@@ -3,15 +3,27 @@
 /*
  * VertexBuffer
  * Contains the vertex information.
+ *
+ * Usage:
+ *		Pass the vertex data to the constructor for geometry that never changes (GL_STATIC_DRAW).
+ *		For geometry that changes every frame, construct with only a size (GL_DYNAMIC_DRAW)
+ *		and upload the vertices with SetData(). The buffer grows when more data is uploaded than it can hold.
+ *		SetSubData() writes part of the buffer, leaving the rest as it was.
  */
 class VertexBuffer
 {
 private:
 	unsigned int m_RendererID;
+	unsigned int m_Size;	// Size of the buffer's storage in bytes
 public:
 	VertexBuffer(const void* data, unsigned int size);
+	VertexBuffer(unsigned int size);
 	~VertexBuffer();
 
+	void SetData(const void* data, unsigned int size);
+	void SetSubData(const void* data, unsigned int size, unsigned int offset);
+
 	void Bind() const;
 	void Unbind() const;
-};
\ No newline at end of file
+	inline unsigned int GetSize() const { return m_Size; }
+};
@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+/*
+ * WorkStealingQueue.h
+ * A fixed size Chase-Lev deque: one owner thread pushes and pops at the bottom (newest first), while any other
+ * thread may steal from the top (oldest first). The owner only competes with thieves for the last value,
+ * so pushing and popping are a few plain loads and stores, and stealing is one compare-and-swap.
+ * The indices only grow, and wrap around the slots with a mask.
+ *
+ * Usage:
+ *		WorkStealingQueue<T, Capacity> holds up to Capacity values (a power of two). T should be a pointer or an index.
+ *		The owner calls Push() and Pop(), every other thread Steal(). All three return false instead of blocking.
+ */
+
+template<typename T, size_t Capacity>
+class WorkStealingQueue
+{
+	static_assert((Capacity & (Capacity - 1)) == 0, "The capacity must be a power of two");
+
+private:
+	static const size_t CacheLineSize = 64;
+	static const long long Mask = (long long)Capacity - 1;
+
+	std::atomic<T> m_Values[Capacity];
+	alignas(CacheLineSize) std::atomic<long long> m_Top;		// Next value to steal, advanced by thieves (and the owner's last pop)
+	alignas(CacheLineSize) std::atomic<long long> m_Bottom;	// Next slot to push to, written by the owner
+
+public:
+	WorkStealingQueue()
+		: m_Top(0), m_Bottom(0)
+	{
+		for (std::atomic<T>& value : m_Values)
+			value.store(T(), std::memory_order_relaxed);
+	}
+
+	WorkStealingQueue(const WorkStealingQueue&) = delete;
+	WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+	/*
+	 * Adds [value] at the bottom. Returns false if the queue is full. Only call from the owner thread.
+	 */
+	bool Push(const T& value)
+	{
+		long long bottom = m_Bottom.load(std::memory_order_relaxed);
+		long long top = m_Top.load(std::memory_order_acquire);
+		if (bottom - top >= (long long)Capacity)
+			return false;
+
+		m_Values[bottom & Mask].store(value, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_release);	// Publishes the value to thieves
+		return true;
+	}
+
+	/*
+	 * Removes the newest value into [value]. Returns false if the queue is empty. Only call from the owner thread.
+	 */
+	bool Pop(T& value)
+	{
+		// Claims the bottom slot first, so a thief reading the indices afterwards can't take it too
+		long long bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+		m_Bottom.store(bottom, std::memory_order_seq_cst);
+		long long top = m_Top.load(std::memory_order_seq_cst);
+
+		if (top > bottom)
+		{
+			m_Bottom.store(bottom + 1, std::memory_order_relaxed);	// Was already empty
+			return false;
+		}
+
+		value = m_Values[bottom & Mask].load(std::memory_order_relaxed);
+		if (top < bottom)
+			return true;
+
+		// The last value: whoever advances the top first gets it
+		bool won = m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+		m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+		return won;
+	}
+
+	/*
+	 * Removes the oldest value into [value]. Returns false if the queue is empty, or another thread took the value
+	 * first. Safe from any thread.
+	 */
+	bool Steal(T& value)
+	{
+		long long top = m_Top.load(std::memory_order_seq_cst);
+		long long bottom = m_Bottom.load(std::memory_order_seq_cst);
+		if (top >= bottom)
+			return false;
+
+		value = m_Values[top & Mask].load(std::memory_order_relaxed);
+		return m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	/*
+	 * Number of values waiting. Only an estimate while other threads use the queue.
+	 */
+	size_t GetSize() const
+	{
+		long long size = m_Bottom.load(std::memory_order_relaxed) - m_Top.load(std::memory_order_relaxed);
+		return size > 0 ? (size_t)size : 0;
+	}
+};
@@ -0,0 +1,264 @@
+#include "BenchmarkRunner.h"
+#include "Display.h"
+#include "FrameClock.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "GPUProfiler.h"
+#include "Profiler.h"
+#include "Renderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+namespace test {
+	/*
+	 * What one measured frame cost. GPU time is negative for a frame the GPUProfiler dropped.
+	 */
+	struct BenchmarkFrame
+	{
+		double CpuMs;
+		double GpuMs;
+		unsigned int DrawCalls;
+		unsigned long long GpuFrameIndex;
+	};
+
+	static void PrintUsage()
+	{
+		std::cerr << "Usage: LearningOpenGL --bench <test name> [--frames N] [--warmup M] [--size WxH] [--out path]" << std::endl;
+	}
+
+	/*
+	 * Reads an integer of at least [minimum] from [text] into [value]. Returns false if [text] isn't one.
+	 */
+	static bool ParseCount(const char* text, int minimum, int& value)
+	{
+		char* end = nullptr;
+		long parsed = std::strtol(text, &end, 10);
+		if (end == text || *end != '\0' || parsed < minimum || parsed > 1000000)
+			return false;
+		value = (int)parsed;
+		return true;
+	}
+
+	/*
+	 * Fills [options] from the command line. Returns false, after printing the usage, if the arguments are invalid.
+	 * Without --bench, options.Enabled stays false and the app runs interactively.
+	 */
+	bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options)
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			const char* arg = argv[i];
+			const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+			bool valid = value != nullptr;
+
+			if (valid && std::strcmp(arg, "--bench") == 0)
+			{
+				options.Enabled = true;
+				options.TestName = value;
+			}
+			else if (valid && std::strcmp(arg, "--frames") == 0)
+				valid = ParseCount(value, 1, options.Frames);
+			else if (valid && std::strcmp(arg, "--warmup") == 0)
+				valid = ParseCount(value, 0, options.Warmup);
+			else if (valid && std::strcmp(arg, "--size") == 0)
+				valid = std::sscanf(value, "%dx%d", &options.Width, &options.Height) == 2 && options.Width > 0 && options.Height > 0;
+			else if (valid && std::strcmp(arg, "--out") == 0)
+				options.OutputPath = value;
+			else
+				valid = false;
+
+			if (!valid)
+			{
+				std::cerr << "Error: invalid argument " << arg << (value ? std::string(" ") + value : "") << std::endl;
+				PrintUsage();
+				return false;
+			}
+			i++;
+		}
+		return true;
+	}
+
+	/*
+	 * The [percentile] (0 to 100) of [sorted], by nearest rank
+	 */
+	static double Percentile(const std::vector<double>& sorted, double percentile)
+	{
+		if (sorted.empty())
+			return 0.0;
+		size_t rank = (size_t)std::ceil(percentile / 100.0 * sorted.size());
+		return sorted[rank > 0 ? rank - 1 : 0];
+	}
+
+	static void WriteJsonString(std::ostream& out, const char* text)
+	{
+		out << '"';
+		for (const char* c = text; *c; c++)
+		{
+			if (*c == '"' || *c == '\\')
+				out << '\\';
+			if ((unsigned char)*c >= 0x20)
+				out << *c;
+		}
+		out << '"';
+	}
+
+	/*
+	 * Writes the mean, minimum, percentiles and maximum of [values] as a JSON object
+	 */
+	static void WriteSummary(std::ostream& out, std::vector<double> values)
+	{
+		std::sort(values.begin(), values.end());
+		double sum = 0.0;
+		for (double value : values)
+			sum += value;
+
+		out << "{\"count\":" << values.size();
+		if (!values.empty())
+		{
+			out << ",\"mean\":" << sum / values.size() << ",\"min\":" << values.front()
+				<< ",\"p50\":" << Percentile(values, 50.0) << ",\"p90\":" << Percentile(values, 90.0)
+				<< ",\"p95\":" << Percentile(values, 95.0) << ",\"p99\":" << Percentile(values, 99.0)
+				<< ",\"max\":" << values.back();
+		}
+		out << "}";
+	}
+
+	static void WriteResults(std::ostream& out, const BenchmarkOptions& options, const std::vector<BenchmarkFrame>& frames)
+	{
+		std::vector<double> cpu, gpu, drawCalls;
+		for (const BenchmarkFrame& frame : frames)
+		{
+			cpu.push_back(frame.CpuMs);
+			if (frame.GpuMs >= 0.0)
+				gpu.push_back(frame.GpuMs);
+			drawCalls.push_back(frame.DrawCalls);
+		}
+
+		out << "{\n\"test\":";
+		WriteJsonString(out, options.TestName.c_str());
+		out << ",\n\"renderer\":";
+		WriteJsonString(out, (const char*)glGetString(GL_RENDERER));
+		out << ",\n\"version\":";
+		WriteJsonString(out, (const char*)glGetString(GL_VERSION));
+		out << ",\n\"width\":" << options.Width << ",\"height\":" << options.Height
+			<< ",\"warmup\":" << options.Warmup << ",\"frames\":" << options.Frames << ",\n";
+
+		out << std::fixed;
+		out.precision(4);
+		out << "\"cpu_ms\":";
+		WriteSummary(out, cpu);
+		out << ",\n\"gpu_ms\":";
+		WriteSummary(out, gpu);
+		out << ",\n\"draw_calls\":";
+		WriteSummary(out, drawCalls);
+
+		// Per frame: [cpu ms, gpu ms or null if the result was dropped, draw calls]
+		out << ",\n\"per_frame\":[";
+		for (size_t i = 0; i < frames.size(); i++)
+		{
+			out << (i > 0 ? ",\n" : "\n") << "[" << frames[i].CpuMs << ",";
+			if (frames[i].GpuMs >= 0.0)
+				out << frames[i].GpuMs;
+			else
+				out << "null";
+			out << "," << frames[i].DrawCalls << "]";
+		}
+		out << "\n]\n}\n";
+	}
+
+	/*
+	 * Runs the test named in [options] for its warmup and measured frames, then writes the results.
+	 * Frames are driven by a FrameClock like the interactive loop, so tests advance with real time.
+	 * Returns the process exit code: 0 on success, 1 if the test doesn't exist or the results can't be written.
+	 */
+	int RunBenchmark(const BenchmarkOptions& options, const TestMenu& menu, Display& window, Renderer& renderer,
+		std::ostream& standardOutput)
+	{
+		std::unique_ptr<Test> test(menu.CreateTest(options.TestName));
+		if (!test)
+		{
+			std::cerr << "Error: no test named \"" << options.TestName << "\". Registered tests:" << std::endl;
+			for (const std::string& name : menu.GetTestNames())
+				std::cerr << "    " << name << std::endl;
+			return 1;
+		}
+
+		std::vector<BenchmarkFrame> frames;
+		frames.reserve(options.Frames);
+		size_t unresolved = 0;	// First measured frame whose GPU time hasn't been looked up yet
+
+		FrameClock frameClock;
+
+		// After the measured frames, keep rendering until the GPU results of the last ones are read back
+		int totalFrames = options.Warmup + options.Frames + GPUProfiler::FrameLatency;
+		for (int frameNumber = 0; frameNumber < totalFrames && !window.WindowShouldClose(); frameNumber++)
+		{
+			auto frameStart = std::chrono::steady_clock::now();
+			unsigned int updates = frameClock.BeginFrame();
+			Profiler::MarkFrame();
+			GPUProfiler::BeginFrame();
+
+			// Frames still waiting for their GPU time. Those older than FrameLatency frames were dropped.
+			for (; unresolved < frames.size(); unresolved++)
+			{
+				BenchmarkFrame& frame = frames[unresolved];
+				if (!GPUProfiler::GetFrameMs(frame.GpuFrameIndex, frame.GpuMs) &&
+					GPUProfiler::GetFrameIndex() - frame.GpuFrameIndex < GPUProfiler::FrameLatency)
+					break;
+			}
+
+			unsigned long long gpuFrameIndex = GPUProfiler::GetFrameIndex();
+			GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+			renderer.Clear();
+			Renderer::ResetStats();
+			GLStateCache::ResetStats();
+
+			for (unsigned int update = 0; update < updates; update++)
+				test->OnUpdate(frameClock.GetUpdateStep());
+			test->OnRenderInterpolated(frameClock.GetAlpha());
+			unsigned int drawCalls = Renderer::GetStats().DrawCalls;
+
+			GPUProfiler::EndFrame();
+			double cpuMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - frameStart).count();
+			window.EndFrame();
+
+			bool measured = frameNumber >= options.Warmup && frameNumber < options.Warmup + options.Frames;
+			if (measured)
+				frames.push_back({ cpuMs, -1.0, drawCalls, gpuFrameIndex });
+		}
+		test.reset();
+
+		if ((int)frames.size() < options.Frames)
+			std::cerr << "Warning: the window closed after " << frames.size() << " of " << options.Frames << " frames" << std::endl;
+
+		if (options.OutputPath.empty())
+		{
+			WriteResults(standardOutput, options, frames);
+			return standardOutput.flush() ? 0 : 1;
+		}
+
+		std::error_code error;
+		std::filesystem::path parent = std::filesystem::path(options.OutputPath).parent_path();
+		if (!parent.empty())
+			std::filesystem::create_directories(parent, error);
+
+		std::ofstream file(options.OutputPath);
+		if (!file)
+		{
+			std::cerr << "Error: could not write benchmark results " << options.OutputPath << std::endl;
+			return 1;
+		}
+		WriteResults(file, options, frames);
+		return file ? 0 : 1;
+	}
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Test.h"
+
+#include <ostream>
+#include <string>
+
+class Display;
+class Renderer;
+
+/*
+ * BenchmarkRunner.h
+ * Runs one registered Test without ImGui, for a fixed number of frames, and writes what each frame cost as JSON,
+ * so performance can be compared between builds (in CI, for example) without anyone clicking through the menu.
+ *
+ * Usage:
+ *		LearningOpenGL --bench "Batch Renderer" [--frames 300] [--warmup 60] [--size 960x540] [--out results.json]
+ *
+ *		Parse the command line with ParseBenchmarkArgs() before creating the Display, so the window can be
+ *		created hidden and at the requested size. If it returns true and options.Enabled is set, call
+ *		RunBenchmark() instead of the interactive loop and exit with its result.
+ *		Without --out the JSON goes to [standardOutput]. Main.cpp passes the real stdout there and points std::cout
+ *		at stderr for the whole run, so startup messages and warnings don't mix with the JSON.
+ *
+ *		The hidden window needs a display server; on a machine without a GPU, Mesa's llvmpipe works, for example
+ *		under xvfb-run with LIBGL_ALWAYS_SOFTWARE=1.
+ */
+
+namespace test {
+	struct BenchmarkOptions
+	{
+		bool Enabled = false;
+		std::string TestName;
+		int Frames = 300;		// Measured frames
+		int Warmup = 60;		// Frames run first and not measured, while textures load and caches fill
+		int Width = 960;
+		int Height = 540;
+		std::string OutputPath;	// Empty for stdout
+	};
+
+	bool ParseBenchmarkArgs(int argc, char** argv, BenchmarkOptions& options);
+	int RunBenchmark(const BenchmarkOptions& options, const TestMenu& menu, Display& window, Renderer& renderer,
+		std::ostream& standardOutput);
+}
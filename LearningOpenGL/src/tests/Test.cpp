@@ -12,7 +12,32 @@ namespace test {
         for (auto& test : m_Tests)
         {
             if (ImGui::Button(test.first.c_str()))
+            {
                 m_CurrentTest = test.second();
+                m_CurrentTestName = test.first;
+            }
         }
     }
+
+    /*
+     * Creates the test registered as [name], or returns nullptr if there is none.
+     * The caller owns the test.
+     */
+    Test* TestMenu::CreateTest(const std::string& name) const
+    {
+        for (auto& test : m_Tests)
+        {
+            if (test.first == name)
+                return test.second();
+        }
+        return nullptr;
+    }
+
+    std::vector<std::string> TestMenu::GetTestNames() const
+    {
+        std::vector<std::string> names;
+        for (auto& test : m_Tests)
+            names.push_back(test.first);
+        return names;
+    }
 }
\ No newline at end of file
@@ -13,6 +13,9 @@ namespace test {
 
 		virtual void OnUpdate(float deltaTime) {}
 		virtual void OnRender() {}
+		// What the main loop calls, after its fixed step updates. [alpha] (0 to 1) is how far the frame is from
+		// the last update towards the next, for tests that interpolate between the two.
+		virtual void OnRenderInterpolated(float alpha) { OnRender(); }
 		virtual void OnImGuiRender() {}
 	};
 
@@ -23,6 +26,10 @@ namespace test {
 
 		void OnImGuiRender() override;
 
+		Test* CreateTest(const std::string& name) const;
+		std::vector<std::string> GetTestNames() const;
+		inline const std::string& GetCurrentTestName() const { return m_CurrentTestName; }
+
 		template<typename T>
 		void RegisterTest(const std::string& name)
 		{
@@ -32,6 +39,7 @@ namespace test {
 		}
 	private:
 		Test*& m_CurrentTest;
+		std::string m_CurrentTestName;	// Of the test last opened from the menu
 		std::vector<std::pair<std::string, std::function<Test* ()>>> m_Tests;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,138 @@
+#include "TestBatchRenderer.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <random>
+
+/*
+ * TestBatchRenderer
+ * Draws thousands of textured quads through the BatchRenderer and measures how many quads per second
+ * can be submitted. The benchmark runs the scene at 1k, 10k, and 100k quads.
+ */
+
+namespace test {
+	static const int s_BenchmarkCounts[] = { 1000, 10000, 100000 };
+	static const int s_BenchmarkWarmupFrames = 30;
+	static const int s_BenchmarkFrames = 120;
+
+	TestBatchRenderer::TestBatchRenderer()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_QuadCount(1000), m_SubmitMs(0.0f),
+		m_Benchmarking(false), m_BenchmarkIndex(0), m_BenchmarkFrame(0), m_BenchmarkTotalMs(0.0)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/manatee.jpg"));
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/mct.png"));
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/Mail icon.png"));
+
+		GenerateQuads(m_QuadCount);
+	}
+
+	TestBatchRenderer::~TestBatchRenderer()
+	{
+	}
+
+	/*
+	 * Scatters [count] randomly rotated and tinted quads across the screen.
+	 */
+	void TestBatchRenderer::GenerateQuads(int count)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2832f),
+			size(8.0f, 32.0f), channel(0.5f, 1.0f);
+
+		m_Quads.resize(count);
+		for (Quad& quad : m_Quads)
+		{
+			float s = size(rng);
+			quad.Transform = glm::translate(glm::mat4(1.0f), glm::vec3(x(rng), y(rng), 0.0f));
+			quad.Transform = glm::rotate(quad.Transform, angle(rng), glm::vec3(0.0f, 0.0f, 1.0f));
+			quad.Transform = glm::scale(quad.Transform, glm::vec3(s, s, 1.0f));
+			quad.Color = glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f);
+			quad.TextureIndex = rng() % m_Textures.size();
+		}
+	}
+
+	void TestBatchRenderer::StartNextBenchmark()
+	{
+		m_QuadCount = s_BenchmarkCounts[m_BenchmarkIndex];
+		m_BenchmarkFrame = 0;
+		m_BenchmarkTotalMs = 0.0;
+		GenerateQuads(m_QuadCount);
+	}
+
+	void TestBatchRenderer::OnUpdate(float deltaTime)
+	{
+	}
+
+	void TestBatchRenderer::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+
+		auto start = std::chrono::steady_clock::now();
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		m_BatchRenderer->BeginBatch();
+		for (const Quad& quad : m_Quads)
+			m_BatchRenderer->SubmitQuad(quad.Transform, fullTexture, *m_Textures[quad.TextureIndex], quad.Color);
+		m_BatchRenderer->EndBatch();
+
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_SubmitMs = m_SubmitMs * 0.95f + ms * 0.05f;
+
+		if (m_Benchmarking)
+		{
+			m_BenchmarkFrame++;
+			if (m_BenchmarkFrame > s_BenchmarkWarmupFrames)
+				m_BenchmarkTotalMs += ms;
+
+			if (m_BenchmarkFrame == s_BenchmarkWarmupFrames + s_BenchmarkFrames)
+			{
+				float average = (float)(m_BenchmarkTotalMs / s_BenchmarkFrames);
+				m_Results.push_back({ m_QuadCount, average, m_QuadCount / (average / 1000.0) });
+
+				m_BenchmarkIndex++;
+				if (m_BenchmarkIndex < (int)(sizeof(s_BenchmarkCounts) / sizeof(s_BenchmarkCounts[0])))
+					StartNextBenchmark();
+				else
+					m_Benchmarking = false;
+			}
+		}
+	}
+
+	void TestBatchRenderer::OnImGuiRender()
+	{
+		if (!m_Benchmarking)
+		{
+			if (ImGui::SliderInt("Quads", &m_QuadCount, 1, 100000))
+				GenerateQuads(m_QuadCount);
+
+			if (ImGui::Button("Run benchmark"))
+			{
+				m_Results.clear();
+				m_Benchmarking = true;
+				m_BenchmarkIndex = 0;
+				StartNextBenchmark();
+			}
+		}
+		else
+		{
+			ImGui::Text("Benchmarking %d quads (frame %d)...", m_QuadCount, m_BenchmarkFrame);
+		}
+
+		ImGui::Text("Submit: %.3f ms (%.0f quads/sec)", m_SubmitMs, m_QuadCount / (m_SubmitMs / 1000.0f));
+		ImGui::Text("Draw calls: %u", m_BatchRenderer->GetDrawCallCount());
+
+		for (const BenchmarkResult& result : m_Results)
+			ImGui::Text("%6d quads: %.3f ms/frame, %.2f M quads/sec", result.QuadCount, result.AverageMs, result.QuadsPerSecond / 1e6);
+	}
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestBatchRenderer : public Test
+	{
+	public:
+		TestBatchRenderer();
+		~TestBatchRenderer();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		struct Quad
+		{
+			glm::mat4 Transform;
+			glm::vec4 Color;
+			unsigned int TextureIndex;
+		};
+
+		struct BenchmarkResult
+		{
+			int QuadCount;
+			float AverageMs;
+			double QuadsPerSecond;
+		};
+
+		void GenerateQuads(int count);
+		void StartNextBenchmark();
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		std::vector<Quad> m_Quads;
+		glm::mat4 m_Proj;
+
+		int m_QuadCount;
+		float m_SubmitMs;	// Smoothed CPU time of BeginBatch() through EndBatch()
+
+		// Benchmark state: runs every entry of s_BenchmarkCounts for warmup + measured frames
+		bool m_Benchmarking;
+		int m_BenchmarkIndex;
+		int m_BenchmarkFrame;
+		double m_BenchmarkTotalMs;
+		std::vector<BenchmarkResult> m_Results;
+	};
+}
@@ -0,0 +1,169 @@
+#include "TestCompressedTextures.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+#include "stb_image/stb_image.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <filesystem>
+#include <vector>
+
+/*
+ * TestCompressedTextures
+ * Loads one image as RGBA8 from its PNG/JPEG and as the BC1, BC3 and BC7 KTX2 files written by the
+ * TextureCompressor tool, then draws them side by side. Compares file size, GPU memory and load time,
+ * and can benchmark the encoder on one core.
+ */
+
+namespace test {
+	static const char* s_Images[] = { "res/textures/manatee.jpg", "res/textures/mct.png", "res/textures/Mail icon.png" };
+	static const BlockFormat s_Formats[] = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7 };
+	static const int s_BenchmarkBlockRows = 32;	// Encoded per format, so even BC7 of a large image takes well under a second
+
+	TestCompressedTextures::TestCompressedTextures()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Image(0), m_MissingFiles(false)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		LoadVariants();
+	}
+
+	TestCompressedTextures::~TestCompressedTextures()
+	{
+	}
+
+	void TestCompressedTextures::LoadVariants()
+	{
+		// The tool writes res/textures/compressed/<lowercase name>.<format>.ktx2
+		std::filesystem::path source = s_Images[m_Image];
+		std::string stem = source.stem().string();
+		std::transform(stem.begin(), stem.end(), stem.begin(), [](char c) { return (char)std::tolower(c); });
+
+		m_Variants[0].Filepath = source.string();
+		for (int i = 1; i < VariantCount; i++)
+		{
+			std::string format = BlockCompressor::GetFormatName(s_Formats[i - 1]);
+			std::transform(format.begin(), format.end(), format.begin(), [](char c) { return (char)std::tolower(c); });
+			m_Variants[i].Filepath = "res/textures/compressed/" + stem + "." + format + ".ktx2";
+		}
+
+		// Mipmapped like the KTX2 files, so both paths upload the same number of levels
+		TextureSpec spec;
+		spec.Mipmaps = MipmapMode::GenerateGPU;
+
+		m_MissingFiles = false;
+		for (Variant& variant : m_Variants)
+		{
+			variant.Loaded.reset();
+			variant.EncodeMPs = 0.0f;
+
+			std::error_code error;
+			variant.FileSize = (size_t)std::filesystem::file_size(variant.Filepath, error);
+			if (error)
+			{
+				variant.FileSize = 0;
+				variant.LoadMs = 0.0f;
+				m_MissingFiles = true;
+				continue;
+			}
+
+			GLCall(glFinish());
+			auto start = std::chrono::steady_clock::now();
+			variant.Loaded = std::make_unique<Texture>(variant.Filepath, spec);
+			GLCall(glFinish());
+			variant.LoadMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+	}
+
+	void TestCompressedTextures::BenchmarkEncoder()
+	{
+		int width, height;
+		unsigned char* pixels = Texture::DecodeImage(s_Images[m_Image], width, height);
+		if (!pixels)
+			return;
+
+		int blockRows = std::min(s_BenchmarkBlockRows, (height + 3) / 4);
+		for (int i = 1; i < VariantCount; i++)
+		{
+			BlockFormat format = s_Formats[i - 1];
+			std::vector<unsigned char> output(BlockCompressor::GetCompressedSize(format, width, height));
+
+			auto start = std::chrono::steady_clock::now();
+			BlockCompressor::CompressImage(pixels, width, height, format, output.data(), 0, blockRows);
+			float seconds = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+			m_Variants[i].EncodeMPs = (float)width * blockRows * 4 / seconds / 1e6f;
+		}
+
+		stbi_image_free(pixels);
+	}
+
+	void TestCompressedTextures::OnUpdate(float deltaTime)
+	{
+	}
+
+	void TestCompressedTextures::OnRender()
+	{
+		GLCall(glClearColor(0.1f, 0.1f, 0.1f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		// One column per variant, each image fitted into a 220x440 box
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+		m_BatchRenderer->BeginBatch();
+		for (int i = 0; i < VariantCount; i++)
+		{
+			const Texture* texture = m_Variants[i].Loaded.get();
+			if (!texture)
+				continue;
+
+			float scale = std::min(220.0f / texture->GetWidth(), 440.0f / texture->GetHeight());
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(120.0f + i * 240.0f, 270.0f, 0.0f));
+			transform = glm::scale(transform, glm::vec3(texture->GetWidth() * scale, texture->GetHeight() * scale, 1.0f));
+			m_BatchRenderer->SubmitQuad(transform, fullTexture, *texture, glm::vec4(1.0f));
+		}
+		m_BatchRenderer->EndBatch();
+	}
+
+	void TestCompressedTextures::OnImGuiRender()
+	{
+		if (ImGui::Combo("Image", &m_Image, "manatee.jpg\0mct.png\0Mail icon.png\0"))
+			LoadVariants();
+		if (ImGui::Button("Reload"))
+			LoadVariants();
+		ImGui::SameLine();
+		if (ImGui::Button("Benchmark encoder"))
+			BenchmarkEncoder();
+
+		if (m_MissingFiles)
+			ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "Some KTX2 files are missing, run tools/TextureCompressor first (see README)");
+		if (!Texture::IsCompressedFormatSupported(BlockFormat::BC7))
+			ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "BC7 is not supported by this driver");
+
+		ImGui::Text("%-8s %10s %10s %10s %12s", "", "File KB", "GPU KB", "Load ms", "Encode MP/s");
+		for (int i = 0; i < VariantCount; i++)
+		{
+			const Variant& variant = m_Variants[i];
+			const char* name = i == 0 ? "RGBA8" : BlockCompressor::GetFormatName(s_Formats[i - 1]);
+			if (!variant.Loaded)
+			{
+				ImGui::Text("%-8s %10s", name, "missing");
+				continue;
+			}
+
+			if (variant.EncodeMPs > 0.0f)
+				ImGui::Text("%-8s %10zu %10zu %10.2f %12.2f", name, variant.FileSize / 1024, variant.Loaded->GetMemorySize() / 1024,
+					variant.LoadMs, variant.EncodeMPs);
+			else
+				ImGui::Text("%-8s %10zu %10zu %10.2f %12s", name, variant.FileSize / 1024, variant.Loaded->GetMemorySize() / 1024,
+					variant.LoadMs, "-");
+		}
+		ImGui::Text("Encoder SIMD: %s", BlockCompressor::IsSimdEnabled() ? "SSE2" : "off");
+	}
+}
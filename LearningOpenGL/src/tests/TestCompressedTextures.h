@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "BlockCompression.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <string>
+
+namespace test {
+	class TestCompressedTextures : public Test
+	{
+	public:
+		TestCompressedTextures();
+		~TestCompressedTextures();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		static const int VariantCount = 4;		// The source image, then BC1, BC3 and BC7
+
+		struct Variant
+		{
+			std::string Filepath;
+			std::unique_ptr<Texture> Loaded;
+			size_t FileSize = 0;
+			float LoadMs = 0.0f;	// Constructor through glFinish(), so the upload is included
+			float EncodeMPs = 0.0f;	// Single core encode throughput, 0 until benchmarked
+		};
+
+		void LoadVariants();
+		void BenchmarkEncoder();
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		Variant m_Variants[VariantCount];
+
+		glm::mat4 m_Proj;
+		int m_Image;
+		bool m_MissingFiles;	// The TextureCompressor tool hasn't been run for this image
+	};
+}
@@ -0,0 +1,95 @@
+#include "TestGLCallOverhead.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include <chrono>
+
+/*
+ * TestGLCallOverhead
+ * Microbenchmark for the cost GLCall() adds to every OpenGL call in each error checking mode.
+ * The same uniform upload is timed without checking, with the KHR_debug callback enabled,
+ * and with the glGetError() checks of the full mode.
+ */
+
+namespace test {
+	TestGLCallOverhead::TestGLCallOverhead()
+		: m_Location(-1), m_Calls(100000),
+		m_UncheckedNs(0.0f), m_DebugOutputNs(0.0f), m_CheckedNs(0.0f)
+	{
+		m_Shader = std::make_unique<Shader>("res/shaders/Basic.vert", "res/shaders/Basic.frag");
+		m_Shader->Bind();
+
+		// Benchmark with a real uniform, so the driver can not skip the call
+		GLint program;
+		GLCall(glGetIntegerv(GL_CURRENT_PROGRAM, &program));
+		GLCall(m_Location = glGetUniformLocation(program, "u_Texture"));
+	}
+
+	TestGLCallOverhead::~TestGLCallOverhead()
+	{
+	}
+
+	void TestGLCallOverhead::RunBenchmark()
+	{
+		m_Shader->Bind();
+
+		// The driver validates every call while debug output is on (GLEnableDebugOutput() turns it on in that mode),
+		// so it is off for the other two loops and restored afterwards
+		bool hasDebugOutput = GLEW_VERSION_4_3 || GLEW_KHR_debug;
+		GLboolean wasEnabled = GL_FALSE;
+		if (hasDebugOutput)
+		{
+			GLCall(wasEnabled = glIsEnabled(GL_DEBUG_OUTPUT));
+			GLCall(glDisable(GL_DEBUG_OUTPUT));
+		}
+		GLCall(glFinish());
+
+		// Off: the call on its own
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < m_Calls; i++)
+			glUniform1i(m_Location, 0);
+		GLCall(glFinish());
+		m_UncheckedNs = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / m_Calls;
+
+		// Full: clear and check the error flags around every call
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < m_Calls; i++)
+		{
+			GLCallChecked(glUniform1i(m_Location, 0));
+		}
+		GLCall(glFinish());
+		m_CheckedNs = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / m_Calls;
+
+		// Debug output: also the call on its own, but the driver validates it for the callback
+		m_DebugOutputNs = 0.0f;
+		if (hasDebugOutput)
+		{
+			GLCall(glEnable(GL_DEBUG_OUTPUT));
+			start = std::chrono::steady_clock::now();
+			for (int i = 0; i < m_Calls; i++)
+				glUniform1i(m_Location, 0);
+			GLCall(glFinish());
+			m_DebugOutputNs = std::chrono::duration<float, std::nano>(std::chrono::steady_clock::now() - start).count() / m_Calls;
+
+			if (!wasEnabled)
+			{
+				GLCall(glDisable(GL_DEBUG_OUTPUT));
+			}
+		}
+	}
+
+	void TestGLCallOverhead::OnImGuiRender()
+	{
+		ImGui::Text("Compiled error checking mode: %s", GLGetErrorCheckModeName());
+		ImGui::SliderInt("Calls", &m_Calls, 1000, 1000000);
+		if (ImGui::Button("Run benchmark"))
+			RunBenchmark();
+
+		ImGui::Text("Off:          %.1f ns/call", m_UncheckedNs);
+		if (GLEW_VERSION_4_3 || GLEW_KHR_debug)
+			ImGui::Text("Debug output: %.1f ns/call", m_DebugOutputNs);
+		else
+			ImGui::Text("Debug output: KHR_debug not supported");
+		ImGui::Text("Full:         %.1f ns/call (+%.1f ns)", m_CheckedNs, m_CheckedNs - m_UncheckedNs);
+	}
+}
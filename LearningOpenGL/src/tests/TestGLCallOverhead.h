@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Test.h"
+
+#include "Shader.h"
+
+#include <memory>
+
+namespace test {
+	class TestGLCallOverhead : public Test
+	{
+	public:
+		TestGLCallOverhead();
+		~TestGLCallOverhead();
+
+		void OnImGuiRender() override;
+
+	private:
+		void RunBenchmark();
+
+		std::unique_ptr<Shader> m_Shader;
+		int m_Location;
+
+		int m_Calls;
+		float m_UncheckedNs;		// Per call, no error checking
+		float m_DebugOutputNs;		// Per call, no error checking, with the debug callback installed
+		float m_CheckedNs;			// Per call, glGetError() before and after
+	};
+}
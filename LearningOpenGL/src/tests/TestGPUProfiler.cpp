@@ -0,0 +1,110 @@
+#include "TestGPUProfiler.h"
+#include "GLErrorManager.h"
+#include "GPUProfiler.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+#include <cstring>
+
+/*
+ * TestGPUProfiler
+ * Draws two passes in nested GPU sections: layers of blended fullscreen quads, which cost fill rate,
+ * and a field of small sprites. The sliders change how much work each pass is, and the times below
+ * (and in the GPU sections of the Test window) follow a few frames later.
+ * With the Profiler open, the same sections appear on its "GPU" track and in the exported trace.
+ */
+
+namespace test {
+	static const char* s_LayerNames[] = { "Layer 0", "Layer 1", "Layer 2", "Layer 3", "Layer 4", "Layer 5", "Layer 6", "Layer 7" };
+	static const int s_MaxLayers = 64;
+
+	TestGPUProfiler::TestGPUProfiler()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_OverdrawLayers(8), m_SpriteCount(5000),
+		m_TimeEachLayer(true), m_Time(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/manatee.jpg"));
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/mct.png"));
+	}
+
+	TestGPUProfiler::~TestGPUProfiler()
+	{
+	}
+
+	void TestGPUProfiler::OnUpdate(float deltaTime)
+	{
+		m_Time += 1.0f / 60.0f;
+	}
+
+	void TestGPUProfiler::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		GPU_PROFILE_SCOPE("Scene");
+		{
+			GPU_PROFILE_SCOPE("Overdraw");
+			glm::mat4 fullscreen = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(480.0f, 270.0f, 0.0f)),
+				glm::vec3(960.0f, 540.0f, 1.0f));
+
+			if (m_TimeEachLayer)
+			{
+				// One batch per layer, so each can be timed on its own
+				for (int layer = 0; layer < m_OverdrawLayers; layer++)
+				{
+					const int nameCount = (int)(sizeof(s_LayerNames) / sizeof(s_LayerNames[0]));
+					GPU_PROFILE_SCOPE(layer < nameCount ? s_LayerNames[layer] : "Layer 8+");
+					m_BatchRenderer->BeginBatch();
+					m_BatchRenderer->SubmitQuad(fullscreen, fullTexture, *m_Textures[0], glm::vec4(1.0f, 1.0f, 1.0f, 0.1f));
+					m_BatchRenderer->EndBatch();
+				}
+			}
+			else
+			{
+				m_BatchRenderer->BeginBatch();
+				for (int layer = 0; layer < m_OverdrawLayers; layer++)
+					m_BatchRenderer->SubmitQuad(fullscreen, fullTexture, *m_Textures[0], glm::vec4(1.0f, 1.0f, 1.0f, 0.1f));
+				m_BatchRenderer->EndBatch();
+			}
+		}
+		{
+			GPU_PROFILE_SCOPE("Sprites");
+			m_BatchRenderer->BeginBatch();
+			for (int i = 0; i < m_SpriteCount; i++)
+			{
+				// Spread on a spiral that turns over time
+				float t = i * 0.618f + m_Time * 0.5f;
+				float radius = 20.0f + 250.0f * i / (float)(m_SpriteCount > 0 ? m_SpriteCount : 1);
+				glm::mat4 transform = glm::translate(glm::mat4(1.0f),
+					glm::vec3(480.0f + std::cos(t) * radius * 1.6f, 270.0f + std::sin(t) * radius, 0.0f));
+				transform = glm::scale(transform, glm::vec3(12.0f, 12.0f, 1.0f));
+				m_BatchRenderer->SubmitQuad(transform, fullTexture, *m_Textures[1]);
+			}
+			m_BatchRenderer->EndBatch();
+		}
+	}
+
+	void TestGPUProfiler::OnImGuiRender()
+	{
+		ImGui::SliderInt("Overdraw layers", &m_OverdrawLayers, 0, s_MaxLayers);
+		ImGui::SliderInt("Sprites", &m_SpriteCount, 0, 100000);
+		ImGui::Checkbox("Time each layer", &m_TimeEachLayer);
+
+		// This test's sections, from the latest frame the GPU has finished
+		for (unsigned int i = 0; i < GPUProfiler::GetResultCount(); i++)
+		{
+			const GPUSectionTiming& section = GPUProfiler::GetResults()[i];
+			if (std::strcmp(section.Name, "Overdraw") == 0 || std::strcmp(section.Name, "Sprites") == 0)
+				ImGui::Text("%s: %.3f ms, starting %.3f ms into the frame", section.Name, section.Ms, section.StartMs);
+		}
+		ImGui::TextDisabled("Results are %u frames old", GPUProfiler::GetLatency());
+	}
+}
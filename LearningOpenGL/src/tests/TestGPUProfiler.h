@@ -0,0 +1,36 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestGPUProfiler : public Test
+	{
+	public:
+		TestGPUProfiler();
+		~TestGPUProfiler();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		glm::mat4 m_Proj;
+
+		int m_OverdrawLayers;	// Blended fullscreen quads, to load the GPU's fill rate
+		int m_SpriteCount;		// Small quads, to load vertex processing and submission
+		bool m_TimeEachLayer;	// Put every overdraw layer in its own nested section
+		float m_Time;
+	};
+}
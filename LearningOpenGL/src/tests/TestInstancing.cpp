@@ -0,0 +1,137 @@
+#include "TestInstancing.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "Renderer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <random>
+#include <vector>
+
+/*
+ * TestInstancing
+ * Draws up to 100,000 textured quads with a single instanced draw call.
+ * Each instance has its own model matrix and color in a per-instance vertex buffer, so the CPU cost
+ * of a frame stays the same no matter how many quads are drawn.
+ */
+
+namespace test {
+	/*
+	 * Per-instance data, matching locations 2-6 in res/shaders/Instanced.vert
+	 */
+	struct InstanceData
+	{
+		glm::mat4 Model;
+		glm::vec4 Color;
+	};
+
+	TestInstancing::TestInstancing()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_InstanceCount(100000), m_SubmitMs(0.0f)
+	{
+		// Unit quad, scaled by each instance's model matrix
+		float positions[] = {
+			-0.5f, -0.5f, 0.0f, 0.0f,
+			 0.5f, -0.5f, 1.0f, 0.0f,
+			 0.5f,  0.5f, 1.0f, 1.0f,
+			-0.5f,  0.5f, 0.0f, 1.0f
+		};
+		unsigned int indices[] = {
+			0, 1, 2,
+			2, 3, 0
+		};
+
+		m_Shader = std::make_unique<Shader>("res/shaders/Instanced.vert", "res/shaders/Instanced.frag");
+		m_VAO = std::make_unique<VertexArrayObject>();
+
+		m_QuadBuffer = std::make_unique<VertexBuffer>(positions, (unsigned int)sizeof(positions));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_QuadBuffer, layout);
+
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices, 6);
+
+		CreateInstances(m_InstanceCount);
+
+		m_Texture = std::make_unique<Texture>("res/textures/mct.png");
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+	}
+
+	TestInstancing::~TestInstancing()
+	{
+	}
+
+	/*
+	 * Fills a new per-instance buffer with [count] random transforms and colors.
+	 * This only happens when the count changes, not every frame.
+	 */
+	void TestInstancing::CreateInstances(int count)
+	{
+		std::mt19937 rng(42);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2832f),
+			size(4.0f, 16.0f), channel(0.3f, 1.0f);
+
+		std::vector<InstanceData> instances(count);
+		for (InstanceData& instance : instances)
+		{
+			float s = size(rng);
+			instance.Model = glm::translate(glm::mat4(1.0f), glm::vec3(x(rng), y(rng), 0.0f));
+			instance.Model = glm::rotate(instance.Model, angle(rng), glm::vec3(0.0f, 0.0f, 1.0f));
+			instance.Model = glm::scale(instance.Model, glm::vec3(s, s, 1.0f));
+			instance.Color = glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f);
+		}
+
+		// A VAO's attribute indices can only be added, so recreate it with the new instance buffer
+		if (m_InstanceBuffer)
+		{
+			m_VAO = std::make_unique<VertexArrayObject>();
+			VertexBufferLayout layout;
+			layout.Push<float>(2);
+			layout.Push<float>(2);
+			m_VAO->AddBuffer(*m_QuadBuffer, layout);
+		}
+
+		m_InstanceBuffer = std::make_unique<VertexBuffer>(instances.data(), (unsigned int)(instances.size() * sizeof(InstanceData)));
+
+		VertexBufferLayout instanceLayout;
+		instanceLayout.Push<float>(4);	// Model matrix, one column per attribute
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);
+		instanceLayout.Push<float>(4);	// Color
+		m_VAO->AddInstanceBuffer(*m_InstanceBuffer, instanceLayout);
+	}
+
+	void TestInstancing::OnUpdate(float deltaTime)
+	{
+	}
+
+	void TestInstancing::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		auto start = std::chrono::steady_clock::now();
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		Renderer renderer;
+		m_Texture->Bind();
+		renderer.DrawInstanced(*m_VAO, *m_IndexBuffer, *m_Shader, m_InstanceCount);
+
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_SubmitMs = m_SubmitMs * 0.95f + ms * 0.05f;
+	}
+
+	void TestInstancing::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Instances", &m_InstanceCount, 1, 100000))
+			CreateInstances(m_InstanceCount);
+		ImGui::Text("CPU submit: %.4f ms", m_SubmitMs);
+	}
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "Test.h"
+
+#include "VertexBuffer.h"
+#include "VertexBufferLayout.h"
+#include "Texture.h"
+#include "VertexArrayObject.h"
+#include "Shader.h"
+#include "IndexBuffer.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+
+namespace test {
+	class TestInstancing : public Test
+	{
+	public:
+		TestInstancing();
+		~TestInstancing();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void CreateInstances(int count);
+
+		std::unique_ptr<VertexArrayObject> m_VAO;
+		std::unique_ptr<VertexBuffer> m_QuadBuffer;
+		std::unique_ptr<VertexBuffer> m_InstanceBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+
+		glm::mat4 m_Proj;
+		int m_InstanceCount;
+		float m_SubmitMs;	// Smoothed CPU time spent submitting the instanced draw
+	};
+}
@@ -0,0 +1,228 @@
+#include "TestJobSystem.h"
+#include "JobSystem.h"
+#include "Profiler.h"
+#include "ThreadPool.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+
+/*
+ * TestJobSystem
+ * Every frame, rebuilds the model matrices of 1M spinning quads in OnUpdate, either in a plain loop or with
+ * JobSystem::ParallelFor on a chosen number of threads. "Scale threads" times the loop, then every thread count.
+ * "Run microbenchmarks" measures what the JobSystem costs per job: spawning and waiting for empty jobs (next to
+ * the ThreadPool's mutex-protected queue), the round trip of a single job, and ParallelFor per span.
+ */
+
+namespace test {
+	static const int s_QuadCount = 1000000;
+	static const int s_BenchmarkJobs = 100000;
+	static const int s_RoundTrips = 10000;
+	static const int s_SweepWarmupFrames = 5;
+	static const int s_SweepFrames = 30;
+
+	TestJobSystem::TestJobSystem()
+		: m_Time(0.0f), m_UseJobs(true), m_Threads(1), m_MaxThreads((int)JobSystem::GetWorkerCount() + 1), m_GrainSize(4096),
+		m_UpdateMs(0.0f), m_SpawnNs(0.0), m_PoolSubmitNs(0.0), m_RoundTripNs(0.0), m_ParallelForNs(0.0), m_ManySpansNs(0.0), m_Benchmarked(false),
+		m_Sweeping(false), m_SweepFrame(0), m_SweepMs(0.0)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2832f), spin(-2.0f, 2.0f), size(2.0f, 8.0f);
+
+		m_Quads.resize(s_QuadCount);
+		for (Quad& quad : m_Quads)
+			quad = { glm::vec2(x(rng), y(rng)), angle(rng), spin(rng), size(rng) };
+		m_Transforms.resize(s_QuadCount);
+
+		SetThreads(m_MaxThreads);
+	}
+
+	TestJobSystem::~TestJobSystem()
+	{
+		JobSystem::SetActiveWorkerCount(JobSystem::GetWorkerCount());
+	}
+
+	void TestJobSystem::SetThreads(int threads)
+	{
+		m_Threads = threads;
+		JobSystem::SetActiveWorkerCount((unsigned int)(threads - 1));
+	}
+
+	/*
+	 * Writes the model matrices of the quads [first, first + count)
+	 */
+	void TestJobSystem::UpdateTransforms(const Quad* first, size_t count)
+	{
+		glm::mat4* transform = &m_Transforms[first - m_Quads.data()];
+		for (size_t i = 0; i < count; i++)
+		{
+			const Quad& quad = first[i];
+			glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(quad.Position, 0.0f));
+			model = glm::rotate(model, quad.Angle + quad.Spin * m_Time, glm::vec3(0.0f, 0.0f, 1.0f));
+			transform[i] = glm::scale(model, glm::vec3(quad.Size, quad.Size, 1.0f));
+		}
+	}
+
+	void TestJobSystem::OnUpdate(float deltaTime)
+	{
+		PROFILE_SCOPE("Update transforms");
+		m_Time += deltaTime;
+
+		auto start = std::chrono::steady_clock::now();
+		if (m_UseJobs)
+		{
+			auto update = [this](const Quad* first, size_t count) { UpdateTransforms(first, count); };
+			JobSystem::ParallelFor((const Quad*)m_Quads.data(), m_Quads.size(), (size_t)m_GrainSize, update);
+		}
+		else
+			UpdateTransforms(m_Quads.data(), m_Quads.size());
+		double updateMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		m_UpdateMs = m_UpdateMs * 0.95f + (float)updateMs * 0.05f;
+		UpdateSweep(updateMs);
+	}
+
+	/*
+	 * Adds the frame to the setting being measured, and moves on to the next one once it has enough frames
+	 */
+	void TestJobSystem::UpdateSweep(double updateMs)
+	{
+		if (!m_Sweeping)
+			return;
+
+		m_SweepFrame++;
+		if (m_SweepFrame <= s_SweepWarmupFrames)
+			return;
+
+		m_SweepMs += updateMs;
+		if (m_SweepFrame < s_SweepWarmupFrames + s_SweepFrames)
+			return;
+
+		m_SweepResults.push_back({ m_UseJobs ? m_Threads : 0, m_SweepMs / s_SweepFrames });
+		m_SweepFrame = 0;
+		m_SweepMs = 0.0;
+
+		if (!m_UseJobs)
+			m_UseJobs = true;
+		else if (m_Threads < m_MaxThreads)
+			SetThreads(m_Threads + 1);
+		else
+			m_Sweeping = false;
+	}
+
+	void TestJobSystem::RunBenchmarks()
+	{
+		using Clock = std::chrono::steady_clock;
+		auto nsSince = [](Clock::time_point start, int count)
+		{
+			return std::chrono::duration<double, std::nano>(Clock::now() - start).count() / count;
+		};
+
+		{
+			JobCounter counter;
+			auto start = Clock::now();
+			for (int i = 0; i < s_BenchmarkJobs; i++)
+				JobSystem::Run([]() {}, counter);
+			JobSystem::Wait(counter);
+			m_SpawnNs = nsSince(start, s_BenchmarkJobs);
+		}
+
+		{
+			ThreadPool pool((unsigned int)std::max(m_Threads - 1, 1));
+			std::atomic<int> remaining(s_BenchmarkJobs);
+			auto start = Clock::now();
+			for (int i = 0; i < s_BenchmarkJobs; i++)
+				pool.Submit([&remaining]() { remaining--; });
+			while (remaining > 0)
+				std::this_thread::yield();
+			m_PoolSubmitNs = nsSince(start, s_BenchmarkJobs);
+		}
+
+		{
+			auto start = Clock::now();
+			for (int i = 0; i < s_RoundTrips; i++)
+			{
+				JobCounter counter;
+				JobSystem::Run([]() {}, counter);
+				JobSystem::Wait(counter);
+			}
+			m_RoundTripNs = nsSince(start, s_RoundTrips);
+		}
+
+		{
+			const size_t grainSize = 256;
+			auto nothing = [](const Quad*, size_t) {};
+			auto start = Clock::now();
+			JobSystem::ParallelFor((const Quad*)m_Quads.data(), m_Quads.size(), grainSize, nothing);
+			m_ParallelForNs = nsSince(start, (int)((m_Quads.size() + grainSize - 1) / grainSize));
+		}
+
+		{
+			const size_t grainSize = 16;	// 62500 spans
+			auto nothing = [](const Quad*, size_t) {};
+			auto start = Clock::now();
+			JobSystem::ParallelFor((const Quad*)m_Quads.data(), m_Quads.size(), grainSize, nothing);
+			m_ManySpansNs = nsSince(start, (int)((m_Quads.size() + grainSize - 1) / grainSize));
+		}
+
+		m_Benchmarked = true;
+	}
+
+	void TestJobSystem::OnImGuiRender()
+	{
+		ImGui::Text("%d quads, %u workers", s_QuadCount, JobSystem::GetWorkerCount());
+
+		if (m_Sweeping)
+			ImGui::Text("Measuring %s...", m_UseJobs ? "threads" : "the loop without jobs");
+		else
+		{
+			ImGui::Checkbox("Use jobs", &m_UseJobs);
+			int threads = m_Threads;
+			if (ImGui::SliderInt("Threads", &threads, 1, m_MaxThreads))
+				SetThreads(threads);
+			ImGui::SliderInt("Quads per job", &m_GrainSize, 16, 65536);
+			if (ImGui::Button("Scale threads"))
+			{
+				m_Sweeping = true;
+				m_UseJobs = false;
+				SetThreads(1);
+				m_SweepFrame = 0;
+				m_SweepMs = 0.0;
+				m_SweepResults.clear();
+			}
+		}
+		ImGui::Text("Update: %.3f ms per frame", m_UpdateMs);
+
+		if (!m_SweepResults.empty())
+		{
+			ImGui::Separator();
+			ImGui::Text("Update time per frame, %d frames each:", s_SweepFrames);
+			double loopMs = m_SweepResults[0].UpdateMs;
+			for (const SweepResult& result : m_SweepResults)
+			{
+				if (result.Threads == 0)
+					ImGui::Text("No jobs:    %.3f ms", result.UpdateMs);
+				else
+					ImGui::Text("%2d threads: %.3f ms (%.2fx)", result.Threads, result.UpdateMs, result.UpdateMs > 0.0 ? loopMs / result.UpdateMs : 0.0);
+			}
+		}
+
+		ImGui::Separator();
+		if (!m_Sweeping && ImGui::Button("Run microbenchmarks"))
+			RunBenchmarks();
+		if (m_Benchmarked)
+		{
+			const JobSystemStats stats = JobSystem::GetStats();
+			ImGui::Text("Run + Wait: %.1f ns per empty job (ThreadPool::Submit: %.1f ns)", m_SpawnNs, m_PoolSubmitNs);
+			ImGui::Text("Round trip of one job: %.1f ns", m_RoundTripNs);
+			ImGui::Text("ParallelFor: %.1f ns per empty span (%.1f ns with 16 quads per span)", m_ParallelForNs, m_ManySpansNs);
+			ImGui::Text("%llu jobs run since startup, %llu stolen", stats.Jobs, stats.Steals);
+		}
+	}
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "Test.h"
+
+#include "glm/glm.hpp"
+
+#include <vector>
+
+namespace test {
+	class TestJobSystem : public Test
+	{
+	public:
+		TestJobSystem();
+		~TestJobSystem();
+
+		void OnUpdate(float deltaTime) override;
+		void OnImGuiRender() override;
+
+	private:
+		struct Quad
+		{
+			glm::vec2 Position;
+			float Angle, Spin, Size;
+		};
+
+		struct SweepResult
+		{
+			int Threads;		// 0 for the loop without jobs
+			double UpdateMs;	// Mean per frame
+		};
+
+		void RunBenchmarks();
+		void UpdateTransforms(const Quad* first, size_t count);
+		void UpdateSweep(double updateMs);
+		void SetThreads(int threads);
+
+		std::vector<Quad> m_Quads;
+		std::vector<glm::mat4> m_Transforms;
+		float m_Time;
+		bool m_UseJobs;
+		int m_Threads;			// The main thread and as many active workers as it takes
+		int m_MaxThreads;
+		int m_GrainSize;
+		float m_UpdateMs;		// Smoothed
+
+		// Microbenchmarks, in ns
+		double m_SpawnNs;			// Run() and Wait() per empty job
+		double m_PoolSubmitNs;		// ThreadPool::Submit() per empty job, with as many workers
+		double m_RoundTripNs;		// Run() of one job and Wait() for it
+		double m_ParallelForNs;		// ParallelFor() per span, with empty spans
+		double m_ManySpansNs;		// The same with more spans than JobSystem::QueueCapacity, some of them run inline
+		bool m_Benchmarked;
+
+		// Scaling: the loop without jobs, then every thread count, for a fixed number of frames each
+		bool m_Sweeping;
+		int m_SweepFrame;
+		double m_SweepMs;
+		std::vector<SweepResult> m_SweepResults;
+	};
+}
@@ -0,0 +1,158 @@
+#include "TestMeshPool.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "Renderer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+/*
+ * TestMeshPool
+ * Draws thousands of different static meshes (random stars, each with its own vertices) once each:
+ * with one glMultiDrawElementsIndirect from the MeshPool, with the pool's GL 3.3 CPU loop, and with a
+ * separate VAO, vertex buffer and index buffer per mesh drawn by Renderer::Draw, comparing draw calls and CPU time.
+ * Every mode uses res/shaders/Instanced.vert/.frag, the last two setting the instance attributes with glVertexAttrib.
+ */
+
+namespace test {
+	static const int s_MaxMeshPoints = 12;
+
+	TestMeshPool::TestMeshPool()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_MeshCount(5000),
+		m_Mode(MeshPool::IsMultiDrawIndirectSupported() ? DrawMode::MultiDrawIndirect : DrawMode::PoolLoop), m_DrawMs(0.0f)
+	{
+		m_Shader = std::make_unique<Shader>("res/shaders/Instanced.vert", "res/shaders/Instanced.frag");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+
+		unsigned char white[] = { 255, 255, 255, 255 };
+		m_WhiteTexture = std::make_unique<Texture>(1, 1, white);
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		CreateMeshes(m_MeshCount);
+	}
+
+	TestMeshPool::~TestMeshPool()
+	{
+	}
+
+	/*
+	 * Generates [count] stars with 5 to 12 points and random radii, in a new pool and as separate meshes,
+	 * and lays them out in a grid filling the window.
+	 */
+	void TestMeshPool::CreateMeshes(int count)
+	{
+		std::mt19937 rng(2024);
+		std::uniform_int_distribution<int> points(5, s_MaxMeshPoints);
+		std::uniform_real_distribution<float> radius(0.15f, 0.5f), channel(0.3f, 1.0f);
+
+		VertexBufferLayout layout;
+		layout.Push<float>(2);	// Position
+		layout.Push<float>(2);	// TexCoord
+
+		unsigned int maxVertices = 2 * s_MaxMeshPoints + 1;
+		unsigned int maxIndices = 2 * s_MaxMeshPoints * 3;
+		m_Pool = std::make_unique<MeshPool>(layout, count * maxVertices, count * maxIndices);
+		m_SeparateMeshes.clear();
+		m_Instances.clear();
+
+		int columns = (int)std::ceil(std::sqrt(count * 960.0f / 540.0f));
+		float cell = 960.0f / columns;
+
+		std::vector<float> vertices;
+		std::vector<unsigned int> indices;
+		for (int i = 0; i < count; i++)
+		{
+			// Triangle fan around the center, alternating between the outer and a random inner radius
+			int corners = points(rng) * 2;
+			float inner = radius(rng);
+			vertices.assign({ 0.0f, 0.0f, 0.5f, 0.5f });
+			indices.clear();
+			for (int c = 0; c < corners; c++)
+			{
+				float angle = c * 6.2832f / corners;
+				float r = c % 2 == 0 ? 0.5f : inner;
+				float x = r * std::cos(angle), y = r * std::sin(angle);
+				vertices.insert(vertices.end(), { x, y, x + 0.5f, y + 0.5f });
+				indices.insert(indices.end(), { 0u, (unsigned int)c + 1, (unsigned int)(c + 1) % corners + 1 });
+			}
+
+			unsigned int vertexCount = (unsigned int)vertices.size() / 4;
+			m_Pool->AddMesh(vertices.data(), vertexCount, indices.data(), (unsigned int)indices.size());
+
+			SeparateMesh mesh;
+			mesh.VAO = std::make_unique<VertexArrayObject>();
+			mesh.Vertices = std::make_unique<VertexBuffer>(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+			mesh.VAO->AddBuffer(*mesh.Vertices, layout);
+			mesh.Indices = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+			m_SeparateMeshes.push_back(std::move(mesh));
+
+			glm::vec3 position((i % columns + 0.5f) * cell, (i / columns + 0.5f) * cell, 0.0f);
+			glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(cell, cell, 1.0f));
+			m_Instances.push_back({ model, glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f) });
+		}
+	}
+
+	void TestMeshPool::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+		m_WhiteTexture->Bind();
+
+		auto start = std::chrono::steady_clock::now();
+
+		if (m_Mode == DrawMode::SeparateMeshes)
+		{
+			Renderer renderer;
+			m_Shader->Bind();
+			for (size_t i = 0; i < m_SeparateMeshes.size(); i++)
+			{
+				const MeshInstance& instance = m_Instances[i];
+				for (unsigned int column = 0; column < 4; column++)
+				{
+					GLCall(glVertexAttrib4fv(2 + column, &instance.Model[column][0]));
+				}
+				GLCall(glVertexAttrib4fv(6, &instance.Color[0]));
+
+				const SeparateMesh& mesh = m_SeparateMeshes[i];
+				renderer.Draw(*mesh.VAO, *mesh.Indices, *m_Shader);
+			}
+		}
+		else
+		{
+			m_Pool->SetMultiDrawEnabled(m_Mode == DrawMode::MultiDrawIndirect);
+			for (int i = 0; i < (int)m_Instances.size(); i++)
+				m_Pool->Submit(i, m_Instances[i].Model, m_Instances[i].Color);
+			m_Pool->Draw(*m_Shader);
+		}
+
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_DrawMs = m_DrawMs * 0.95f + ms * 0.05f;
+	}
+
+	void TestMeshPool::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Meshes", &m_MeshCount, 100, 20000))
+			CreateMeshes(m_MeshCount);
+
+		int mode = (int)m_Mode;
+		bool multiDraw = MeshPool::IsMultiDrawIndirectSupported();
+		if (multiDraw)
+			ImGui::RadioButton("Multi-draw indirect", &mode, (int)DrawMode::MultiDrawIndirect);
+		else
+			ImGui::TextDisabled("Multi-draw indirect (needs GL 4.3 or ARB_multi_draw_indirect)");
+		ImGui::RadioButton("Mesh pool, CPU loop", &mode, (int)DrawMode::PoolLoop);
+		ImGui::RadioButton("Separate meshes, Renderer::Draw", &mode, (int)DrawMode::SeparateMeshes);
+		m_Mode = (DrawMode)mode;
+
+		ImGui::Text("Pool: %u meshes, %u vertices, %u indices", m_Pool->GetMeshCount(), m_Pool->GetVertexCount(), m_Pool->GetIndexCount());
+		ImGui::Text("CPU submit and draw: %.3f ms", m_DrawMs);
+	}
+}
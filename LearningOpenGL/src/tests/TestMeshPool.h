@@ -0,0 +1,58 @@
+#pragma once
+
+#include "Test.h"
+
+#include "IndexBuffer.h"
+#include "MeshPool.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+#include "VertexArrayObject.h"
+#include "VertexBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestMeshPool : public Test
+	{
+	public:
+		TestMeshPool();
+		~TestMeshPool();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		enum class DrawMode
+		{
+			MultiDrawIndirect,
+			PoolLoop,
+			SeparateMeshes
+		};
+
+		// The same mesh in its own buffers, for the per-mesh Renderer::Draw comparison
+		struct SeparateMesh
+		{
+			std::unique_ptr<VertexArrayObject> VAO;
+			std::unique_ptr<VertexBuffer> Vertices;
+			std::unique_ptr<IndexBuffer> Indices;
+		};
+
+		void CreateMeshes(int count);
+
+		std::unique_ptr<MeshPool> m_Pool;
+		std::vector<SeparateMesh> m_SeparateMeshes;
+		std::vector<MeshInstance> m_Instances;		// One per mesh
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_WhiteTexture;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+
+		glm::mat4 m_Proj;
+		int m_MeshCount;
+		DrawMode m_Mode;
+		float m_DrawMs;		// Smoothed CPU time of submitting and drawing every mesh
+	};
+}
@@ -0,0 +1,175 @@
+#include "TestNullBackend.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "Renderer.h"
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <thread>
+
+/*
+ * TestNullBackend
+ * Runs the 2D Texture test against the null GL backend: its construction, texture loading and frames are
+ * recorded into GLCommandLogs and never reach the driver. Every real frame submits the scene many times,
+ * which measures the pure CPU cost of a frame, and each submitted frame must make exactly 2 draw calls
+ * and as many bind calls as GLStateCache says it issued (an ASSERT fires otherwise).
+ * "Replay into this context" records a second copy of the test from construction to destruction and
+ * executes the log for real, which draws the scene for one frame and reports whether OpenGL raised an error.
+ */
+
+namespace test {
+	static const int s_MaxLoadMs = 5000;
+
+	// Calls that bind an object, and so count as issued binds in GLStateCache
+	static const GLEntryPoint s_BindEntryPoints[] = {
+		GLEntryPoint::BindBuffer, GLEntryPoint::BindBufferBase, GLEntryPoint::BindBufferRange,
+		GLEntryPoint::BindTexture, GLEntryPoint::BindVertexArray, GLEntryPoint::UseProgram
+	};
+
+	static unsigned int CountBinds(const GLCommandLog& log)
+	{
+		unsigned int binds = 0;
+		for (GLEntryPoint entry : s_BindEntryPoints)
+			binds += log.GetCount(entry);
+		return binds;
+	}
+
+	TestNullBackend::TestNullBackend()
+		: m_FramesPerRender(1000), m_MeanSubmitUs(0.0), m_MinSubmitUs(0.0), m_FrameDrawCalls(0), m_FrameIssuedBinds(0),
+		m_ReplayRequested(false), m_ReplayDone(false), m_ReplaySucceeded(false), m_ReplayMs(0.0)
+	{
+		if (GLDispatch::BeginRecording(m_SetupLog))
+		{
+			m_Scene = std::make_unique<TestTexture2D>();
+			GLDispatch::EndRecording();
+		}
+	}
+
+	TestNullBackend::~TestNullBackend()
+	{
+		if (!m_Scene)
+			return;
+
+		// The scene's objects only exist in the log, so deleting them mustn't reach the driver
+		GLCommandLog teardown;
+		bool recording = GLDispatch::BeginRecording(teardown);
+		ASSERT(recording);
+		m_Scene.reset();
+		GLDispatch::EndRecording();
+	}
+
+	void TestNullBackend::OnUpdate(float deltaTime)
+	{
+		// Texture uploads are made here, spread over frames, until the texture is resident
+		if (m_Scene && !m_Scene->IsTextureResident() && GLDispatch::BeginRecording(m_SetupLog))
+		{
+			m_Scene->OnUpdate(deltaTime);
+			GLDispatch::EndRecording();
+		}
+	}
+
+	void TestNullBackend::OnRender()
+	{
+		if (m_ReplayRequested)
+		{
+			m_ReplayRequested = false;
+			RecordAndReplay();
+		}
+
+		if (!m_Scene || !m_Scene->IsTextureResident() || !GLDispatch::BeginRecording(m_FrameLog))
+			return;
+
+		double totalUs = 0.0;
+		m_MinSubmitUs = 0.0;
+		for (int frame = 0; frame < m_FramesPerRender; frame++)
+		{
+			m_FrameLog.Clear();
+			unsigned int drawCalls = Renderer::GetStats().DrawCalls;
+			unsigned int issuedBinds = GLStateCache::GetStats().IssuedBinds;
+
+			auto start = std::chrono::steady_clock::now();
+			m_Scene->OnRender();
+			double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+			m_FrameDrawCalls = Renderer::GetStats().DrawCalls - drawCalls;
+			m_FrameIssuedBinds = GLStateCache::GetStats().IssuedBinds - issuedBinds;
+			ASSERT(m_FrameDrawCalls == 2);
+			ASSERT(m_FrameLog.GetCount(GLEntryPoint::DrawElements) == m_FrameDrawCalls);
+			ASSERT(CountBinds(m_FrameLog) == m_FrameIssuedBinds);
+
+			totalUs += us;
+			m_MinSubmitUs = (frame == 0 || us < m_MinSubmitUs) ? us : m_MinSubmitUs;
+		}
+		m_MeanSubmitUs = totalUs / m_FramesPerRender;
+
+		GLDispatch::EndRecording();
+	}
+
+	/*
+	 * Records a separate 2D Texture test from construction to destruction, with one frame, and replays it
+	 */
+	void TestNullBackend::RecordAndReplay()
+	{
+		m_ReplayLog.Clear();
+		if (!GLDispatch::BeginRecording(m_ReplayLog))
+			return;
+
+		{
+			TestTexture2D scene;
+			auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(s_MaxLoadMs);
+			while (!scene.IsTextureResident() && std::chrono::steady_clock::now() < deadline)
+			{
+				scene.OnUpdate(0.0f);
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			}
+			scene.OnRender();
+		}
+		GLDispatch::EndRecording();
+
+		auto start = std::chrono::steady_clock::now();
+		m_ReplaySucceeded = GLDispatch::Replay(m_ReplayLog);
+		m_ReplayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_ReplayDone = true;
+	}
+
+	void TestNullBackend::OnImGuiRender()
+	{
+		if (!m_Scene)
+		{
+			ImGui::Text("Recording isn't available (GL_DISPATCH_ENABLED is 0, or the render thread is on)");
+			return;
+		}
+
+		ImGui::Text("Setup: %zu calls, %zu bytes", m_SetupLog.GetCommandCount(), m_SetupLog.GetSize());
+		if (!m_Scene->IsTextureResident())
+		{
+			ImGui::Text("Loading the texture...");
+			return;
+		}
+
+		ImGui::SliderInt("Frames per frame", &m_FramesPerRender, 1, 10000);
+		ImGui::Text("CPU submit: %.2f us per frame (%.2f us fastest)", m_MeanSubmitUs, m_MinSubmitUs);
+		ImGui::Text("Last frame: %zu calls, %zu bytes, %u draw calls, %u binds", m_FrameLog.GetCommandCount(), m_FrameLog.GetSize(),
+			m_FrameDrawCalls, m_FrameIssuedBinds);
+
+		if (ImGui::TreeNode("Calls in the last frame"))
+		{
+			for (size_t i = 0; i < (size_t)GLEntryPoint::Count; i++)
+			{
+				unsigned int count = m_FrameLog.GetCount((GLEntryPoint)i);
+				if (count > 0)
+					ImGui::Text("%s: %u", GLDispatch::GetEntryPointName((GLEntryPoint)i), count);
+			}
+			ImGui::TreePop();
+		}
+
+		ImGui::Separator();
+		if (ImGui::Button("Replay into this context"))
+			m_ReplayRequested = true;
+		if (m_ReplayDone)
+		{
+			ImGui::Text("%s: %zu calls replayed in %.3f ms", m_ReplaySucceeded ? "Succeeded" : "Failed (see the console)",
+				m_ReplayLog.GetCommandCount(), m_ReplayMs);
+		}
+	}
+}
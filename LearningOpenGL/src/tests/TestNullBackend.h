@@ -0,0 +1,39 @@
+#pragma once
+
+#include "Test.h"
+#include "TestTexture2D.h"
+#include "GLCommandLog.h"
+
+#include <memory>
+
+namespace test {
+	class TestNullBackend : public Test
+	{
+	public:
+		TestNullBackend();
+		~TestNullBackend();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void RecordAndReplay();
+
+		std::unique_ptr<TestTexture2D> m_Scene;	// Only ever touched while recording, its objects have fake names
+		GLCommandLog m_SetupLog;	// Construction and texture loading
+		GLCommandLog m_FrameLog;	// The last submitted frame
+		GLCommandLog m_ReplayLog;	// A whole lifecycle, recorded for replay
+
+		int m_FramesPerRender;		// Frames submitted to the null backend per real frame
+		double m_MeanSubmitUs;
+		double m_MinSubmitUs;
+		unsigned int m_FrameDrawCalls;
+		unsigned int m_FrameIssuedBinds;
+
+		bool m_ReplayRequested;
+		bool m_ReplayDone;
+		bool m_ReplaySucceeded;
+		double m_ReplayMs;
+	};
+}
@@ -0,0 +1,251 @@
+#include "TestParallelRecording.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <thread>
+
+/*
+ * TestParallelRecording
+ * Draws up to 100k spinning objects with random materials through RenderQueue::Record(), which builds their
+ * draw commands on several threads, each into its own DrawCommandBuffer. The buffers are merged and radix sorted
+ * on the same threads, then drawn on the render thread. "Scale threads" measures every thread count from 1 to
+ * the number of hardware threads and lists the CPU time of recording, merging and sorting per frame.
+ */
+
+namespace test {
+	static const int s_ShaderCount = 4;
+	static const int s_TextureCount = 16;
+	static const int s_MeshSides[] = { 3, 4, 6, 8 };
+	static const int s_SweepWarmupFrames = 10;
+	static const int s_SweepFrames = 60;
+
+	TestParallelRecording::TestParallelRecording()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Time(0.0f), m_PreviousTime(0.0f), m_RenderTime(0.0f), m_ObjectCount(50000), m_Threads(1),
+		m_MaxThreads((int)std::max(std::thread::hardware_concurrency(), 1u)), m_Sorting(true),
+		m_RecordMs(0.0f), m_MergeMs(0.0f), m_SortMs(0.0f), m_ExecuteMs(0.0f), m_Sweeping(false), m_SweepFrame(0), m_SweepCurrent{}
+	{
+		m_Pool = std::make_unique<ThreadPool>();
+		m_Threads = std::min(m_MaxThreads, (int)m_Pool->GetWorkerCount() + 1);
+		m_Queue = std::make_unique<RenderQueue>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		for (int i = 0; i < s_ShaderCount; i++)
+			m_Shaders.push_back(std::make_unique<Shader>("res/shaders/Object.vert", "res/shaders/Object.frag"));
+
+		for (int i = 0; i < s_TextureCount; i++)
+		{
+			// 8x8 checkers in different colors
+			unsigned char pixels[8 * 8 * 4];
+			for (int p = 0; p < 64; p++)
+			{
+				bool dark = ((p % 8) / 2 + (p / 8) / 2) % 2 == 1;
+				pixels[p * 4 + 0] = (unsigned char)(dark ? 40 : 80 + i * 10);
+				pixels[p * 4 + 1] = (unsigned char)(dark ? 40 : 240 - i * 11);
+				pixels[p * 4 + 2] = (unsigned char)(dark ? 40 : 60 + i * 9);
+				pixels[p * 4 + 3] = 255;
+			}
+			m_Textures.push_back(std::make_unique<Texture>(8, 8, pixels));
+		}
+
+		for (int sides : s_MeshSides)
+			CreateMesh(sides);
+
+		GenerateObjects(m_ObjectCount);
+	}
+
+	TestParallelRecording::~TestParallelRecording()
+	{
+	}
+
+	/*
+	 * Regular polygon with [sides] sides and a radius of 0.5, as a triangle fan around its center
+	 */
+	void TestParallelRecording::CreateMesh(int sides)
+	{
+		std::vector<float> vertices = { 0.0f, 0.0f, 0.5f, 0.5f };
+		std::vector<unsigned int> indices;
+		for (int i = 0; i < sides; i++)
+		{
+			float angle = i * 6.2832f / sides;
+			float x = 0.5f * std::cos(angle), y = 0.5f * std::sin(angle);
+			vertices.insert(vertices.end(), { x, y, x + 0.5f, y + 0.5f });
+			indices.insert(indices.end(), { 0u, (unsigned int)i + 1, (unsigned int)(i + 1) % sides + 1 });
+		}
+
+		Mesh mesh;
+		mesh.VAO = std::make_unique<VertexArrayObject>();
+		mesh.Vertices = std::make_unique<VertexBuffer>(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);	// Position
+		layout.Push<float>(2);	// TexCoord
+		mesh.VAO->AddBuffer(*mesh.Vertices, layout);
+		mesh.Indices = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+		m_Meshes.push_back(std::move(mesh));
+	}
+
+	void TestParallelRecording::GenerateObjects(int count)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2832f), spin(-2.0f, 2.0f),
+			size(4.0f, 16.0f), channel(0.5f, 1.0f), depth(0.0f, 1.0f);
+
+		m_Objects.resize(count);
+		for (Object& object : m_Objects)
+		{
+			object.Position = glm::vec2(x(rng), y(rng));
+			object.Angle = angle(rng);
+			object.Spin = spin(rng);
+			object.Size = size(rng);
+			object.Color = glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f);
+			object.ShaderIndex = rng() % m_Shaders.size();
+			object.TextureIndex = rng() % m_Textures.size();
+			object.MeshIndex = rng() % m_Meshes.size();
+			object.Depth = depth(rng);
+		}
+	}
+
+	void TestParallelRecording::OnUpdate(float deltaTime)
+	{
+		m_PreviousTime = m_Time;
+		m_Time += deltaTime;
+	}
+
+	/*
+	 * Called on a recording thread for the objects [first, end). Only reads the test and writes [buffer].
+	 */
+	void TestParallelRecording::RecordObjects(DrawCommandBuffer& buffer, unsigned int first, unsigned int end) const
+	{
+		for (unsigned int i = first; i < end; i++)
+		{
+			const Object& object = m_Objects[i];
+			const Mesh& mesh = m_Meshes[object.MeshIndex];
+
+			ObjectBlock block;
+			block.Model = glm::translate(glm::mat4(1.0f), glm::vec3(object.Position, 0.0f));
+			block.Model = glm::rotate(block.Model, object.Angle + object.Spin * m_RenderTime, glm::vec3(0.0f, 0.0f, 1.0f));
+			block.Model = glm::scale(block.Model, glm::vec3(object.Size, object.Size, 1.0f));
+			block.Color = object.Color;
+
+			DrawCommand command;
+			command.VertexArray = mesh.VAO.get();
+			command.Indices = mesh.Indices.get();
+			command.Program = m_Shaders[object.ShaderIndex].get();
+			command.Textures[0] = m_Textures[object.TextureIndex].get();
+			command.UniformOffset = buffer.PushUniforms(&block, sizeof(ObjectBlock));
+			command.UniformSize = sizeof(ObjectBlock);
+			command.Depth = object.Depth;
+			buffer.Submit(command);
+		}
+	}
+
+	void TestParallelRecording::OnRender()
+	{
+		OnRenderInterpolated(1.0f);
+	}
+
+	/*
+	 * Draws the objects as they are [alpha] of the way from the previous update to the last one,
+	 * so they turn smoothly even when frames come faster than updates
+	 */
+	void TestParallelRecording::OnRenderInterpolated(float alpha)
+	{
+		m_RenderTime = m_PreviousTime + (m_Time - m_PreviousTime) * alpha;
+
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		m_Queue->Record(*m_Pool, (unsigned int)m_Threads, (unsigned int)m_Objects.size(),
+			[this](DrawCommandBuffer& buffer, unsigned int first, unsigned int end) { RecordObjects(buffer, first, end); });
+
+		m_Queue->SetSortingEnabled(m_Sorting);
+		m_Queue->Execute();
+
+		const RenderQueueStats& stats = m_Queue->GetStats();
+		m_RecordMs = m_RecordMs * 0.95f + (float)stats.RecordMs * 0.05f;
+		m_MergeMs = m_MergeMs * 0.95f + (float)stats.MergeMs * 0.05f;
+		m_SortMs = m_SortMs * 0.95f + (float)stats.SortMs * 0.05f;
+		m_ExecuteMs = m_ExecuteMs * 0.95f + (float)stats.ExecuteMs * 0.05f;
+
+		UpdateSweep(stats);
+	}
+
+	/*
+	 * Adds the frame to the thread count being measured, and moves on to the next count once it has enough frames
+	 */
+	void TestParallelRecording::UpdateSweep(const RenderQueueStats& stats)
+	{
+		if (!m_Sweeping)
+			return;
+
+		m_SweepFrame++;
+		if (m_SweepFrame <= s_SweepWarmupFrames)
+			return;
+
+		m_SweepCurrent.RecordMs += stats.RecordMs;
+		m_SweepCurrent.MergeMs += stats.MergeMs;
+		m_SweepCurrent.SortMs += stats.SortMs;
+		if (m_SweepFrame < s_SweepWarmupFrames + s_SweepFrames)
+			return;
+
+		m_SweepCurrent.RecordMs /= s_SweepFrames;
+		m_SweepCurrent.MergeMs /= s_SweepFrames;
+		m_SweepCurrent.SortMs /= s_SweepFrames;
+		m_SweepResults.push_back(m_SweepCurrent);
+
+		if (m_Threads >= m_MaxThreads)
+		{
+			m_Sweeping = false;
+			return;
+		}
+		m_Threads++;
+		m_SweepFrame = 0;
+		m_SweepCurrent = { (unsigned int)m_Threads, 0.0, 0.0, 0.0 };
+	}
+
+	void TestParallelRecording::OnImGuiRender()
+	{
+		if (m_Sweeping)
+			ImGui::Text("Measuring %d of %d threads...", m_Threads, m_MaxThreads);
+		else
+		{
+			if (ImGui::SliderInt("Objects", &m_ObjectCount, 1000, 100000))
+				GenerateObjects(m_ObjectCount);
+			ImGui::SliderInt("Recording threads", &m_Threads, 1, m_MaxThreads);
+			ImGui::Checkbox("Sort by key", &m_Sorting);
+			if (ImGui::Button("Scale threads"))
+			{
+				m_Sweeping = true;
+				m_Threads = 1;
+				m_SweepFrame = 0;
+				m_SweepCurrent = { 1, 0.0, 0.0, 0.0 };
+				m_SweepResults.clear();
+			}
+		}
+
+		const RenderQueueStats& stats = m_Queue->GetStats();
+		ImGui::Text("Commands: %u, sorted on %u threads", stats.Commands, stats.SortThreads);
+		ImGui::Text("Record: %.3f ms, merge: %.3f ms, sort: %.3f ms", m_RecordMs, m_MergeMs, m_SortMs);
+		ImGui::Text("Execute: %.3f ms (including the sort)", m_ExecuteMs);
+
+		if (!m_SweepResults.empty())
+		{
+			ImGui::Separator();
+			ImGui::Text("CPU time per frame, %d frames each:", s_SweepFrames);
+			double singleThreadMs = m_SweepResults[0].RecordMs + m_SweepResults[0].MergeMs + m_SweepResults[0].SortMs;
+			for (const SweepResult& result : m_SweepResults)
+			{
+				double totalMs = result.RecordMs + result.MergeMs + result.SortMs;
+				ImGui::Text("%2u threads: record %.3f ms, merge %.3f ms, sort %.3f ms (%.2fx)", result.Threads,
+					result.RecordMs, result.MergeMs, result.SortMs, totalMs > 0.0 ? singleThreadMs / totalMs : 0.0);
+			}
+		}
+	}
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include "Test.h"
+
+#include "IndexBuffer.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "ThreadPool.h"
+#include "UniformBuffer.h"
+#include "VertexArrayObject.h"
+#include "VertexBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestParallelRecording : public Test
+	{
+	public:
+		TestParallelRecording();
+		~TestParallelRecording();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnRenderInterpolated(float alpha) override;
+		void OnImGuiRender() override;
+
+	private:
+		struct Mesh
+		{
+			std::unique_ptr<VertexArrayObject> VAO;
+			std::unique_ptr<VertexBuffer> Vertices;
+			std::unique_ptr<IndexBuffer> Indices;
+		};
+
+		// Per-object uniform block, matching ObjectBlockLayout()
+		struct ObjectBlock
+		{
+			glm::mat4 Model;
+			glm::vec4 Color;
+		};
+
+		// The model matrix is rebuilt every frame while recording, so each object costs some CPU time
+		struct Object
+		{
+			glm::vec2 Position;
+			float Angle, Spin, Size;
+			glm::vec4 Color;
+			int ShaderIndex, TextureIndex, MeshIndex;
+			float Depth;
+		};
+
+		struct SweepResult
+		{
+			unsigned int Threads;
+			double RecordMs, MergeMs, SortMs;	// Means per frame
+		};
+
+		void CreateMesh(int sides);
+		void GenerateObjects(int count);
+		void RecordObjects(DrawCommandBuffer& buffer, unsigned int first, unsigned int end) const;
+		void UpdateSweep(const RenderQueueStats& stats);
+
+		std::unique_ptr<ThreadPool> m_Pool;
+		std::unique_ptr<RenderQueue> m_Queue;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::vector<std::unique_ptr<Shader>> m_Shaders;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		std::vector<Mesh> m_Meshes;
+		std::vector<Object> m_Objects;
+
+		glm::mat4 m_Proj;
+		float m_Time;			// Of the last update
+		float m_PreviousTime;	// Of the update before it
+		float m_RenderTime;		// Between the two, at the frame's alpha
+		int m_ObjectCount;
+		int m_Threads;
+		int m_MaxThreads;		// Hardware threads
+		bool m_Sorting;
+		float m_RecordMs;		// Smoothed
+		float m_MergeMs;
+		float m_SortMs;
+		float m_ExecuteMs;
+
+		// Benchmark: every thread count from 1 to m_MaxThreads, for a fixed number of frames each
+		bool m_Sweeping;
+		int m_SweepFrame;
+		SweepResult m_SweepCurrent;
+		std::vector<SweepResult> m_SweepResults;
+	};
+}
@@ -0,0 +1,193 @@
+#include "TestPixelConvert.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <random>
+
+/*
+ * TestPixelConvert
+ * Runs every PixelConvert operation with each backend the CPU supports on a random 2048x2048 image,
+ * checking the output is bit for bit the same as the scalar version and timing it.
+ *
+ * It also draws an image with transparent edges, minified through its mipmaps, with straight alpha
+ * (GL_SRC_ALPHA blending) and premultiplied alpha (GL_ONE blending). Straight alpha filters the color of
+ * transparent pixels into the edges, leaving dark fringes that premultiplied alpha doesn't have.
+ */
+
+namespace test {
+	static const int s_ImageSize = 2048;
+	static const int s_Repeats = 5;		// Each timing is the fastest of this many runs
+	static const PixelBackend s_Backends[] = { PixelBackend::Scalar, PixelBackend::SSE2, PixelBackend::AVX2, PixelBackend::NEON };
+
+	TestPixelConvert::TestPixelConvert()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_Scale(0.25f), m_Measured(false), m_DivisionExact(false)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		TextureSpec spec;
+		spec.Mipmaps = MipmapMode::GenerateGPU;
+		m_StraightTexture = std::make_unique<Texture>("res/textures/Mail icon.png", spec);
+		spec.PremultiplyAlpha = true;
+		m_PremultipliedTexture = std::make_unique<Texture>("res/textures/Mail icon.png", spec);
+	}
+
+	TestPixelConvert::~TestPixelConvert()
+	{
+		// Leave the blend state the way Display set it up
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	}
+
+	void TestPixelConvert::RunBenchmark()
+	{
+		m_DivisionExact = true;
+		for (int c = 0; c < 256; c++)
+		{
+			for (int a = 0; a < 256; a++)
+			{
+				unsigned char pixel[4] = { (unsigned char)c, 0, 0, (unsigned char)a };
+				PixelConvert::PremultiplyAlpha(pixel, 1);
+				m_DivisionExact &= pixel[0] == (unsigned char)std::floor(c * a / 255.0 + 0.5);
+			}
+		}
+
+		size_t pixelCount = (size_t)s_ImageSize * s_ImageSize;
+		std::vector<unsigned char> source(pixelCount * 4);
+		std::mt19937 rng(1234);
+		for (unsigned char& byte : source)
+			byte = (unsigned char)rng();
+
+		std::vector<unsigned char> bytes(pixelCount * 4), scalarBytes[OperationCount];
+		std::vector<float> floats(pixelCount * 4), scalarFloats[OperationCount];
+
+		PixelBackend previous = PixelConvert::GetBackend();
+		for (int b = 0; b < BackendCount; b++)
+		{
+			for (int operation = 0; operation < OperationCount; operation++)
+			{
+				Result& result = m_Results[operation][b];
+				result = Result();
+				if (!PixelConvert::IsSupported(s_Backends[b]))
+					continue;
+				PixelConvert::SetBackend(s_Backends[b]);
+
+				float bestSeconds = 1e9f;
+				for (int repeat = 0; repeat < s_Repeats; repeat++)
+				{
+					// Expand reads the first 3 bytes per pixel, the rest read all 4
+					std::memcpy(bytes.data(), source.data(), source.size());
+
+					auto start = std::chrono::steady_clock::now();
+					switch (operation)
+					{
+					case Flip:			PixelConvert::FlipVertical(bytes.data(), s_ImageSize, s_ImageSize, 4); break;
+					case Expand:		PixelConvert::ExpandRGBToRGBA(bytes.data(), pixelCount); break;
+					case Premultiply:	PixelConvert::PremultiplyAlpha(bytes.data(), pixelCount); break;
+					case ToLinear:		PixelConvert::ToLinear(bytes.data(), floats.data(), pixelCount, false); break;
+					case ToLinearSRGB:	PixelConvert::ToLinear(bytes.data(), floats.data(), pixelCount, true); break;
+					}
+					bestSeconds = std::min(bestSeconds, std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count());
+				}
+
+				bool floatOutput = operation == ToLinear || operation == ToLinearSRGB;
+				if (s_Backends[b] == PixelBackend::Scalar)
+				{
+					scalarBytes[operation] = bytes;
+					scalarFloats[operation] = floats;
+					result.Exact = true;
+				}
+				else if (floatOutput)
+				{
+					result.Exact = std::memcmp(floats.data(), scalarFloats[operation].data(), floats.size() * sizeof(float)) == 0;
+				}
+				else
+				{
+					result.Exact = bytes == scalarBytes[operation];
+				}
+
+				result.Supported = true;
+				result.MegapixelsPerSecond = pixelCount / bestSeconds / 1e6f;
+			}
+		}
+		PixelConvert::SetBackend(previous);
+
+		m_Measured = true;
+	}
+
+	void TestPixelConvert::OnRender()
+	{
+		GLCall(glClearColor(0.85f, 0.85f, 0.85f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+		float size = 512.0f * m_Scale;
+		const Texture* textures[2] = { m_StraightTexture.get(), m_PremultipliedTexture.get() };
+		for (int i = 0; i < 2; i++)
+		{
+			if (i == 0)
+			{
+				GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+			}
+			else
+			{
+				GLCall(glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+			}
+
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(320.0f + i * 320.0f, 270.0f, 0.0f));
+			transform = glm::scale(transform, glm::vec3(size, size, 1.0f));
+
+			m_BatchRenderer->BeginBatch();
+			m_BatchRenderer->SubmitQuad(transform, fullTexture, *textures[i], glm::vec4(1.0f));
+			m_BatchRenderer->EndBatch();
+		}
+		GLCall(glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA));
+	}
+
+	void TestPixelConvert::OnImGuiRender()
+	{
+		ImGui::Text("Left: straight alpha, right: premultiplied alpha");
+		ImGui::SliderFloat("Scale", &m_Scale, 0.05f, 1.0f);
+
+		ImGui::Text("Default backend: %s", PixelConvert::GetBackendName(PixelConvert::GetBackend()));
+		if (ImGui::Button("Run benchmark"))
+			RunBenchmark();
+
+		if (!m_Measured)
+			return;
+
+		ImGui::Text("Premultiply rounding exact for all 65536 inputs: %s", m_DivisionExact ? "yes" : "NO");
+
+		const char* operations[OperationCount] = { "Flip", "Expand RGB", "Premultiply", "To linear", "sRGB to linear" };
+		ImGui::Text("%-16s", "MP/s");
+		for (int b = 0; b < BackendCount; b++)
+		{
+			ImGui::SameLine(140.0f + b * 90.0f);
+			ImGui::Text("%s", PixelConvert::GetBackendName(s_Backends[b]));
+		}
+		for (int operation = 0; operation < OperationCount; operation++)
+		{
+			ImGui::Text("%s", operations[operation]);
+			for (int b = 0; b < BackendCount; b++)
+			{
+				const Result& result = m_Results[operation][b];
+				ImGui::SameLine(140.0f + b * 90.0f);
+				if (!result.Supported)
+					ImGui::TextDisabled("-");
+				else if (result.Exact)
+					ImGui::Text("%.0f", result.MegapixelsPerSecond);
+				else
+					ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "%.0f (!)", result.MegapixelsPerSecond);
+			}
+		}
+		ImGui::TextDisabled("(!) output differs from the scalar backend");
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "PixelConvert.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestPixelConvert : public Test
+	{
+	public:
+		TestPixelConvert();
+		~TestPixelConvert();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		enum Operation { Flip, Expand, Premultiply, ToLinear, ToLinearSRGB, OperationCount };
+		static const int BackendCount = 4;
+
+		struct Result
+		{
+			bool Supported = false;
+			bool Exact = false;			// Same bytes as the scalar backend
+			float MegapixelsPerSecond = 0.0f;
+		};
+
+		void RunBenchmark();
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::unique_ptr<Texture> m_StraightTexture;			// The same image, with straight and premultiplied alpha
+		std::unique_ptr<Texture> m_PremultipliedTexture;
+		glm::mat4 m_Proj;
+		float m_Scale;
+
+		bool m_Measured;
+		bool m_DivisionExact;	// The premultiply rounding matches round(c * a / 255) for every c and a
+		Result m_Results[OperationCount][BackendCount];
+	};
+}
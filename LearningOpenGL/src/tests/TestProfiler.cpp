@@ -0,0 +1,111 @@
+#include "TestProfiler.h"
+#include "Profiler.h"
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+/*
+ * TestProfiler
+ * Measures what a PROFILE_SCOPE costs, recorded and with recording turned off, on a separate thread
+ * so the million benchmark scopes don't fill the render thread's ring. Every frame it also runs a few
+ * nested, named scopes of busy work, to show in the Profiler panel (the checkbox in the Test window).
+ */
+
+namespace test {
+	static const int s_BenchmarkScopes = 1000000;
+	static volatile float s_Sink = 0.0f;
+
+	/*
+	 * Busy work of roughly [iterations] square roots
+	 */
+	static void Work(int iterations)
+	{
+		float sum = 0.0f;
+		for (int i = 0; i < iterations; i++)
+			sum += std::sqrt((float)i);
+		s_Sink = sum;
+	}
+
+	TestProfiler::TestProfiler()
+		: m_WorkItems(8), m_EnabledNs(0.0), m_DisabledNs(0.0), m_LoopNs(0.0), m_Benchmarked(false)
+	{
+	}
+
+	TestProfiler::~TestProfiler()
+	{
+	}
+
+	void TestProfiler::OnUpdate(float deltaTime)
+	{
+		PROFILE_SCOPE("Simulated update");
+		for (int item = 0; item < m_WorkItems; item++)
+		{
+			PROFILE_SCOPE("Work item");
+			{
+				PROFILE_SCOPE("Physics");
+				Work(20000);
+			}
+			{
+				PROFILE_SCOPE("Animation");
+				Work(10000 + item * 2000);
+			}
+		}
+	}
+
+	void TestProfiler::RunBenchmark()
+	{
+		auto timeLoop = [](bool scoped)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (int i = 0; i < s_BenchmarkScopes; i++)
+			{
+				if (scoped)
+				{
+					PROFILE_SCOPE("Benchmark scope");
+					s_Sink = (float)i;
+				}
+				else
+				{
+					s_Sink = (float)i;
+				}
+			}
+			return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / s_BenchmarkScopes;
+		};
+
+		std::thread benchmark([&]()
+			{
+				Profiler::SetThreadName("Profiler benchmark");
+				bool wasEnabled = Profiler::IsEnabled();
+
+				m_LoopNs = timeLoop(false);
+				Profiler::SetEnabled(true);
+				m_EnabledNs = timeLoop(true) - m_LoopNs;
+				Profiler::SetEnabled(false);
+				m_DisabledNs = timeLoop(true) - m_LoopNs;
+
+				Profiler::SetEnabled(wasEnabled);
+			});
+		benchmark.join();
+		m_Benchmarked = true;
+	}
+
+	void TestProfiler::OnImGuiRender()
+	{
+		ImGui::SliderInt("Work items", &m_WorkItems, 0, 64);
+		ImGui::Text("Open the Profiler panel with the checkbox below to see them.");
+
+		if (ImGui::Button("Measure scope overhead"))
+			RunBenchmark();
+		if (m_Benchmarked)
+		{
+			ImGui::Text("Recorded scope: %.1f ns", m_EnabledNs);
+			ImGui::Text("Scope while recording is off: %.1f ns", m_DisabledNs);
+			ImGui::TextDisabled("(loop overhead of %.1f ns subtracted, %d scopes each)", m_LoopNs, s_BenchmarkScopes);
+		}
+#if !PROFILING_ENABLED
+		ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "PROFILING_ENABLED is 0, scopes are compiled out");
+#endif
+	}
+}
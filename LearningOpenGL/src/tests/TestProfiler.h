@@ -0,0 +1,24 @@
+#pragma once
+
+#include "Test.h"
+
+namespace test {
+	class TestProfiler : public Test
+	{
+	public:
+		TestProfiler();
+		~TestProfiler();
+
+		void OnUpdate(float deltaTime) override;
+		void OnImGuiRender() override;
+
+	private:
+		void RunBenchmark();
+
+		int m_WorkItems;		// Nested scopes simulated every frame, to have something to look at in the panel
+		double m_EnabledNs;		// Cost of one recorded scope
+		double m_DisabledNs;	// Cost of one scope while recording is turned off
+		double m_LoopNs;		// Cost of the benchmark loop without a scope, already subtracted from the others
+		bool m_Benchmarked;
+	};
+}
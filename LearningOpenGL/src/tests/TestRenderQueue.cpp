@@ -0,0 +1,157 @@
+#include "TestRenderQueue.h"
+#include "GLErrorManager.h"
+#include "GLStateCache.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+
+/*
+ * TestRenderQueue
+ * Draws thousands of objects with random materials (one of 4 shader programs, 16 textures and 4 meshes)
+ * through the RenderQueue, in the order they were submitted or sorted by key, and compares the state changes
+ * and CPU time. The shader programs all come from res/shaders/Object.vert/.frag, created separately so they
+ * stand in for different materials' shaders.
+ */
+
+namespace test {
+	static const int s_ShaderCount = 4;
+	static const int s_GeneratedTextureCount = 13;
+	static const int s_MeshSides[] = { 3, 4, 6, 8 };
+
+	TestRenderQueue::TestRenderQueue()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_ObjectCount(10000), m_Sorting(true),
+		m_SubmitMs(0.0f), m_ExecuteMs(0.0f), m_SortMs(0.0f)
+	{
+		m_Queue = std::make_unique<RenderQueue>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		for (int i = 0; i < s_ShaderCount; i++)
+			m_Shaders.push_back(std::make_unique<Shader>("res/shaders/Object.vert", "res/shaders/Object.frag"));
+
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/manatee.jpg"));
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/mct.png"));
+		m_Textures.push_back(std::make_unique<Texture>("res/textures/Mail icon.png"));
+		for (int i = 0; i < s_GeneratedTextureCount; i++)
+		{
+			// 8x8 checkers in different colors
+			unsigned char pixels[8 * 8 * 4];
+			for (int p = 0; p < 64; p++)
+			{
+				bool dark = ((p % 8) / 2 + (p / 8) / 2) % 2 == 1;
+				pixels[p * 4 + 0] = (unsigned char)(dark ? 40 : 100 + i * 11);
+				pixels[p * 4 + 1] = (unsigned char)(dark ? 40 : 240 - i * 13);
+				pixels[p * 4 + 2] = (unsigned char)(dark ? 40 : 60 + i * 7);
+				pixels[p * 4 + 3] = 255;
+			}
+			m_Textures.push_back(std::make_unique<Texture>(8, 8, pixels));
+		}
+
+		for (int sides : s_MeshSides)
+			CreateMesh(sides);
+
+		GenerateObjects(m_ObjectCount);
+	}
+
+	TestRenderQueue::~TestRenderQueue()
+	{
+	}
+
+	/*
+	 * Regular polygon with [sides] sides and a radius of 0.5, as a triangle fan around its center
+	 */
+	void TestRenderQueue::CreateMesh(int sides)
+	{
+		std::vector<float> vertices = { 0.0f, 0.0f, 0.5f, 0.5f };
+		std::vector<unsigned int> indices;
+		for (int i = 0; i < sides; i++)
+		{
+			float angle = i * 6.2832f / sides;
+			float x = 0.5f * std::cos(angle), y = 0.5f * std::sin(angle);
+			vertices.insert(vertices.end(), { x, y, x + 0.5f, y + 0.5f });
+			indices.insert(indices.end(), { 0u, (unsigned int)i + 1, (unsigned int)(i + 1) % sides + 1 });
+		}
+
+		Mesh mesh;
+		mesh.VAO = std::make_unique<VertexArrayObject>();
+		mesh.Vertices = std::make_unique<VertexBuffer>(vertices.data(), (unsigned int)(vertices.size() * sizeof(float)));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);	// Position
+		layout.Push<float>(2);	// TexCoord
+		mesh.VAO->AddBuffer(*mesh.Vertices, layout);
+		mesh.Indices = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+		m_Meshes.push_back(std::move(mesh));
+	}
+
+	void TestRenderQueue::GenerateObjects(int count)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), angle(0.0f, 6.2832f),
+			size(8.0f, 32.0f), channel(0.5f, 1.0f), depth(0.0f, 1.0f);
+
+		m_Objects.resize(count);
+		for (Object& object : m_Objects)
+		{
+			float s = size(rng);
+			object.Block.Model = glm::translate(glm::mat4(1.0f), glm::vec3(x(rng), y(rng), 0.0f));
+			object.Block.Model = glm::rotate(object.Block.Model, angle(rng), glm::vec3(0.0f, 0.0f, 1.0f));
+			object.Block.Model = glm::scale(object.Block.Model, glm::vec3(s, s, 1.0f));
+			object.Block.Color = glm::vec4(channel(rng), channel(rng), channel(rng), 1.0f);
+			object.ShaderIndex = rng() % m_Shaders.size();
+			object.TextureIndex = rng() % m_Textures.size();
+			object.MeshIndex = rng() % m_Meshes.size();
+			object.Depth = depth(rng);
+		}
+	}
+
+	void TestRenderQueue::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		auto start = std::chrono::steady_clock::now();
+
+		for (const Object& object : m_Objects)
+		{
+			const Mesh& mesh = m_Meshes[object.MeshIndex];
+
+			DrawCommand command;
+			command.VertexArray = mesh.VAO.get();
+			command.Indices = mesh.Indices.get();
+			command.Program = m_Shaders[object.ShaderIndex].get();
+			command.Textures[0] = m_Textures[object.TextureIndex].get();
+			command.UniformOffset = m_Queue->PushUniforms(&object.Block, sizeof(ObjectBlock));
+			command.UniformSize = sizeof(ObjectBlock);
+			command.Depth = object.Depth;
+			m_Queue->Submit(command);
+		}
+
+		float submitMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		m_Queue->SetSortingEnabled(m_Sorting);
+		m_Queue->Execute();
+
+		m_SubmitMs = m_SubmitMs * 0.95f + submitMs * 0.05f;
+		m_ExecuteMs = m_ExecuteMs * 0.95f + (float)m_Queue->GetStats().ExecuteMs * 0.05f;
+		m_SortMs = m_SortMs * 0.95f + (float)m_Queue->GetStats().SortMs * 0.05f;
+	}
+
+	void TestRenderQueue::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Objects", &m_ObjectCount, 100, 50000))
+			GenerateObjects(m_ObjectCount);
+		ImGui::Checkbox("Sort by key", &m_Sorting);
+
+		const RenderQueueStats& stats = m_Queue->GetStats();
+		ImGui::Text("Commands: %u", stats.Commands);
+		ImGui::Text("State changes: %u shader, %u texture, %u VAO, %u uniform range",
+			stats.ProgramChanges, stats.TextureChanges, stats.VertexArrayChanges, stats.UniformRangeChanges);
+		ImGui::Text("Submit: %.3f ms, execute: %.3f ms (sort %.3f ms)", m_SubmitMs, m_ExecuteMs, m_SortMs);
+	}
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "Test.h"
+
+#include "IndexBuffer.h"
+#include "RenderQueue.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+#include "VertexArrayObject.h"
+#include "VertexBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestRenderQueue : public Test
+	{
+	public:
+		TestRenderQueue();
+		~TestRenderQueue();
+
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		struct Mesh
+		{
+			std::unique_ptr<VertexArrayObject> VAO;
+			std::unique_ptr<VertexBuffer> Vertices;
+			std::unique_ptr<IndexBuffer> Indices;
+		};
+
+		// Per-object uniform block, matching ObjectBlockLayout()
+		struct ObjectBlock
+		{
+			glm::mat4 Model;
+			glm::vec4 Color;
+		};
+
+		struct Object
+		{
+			ObjectBlock Block;
+			int ShaderIndex, TextureIndex, MeshIndex;
+			float Depth;
+		};
+
+		void CreateMesh(int sides);
+		void GenerateObjects(int count);
+
+		std::unique_ptr<RenderQueue> m_Queue;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::vector<std::unique_ptr<Shader>> m_Shaders;
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		std::vector<Mesh> m_Meshes;
+		std::vector<Object> m_Objects;
+
+		glm::mat4 m_Proj;
+		int m_ObjectCount;
+		bool m_Sorting;
+		float m_SubmitMs;		// Smoothed CPU time of pushing uniforms and submitting every object
+		float m_ExecuteMs;		// Smoothed CPU time of Execute(), including the sort
+		float m_SortMs;
+	};
+}
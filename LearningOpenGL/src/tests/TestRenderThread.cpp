@@ -0,0 +1,70 @@
+#include "TestRenderThread.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+
+/*
+ * TestRenderThread
+ * A frame with a slow update: OnUpdate() keeps the CPU busy for a set time, then a field of sprites is drawn.
+ * Toggle "Render thread" in the Test window to compare the end-to-end latency and frame rate of the two loops.
+ * On one thread the update, the OpenGL calls and the swap add up. With the render thread, the update of the
+ * next frame overlaps the execution and swap of this one, so the frame rate holds up for longer as the update grows,
+ * at the cost of showing each frame one or two frames later.
+ */
+
+namespace test {
+	TestRenderThread::TestRenderThread()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_UpdateMs(8.0f), m_SpriteCount(5000), m_Time(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+		m_Texture = std::make_unique<Texture>("res/textures/mct.png");
+	}
+
+	TestRenderThread::~TestRenderThread()
+	{
+	}
+
+	void TestRenderThread::OnUpdate(float deltaTime)
+	{
+		m_Time += 1.0f / 60.0f;
+
+		// Busy, not asleep, like real update work would be
+		auto end = std::chrono::steady_clock::now() + std::chrono::duration<float, std::milli>(m_UpdateMs);
+		while (std::chrono::steady_clock::now() < end)
+			;
+	}
+
+	void TestRenderThread::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+		m_BatchRenderer->BeginBatch();
+		for (int i = 0; i < m_SpriteCount; i++)
+		{
+			float t = i * 0.618f + m_Time * 0.5f;
+			float radius = 20.0f + 250.0f * i / (float)(m_SpriteCount > 0 ? m_SpriteCount : 1);
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f),
+				glm::vec3(480.0f + std::cos(t) * radius * 1.6f, 270.0f + std::sin(t) * radius, 0.0f));
+			transform = glm::scale(transform, glm::vec3(12.0f, 12.0f, 1.0f));
+			m_BatchRenderer->SubmitQuad(transform, fullTexture, *m_Texture);
+		}
+		m_BatchRenderer->EndBatch();
+	}
+
+	void TestRenderThread::OnImGuiRender()
+	{
+		ImGui::SliderFloat("Update work (ms)", &m_UpdateMs, 0.0f, 33.0f);
+		ImGui::SliderInt("Sprites", &m_SpriteCount, 0, 100000);
+		ImGui::TextDisabled("Toggle \"Render thread\" below to compare the loops (this test restarts)");
+	}
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+
+namespace test {
+	class TestRenderThread : public Test
+	{
+	public:
+		TestRenderThread();
+		~TestRenderThread();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::unique_ptr<Texture> m_Texture;
+		glm::mat4 m_Proj;
+
+		float m_UpdateMs;	// CPU time OnUpdate() spends, standing in for game logic
+		int m_SpriteCount;	// Quads drawn, so recording and executing the frame cost something too
+		float m_Time;
+	};
+}
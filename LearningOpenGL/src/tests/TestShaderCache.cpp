@@ -0,0 +1,53 @@
+#include "TestShaderCache.h"
+#include "Shader.h"
+#include "imgui/imgui.h"
+
+/*
+ * TestShaderCache
+ * Measures how long it takes to create the Basic shader with an empty program binary cache (cold),
+ * and again once its binary has been cached (warm).
+ */
+
+namespace test {
+	TestShaderCache::TestShaderCache()
+		: m_Measured(false), m_ColdMs(0.0f), m_WarmMs(0.0f), m_WarmFromBinary(false)
+	{
+	}
+
+	TestShaderCache::~TestShaderCache()
+	{
+	}
+
+	void TestShaderCache::Measure()
+	{
+		Shader::ClearBinaryCache();
+		{
+			Shader cold("res/shaders/Basic.vert", "res/shaders/Basic.frag");
+			m_ColdMs = cold.GetLoadMs();
+		}
+		{
+			Shader warm("res/shaders/Basic.vert", "res/shaders/Basic.frag");
+			m_WarmMs = warm.GetLoadMs();
+			m_WarmFromBinary = warm.IsLoadedFromBinary();
+		}
+		m_Measured = true;
+	}
+
+	void TestShaderCache::OnImGuiRender()
+	{
+		if (!Shader::IsBinaryCacheSupported())
+		{
+			ImGui::Text("Program binaries are not supported by this driver.");
+			return;
+		}
+
+		if (ImGui::Button("Measure Basic.vert/Basic.frag"))
+			Measure();
+
+		if (m_Measured)
+		{
+			ImGui::Text("Cold (compile + link): %.3f ms", m_ColdMs);
+			ImGui::Text("Warm (program binary): %.3f ms%s", m_WarmMs, m_WarmFromBinary ? "" : " - binary was rejected");
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "Test.h"
+
+namespace test {
+	class TestShaderCache : public Test
+	{
+	public:
+		TestShaderCache();
+		~TestShaderCache();
+
+		void OnImGuiRender() override;
+
+	private:
+		void Measure();
+
+		bool m_Measured;
+		float m_ColdMs;		// Compile + link, then save the binary
+		float m_WarmMs;		// Load the saved binary
+		bool m_WarmFromBinary;
+	};
+}
@@ -0,0 +1,136 @@
+#include "TestStreaming.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "Renderer.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <cmath>
+
+/*
+ * TestStreaming
+ * Rewrites the vertices of thousands of moving quads every frame and streams them to the GPU through a
+ * StreamingVertexBuffer, so the orphaning and persistent-mapped ring strategies can be compared.
+ */
+
+namespace test {
+	static const int s_MaxQuads = 50000;
+	static const unsigned int s_StatsWindow = 60;	// Frames averaged for the displayed counters
+
+	TestStreaming::TestStreaming()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_QuadCount(20000), m_Time(0.0f),
+		m_BytesPerFrame(0.0f), m_StallMsPerFrame(0.0f)
+	{
+		// Same vertex format as the BatchRenderer, so its shader can be reused
+		m_Shader = std::make_unique<Shader>("res/shaders/Batch.vert", "res/shaders/Batch.frag");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Textures", 0);
+		m_Texture = std::make_unique<Texture>("res/textures/mct.png");
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		std::vector<unsigned int> indices(s_MaxQuads * 6);
+		for (unsigned int quad = 0; quad < s_MaxQuads; quad++)
+		{
+			unsigned int vertex = quad * 4;
+			unsigned int* index = &indices[quad * 6];
+			index[0] = vertex + 0; index[1] = vertex + 1; index[2] = vertex + 2;
+			index[3] = vertex + 2; index[4] = vertex + 3; index[5] = vertex + 0;
+		}
+
+		CreateBuffer(StreamingMode::Orphaning);
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices.data(), (unsigned int)indices.size());
+		m_Vertices.resize(s_MaxQuads * 4);
+	}
+
+	TestStreaming::~TestStreaming()
+	{
+	}
+
+	/*
+	 * (Re)creates the streaming buffer and a VAO that reads from it.
+	 */
+	void TestStreaming::CreateBuffer(StreamingMode mode)
+	{
+		m_VAO = std::make_unique<VertexArrayObject>();
+		m_VertexBuffer = std::make_unique<StreamingVertexBuffer>(s_MaxQuads * 4 * sizeof(QuadVertex), mode);
+
+		VertexBufferLayout layout;
+		layout.Push<float>(3);
+		layout.Push<float>(2);
+		layout.Push<float>(4);
+		layout.Push<float>(1);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+
+		// The new VAO needs the index buffer attached again
+		if (m_IndexBuffer)
+			m_IndexBuffer->Bind();
+	}
+
+	/*
+	 * Moves every quad along its own circle, writing its 4 corners from scratch.
+	 */
+	void TestStreaming::OnUpdate(float deltaTime)
+	{
+		m_Time += deltaTime > 0.0f ? deltaTime : 1.0f / 60.0f;
+
+		for (int quad = 0; quad < m_QuadCount; quad++)
+		{
+			float phase = quad * 0.618f;
+			float radius = 20.0f + (quad % 250);
+			float x = 480.0f + radius * std::cos(m_Time + phase);
+			float y = 270.0f + radius * 0.5f * std::sin(m_Time * 1.3f + phase);
+			float size = 3.0f;
+			glm::vec4 color(0.5f + 0.5f * std::sin(phase), 0.6f, 0.5f + 0.5f * std::cos(phase), 1.0f);
+
+			QuadVertex* v = &m_Vertices[quad * 4];
+			v[0] = { { x - size, y - size, 0.0f }, { 0.0f, 0.0f }, color, 0.0f };
+			v[1] = { { x + size, y - size, 0.0f }, { 1.0f, 0.0f }, color, 0.0f };
+			v[2] = { { x + size, y + size, 0.0f }, { 1.0f, 1.0f }, color, 0.0f };
+			v[3] = { { x - size, y + size, 0.0f }, { 0.0f, 1.0f }, color, 0.0f };
+		}
+	}
+
+	void TestStreaming::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		unsigned int offset = m_VertexBuffer->Upload(m_Vertices.data(), m_QuadCount * 4 * sizeof(QuadVertex));
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		Renderer renderer;
+		m_Texture->Bind();
+		renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader, m_QuadCount * 6, 0, offset / sizeof(QuadVertex));
+
+		m_VertexBuffer->EndFrame();
+
+		const StreamingStats& stats = m_VertexBuffer->GetStats();
+		if (stats.Frames >= s_StatsWindow)
+		{
+			m_BytesPerFrame = (float)stats.BytesUploaded / stats.Frames;
+			m_StallMsPerFrame = (float)(stats.StallMs / stats.Frames);
+			m_VertexBuffer->ResetStats();
+		}
+	}
+
+	void TestStreaming::OnImGuiRender()
+	{
+		int mode = (int)m_VertexBuffer->GetMode();
+		bool ringSupported = StreamingVertexBuffer::IsPersistentMappingSupported();
+
+		if (ImGui::RadioButton("Orphaning", mode == (int)StreamingMode::Orphaning))
+			CreateBuffer(StreamingMode::Orphaning);
+		ImGui::SameLine();
+		if (ImGui::RadioButton("Persistent ring", mode == (int)StreamingMode::PersistentRing) && ringSupported)
+			CreateBuffer(StreamingMode::PersistentRing);
+		if (!ringSupported)
+			ImGui::Text("(ARB_buffer_storage not supported)");
+
+		ImGui::SliderInt("Quads", &m_QuadCount, 1, s_MaxQuads);
+		ImGui::Text("Uploaded: %.1f KB/frame", m_BytesPerFrame / 1024.0f);
+		ImGui::Text("Upload stall: %.4f ms/frame", m_StallMsPerFrame);
+	}
+}
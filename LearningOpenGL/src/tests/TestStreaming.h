@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Test.h"
+
+#include "StreamingVertexBuffer.h"
+#include "VertexArrayObject.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "BatchRenderer.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestStreaming : public Test
+	{
+	public:
+		TestStreaming();
+		~TestStreaming();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void CreateBuffer(StreamingMode mode);
+
+		std::unique_ptr<StreamingVertexBuffer> m_VertexBuffer;
+		std::unique_ptr<VertexArrayObject> m_VAO;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		std::unique_ptr<Texture> m_Texture;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+
+		std::vector<QuadVertex> m_Vertices;
+		glm::mat4 m_Proj;
+		int m_QuadCount;
+		float m_Time;
+
+		// Averages over the last sample window, so the numbers are readable
+		float m_BytesPerFrame;
+		float m_StallMsPerFrame;
+	};
+}
@@ -15,9 +15,10 @@
 
 namespace test {
 	TestTexture2D::TestTexture2D()
-        : m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), 
+        : m_TranslationA(200, 200, 0), m_TranslationB(400, 200, 0),
+        m_Tint(1.0f),
         m_View(glm::translate(glm::mat4(1.0f), glm::vec3(0, 0, 0))), 
-        m_TranslationA(200, 200, 0), m_TranslationB(400, 200, 0)
+        m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f))
 	{
         // Verticies for our model
         float positions[] = {
@@ -59,11 +60,19 @@ namespace test {
 
 
         m_Shader->Bind();
-        m_Shader->SetUniform4f("u_Color", 0.8f, 0.3f, 0.8f, 1.0f);
 
-        // Add texture to the shader as a uniform
-        m_Texture = std::make_unique<Texture>("res/textures/manatee.jpg");
+        // Add texture to the shader as a uniform. It is decoded and uploaded in the background,
+        // so opening the test never freezes the frame (a placeholder is drawn until then)
+        m_TextureLoader = std::make_unique<TextureLoader>();
+        m_Texture = m_TextureLoader->Load("res/textures/manatee.jpg");
         m_Shader->SetUniform1i("u_Texture", 0);
+
+        // Looked up once here, so setting the model matrix every draw needs no name lookup
+        m_ModelUniform = m_Shader->GetUniformHandle("u_Model");
+
+        // Camera and material data live in uniform buffers shared by every shader using the blocks
+        m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+        m_MaterialBuffer = std::make_unique<UniformBuffer>(MaterialBlockLayout(), UniformBlockBinding::Material);
 	}
 
 	TestTexture2D::~TestTexture2D()
@@ -72,6 +81,7 @@ namespace test {
 
 	void TestTexture2D::OnUpdate(float deltaTime)
 	{
+        m_TextureLoader->Update();
 	}
 
 	void TestTexture2D::OnRender()
@@ -79,19 +89,22 @@ namespace test {
 		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
 		GLCall(glClear(GL_COLOR_BUFFER_BIT));
 
+        // Per-frame data is uploaded once, not once per draw
+        m_CameraBuffer->Set(0, m_Proj * m_View);
+        m_CameraBuffer->Bind();
+        m_MaterialBuffer->Set(0, m_Tint);
+        m_MaterialBuffer->Bind();
+
         Renderer renderer;
 
         m_Texture->Bind();
 
         /* Render instance A */
         {
-            // Create MVP matrix transformation with updated translation
+            // Only the model matrix changes between draws
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationA);
-            glm::mat4 mvp = m_Proj * m_View * model;
-            
-            // Add MVP to shader as a uniform
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->SetUniformMat4f(m_ModelUniform, model);
 
             // Render the VAO
             renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
@@ -100,9 +113,8 @@ namespace test {
         /* Render instance B */
         {
             glm::mat4 model = glm::translate(glm::mat4(1.0f), m_TranslationB);
-            glm::mat4 mvp = m_Proj * m_View * model;
             m_Shader->Bind();
-            m_Shader->SetUniformMat4f("u_MVP", mvp);
+            m_Shader->SetUniformMat4f(m_ModelUniform, model);
             renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
         }
 
@@ -112,5 +124,6 @@ namespace test {
 	{
         ImGui::SliderFloat3("Translation A", &m_TranslationA.x, 0.0f, 1000.0f);
         ImGui::SliderFloat3("Translation B", &m_TranslationB.x, 0.0f, 1000.0f);
+        ImGui::ColorEdit4("Tint", &m_Tint.x);
 	}
 }
\ No newline at end of file
@@ -5,9 +5,11 @@
 #include "VertexBuffer.h"
 #include "VertexBufferLayout.h"
 #include "Texture.h"
+#include "TextureLoader.h"
 #include "VertexArrayObject.h"
 #include "Shader.h"
 #include "IndexBuffer.h"
+#include "UniformBuffer.h"
 
 #include "glm/glm.hpp"
 
@@ -24,14 +26,21 @@ namespace test {
 		void OnRender() override;
 		void OnImGuiRender() override;
 
+		inline bool IsTextureResident() const { return m_Texture->IsResident(); }
+
 	private:
 		std::unique_ptr<VertexArrayObject> m_VAO;
 		std::unique_ptr<IndexBuffer> m_IndexBuffer;
 		std::unique_ptr<Shader> m_Shader;
-		std::unique_ptr<Texture> m_Texture;
+		UniformHandle m_ModelUniform;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::unique_ptr<UniformBuffer> m_MaterialBuffer;
+		std::unique_ptr<TextureLoader> m_TextureLoader;
+		std::shared_ptr<Texture> m_Texture;
 		std::unique_ptr<VertexBuffer> m_VertexBuffer;
 
 		glm::vec3 m_TranslationA, m_TranslationB;
+		glm::vec4 m_Tint;
 		glm::mat4 m_View, m_Proj;
 	};
 }
\ No newline at end of file
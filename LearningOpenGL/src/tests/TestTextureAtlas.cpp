@@ -0,0 +1,142 @@
+#include "TestTextureAtlas.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <string>
+
+/*
+ * TestTextureAtlas
+ * Draws sprites using 64 different images, either as 64 separate textures or from an atlas.
+ * With separate textures the BatchRenderer has to start a new draw call whenever its 16 texture slots
+ * run out, while every sprite in the atlas samples the same page, so the whole scene is one draw call.
+ */
+
+namespace test {
+	static const char* s_Files[] = { "res/textures/manatee.jpg", "res/textures/mct.png", "res/textures/Mail icon.png" };
+	static const int s_GeneratedCount = 61;
+	static const int s_GeneratedSize = 64;
+
+	TestTextureAtlas::TestTextureAtlas()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_UseAtlas(true), m_SpriteCount(5000),
+		m_Padding(2), m_SubmitMs(0.0f)
+	{
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+
+		for (const char* file : s_Files)
+			m_Textures.push_back(std::make_unique<Texture>(file));
+
+		// Soft discs in different colors, standing in for a game's many small sprites
+		for (int i = 0; i < s_GeneratedCount; i++)
+		{
+			float hue = i / (float)s_GeneratedCount * 6.2832f;
+			glm::vec3 color = 0.5f + 0.5f * glm::vec3(std::cos(hue), std::cos(hue + 2.094f), std::cos(hue + 4.189f));
+
+			std::vector<unsigned char> pixels(s_GeneratedSize * s_GeneratedSize * 4);
+			for (int y = 0; y < s_GeneratedSize; y++)
+			{
+				for (int x = 0; x < s_GeneratedSize; x++)
+				{
+					glm::vec2 p = (glm::vec2(x, y) + 0.5f) / (float)s_GeneratedSize * 2.0f - 1.0f;
+					float alpha = glm::clamp((1.0f - glm::length(p)) * 8.0f, 0.0f, 1.0f);
+					unsigned char* pixel = &pixels[(y * s_GeneratedSize + x) * 4];
+					pixel[0] = (unsigned char)(color.r * 255.0f);
+					pixel[1] = (unsigned char)(color.g * 255.0f);
+					pixel[2] = (unsigned char)(color.b * 255.0f);
+					pixel[3] = (unsigned char)(alpha * 255.0f);
+				}
+			}
+			m_Textures.push_back(std::make_unique<Texture>(s_GeneratedSize, s_GeneratedSize, pixels.data()));
+			m_GeneratedImages.push_back(std::move(pixels));
+		}
+
+		BuildAtlas();
+		GenerateSprites(m_SpriteCount);
+	}
+
+	TestTextureAtlas::~TestTextureAtlas()
+	{
+	}
+
+	void TestTextureAtlas::BuildAtlas()
+	{
+		m_Atlas = std::make_unique<AtlasBuilder>(4096, m_Padding);
+		m_AtlasIDs.clear();
+
+		for (const char* file : s_Files)
+			m_AtlasIDs.push_back(m_Atlas->AddImage(file));
+		for (int i = 0; i < s_GeneratedCount; i++)
+			m_AtlasIDs.push_back(m_Atlas->AddImage("generated " + std::to_string(i), s_GeneratedSize, s_GeneratedSize, m_GeneratedImages[i].data()));
+
+		m_Atlas->Build();
+	}
+
+	void TestTextureAtlas::GenerateSprites(int count)
+	{
+		std::mt19937 rng(1234);
+		std::uniform_real_distribution<float> x(0.0f, 960.0f), y(0.0f, 540.0f), size(12.0f, 40.0f);
+
+		m_Sprites.resize(count);
+		for (Sprite& sprite : m_Sprites)
+		{
+			float s = size(rng);
+			sprite.Transform = glm::translate(glm::mat4(1.0f), glm::vec3(x(rng), y(rng), 0.0f));
+			sprite.Transform = glm::scale(sprite.Transform, glm::vec3(s, s, 1.0f));
+			sprite.Image = rng() % m_Textures.size();
+		}
+	}
+
+	void TestTextureAtlas::OnUpdate(float deltaTime)
+	{
+	}
+
+	void TestTextureAtlas::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+		const glm::vec4 white(1.0f);
+
+		auto start = std::chrono::steady_clock::now();
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		m_BatchRenderer->BeginBatch();
+		for (const Sprite& sprite : m_Sprites)
+		{
+			const AtlasRegion& region = m_Atlas->GetRegion(m_AtlasIDs[sprite.Image]);
+			if (m_UseAtlas && region.Page >= 0)
+				m_BatchRenderer->SubmitQuad(sprite.Transform, region.UVRect, m_Atlas->GetPage(region.Page), white);
+			else
+				m_BatchRenderer->SubmitQuad(sprite.Transform, fullTexture, *m_Textures[sprite.Image], white);
+		}
+		m_BatchRenderer->EndBatch();
+
+		float ms = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		m_SubmitMs = m_SubmitMs * 0.95f + ms * 0.05f;
+	}
+
+	void TestTextureAtlas::OnImGuiRender()
+	{
+		ImGui::Checkbox("Use atlas", &m_UseAtlas);
+
+		if (ImGui::SliderInt("Sprites", &m_SpriteCount, 1, 50000))
+			GenerateSprites(m_SpriteCount);
+
+		ImGui::SliderInt("Padding", &m_Padding, 0, 8);
+		if (ImGui::IsItemDeactivatedAfterEdit())
+			BuildAtlas();
+
+		ImGui::Text("%u images in %u atlas page(s) of %dx%d", m_Atlas->GetImageCount(), m_Atlas->GetPageCount(),
+			m_Atlas->GetPageSize(), m_Atlas->GetPageSize());
+		ImGui::Text("Draw calls: %u", m_BatchRenderer->GetDrawCallCount());
+		ImGui::Text("Submit: %.3f ms, frame: %.3f ms", m_SubmitMs, 1000.0f / ImGui::GetIO().Framerate);
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Test.h"
+
+#include "AtlasBuilder.h"
+#include "BatchRenderer.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestTextureAtlas : public Test
+	{
+	public:
+		TestTextureAtlas();
+		~TestTextureAtlas();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		struct Sprite
+		{
+			glm::mat4 Transform;
+			int Image;
+		};
+
+		void BuildAtlas();
+		void GenerateSprites(int count);
+
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+
+		// The same images, as separate textures and packed into an atlas
+		std::vector<std::unique_ptr<Texture>> m_Textures;
+		std::unique_ptr<AtlasBuilder> m_Atlas;
+		std::vector<int> m_AtlasIDs;				// Atlas id of each image
+		std::vector<std::vector<unsigned char>> m_GeneratedImages;	// Pixels of the generated sprites, kept to rebuild the atlas
+
+		std::vector<Sprite> m_Sprites;
+		glm::mat4 m_Proj;
+
+		bool m_UseAtlas;
+		int m_SpriteCount;
+		int m_Padding;
+		float m_SubmitMs;	// Smoothed CPU time of BeginBatch() through EndBatch()
+	};
+}
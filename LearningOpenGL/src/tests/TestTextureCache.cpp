@@ -0,0 +1,101 @@
+#include "TestTextureCache.h"
+#include "GLErrorManager.h"
+#include "Texture.h"
+#include "TextureCache.h"
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <filesystem>
+#include <memory>
+
+/*
+ * TestTextureCache
+ * Measures startup texture loading over a directory of hundreds of images:
+ *		Uncached - the cache is disabled, every image is decoded by stb_image.
+ *		Cold - the cache is empty, every image is decoded and written to the cache.
+ *		Warm - every image is mapped from its cache file and uploaded without decoding.
+ * The images are copies of the sample textures, each under its own name so each has its own cache file.
+ * The source files are in the OS file cache for every run, so only the decoding differs.
+ */
+
+namespace test {
+	static const char* s_ImageDirectory = "cache/benchmark_images";
+	static const char* s_Sources[] = { "res/textures/manatee.jpg", "res/textures/Mail icon.png" };
+
+	TestTextureCache::TestTextureCache()
+		: m_ImageCount(300), m_Measured(false), m_Ms{ 0.0f, 0.0f, 0.0f }, m_CacheBytes(0)
+	{
+	}
+
+	TestTextureCache::~TestTextureCache()
+	{
+	}
+
+	void TestTextureCache::CreateImageDirectory()
+	{
+		std::error_code error;
+		std::filesystem::create_directories(s_ImageDirectory, error);
+
+		m_Images.clear();
+		for (int i = 0; i < m_ImageCount; i++)
+		{
+			std::filesystem::path source = s_Sources[i % 2];
+			std::string image = std::string(s_ImageDirectory) + "/" + std::to_string(i) + source.extension().string();
+			if (!std::filesystem::exists(image, error))
+				std::filesystem::copy_file(source, image, error);
+			m_Images.push_back(image);
+		}
+	}
+
+	/*
+	 * Creates a Texture for every image, keeping them all alive like a scene would, and returns the time taken
+	 */
+	float TestTextureCache::LoadAll()
+	{
+		std::vector<std::unique_ptr<Texture>> textures;
+		textures.reserve(m_Images.size());
+
+		GLCall(glFinish());
+		auto start = std::chrono::steady_clock::now();
+		for (const std::string& image : m_Images)
+			textures.push_back(std::make_unique<Texture>(image));
+		GLCall(glFinish());
+
+		return std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void TestTextureCache::Measure()
+	{
+		CreateImageDirectory();
+
+		TextureCache::SetEnabled(false);
+		m_Ms[Uncached] = LoadAll();
+
+		TextureCache::SetEnabled(true);
+		TextureCache::Clear();
+		m_Ms[Cold] = LoadAll();
+		m_Ms[Warm] = LoadAll();
+
+		m_CacheBytes = TextureCache::GetDiskSize();
+		m_Measured = true;
+	}
+
+	void TestTextureCache::OnImGuiRender()
+	{
+		ImGui::SliderInt("Images", &m_ImageCount, 10, 1000);
+		if (ImGui::Button("Measure"))
+			Measure();
+		ImGui::SameLine();
+		if (ImGui::Button("Clear cache"))
+			TextureCache::Clear();
+
+		if (m_Measured)
+		{
+			const char* names[RunCount] = { "Uncached (decode)", "Cold (decode + write)", "Warm (mapped)" };
+			for (int run = 0; run < RunCount; run++)
+				ImGui::Text("%-22s %9.1f ms  %6.3f ms/image", names[run], m_Ms[run], m_Ms[run] / m_Images.size());
+			ImGui::Text("Warm start is %.1fx faster than decoding", m_Ms[Uncached] / m_Ms[Warm]);
+			ImGui::Text("Cache on disk: %.1f MB", m_CacheBytes / (1024.0f * 1024.0f));
+		}
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Test.h"
+
+#include <string>
+#include <vector>
+
+namespace test {
+	class TestTextureCache : public Test
+	{
+	public:
+		TestTextureCache();
+		~TestTextureCache();
+
+		void OnImGuiRender() override;
+
+	private:
+		enum Run { Uncached, Cold, Warm, RunCount };
+
+		void CreateImageDirectory();
+		float LoadAll();
+		void Measure();
+
+		std::vector<std::string> m_Images;
+		int m_ImageCount;
+		bool m_Measured;
+		float m_Ms[RunCount];		// Time to construct a Texture for every image, through glFinish()
+		size_t m_CacheBytes;
+	};
+}
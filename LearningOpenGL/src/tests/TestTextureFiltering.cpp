@@ -0,0 +1,187 @@
+#include "TestTextureFiltering.h"
+#include "GLErrorManager.h"
+#include "Renderer.h"
+#include "VertexBufferLayout.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+/*
+ * TestTextureFiltering
+ * Renders a textured ground plane stretching to the horizon, so the texture is heavily minified,
+ * with each MipmapMode. Without mipmaps the far half shimmers and every pixel samples texels far apart,
+ * which thrashes the texture cache. A GL_TIME_ELAPSED query measures the GPU time of each mode.
+ */
+
+namespace test {
+	static const char* s_ModeNames[] = { "None", "glGenerateMipmap", "Box (CPU)", "Kaiser (CPU)" };
+	static const int s_PatternSize = 512;
+	static const int s_CompareFrames = 90;	// Frames spent on each mode when comparing
+
+	TestTextureFiltering::TestTextureFiltering()
+		: m_Mode(0), m_Anisotropy(1.0f), m_SRGB(false), m_Layers(8), m_QueryFrame(0),
+		m_GpuMs{ 0.0f, 0.0f, 0.0f, 0.0f }, m_CreateMs{ 0.0f, 0.0f, 0.0f, 0.0f }, m_QueryModes{ 0, 0, 0 },
+		m_Comparing(false), m_CompareFrame(0)
+	{
+		// Unit plane with the texture repeated 64 times across it
+		float vertices[] = {
+			-1.0f, -1.0f,  0.0f,  0.0f,
+			 1.0f, -1.0f, 64.0f,  0.0f,
+			 1.0f,  1.0f, 64.0f, 64.0f,
+			-1.0f,  1.0f,  0.0f, 64.0f
+		};
+		unsigned int indices[] = { 0, 1, 2, 2, 3, 0 };
+
+		m_Shader = std::make_unique<Shader>("res/shaders/Basic.vert", "res/shaders/Basic.frag");
+		m_Shader->Bind();
+		m_Shader->SetUniform1i("u_Texture", 0);
+		m_ModelUniform = m_Shader->GetUniformHandle("u_Model");
+
+		m_VAO = std::make_unique<VertexArrayObject>();
+		m_VertexBuffer = std::make_unique<VertexBuffer>(vertices, (unsigned int)sizeof(vertices));
+		VertexBufferLayout layout;
+		layout.Push<float>(2);
+		layout.Push<float>(2);
+		m_VAO->AddBuffer(*m_VertexBuffer, layout);
+		m_IndexBuffer = std::make_unique<IndexBuffer>(indices, 6);
+
+		// Camera just above a plane that runs 200 units into the distance
+		glm::mat4 proj = glm::perspective(glm::radians(60.0f), 960.0f / 540.0f, 0.1f, 500.0f);
+		glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 2.0f, 0.0f), glm::vec3(0.0f, 1.5f, -10.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+		m_ViewProjection = proj * view;
+
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+		m_MaterialBuffer = std::make_unique<UniformBuffer>(MaterialBlockLayout(), UniformBlockBinding::Material);
+		m_MaterialBuffer->Set(0, glm::vec4(1.0f));
+
+		// Fine checkerboard with thin grid lines: the worst case for aliasing
+		m_Pattern.resize(s_PatternSize * s_PatternSize * 4);
+		for (int y = 0; y < s_PatternSize; y++)
+		{
+			for (int x = 0; x < s_PatternSize; x++)
+			{
+				unsigned char* p = &m_Pattern[(y * s_PatternSize + x) * 4];
+				bool line = x % 64 == 0 || y % 64 == 0;
+				unsigned char checker = ((x / 4 + y / 4) & 1) ? 230 : 25;
+				p[0] = line ? 255 : checker;
+				p[1] = line ? 60 : checker;
+				p[2] = line ? 60 : checker;
+				p[3] = 255;
+			}
+		}
+
+		CreateTextures();
+
+		GLCall(glGenQueries(QueryCount, m_Queries));
+	}
+
+	TestTextureFiltering::~TestTextureFiltering()
+	{
+		GLCall(glDeleteQueries(QueryCount, m_Queries));
+	}
+
+	void TestTextureFiltering::CreateTextures()
+	{
+		for (int mode = 0; mode < ModeCount; mode++)
+		{
+			TextureSpec spec;
+			spec.Mipmaps = (MipmapMode)mode;
+			spec.Anisotropy = m_Anisotropy;
+			spec.WrapS = TextureWrap::Repeat;
+			spec.WrapT = TextureWrap::Repeat;
+			spec.SRGB = m_SRGB;
+
+			auto start = std::chrono::steady_clock::now();
+			m_Textures[mode].reset();
+			m_Textures[mode] = std::make_unique<Texture>(s_PatternSize, s_PatternSize, m_Pattern.data(), spec);
+			GLCall(glFinish());	// Include the driver's work (glGenerateMipmap) in the time
+			m_CreateMs[mode] = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+		}
+
+		for (float& ms : m_GpuMs)
+			ms = 0.0f;
+	}
+
+	void TestTextureFiltering::OnUpdate(float deltaTime)
+	{
+		if (!m_Comparing)
+			return;
+
+		m_CompareFrame++;
+		m_Mode = std::min(m_CompareFrame / s_CompareFrames, ModeCount - 1);
+		if (m_CompareFrame == ModeCount * s_CompareFrames)
+			m_Comparing = false;
+	}
+
+	void TestTextureFiltering::OnRender()
+	{
+		GLCall(glClearColor(0.4f, 0.6f, 0.9f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		// The query about to be reused was issued QueryCount frames ago, so its result is normally ready
+		int query = m_QueryFrame % QueryCount;
+		if (m_QueryFrame >= QueryCount)
+		{
+			GLint available = 0;
+			GLCall(glGetQueryObjectiv(m_Queries[query], GL_QUERY_RESULT_AVAILABLE, &available));
+			if (available)
+			{
+				GLuint64 ns = 0;
+				GLCall(glGetQueryObjectui64v(m_Queries[query], GL_QUERY_RESULT, &ns));
+				float& ms = m_GpuMs[m_QueryModes[query]];
+				ms = ms == 0.0f ? ns / 1e6f : ms * 0.9f + (ns / 1e6f) * 0.1f;
+			}
+		}
+
+		m_CameraBuffer->Set(0, m_ViewProjection);
+		m_CameraBuffer->Bind();
+		m_MaterialBuffer->Bind();
+
+		glm::mat4 model = glm::translate(glm::mat4(1.0f), glm::vec3(0.0f, 0.0f, -100.0f));
+		model = glm::rotate(model, glm::radians(-90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
+		model = glm::scale(model, glm::vec3(100.0f, 100.0f, 1.0f));
+
+		Renderer renderer;
+		m_Textures[m_Mode]->Bind();
+		m_Shader->Bind();
+		m_Shader->SetUniformMat4f(m_ModelUniform, model);
+
+		GLCall(glBeginQuery(GL_TIME_ELAPSED, m_Queries[query]));
+		for (int i = 0; i < m_Layers; i++)
+			renderer.Draw(*m_VAO, *m_IndexBuffer, *m_Shader);
+		GLCall(glEndQuery(GL_TIME_ELAPSED));
+
+		m_QueryModes[query] = m_Mode;
+		m_QueryFrame++;
+	}
+
+	void TestTextureFiltering::OnImGuiRender()
+	{
+		for (int mode = 0; mode < ModeCount; mode++)
+			ImGui::RadioButton(s_ModeNames[mode], &m_Mode, mode);
+
+		// Recreating the textures rebuilds the CPU mipmaps, so only do it once the slider is let go
+		ImGui::SliderFloat("Anisotropy", &m_Anisotropy, 1.0f, std::max(Texture::GetMaxAnisotropy(), 1.0f), "%.0fx");
+		if (ImGui::IsItemDeactivatedAfterEdit())
+			CreateTextures();
+		if (ImGui::Checkbox("sRGB", &m_SRGB))
+			CreateTextures();
+
+		ImGui::SliderInt("Layers", &m_Layers, 1, 64);
+
+		if (!m_Comparing && ImGui::Button("Compare all modes"))
+		{
+			m_Comparing = true;
+			m_CompareFrame = 0;
+			for (float& ms : m_GpuMs)
+				ms = 0.0f;
+		}
+
+		ImGui::Text("Immutable storage (glTexStorage2D): %s", Texture::IsImmutableStorageSupported() ? "yes" : "no");
+		for (int mode = 0; mode < ModeCount; mode++)
+			ImGui::Text("%-18s GPU %.3f ms, created in %.2f ms", s_ModeNames[mode], m_GpuMs[mode], m_CreateMs[mode]);
+	}
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include "Test.h"
+
+#include "VertexBuffer.h"
+#include "VertexArrayObject.h"
+#include "IndexBuffer.h"
+#include "Shader.h"
+#include "Texture.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestTextureFiltering : public Test
+	{
+	public:
+		TestTextureFiltering();
+		~TestTextureFiltering();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		static const int ModeCount = 4;			// One texture per MipmapMode that builds levels from pixels (not Prebuilt)
+		static const int QueryCount = 3;		// Timer results are read 3 frames late, so reading never stalls
+
+		void CreateTextures();
+
+		std::unique_ptr<VertexArrayObject> m_VAO;
+		std::unique_ptr<VertexBuffer> m_VertexBuffer;
+		std::unique_ptr<IndexBuffer> m_IndexBuffer;
+		std::unique_ptr<Shader> m_Shader;
+		UniformHandle m_ModelUniform;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::unique_ptr<UniformBuffer> m_MaterialBuffer;
+		std::unique_ptr<Texture> m_Textures[ModeCount];
+		std::vector<unsigned char> m_Pattern;	// Level 0 shared by every mode
+
+		glm::mat4 m_ViewProjection;
+		int m_Mode;
+		float m_Anisotropy;
+		bool m_SRGB;
+		int m_Layers;		// The plane is drawn this many times, so the GPU time is measurable
+
+		// GL_TIME_ELAPSED queries, one per frame in flight
+		unsigned int m_Queries[QueryCount];
+		int m_QueryFrame;
+		float m_GpuMs[ModeCount];	// Smoothed, per mode
+		float m_CreateMs[ModeCount];	// CPU time to create each texture, including building its mipmaps
+		int m_QueryModes[QueryCount];	// Mode that was drawn while each query ran
+
+		// Cycles through every mode when comparing
+		bool m_Comparing;
+		int m_CompareFrame;
+	};
+}
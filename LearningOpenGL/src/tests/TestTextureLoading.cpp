@@ -0,0 +1,126 @@
+#include "TestTextureLoading.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include "glm/gtc/matrix_transform.hpp"
+
+/*
+ * TestTextureLoading
+ * Loads a grid of textures either synchronously (the Texture constructor) or through the TextureLoader,
+ * to compare how long the render thread is blocked. The grid keeps drawing while the loader works,
+ * showing placeholders for the textures that are not resident yet.
+ */
+
+namespace test {
+	static const char* s_Images[] = { "res/textures/mct.png", "res/textures/manatee.jpg", "res/textures/Mail icon.png" };
+	static const int s_Columns = 4;
+	static const int s_Rows = 3;
+
+	TestTextureLoading::TestTextureLoading()
+		: m_Proj(glm::ortho(0.0f, 960.0f, 0.0f, 540.0f, -1.0f, 1.0f)), m_UploadBudgetKB(4096),
+		m_Loading(false), m_LastLoadAsync(false), m_LoadMs(0.0f), m_SyncBlockedMs(0.0f)
+	{
+		m_Loader = std::make_unique<TextureLoader>(m_UploadBudgetKB * 1024);
+		m_BatchRenderer = std::make_unique<BatchRenderer>();
+		m_CameraBuffer = std::make_unique<UniformBuffer>(CameraBlockLayout(), UniformBlockBinding::Camera);
+	}
+
+	TestTextureLoading::~TestTextureLoading()
+	{
+	}
+
+	void TestTextureLoading::LoadSynchronously()
+	{
+		m_Textures.clear();
+		m_LoadStart = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < s_Columns * s_Rows; i++)
+			m_Textures.push_back(std::make_shared<Texture>(s_Images[i % 3]));
+
+		m_SyncBlockedMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_LoadStart).count();
+		m_LoadMs = m_SyncBlockedMs;
+		m_LastLoadAsync = false;
+		m_Loading = false;
+	}
+
+	void TestTextureLoading::LoadAsynchronously()
+	{
+		m_Textures.clear();
+		m_Loader->ResetStats();
+		m_LoadStart = std::chrono::steady_clock::now();
+
+		for (int i = 0; i < s_Columns * s_Rows; i++)
+			m_Textures.push_back(m_Loader->Load(s_Images[i % 3]));
+
+		m_LastLoadAsync = true;
+		m_Loading = true;
+	}
+
+	void TestTextureLoading::OnUpdate(float deltaTime)
+	{
+		m_Loader->Update();
+
+		if (m_Loading && m_Loader->IsIdle())
+		{
+			m_LoadMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_LoadStart).count();
+			m_Loading = false;
+		}
+	}
+
+	void TestTextureLoading::OnRender()
+	{
+		GLCall(glClearColor(0.0f, 0.0f, 0.0f, 1.0f));
+		GLCall(glClear(GL_COLOR_BUFFER_BIT));
+
+		if (m_Textures.empty())
+			return;
+
+		m_CameraBuffer->Set(0, m_Proj);
+		m_CameraBuffer->Bind();
+
+		const glm::vec4 fullTexture(0.0f, 0.0f, 1.0f, 1.0f);
+		const glm::vec2 cell(960.0f / s_Columns, 540.0f / s_Rows);
+
+		m_BatchRenderer->BeginBatch();
+		for (int i = 0; i < (int)m_Textures.size(); i++)
+		{
+			glm::vec3 center((i % s_Columns + 0.5f) * cell.x, (i / s_Columns + 0.5f) * cell.y, 0.0f);
+			glm::mat4 transform = glm::translate(glm::mat4(1.0f), center);
+			transform = glm::scale(transform, glm::vec3(cell.x - 8.0f, cell.y - 8.0f, 1.0f));
+			m_BatchRenderer->SubmitQuad(transform, fullTexture, *m_Textures[i], glm::vec4(1.0f));
+		}
+		m_BatchRenderer->EndBatch();
+	}
+
+	void TestTextureLoading::OnImGuiRender()
+	{
+		if (ImGui::SliderInt("Upload budget (KB/frame)", &m_UploadBudgetKB, 64, 16384))
+			m_Loader->SetUploadBudget(m_UploadBudgetKB * 1024);
+
+		if (ImGui::Button("Load synchronously"))
+			LoadSynchronously();
+		ImGui::SameLine();
+		if (ImGui::Button("Load asynchronously"))
+			LoadAsynchronously();
+
+		ImGui::Text("Decode workers: %u", m_Loader->GetWorkerCount());
+
+		if (m_Loading)
+			ImGui::Text("Loading... %.0f ms", std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - m_LoadStart).count());
+		else if (!m_Textures.empty())
+			ImGui::Text("%s load: %.1f ms until resident", m_LastLoadAsync ? "Asynchronous" : "Synchronous", m_LoadMs);
+
+		if (!m_LastLoadAsync)
+		{
+			if (!m_Textures.empty())
+				ImGui::Text("Frames blocked: 1 (%.1f ms)", m_SyncBlockedMs);
+			return;
+		}
+
+		const TextureLoaderStats& stats = m_Loader->GetStats();
+		ImGui::Text("Resident: %u / %u (%u failed)", stats.Resident, stats.Requested, stats.Failed);
+		ImGui::Text("Decode: %.1f ms (worker time)", stats.DecodeMs);
+		ImGui::Text("Upload: %.1f ms (render thread), longest frame %.2f ms", stats.UploadMs, stats.MaxUpdateMs);
+		ImGui::Text("Frames blocked (> %.1f ms): %u", m_Loader->GetFrameBudgetMs(), stats.FramesBlocked);
+	}
+}
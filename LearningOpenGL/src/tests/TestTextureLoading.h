@@ -0,0 +1,46 @@
+#pragma once
+
+#include "Test.h"
+
+#include "BatchRenderer.h"
+#include "Texture.h"
+#include "TextureLoader.h"
+#include "UniformBuffer.h"
+
+#include "glm/glm.hpp"
+
+#include <chrono>
+#include <memory>
+#include <vector>
+
+namespace test {
+	class TestTextureLoading : public Test
+	{
+	public:
+		TestTextureLoading();
+		~TestTextureLoading();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		void LoadSynchronously();
+		void LoadAsynchronously();
+
+		std::unique_ptr<TextureLoader> m_Loader;
+		std::unique_ptr<BatchRenderer> m_BatchRenderer;
+		std::unique_ptr<UniformBuffer> m_CameraBuffer;
+		std::vector<std::shared_ptr<Texture>> m_Textures;
+		glm::mat4 m_Proj;
+
+		int m_UploadBudgetKB;
+
+		// Results of the last load
+		bool m_Loading;
+		bool m_LastLoadAsync;
+		std::chrono::steady_clock::time_point m_LoadStart;
+		float m_LoadMs;			// Until every texture was resident
+		float m_SyncBlockedMs;	// Length of the frame the synchronous load froze
+	};
+}
@@ -0,0 +1,84 @@
+#include "TestUniformLookup.h"
+#include "GLErrorManager.h"
+#include "imgui/imgui.h"
+
+#include <chrono>
+#include <string>
+#include <unordered_map>
+
+/*
+ * TestUniformLookup
+ * Times 1,000,000 SetUniformMat4f calls with each way of finding the uniform:
+ * the old std::string + unordered_map cache, the string_view lookup, and a cached UniformHandle.
+ */
+
+namespace test {
+	static const int s_Calls = 1000000;
+
+	TestUniformLookup::TestUniformLookup()
+		: m_Measured(false), m_StringMapMs(0.0f), m_StringViewMs(0.0f), m_HandleMs(0.0f)
+	{
+		m_Shader = std::make_unique<Shader>("res/shaders/Basic.vert", "res/shaders/Basic.frag");
+	}
+
+	TestUniformLookup::~TestUniformLookup()
+	{
+	}
+
+	/*
+	 * The lookup Shader used before uniforms were reflected: a std::string is built from the literal,
+	 * then hashed twice by find() and operator[].
+	 */
+	static int OldGetUniformLocation(std::unordered_map<std::string, int>& cache, const std::string& name)
+	{
+		if (cache.find(name) != cache.end())
+			return cache[name];
+		return -1;
+	}
+
+	void TestUniformLookup::RunBenchmark()
+	{
+		glm::mat4 matrix(1.0f);
+		m_Shader->Bind();
+
+		UniformHandle handle = m_Shader->GetUniformHandle("u_Model");
+		std::unordered_map<std::string, int> oldCache;
+		oldCache["u_Model"] = handle.Location;
+
+		GLCall(glFinish());
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < s_Calls; i++)
+		{
+			GLCall(glUniformMatrix4fv(OldGetUniformLocation(oldCache, "u_Model"), 1, GL_FALSE, &matrix[0][0]));
+		}
+		GLCall(glFinish());
+		m_StringMapMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < s_Calls; i++)
+			m_Shader->SetUniformMat4f("u_Model", matrix);
+		GLCall(glFinish());
+		m_StringViewMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		start = std::chrono::steady_clock::now();
+		for (int i = 0; i < s_Calls; i++)
+			m_Shader->SetUniformMat4f(handle, matrix);
+		GLCall(glFinish());
+		m_HandleMs = std::chrono::duration<float, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		m_Measured = true;
+	}
+
+	void TestUniformLookup::OnImGuiRender()
+	{
+		if (ImGui::Button("Run 1M SetUniformMat4f"))
+			RunBenchmark();
+
+		if (m_Measured)
+		{
+			ImGui::Text("std::string + unordered_map: %.2f ms", m_StringMapMs);
+			ImGui::Text("string_view lookup:          %.2f ms", m_StringViewMs);
+			ImGui::Text("UniformHandle:               %.2f ms", m_HandleMs);
+		}
+	}
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "Test.h"
+
+#include "Shader.h"
+
+#include <memory>
+
+namespace test {
+	class TestUniformLookup : public Test
+	{
+	public:
+		TestUniformLookup();
+		~TestUniformLookup();
+
+		void OnImGuiRender() override;
+
+	private:
+		void RunBenchmark();
+
+		std::unique_ptr<Shader> m_Shader;
+
+		bool m_Measured;
+		float m_StringMapMs;	// std::string key + unordered_map find/operator[] (the old lookup)
+		float m_StringViewMs;	// Binary search by std::string_view
+		float m_HandleMs;		// Cached UniformHandle
+	};
+}
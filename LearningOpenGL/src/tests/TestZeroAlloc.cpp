@@ -0,0 +1,77 @@
+#include "TestZeroAlloc.h"
+#include "GLErrorManager.h"
+#include "FrameArena.h"
+#include "HeapTracker.h"
+#include "imgui/imgui.h"
+
+/*
+ * TestZeroAlloc
+ * Runs the 2D Texture test and counts the heap allocations the render thread makes in each whole frame
+ * (from one OnUpdate() to the next, so Main's ImGui rendering and buffer swap are included).
+ * Once the texture is resident and the scene has run for a moment, every frame must make zero allocations;
+ * one that doesn't triggers an ASSERT.
+ */
+
+namespace test {
+	static const int s_WarmupFrames = 60;
+
+	TestZeroAlloc::TestZeroAlloc()
+		: m_LastAllocations(0), m_FrameAllocations(0), m_WarmupFrames(s_WarmupFrames), m_SteadyFrames(0),
+		m_AllocatingFrames(0), m_MaxAllocations(0), m_AssertOnAllocation(true)
+	{
+		m_Scene = std::make_unique<TestTexture2D>();
+		m_LastAllocations = HeapTracker::GetThreadAllocations();
+	}
+
+	TestZeroAlloc::~TestZeroAlloc()
+	{
+	}
+
+	void TestZeroAlloc::OnUpdate(float deltaTime)
+	{
+		unsigned long long allocations = HeapTracker::GetThreadAllocations();
+		m_FrameAllocations = allocations - m_LastAllocations;
+		m_LastAllocations = allocations;
+
+		// Loading the texture and ImGui creating its windows allocate, so the count starts once they are done
+		if (!m_Scene->IsTextureResident())
+			m_WarmupFrames = s_WarmupFrames;
+		else if (m_WarmupFrames > 0)
+			m_WarmupFrames--;
+		else
+		{
+			m_SteadyFrames++;
+			if (m_FrameAllocations > 0)
+			{
+				m_AllocatingFrames++;
+				m_MaxAllocations = m_FrameAllocations > m_MaxAllocations ? m_FrameAllocations : m_MaxAllocations;
+				if (m_AssertOnAllocation)
+					ASSERT(m_FrameAllocations == 0);
+			}
+		}
+
+		m_Scene->OnUpdate(deltaTime);
+	}
+
+	void TestZeroAlloc::OnRender()
+	{
+		m_Scene->OnRender();
+	}
+
+	void TestZeroAlloc::OnImGuiRender()
+	{
+		m_Scene->OnImGuiRender();
+
+		ImGui::Separator();
+		ImGui::Checkbox("Assert on allocation", &m_AssertOnAllocation);
+		if (m_WarmupFrames > 0)
+			ImGui::Text("Warming up (%d frames left)", m_WarmupFrames);
+		else
+			ImGui::Text("Steady frames: %u, with heap allocations: %u (at most %llu)", m_SteadyFrames, m_AllocatingFrames, m_MaxAllocations);
+		ImGui::Text("Last frame: %llu heap allocations", m_FrameAllocations);
+
+		const FrameArenaStats& arena = FrameArena::GetLastFrameStats();
+		ImGui::Text("Frame arena: %u allocations, %zu / %zu bytes, %u overflows", arena.Allocations, arena.BytesUsed,
+			arena.Capacity, arena.Overflows);
+	}
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include "Test.h"
+#include "TestTexture2D.h"
+
+#include <memory>
+
+namespace test {
+	class TestZeroAlloc : public Test
+	{
+	public:
+		TestZeroAlloc();
+		~TestZeroAlloc();
+
+		void OnUpdate(float deltaTime) override;
+		void OnRender() override;
+		void OnImGuiRender() override;
+
+	private:
+		std::unique_ptr<TestTexture2D> m_Scene;
+
+		unsigned long long m_LastAllocations;	// Render thread's allocation count at the start of the last frame
+		unsigned long long m_FrameAllocations;	// Allocations made by the last complete frame
+		int m_WarmupFrames;						// Frames left before the scene counts as steady
+		unsigned int m_SteadyFrames;
+		unsigned int m_AllocatingFrames;		// Steady frames that allocated anyway
+		unsigned long long m_MaxAllocations;
+		bool m_AssertOnAllocation;
+	};
+}
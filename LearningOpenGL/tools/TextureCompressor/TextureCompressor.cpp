@@ -0,0 +1,219 @@
+#include "BlockCompression.h"
+#include "KtxFile.h"
+#include "MipmapGenerator.h"
+#include "stb_image/stb_image.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/*
+ * TextureCompressor
+ * Offline tool that encodes images to BC1/BC3/BC7 KTX2 files with a full Kaiser filtered mip chain,
+ * for Texture to load with glCompressedTexImage2D.
+ *
+ * Usage:
+ *		TextureCompressor [--format bc1|bc3|bc7|all] [--srgb] [--no-mips] [--threads N] [--out directory] [images...]
+ *
+ *		Run from the LearningOpenGL directory with no images to compress everything in res/textures
+ *		to res/textures/compressed/<name>.<format>.ktx2.
+ *
+ * Build (it only needs the CPU side of the renderer):
+ *		g++ -std=c++17 -O2 -Isrc -Isrc/vendor tools/TextureCompressor/TextureCompressor.cpp src/BlockCompression.cpp
+ *			src/KtxFile.cpp src/MipmapGenerator.cpp src/PixelConvert.cpp src/vendor/stb_image/stb_image.cpp -pthread -o TextureCompressor
+ */
+
+namespace fs = std::filesystem;
+
+struct Options
+{
+	std::vector<BlockFormat> Formats = { BlockFormat::BC1, BlockFormat::BC3, BlockFormat::BC7 };
+	bool SRGB = false;
+	bool Mipmaps = true;
+	unsigned int Threads = std::max(std::thread::hardware_concurrency(), 1u);
+	fs::path OutputDirectory = "res/textures/compressed";
+	std::vector<fs::path> Inputs;
+};
+
+static bool ParseOptions(int argc, char** argv, Options& options)
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string argument = argv[i];
+		bool hasValue = i + 1 < argc;
+
+		if (argument == "--format" && hasValue)
+		{
+			std::string format = argv[++i];
+			if (format == "bc1")		options.Formats = { BlockFormat::BC1 };
+			else if (format == "bc3")	options.Formats = { BlockFormat::BC3 };
+			else if (format == "bc7")	options.Formats = { BlockFormat::BC7 };
+			else if (format != "all")
+			{
+				std::cout << "Unknown format " << format << std::endl;
+				return false;
+			}
+		}
+		else if (argument == "--srgb")
+			options.SRGB = true;
+		else if (argument == "--no-mips")
+			options.Mipmaps = false;
+		else if (argument == "--threads" && hasValue)
+			options.Threads = std::max(std::atoi(argv[++i]), 1);
+		else if (argument == "--out" && hasValue)
+			options.OutputDirectory = argv[++i];
+		else if (argument.rfind("--", 0) == 0)
+		{
+			std::cout << "Usage: TextureCompressor [--format bc1|bc3|bc7|all] [--srgb] [--no-mips] [--threads N] [--out directory] [images...]" << std::endl;
+			return false;
+		}
+		else
+			options.Inputs.push_back(argument);
+	}
+
+	if (options.Inputs.empty())
+	{
+		for (const fs::directory_entry& entry : fs::directory_iterator("res/textures"))
+		{
+			std::string extension = entry.path().extension().string();
+			if (entry.is_regular_file() && (extension == ".png" || extension == ".jpg" || extension == ".jpeg"))
+				options.Inputs.push_back(entry.path());
+		}
+	}
+	return true;
+}
+
+/*
+ * Compresses one level, splitting its block rows evenly between [threads] threads
+ */
+static std::vector<unsigned char> CompressLevel(const unsigned char* pixels, int width, int height, BlockFormat format, unsigned int threads)
+{
+	std::vector<unsigned char> output(BlockCompressor::GetCompressedSize(format, width, height));
+	int blockRows = (height + 3) / 4;
+	int rowsPerThread = (blockRows + threads - 1) / threads;
+
+	std::vector<std::thread> workers;
+	for (int first = 0; first < blockRows; first += rowsPerThread)
+	{
+		workers.emplace_back([=, &output]() {
+			BlockCompressor::CompressImage(pixels, width, height, format, output.data(), first, rowsPerThread);
+		});
+	}
+	for (std::thread& worker : workers)
+		worker.join();
+
+	return output;
+}
+
+/*
+ * Peak signal to noise ratio of the compressed level 0 against the source, over the channels the format keeps
+ */
+static double ComputePSNR(const unsigned char* pixels, int width, int height, BlockFormat format, const std::vector<unsigned char>& blocks)
+{
+	int blocksWide = (width + 3) / 4;
+	int channels = format == BlockFormat::BC1 ? 3 : 4;
+	unsigned int blockBytes = BlockCompressor::GetBlockBytes(format);
+
+	double squaredError = 0.0;
+	for (int by = 0; by < (height + 3) / 4; by++)
+	{
+		for (int bx = 0; bx < blocksWide; bx++)
+		{
+			unsigned char decoded[16 * 4];
+			BlockCompressor::DecompressBlock(&blocks[((size_t)by * blocksWide + bx) * blockBytes], format, decoded);
+			for (int y = 0; y < 4 && by * 4 + y < height; y++)
+			{
+				for (int x = 0; x < 4 && bx * 4 + x < width; x++)
+				{
+					const unsigned char* source = &pixels[((size_t)(by * 4 + y) * width + bx * 4 + x) * 4];
+					for (int c = 0; c < channels; c++)
+					{
+						double difference = (double)decoded[(y * 4 + x) * 4 + c] - source[c];
+						squaredError += difference * difference;
+					}
+				}
+			}
+		}
+	}
+
+	double meanSquaredError = squaredError / ((double)width * height * channels);
+	return meanSquaredError == 0.0 ? 99.0 : 10.0 * std::log10(255.0 * 255.0 / meanSquaredError);
+}
+
+int main(int argc, char** argv)
+{
+	Options options;
+	if (!ParseOptions(argc, argv, options))
+		return 1;
+
+	fs::create_directories(options.OutputDirectory);
+	std::cout << "Encoding with " << options.Threads << " threads, SIMD " << (BlockCompressor::IsSimdEnabled() ? "SSE2" : "off") << std::endl;
+
+	int failures = 0;
+	for (const fs::path& input : options.Inputs)
+	{
+		int width, height, bpp;
+		stbi_set_flip_vertically_on_load(1);	// Same orientation as Texture, so level data is bottom row first
+		unsigned char* pixels = stbi_load(input.string().c_str(), &width, &height, &bpp, 4);
+		if (!pixels)
+		{
+			std::cout << "Failed to load " << input << ": " << stbi_failure_reason() << std::endl;
+			failures++;
+			continue;
+		}
+
+		std::vector<std::vector<unsigned char>> mipmaps;
+		if (options.Mipmaps)
+			mipmaps = MipmapGenerator::Generate(pixels, width, height, MipmapFilter::Kaiser, options.SRGB, false, false);
+
+		std::cout << input.filename().string() << " (" << width << "x" << height << ", "
+			<< fs::file_size(input) / 1024 << " KB on disk, " << (size_t)width * height * 4 / 1024 << " KB as RGBA8)" << std::endl;
+
+		for (BlockFormat format : options.Formats)
+		{
+			KtxFile file;
+			file.Format = format;
+			file.SRGB = options.SRGB;
+			file.Width = width;
+			file.Height = height;
+
+			auto start = std::chrono::steady_clock::now();
+			size_t encodedPixels = 0;
+			int levelWidth = width, levelHeight = height;
+			for (size_t level = 0; level <= mipmaps.size(); level++)
+			{
+				const unsigned char* levelPixels = level == 0 ? pixels : mipmaps[level - 1].data();
+				file.Levels.push_back(CompressLevel(levelPixels, levelWidth, levelHeight, format, options.Threads));
+				encodedPixels += (size_t)levelWidth * levelHeight;
+				levelWidth = std::max(levelWidth / 2, 1);
+				levelHeight = std::max(levelHeight / 2, 1);
+			}
+			double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			std::string name = input.stem().string() + "." + BlockCompressor::GetFormatName(format) + ".ktx2";
+			std::transform(name.begin(), name.end(), name.begin(), [](char c) { return (char)std::tolower(c); });
+			fs::path output = options.OutputDirectory / name;
+			if (!file.Write(output.string()))
+			{
+				failures++;
+				continue;
+			}
+
+			double megapixelsPerSecond = encodedPixels / seconds / 1e6;
+			printf("  %s: %zu levels, %zu KB, %.2f dB, %.1f ms, %.2f MP/s (%.2f MP/s per core) -> %s\n",
+				BlockCompressor::GetFormatName(format), file.Levels.size(), file.GetDataSize() / 1024,
+				ComputePSNR(pixels, width, height, format, file.Levels[0]), seconds * 1000.0,
+				megapixelsPerSecond, megapixelsPerSecond / options.Threads, output.string().c_str());
+		}
+
+		stbi_image_free(pixels);
+	}
+
+	return failures == 0 ? 0 : 1;
+}